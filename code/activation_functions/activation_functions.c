@@ -9,9 +9,14 @@ Multiple different functions can be chosen from:
 -tanh
 -relu
 -leaku_relu
+
+The array versions (name_arr) call the SIMD kernel of the best instruction set of the CPU (see activation_functions_simd.c).
+The float32 array versions (name_arr_float) do the same with the kernels of activation_functions_simd_float.c.
+The kernels are selected with cpuid once at startup, before main runs. Without x86 the scalar loops below are used.
 */
 
 #include "activation_functions.h"
+#include "activation_functions_simd.h"
 #include <math.h>
 
 double sigmoid(double number){
@@ -108,3 +113,436 @@ double der_leaky_relu(double number, double n){
     }
     return n;
 }
+
+
+/*
+|--------------------------------------------------|
+| Scalar array versions (fallback without SIMD)    |
+|--------------------------------------------------|
+*/
+
+static void sigmoid_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = sigmoid(input[i]);
+    }
+}
+
+static void der_sigmoid_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = der_sigmoid(input[i]);
+    }
+}
+
+static void tanh_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = tanh_(input[i]);
+    }
+}
+
+static void der_tanh_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = der_tanh_(input[i]);
+    }
+}
+
+static void relu_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = relu(input[i]);
+    }
+}
+
+static void der_relu_arr_scalar(const double* input, double* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = der_relu(input[i]);
+    }
+}
+
+static void leaky_relu_arr_scalar(const double* input, double* output, size_t size, double n){
+    for (size_t i = 0; i < size; i++){
+        output[i] = leaky_relu(input[i], n);
+    }
+}
+
+static void der_leaky_relu_arr_scalar(const double* input, double* output, size_t size, double n){
+    for (size_t i = 0; i < size; i++){
+        output[i] = der_leaky_relu(input[i], n);
+    }
+}
+
+// float32 versions (computed with the double functions and rounded to float)
+
+static void sigmoid_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) sigmoid(input[i]);
+    }
+}
+
+static void der_sigmoid_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) der_sigmoid(input[i]);
+    }
+}
+
+static void tanh_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) tanh_(input[i]);
+    }
+}
+
+static void der_tanh_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) der_tanh_(input[i]);
+    }
+}
+
+static void relu_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) relu(input[i]);
+    }
+}
+
+static void der_relu_arr_float_scalar(const float* input, float* output, size_t size){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) der_relu(input[i]);
+    }
+}
+
+static void leaky_relu_arr_float_scalar(const float* input, float* output, size_t size, float n){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) leaky_relu(input[i], n);
+    }
+}
+
+static void der_leaky_relu_arr_float_scalar(const float* input, float* output, size_t size, float n){
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) der_leaky_relu(input[i], n);
+    }
+}
+
+
+/*
+Scalar versions of the fused softmax and cross entropy kernels (same three steps as SOFTMAX_CROSS_ENTROPY_KERNEL)*/
+static void softmax_cross_entropy_arr_scalar(const double* logits, const double* labels, double* output, size_t size, double* sums){
+    double largest = logits[0];
+    for (size_t i = 1; i < size; i++){
+        largest = (logits[i] > largest) ? logits[i] : largest;
+    }
+
+    double sum = 0;
+    for (size_t i = 0; i < size; i++){
+        output[i] = exp(logits[i] - largest);
+        sum += output[i];
+    }
+
+    double inverse = 1.0 / sum;
+    double label_sum = 0;
+    double label_dot = 0;
+    for (size_t i = 0; i < size; i++){
+        output[i] *= inverse;
+        if (labels){
+            output[i] -= labels[i];
+            label_sum += labels[i];
+            label_dot += labels[i] * (logits[i] - largest);
+        }
+    }
+    sums[SOFTMAX_SUM_EXPS] = sum;
+    sums[SOFTMAX_SUM_LABELS] = label_sum;
+    sums[SOFTMAX_LABELS_DOT] = label_dot;
+}
+
+static void softmax_cross_entropy_arr_float_scalar(const float* logits, const double* labels, float* output, size_t size, double* sums){
+    float largest = logits[0];
+    for (size_t i = 1; i < size; i++){
+        largest = (logits[i] > largest) ? logits[i] : largest;
+    }
+
+    double sum = 0;
+    for (size_t i = 0; i < size; i++){
+        output[i] = (float) exp((double) logits[i] - largest);
+        sum += output[i];
+    }
+
+    double inverse = 1.0 / sum;
+    double label_sum = 0;
+    double label_dot = 0;
+    for (size_t i = 0; i < size; i++){
+        if (labels){
+            output[i] = (float) (output[i] * inverse - labels[i]);
+            label_sum += labels[i];
+            label_dot += labels[i] * ((double) logits[i] - largest);
+        }
+        else{
+            output[i] = (float) (output[i] * inverse);
+        }
+    }
+    sums[SOFTMAX_SUM_EXPS] = sum;
+    sums[SOFTMAX_SUM_LABELS] = label_sum;
+    sums[SOFTMAX_LABELS_DOT] = label_dot;
+}
+
+
+/*
+|--------------------------------------------------|
+| Dispatch of the array versions                   |
+|--------------------------------------------------|
+*/
+
+// Kernels currently used by the array versions (scalar until select_activation_kernels() runs)
+static int kernels_in_use = ACTIVATION_KERNELS_SCALAR;
+static void (*sigmoid_kernel)(const double*, double*, size_t) = sigmoid_arr_scalar;
+static void (*der_sigmoid_kernel)(const double*, double*, size_t) = der_sigmoid_arr_scalar;
+static void (*tanh_kernel)(const double*, double*, size_t) = tanh_arr_scalar;
+static void (*der_tanh_kernel)(const double*, double*, size_t) = der_tanh_arr_scalar;
+static void (*relu_kernel)(const double*, double*, size_t) = relu_arr_scalar;
+static void (*der_relu_kernel)(const double*, double*, size_t) = der_relu_arr_scalar;
+static void (*leaky_relu_kernel)(const double*, double*, size_t, double) = leaky_relu_arr_scalar;
+static void (*der_leaky_relu_kernel)(const double*, double*, size_t, double) = der_leaky_relu_arr_scalar;
+static void (*sigmoid_float_kernel)(const float*, float*, size_t) = sigmoid_arr_float_scalar;
+static void (*der_sigmoid_float_kernel)(const float*, float*, size_t) = der_sigmoid_arr_float_scalar;
+static void (*tanh_float_kernel)(const float*, float*, size_t) = tanh_arr_float_scalar;
+static void (*der_tanh_float_kernel)(const float*, float*, size_t) = der_tanh_arr_float_scalar;
+static void (*relu_float_kernel)(const float*, float*, size_t) = relu_arr_float_scalar;
+static void (*der_relu_float_kernel)(const float*, float*, size_t) = der_relu_arr_float_scalar;
+static void (*leaky_relu_float_kernel)(const float*, float*, size_t, float) = leaky_relu_arr_float_scalar;
+static void (*der_leaky_relu_float_kernel)(const float*, float*, size_t, float) = der_leaky_relu_arr_float_scalar;
+static void (*softmax_cross_entropy_kernel)(const double*, const double*, double*, size_t, double*) = softmax_cross_entropy_arr_scalar;
+static void (*softmax_cross_entropy_float_kernel)(const float*, const double*, float*, size_t, double*) = softmax_cross_entropy_arr_float_scalar;
+
+
+/*
+Returns the fastest instruction set supported by the CPU (and the operating system), checked with cpuid.*/
+int best_activation_kernels(void){
+#ifdef ACTIVATION_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")){
+        return ACTIVATION_KERNELS_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return ACTIVATION_KERNELS_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")){
+        return ACTIVATION_KERNELS_SSE2;
+    }
+#endif
+    return ACTIVATION_KERNELS_SCALAR;
+}
+
+
+/*
+Function to select the kernels used by the array versions.
+Returns 0 on success and -1 if the instruction set is not supported by the CPU (the kernels are not changed).*/
+int select_activation_kernels(int kernels){
+
+    if (kernels < ACTIVATION_KERNELS_SCALAR || kernels > best_activation_kernels()){
+        return -1;
+    }
+
+    switch (kernels){
+#ifdef ACTIVATION_KERNELS_X86
+        case ACTIVATION_KERNELS_AVX512:
+            sigmoid_kernel = sigmoid_arr_avx512;
+            der_sigmoid_kernel = der_sigmoid_arr_avx512;
+            tanh_kernel = tanh_arr_avx512;
+            der_tanh_kernel = der_tanh_arr_avx512;
+            relu_kernel = relu_arr_avx512;
+            der_relu_kernel = der_relu_arr_avx512;
+            leaky_relu_kernel = leaky_relu_arr_avx512;
+            der_leaky_relu_kernel = der_leaky_relu_arr_avx512;
+            sigmoid_float_kernel = sigmoid_arr_float_avx512;
+            der_sigmoid_float_kernel = der_sigmoid_arr_float_avx512;
+            tanh_float_kernel = tanh_arr_float_avx512;
+            der_tanh_float_kernel = der_tanh_arr_float_avx512;
+            relu_float_kernel = relu_arr_float_avx512;
+            der_relu_float_kernel = der_relu_arr_float_avx512;
+            leaky_relu_float_kernel = leaky_relu_arr_float_avx512;
+            der_leaky_relu_float_kernel = der_leaky_relu_arr_float_avx512;
+            softmax_cross_entropy_kernel = softmax_cross_entropy_arr_avx512;
+            softmax_cross_entropy_float_kernel = softmax_cross_entropy_arr_float_avx512;
+            break;
+
+        case ACTIVATION_KERNELS_AVX2:
+            sigmoid_kernel = sigmoid_arr_avx2;
+            der_sigmoid_kernel = der_sigmoid_arr_avx2;
+            tanh_kernel = tanh_arr_avx2;
+            der_tanh_kernel = der_tanh_arr_avx2;
+            relu_kernel = relu_arr_avx2;
+            der_relu_kernel = der_relu_arr_avx2;
+            leaky_relu_kernel = leaky_relu_arr_avx2;
+            der_leaky_relu_kernel = der_leaky_relu_arr_avx2;
+            sigmoid_float_kernel = sigmoid_arr_float_avx2;
+            der_sigmoid_float_kernel = der_sigmoid_arr_float_avx2;
+            tanh_float_kernel = tanh_arr_float_avx2;
+            der_tanh_float_kernel = der_tanh_arr_float_avx2;
+            relu_float_kernel = relu_arr_float_avx2;
+            der_relu_float_kernel = der_relu_arr_float_avx2;
+            leaky_relu_float_kernel = leaky_relu_arr_float_avx2;
+            der_leaky_relu_float_kernel = der_leaky_relu_arr_float_avx2;
+            softmax_cross_entropy_kernel = softmax_cross_entropy_arr_avx2;
+            softmax_cross_entropy_float_kernel = softmax_cross_entropy_arr_float_avx2;
+            break;
+
+        case ACTIVATION_KERNELS_SSE2:
+            sigmoid_kernel = sigmoid_arr_sse2;
+            der_sigmoid_kernel = der_sigmoid_arr_sse2;
+            tanh_kernel = tanh_arr_sse2;
+            der_tanh_kernel = der_tanh_arr_sse2;
+            relu_kernel = relu_arr_sse2;
+            der_relu_kernel = der_relu_arr_sse2;
+            leaky_relu_kernel = leaky_relu_arr_sse2;
+            der_leaky_relu_kernel = der_leaky_relu_arr_sse2;
+            sigmoid_float_kernel = sigmoid_arr_float_sse2;
+            der_sigmoid_float_kernel = der_sigmoid_arr_float_sse2;
+            tanh_float_kernel = tanh_arr_float_sse2;
+            der_tanh_float_kernel = der_tanh_arr_float_sse2;
+            relu_float_kernel = relu_arr_float_sse2;
+            der_relu_float_kernel = der_relu_arr_float_sse2;
+            leaky_relu_float_kernel = leaky_relu_arr_float_sse2;
+            der_leaky_relu_float_kernel = der_leaky_relu_arr_float_sse2;
+            softmax_cross_entropy_kernel = softmax_cross_entropy_arr_sse2;
+            softmax_cross_entropy_float_kernel = softmax_cross_entropy_arr_float_sse2;
+            break;
+#endif
+        default:
+            sigmoid_kernel = sigmoid_arr_scalar;
+            der_sigmoid_kernel = der_sigmoid_arr_scalar;
+            tanh_kernel = tanh_arr_scalar;
+            der_tanh_kernel = der_tanh_arr_scalar;
+            relu_kernel = relu_arr_scalar;
+            der_relu_kernel = der_relu_arr_scalar;
+            leaky_relu_kernel = leaky_relu_arr_scalar;
+            der_leaky_relu_kernel = der_leaky_relu_arr_scalar;
+            sigmoid_float_kernel = sigmoid_arr_float_scalar;
+            der_sigmoid_float_kernel = der_sigmoid_arr_float_scalar;
+            tanh_float_kernel = tanh_arr_float_scalar;
+            der_tanh_float_kernel = der_tanh_arr_float_scalar;
+            relu_float_kernel = relu_arr_float_scalar;
+            der_relu_float_kernel = der_relu_arr_float_scalar;
+            leaky_relu_float_kernel = leaky_relu_arr_float_scalar;
+            der_leaky_relu_float_kernel = der_leaky_relu_arr_float_scalar;
+            softmax_cross_entropy_kernel = softmax_cross_entropy_arr_scalar;
+            softmax_cross_entropy_float_kernel = softmax_cross_entropy_arr_float_scalar;
+            break;
+    }
+
+    kernels_in_use = kernels;
+    return 0;
+}
+
+
+/*
+Returns the instruction set of the kernels currently used by the array versions*/
+int current_activation_kernels(void){
+    return kernels_in_use;
+}
+
+
+/*
+Returns the name of an instruction set (for printing)*/
+const char* activation_kernels_name(int kernels){
+    switch (kernels){
+        case ACTIVATION_KERNELS_AVX512: return "AVX-512";
+        case ACTIVATION_KERNELS_AVX2:   return "AVX2";
+        case ACTIVATION_KERNELS_SSE2:   return "SSE2";
+        default:                        return "scalar";
+    }
+}
+
+
+/*
+Selects the best kernels once at startup (runs before main)*/
+__attribute__((constructor))
+static void initialise_activation_kernels(void){
+    select_activation_kernels(best_activation_kernels());
+}
+
+
+/*
+Array versions: apply the function to input[0:size] and store the result in output[0:size].
+input and output may be the same array.*/
+
+void sigmoid_arr(const double* input, double* output, size_t size){
+    sigmoid_kernel(input, output, size);
+}
+
+void der_sigmoid_arr(const double* input, double* output, size_t size){
+    der_sigmoid_kernel(input, output, size);
+}
+
+void tanh_arr(const double* input, double* output, size_t size){
+    tanh_kernel(input, output, size);
+}
+
+void der_tanh_arr(const double* input, double* output, size_t size){
+    der_tanh_kernel(input, output, size);
+}
+
+void relu_arr(const double* input, double* output, size_t size){
+    relu_kernel(input, output, size);
+}
+
+void der_relu_arr(const double* input, double* output, size_t size){
+    der_relu_kernel(input, output, size);
+}
+
+void leaky_relu_arr(const double* input, double* output, size_t size, double n){
+    leaky_relu_kernel(input, output, size, n);
+}
+
+void der_leaky_relu_arr(const double* input, double* output, size_t size, double n){
+    der_leaky_relu_kernel(input, output, size, n);
+}
+
+void sigmoid_arr_float(const float* input, float* output, size_t size){
+    sigmoid_float_kernel(input, output, size);
+}
+
+void der_sigmoid_arr_float(const float* input, float* output, size_t size){
+    der_sigmoid_float_kernel(input, output, size);
+}
+
+void tanh_arr_float(const float* input, float* output, size_t size){
+    tanh_float_kernel(input, output, size);
+}
+
+void der_tanh_arr_float(const float* input, float* output, size_t size){
+    der_tanh_float_kernel(input, output, size);
+}
+
+void relu_arr_float(const float* input, float* output, size_t size){
+    relu_float_kernel(input, output, size);
+}
+
+void der_relu_arr_float(const float* input, float* output, size_t size){
+    der_relu_float_kernel(input, output, size);
+}
+
+void leaky_relu_arr_float(const float* input, float* output, size_t size, float n){
+    leaky_relu_float_kernel(input, output, size, n);
+}
+
+void der_leaky_relu_arr_float(const float* input, float* output, size_t size, float n){
+    der_leaky_relu_float_kernel(input, output, size, n);
+}
+
+
+/*
+Fused softmax output layer with the categorical cross entropy: one pass over the outputs of a data point
+instead of calling the activation, the cost and their derivatives for every output.
+Writes output[i] = softmax(logits)[i] - labels[i], the deltas of the outputs (the derivative of the cost after the logits
+if the labels sum up to 1, i.e. are one hot or soft labels).
+Returns the cross entropy -sum(labels[i] * log(softmax(logits)[i])), computed as
+log(sum(exp(logits - largest logit))) * sum(labels) - sum(labels * (logits - largest logit)),
+so that exp never overflows and no log of a tiny probability is taken.
+With labels NULL only the probabilities softmax(logits) are written and 0 is returned (predictions).
+size has to be at least 1, logits and output may only be the same array if labels is NULL.*/
+double softmax_cross_entropy_arr(const double* logits, const double* labels, double* output, size_t size){
+    double sums[NUM_SOFTMAX_SUMS];
+    softmax_cross_entropy_kernel(logits, labels, output, size, sums);
+    return log(sums[SOFTMAX_SUM_EXPS]) * sums[SOFTMAX_SUM_LABELS] - sums[SOFTMAX_LABELS_DOT];
+}
+
+double softmax_cross_entropy_arr_float(const float* logits, const double* labels, float* output, size_t size){
+    double sums[NUM_SOFTMAX_SUMS];
+    softmax_cross_entropy_float_kernel(logits, labels, output, size, sums);
+    return log(sums[SOFTMAX_SUM_EXPS]) * sums[SOFTMAX_SUM_LABELS] - sums[SOFTMAX_LABELS_DOT];
+}
@@ -9,6 +9,10 @@ Include:
 -tanh
 -relu
 -leaku_relu
+
+Every function also has an array version (name_arr) that applies it to a whole array at once.
+The array versions use SIMD kernels (SSE2, AVX2 or AVX-512) selected with cpuid at startup.
+softmax_cross_entropy_arr is the fused softmax output layer with its cost (for NUM_OUTPUT > 1, see SOFTMAX_OUTPUT in config.h).
 */
 
 
@@ -28,4 +32,61 @@ double leaky_relu(double, double);
 double der_leaky_relu(double,double);
 
 
+/*******************************************
+ * Array versions: output[i] = f(input[i]) *
+ *******************************************/
+
+#include <stddef.h> // For size_t
+
+void sigmoid_arr(const double*, double*, size_t);
+void der_sigmoid_arr(const double*, double*, size_t);
+
+void tanh_arr(const double*, double*, size_t);
+void der_tanh_arr(const double*, double*, size_t);
+
+void relu_arr(const double*, double*, size_t);
+void der_relu_arr(const double*, double*, size_t);
+
+void leaky_relu_arr(const double*, double*, size_t, double);
+void der_leaky_relu_arr(const double*, double*, size_t, double);
+
+// float32 versions for the dense engine in single and mixed precision (name_arr_float)
+void sigmoid_arr_float(const float*, float*, size_t);
+void der_sigmoid_arr_float(const float*, float*, size_t);
+
+void tanh_arr_float(const float*, float*, size_t);
+void der_tanh_arr_float(const float*, float*, size_t);
+
+void relu_arr_float(const float*, float*, size_t);
+void der_relu_arr_float(const float*, float*, size_t);
+
+void leaky_relu_arr_float(const float*, float*, size_t, float);
+void der_leaky_relu_arr_float(const float*, float*, size_t, float);
+
+
+/*******************************************
+ * Softmax output layer                    *
+ *******************************************/
+
+// Fused softmax and categorical cross entropy of the outputs of one data point (deltas = probabilities - labels, returns the cost)
+double softmax_cross_entropy_arr(const double*, const double*, double*, size_t);
+double softmax_cross_entropy_arr_float(const float*, const double*, float*, size_t);
+
+
+/*******************************************
+ * Selection of the SIMD kernels           *
+ *******************************************/
+
+// Instruction sets of the array versions (ordered from slowest to fastest)
+#define ACTIVATION_KERNELS_SCALAR 0
+#define ACTIVATION_KERNELS_SSE2 1
+#define ACTIVATION_KERNELS_AVX2 2
+#define ACTIVATION_KERNELS_AVX512 3
+
+int best_activation_kernels(void);
+int select_activation_kernels(int);
+int current_activation_kernels(void);
+const char* activation_kernels_name(int);
+
+
 #endif //ACTIVATION_FUNCTIONS_H
\ No newline at end of file
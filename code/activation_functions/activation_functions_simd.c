@@ -0,0 +1,489 @@
+/*
+This file holds the SIMD kernels of the array versions of the activation functions (and their derivatives).
+There is one kernel per function for SSE2, AVX2 (+FMA) and AVX-512F. activation_functions.c selects the kernels at startup.
+
+Every kernel is compiled for its own instruction set with a target attribute,
+so that the file does not need -march flags and the binary still runs on CPUs without AVX.
+Elements that do not fill a whole vector are computed with the scalar functions.
+
+exp() is vectorised by hand (sigmoid and tanh are built on it):
+- x = k * ln(2) + r with |r| <= ln(2)/2
+- exp(r) is a polynomial of degree 12 (relative error below 1e-15)
+- 2^k is added directly to the exponent bits of exp(r)
+Inputs are clamped to [EXP_MIN, EXP_MAX], so that the results never overflow.
+
+The fused softmax and cross entropy kernels of the output layer are built on the same exp (see SOFTMAX_CROSS_ENTROPY_KERNEL).
+
+This file may not use any header files but its own.*/
+
+#include "activation_functions.h"
+#include "activation_functions_simd.h"
+
+#ifdef ACTIVATION_KERNELS_X86
+
+#include <immintrin.h>
+
+// Clamping of the inputs of exp (2^k has to fit into the exponent of a double)
+#define EXP_MAX 709.0
+#define EXP_MIN -708.0
+
+// Constants of the range reduction (ln(2) is split into two parts to keep k * ln(2) exact)
+#define LOG2E 1.4426950408889634
+#define LN2_HI 6.93147180369123816490e-01
+#define LN2_LO 1.90821492927058770002e-10
+
+// Adding 1.5 * 2^52 rounds to an integer and stores it in the lowest bits of the mantissa
+#define SHIFTER 0x1.8p52
+
+// Number of coefficients of the polynomial of exp(r)
+#define NUM_EXP_COEFFICIENTS 13
+
+// Taylor coefficients of exp(r), highest degree first (for the Horner scheme)
+static const double EXP_COEFFICIENTS[NUM_EXP_COEFFICIENTS] = {
+    1.0 / 479001600.0,  // 1/12!
+    1.0 / 39916800.0,   // 1/11!
+    1.0 / 3628800.0,    // 1/10!
+    1.0 / 362880.0,     // 1/9!
+    1.0 / 40320.0,      // 1/8!
+    1.0 / 5040.0,       // 1/7!
+    1.0 / 720.0,        // 1/6!
+    1.0 / 120.0,        // 1/5!
+    1.0 / 24.0,         // 1/4!
+    1.0 / 6.0,          // 1/3!
+    1.0 / 2.0,          // 1/2!
+    1.0,                // 1/1!
+    1.0                 // 1/0!
+};
+
+
+/*
+Defines the array kernel "name" from a vector function:
+full vectors of "width" doubles use vector_func, the remaining elements use scalar_func.*/
+#define ARRAY_KERNEL(name, target_isa, width, load, store, vector_func, scalar_func) \
+    __attribute__((target(target_isa)))                                             \
+    void name(const double* input, double* output, size_t size){                    \
+        size_t i = 0;                                                                \
+        for (; i + (width) <= size; i += (width)){                                   \
+            store(output + i, vector_func(load(input + i)));                         \
+        }                                                                            \
+        for (; i < size; i++){                                                       \
+            output[i] = scalar_func(input[i]);                                       \
+        }                                                                            \
+    }
+
+/*
+Same as ARRAY_KERNEL for the functions with a slope (leaky relu).*/
+#define SLOPE_ARRAY_KERNEL(name, target_isa, width, load, store, set1, vector_func, scalar_func) \
+    __attribute__((target(target_isa)))                                                         \
+    void name(const double* input, double* output, size_t size, double slope){                  \
+        size_t i = 0;                                                                            \
+        for (; i + (width) <= size; i += (width)){                                               \
+            store(output + i, vector_func(load(input + i), set1(slope)));                        \
+        }                                                                                        \
+        for (; i < size; i++){                                                                   \
+            output[i] = scalar_func(input[i], slope);                                            \
+        }                                                                                        \
+    }
+
+
+/*
+Defines the fused softmax and cross entropy kernel "name" (see softmax_cross_entropy_arr() in activation_functions.c):
+1. the largest logit
+2. exp(logit - largest logit) into output and the sum of the exps
+3. output = exp / sum - label, the sum of the labels and the sum of label * (logit - largest logit)
+The sums are written into sums[NUM_SOFTMAX_SUMS], the caller turns them into the cost (this file may not use math.h).
+Elements that do not fill a whole vector go through exp in a vector padded with zeros.*/
+#define SOFTMAX_CROSS_ENTROPY_KERNEL(name, target_isa, width, vec, load, store, set1, vmax, vadd, vsub, vmul, reduce_max, reduce_add, vector_exp) \
+    __attribute__((target(target_isa)))                                                                             \
+    void name(const double* logits, const double* labels, double* output, size_t size, double* sums){              \
+        /* 1. Largest logit (subtracted, so that exp never overflows) */                                            \
+        double largest = logits[0];                                                                                 \
+        size_t i = 0;                                                                                               \
+        if (size >= (width)){                                                                                       \
+            vec largest_vec = load(logits);                                                                         \
+            for (i = (width); i + (width) <= size; i += (width)){                                                   \
+                largest_vec = vmax(largest_vec, load(logits + i));                                                  \
+            }                                                                                                       \
+            largest = reduce_max(largest_vec);                                                                      \
+        }                                                                                                           \
+        for (; i < size; i++){                                                                                      \
+            largest = (logits[i] > largest) ? logits[i] : largest;                                                  \
+        }                                                                                                           \
+                                                                                                                    \
+        /* 2. exp(logit - largest logit) and their sum */                                                           \
+        vec shift = set1(largest);                                                                                  \
+        vec sum_vec = set1(0.0);                                                                                    \
+        for (i = 0; i + (width) <= size; i += (width)){                                                             \
+            vec exps = vector_exp(vsub(load(logits + i), shift));                                                   \
+            store(output + i, exps);                                                                                \
+            sum_vec = vadd(sum_vec, exps);                                                                          \
+        }                                                                                                           \
+        double sum = reduce_add(sum_vec);                                                                           \
+        if (i < size){                                                                                              \
+            double tail[(width)] = {0};                                                                             \
+            for (size_t j = 0; i + j < size; j++){                                                                  \
+                tail[j] = logits[i + j] - largest;                                                                  \
+            }                                                                                                       \
+            store(tail, vector_exp(load(tail)));                                                                    \
+            for (size_t j = 0; i + j < size; j++){                                                                  \
+                output[i + j] = tail[j];                                                                            \
+                sum += tail[j];                                                                                     \
+            }                                                                                                       \
+        }                                                                                                           \
+                                                                                                                    \
+        /* 3. Probabilities minus the labels */                                                                     \
+        double inverse = 1.0 / sum;                                                                                 \
+        vec inverse_vec = set1(inverse);                                                                            \
+        vec label_sum_vec = set1(0.0);                                                                              \
+        vec label_dot_vec = set1(0.0);                                                                              \
+        double label_sum = 0;                                                                                       \
+        double label_dot = 0;                                                                                       \
+        if (labels){                                                                                                \
+            for (i = 0; i + (width) <= size; i += (width)){                                                         \
+                vec label = load(labels + i);                                                                       \
+                store(output + i, vsub(vmul(load(output + i), inverse_vec), label));                                \
+                label_sum_vec = vadd(label_sum_vec, label);                                                         \
+                label_dot_vec = vadd(label_dot_vec, vmul(label, vsub(load(logits + i), shift)));                    \
+            }                                                                                                       \
+            label_sum = reduce_add(label_sum_vec);                                                                  \
+            label_dot = reduce_add(label_dot_vec);                                                                  \
+            for (; i < size; i++){                                                                                  \
+                output[i] = output[i] * inverse - labels[i];                                                        \
+                label_sum += labels[i];                                                                             \
+                label_dot += labels[i] * (logits[i] - largest);                                                     \
+            }                                                                                                       \
+        }                                                                                                           \
+        else{                                                                                                       \
+            for (i = 0; i + (width) <= size; i += (width)){                                                         \
+                store(output + i, vmul(load(output + i), inverse_vec));                                             \
+            }                                                                                                       \
+            for (; i < size; i++){                                                                                  \
+                output[i] *= inverse;                                                                               \
+            }                                                                                                       \
+        }                                                                                                           \
+        sums[SOFTMAX_SUM_EXPS] = sum;                                                                               \
+        sums[SOFTMAX_SUM_LABELS] = label_sum;                                                                       \
+        sums[SOFTMAX_LABELS_DOT] = label_dot;                                                                       \
+    }
+
+
+/*
+|--------------------------------|
+| SSE2 (2 doubles per vector)    |
+|--------------------------------|
+*/
+
+__attribute__((target("sse2")))
+static inline __m128d exp_sse2(__m128d x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(EXP_MIN)), _mm_set1_pd(EXP_MAX));
+    __m128d shifted = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(LOG2E)), _mm_set1_pd(SHIFTER));
+    __m128d k = _mm_sub_pd(shifted, _mm_set1_pd(SHIFTER));
+    __m128d r = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(LN2_HI)));
+    r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(LN2_LO)));
+
+    // 2. exp(r) with the Horner scheme
+    __m128d poly = _mm_set1_pd(EXP_COEFFICIENTS[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS; c++){
+        poly = _mm_add_pd(_mm_mul_pd(poly, r), _mm_set1_pd(EXP_COEFFICIENTS[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m128i scale = _mm_slli_epi64(_mm_castpd_si128(shifted), 52);
+    return _mm_castsi128_pd(_mm_add_epi64(_mm_castpd_si128(poly), scale));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d sigmoid_sse2(__m128d x){
+    __m128d one = _mm_set1_pd(1.0);
+    return _mm_div_pd(one, _mm_add_pd(one, exp_sse2(_mm_sub_pd(_mm_setzero_pd(), x))));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d der_sigmoid_sse2(__m128d x){
+    __m128d s = sigmoid_sse2(x);
+    return _mm_mul_pd(s, _mm_sub_pd(_mm_set1_pd(1.0), s));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d tanh_sse2(__m128d x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), the sign of x is copied afterwards
+    __m128d sign_mask = _mm_set1_pd(-0.0);
+    __m128d abs_x = _mm_andnot_pd(sign_mask, x);
+    __m128d e = exp_sse2(_mm_add_pd(abs_x, abs_x));
+    __m128d t = _mm_sub_pd(_mm_set1_pd(1.0), _mm_div_pd(_mm_set1_pd(2.0), _mm_add_pd(e, _mm_set1_pd(1.0))));
+    return _mm_or_pd(t, _mm_and_pd(sign_mask, x));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d der_tanh_sse2(__m128d x){
+    __m128d t = tanh_sse2(x);
+    return _mm_sub_pd(_mm_set1_pd(1.0), _mm_mul_pd(t, t));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d relu_sse2(__m128d x){
+    return _mm_max_pd(x, _mm_setzero_pd());
+}
+
+__attribute__((target("sse2")))
+static inline __m128d der_relu_sse2(__m128d x){
+    __m128d zero = _mm_setzero_pd();
+    __m128d positive = _mm_and_pd(_mm_cmpgt_pd(x, zero), _mm_set1_pd(1.0));
+    __m128d at_zero = _mm_and_pd(_mm_cmpeq_pd(x, zero), _mm_set1_pd(0.5));
+    return _mm_or_pd(positive, at_zero);
+}
+
+__attribute__((target("sse2")))
+static inline __m128d leaky_relu_sse2(__m128d x, __m128d slope){
+    __m128d positive = _mm_cmpgt_pd(x, _mm_setzero_pd());
+    return _mm_or_pd(_mm_and_pd(positive, x), _mm_andnot_pd(positive, _mm_mul_pd(x, slope)));
+}
+
+__attribute__((target("sse2")))
+static inline __m128d der_leaky_relu_sse2(__m128d x, __m128d slope){
+    __m128d zero = _mm_setzero_pd();
+    __m128d one = _mm_set1_pd(1.0);
+    __m128d positive = _mm_cmpgt_pd(x, zero);
+    __m128d at_zero = _mm_cmpeq_pd(x, zero);
+    __m128d half = _mm_mul_pd(_mm_add_pd(one, slope), _mm_set1_pd(0.5));
+
+    __m128d result = _mm_andnot_pd(_mm_or_pd(positive, at_zero), slope);
+    result = _mm_or_pd(result, _mm_and_pd(at_zero, half));
+    return _mm_or_pd(result, _mm_and_pd(positive, one));
+}
+
+ARRAY_KERNEL(sigmoid_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, sigmoid_sse2, sigmoid)
+ARRAY_KERNEL(der_sigmoid_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, der_sigmoid_sse2, der_sigmoid)
+ARRAY_KERNEL(tanh_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, tanh_sse2, tanh_)
+ARRAY_KERNEL(der_tanh_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, der_tanh_sse2, der_tanh_)
+ARRAY_KERNEL(relu_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, relu_sse2, relu)
+ARRAY_KERNEL(der_relu_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, der_relu_sse2, der_relu)
+SLOPE_ARRAY_KERNEL(leaky_relu_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, leaky_relu_sse2, leaky_relu)
+SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_sse2, "sse2", 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd, der_leaky_relu_sse2, der_leaky_relu)
+
+
+__attribute__((target("sse2")))
+static inline double reduce_max_sse2(__m128d x){
+    return _mm_cvtsd_f64(_mm_max_sd(x, _mm_unpackhi_pd(x, x)));
+}
+
+__attribute__((target("sse2")))
+static inline double reduce_add_sse2(__m128d x){
+    return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+}
+
+SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_sse2, "sse2", 2, __m128d, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+                             _mm_max_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd, reduce_max_sse2, reduce_add_sse2, exp_sse2)
+
+
+/*
+|--------------------------------|
+| AVX2 + FMA (4 doubles)         |
+|--------------------------------|
+*/
+
+__attribute__((target("avx2,fma")))
+static inline __m256d exp_avx2(__m256d x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+    __m256d shifted = _mm256_fmadd_pd(x, _mm256_set1_pd(LOG2E), _mm256_set1_pd(SHIFTER));
+    __m256d k = _mm256_sub_pd(shifted, _mm256_set1_pd(SHIFTER));
+    __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_HI), x);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(LN2_LO), r);
+
+    // 2. exp(r) with the Horner scheme
+    __m256d poly = _mm256_set1_pd(EXP_COEFFICIENTS[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS; c++){
+        poly = _mm256_fmadd_pd(poly, r, _mm256_set1_pd(EXP_COEFFICIENTS[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m256i scale = _mm256_slli_epi64(_mm256_castpd_si256(shifted), 52);
+    return _mm256_castsi256_pd(_mm256_add_epi64(_mm256_castpd_si256(poly), scale));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d sigmoid_avx2(__m256d x){
+    __m256d one = _mm256_set1_pd(1.0);
+    return _mm256_div_pd(one, _mm256_add_pd(one, exp_avx2(_mm256_sub_pd(_mm256_setzero_pd(), x))));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d der_sigmoid_avx2(__m256d x){
+    __m256d s = sigmoid_avx2(x);
+    return _mm256_mul_pd(s, _mm256_sub_pd(_mm256_set1_pd(1.0), s));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d tanh_avx2(__m256d x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), the sign of x is copied afterwards
+    __m256d sign_mask = _mm256_set1_pd(-0.0);
+    __m256d abs_x = _mm256_andnot_pd(sign_mask, x);
+    __m256d e = exp_avx2(_mm256_add_pd(abs_x, abs_x));
+    __m256d t = _mm256_sub_pd(_mm256_set1_pd(1.0), _mm256_div_pd(_mm256_set1_pd(2.0), _mm256_add_pd(e, _mm256_set1_pd(1.0))));
+    return _mm256_or_pd(t, _mm256_and_pd(sign_mask, x));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d der_tanh_avx2(__m256d x){
+    __m256d t = tanh_avx2(x);
+    return _mm256_fnmadd_pd(t, t, _mm256_set1_pd(1.0));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d relu_avx2(__m256d x){
+    return _mm256_max_pd(x, _mm256_setzero_pd());
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d der_relu_avx2(__m256d x){
+    __m256d zero = _mm256_setzero_pd();
+    __m256d positive = _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_GT_OQ), _mm256_set1_pd(1.0));
+    __m256d at_zero = _mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_EQ_OQ), _mm256_set1_pd(0.5));
+    return _mm256_or_pd(positive, at_zero);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d leaky_relu_avx2(__m256d x, __m256d slope){
+    __m256d positive = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ);
+    return _mm256_blendv_pd(_mm256_mul_pd(x, slope), x, positive);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256d der_leaky_relu_avx2(__m256d x, __m256d slope){
+    __m256d zero = _mm256_setzero_pd();
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d half = _mm256_mul_pd(_mm256_add_pd(one, slope), _mm256_set1_pd(0.5));
+
+    __m256d result = _mm256_blendv_pd(slope, half, _mm256_cmp_pd(x, zero, _CMP_EQ_OQ));
+    return _mm256_blendv_pd(result, one, _mm256_cmp_pd(x, zero, _CMP_GT_OQ));
+}
+
+ARRAY_KERNEL(sigmoid_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, sigmoid_avx2, sigmoid)
+ARRAY_KERNEL(der_sigmoid_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, der_sigmoid_avx2, der_sigmoid)
+ARRAY_KERNEL(tanh_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, tanh_avx2, tanh_)
+ARRAY_KERNEL(der_tanh_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, der_tanh_avx2, der_tanh_)
+ARRAY_KERNEL(relu_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, relu_avx2, relu)
+ARRAY_KERNEL(der_relu_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, der_relu_avx2, der_relu)
+SLOPE_ARRAY_KERNEL(leaky_relu_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, leaky_relu_avx2, leaky_relu)
+SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_avx2, "avx2,fma", 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd, der_leaky_relu_avx2, der_leaky_relu)
+
+
+__attribute__((target("avx2,fma")))
+static inline double reduce_max_avx2(__m256d x){
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline double reduce_add_avx2(__m256d x){
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_avx2, "avx2,fma", 4, __m256d, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                             _mm256_max_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, reduce_max_avx2, reduce_add_avx2, exp_avx2)
+
+
+/*
+|--------------------------------|
+| AVX-512F (8 doubles)           |
+|--------------------------------|
+*/
+
+__attribute__((target("avx512f")))
+static inline __m512d exp_avx512(__m512d x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(EXP_MIN)), _mm512_set1_pd(EXP_MAX));
+    __m512d shifted = _mm512_fmadd_pd(x, _mm512_set1_pd(LOG2E), _mm512_set1_pd(SHIFTER));
+    __m512d k = _mm512_sub_pd(shifted, _mm512_set1_pd(SHIFTER));
+    __m512d r = _mm512_fnmadd_pd(k, _mm512_set1_pd(LN2_HI), x);
+    r = _mm512_fnmadd_pd(k, _mm512_set1_pd(LN2_LO), r);
+
+    // 2. exp(r) with the Horner scheme
+    __m512d poly = _mm512_set1_pd(EXP_COEFFICIENTS[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS; c++){
+        poly = _mm512_fmadd_pd(poly, r, _mm512_set1_pd(EXP_COEFFICIENTS[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m512i scale = _mm512_slli_epi64(_mm512_castpd_si512(shifted), 52);
+    return _mm512_castsi512_pd(_mm512_add_epi64(_mm512_castpd_si512(poly), scale));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d sigmoid_avx512(__m512d x){
+    __m512d one = _mm512_set1_pd(1.0);
+    return _mm512_div_pd(one, _mm512_add_pd(one, exp_avx512(_mm512_sub_pd(_mm512_setzero_pd(), x))));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d der_sigmoid_avx512(__m512d x){
+    __m512d s = sigmoid_avx512(x);
+    return _mm512_mul_pd(s, _mm512_sub_pd(_mm512_set1_pd(1.0), s));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d tanh_avx512(__m512d x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), negated afterwards for negative x
+    __m512d abs_x = _mm512_abs_pd(x);
+    __m512d e = exp_avx512(_mm512_add_pd(abs_x, abs_x));
+    __m512d t = _mm512_sub_pd(_mm512_set1_pd(1.0), _mm512_div_pd(_mm512_set1_pd(2.0), _mm512_add_pd(e, _mm512_set1_pd(1.0))));
+    __mmask8 negative = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_LT_OQ);
+    return _mm512_mask_sub_pd(t, negative, _mm512_setzero_pd(), t);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d der_tanh_avx512(__m512d x){
+    __m512d t = tanh_avx512(x);
+    return _mm512_fnmadd_pd(t, t, _mm512_set1_pd(1.0));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d relu_avx512(__m512d x){
+    return _mm512_max_pd(x, _mm512_setzero_pd());
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d der_relu_avx512(__m512d x){
+    __m512d zero = _mm512_setzero_pd();
+    __mmask8 positive = _mm512_cmp_pd_mask(x, zero, _CMP_GT_OQ);
+    __mmask8 at_zero = _mm512_cmp_pd_mask(x, zero, _CMP_EQ_OQ);
+    __m512d result = _mm512_mask_blend_pd(at_zero, zero, _mm512_set1_pd(0.5));
+    return _mm512_mask_blend_pd(positive, result, _mm512_set1_pd(1.0));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d leaky_relu_avx512(__m512d x, __m512d slope){
+    __mmask8 positive = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ);
+    return _mm512_mask_blend_pd(positive, _mm512_mul_pd(x, slope), x);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d der_leaky_relu_avx512(__m512d x, __m512d slope){
+    __m512d zero = _mm512_setzero_pd();
+    __m512d one = _mm512_set1_pd(1.0);
+    __m512d half = _mm512_mul_pd(_mm512_add_pd(one, slope), _mm512_set1_pd(0.5));
+
+    __m512d result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, zero, _CMP_EQ_OQ), slope, half);
+    return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, zero, _CMP_GT_OQ), result, one);
+}
+
+ARRAY_KERNEL(sigmoid_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, sigmoid_avx512, sigmoid)
+ARRAY_KERNEL(der_sigmoid_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, der_sigmoid_avx512, der_sigmoid)
+ARRAY_KERNEL(tanh_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, tanh_avx512, tanh_)
+ARRAY_KERNEL(der_tanh_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, der_tanh_avx512, der_tanh_)
+ARRAY_KERNEL(relu_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, relu_avx512, relu)
+ARRAY_KERNEL(der_relu_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, der_relu_avx512, der_relu)
+SLOPE_ARRAY_KERNEL(leaky_relu_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, leaky_relu_avx512, leaky_relu)
+SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_avx512, "avx512f", 8, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd, der_leaky_relu_avx512, der_leaky_relu)
+
+
+SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_avx512, "avx512f", 8, __m512d, _mm512_loadu_pd, _mm512_storeu_pd, _mm512_set1_pd,
+                             _mm512_max_pd, _mm512_add_pd, _mm512_sub_pd, _mm512_mul_pd, _mm512_reduce_max_pd, _mm512_reduce_add_pd, exp_avx512)
+
+#endif // ACTIVATION_KERNELS_X86
@@ -0,0 +1,90 @@
+/*
+Header file of the SIMD kernels of the activation functions.
+May only be included by the activation functions files, the rest of the code uses the dispatched name_arr functions.
+
+Every kernel has the same signature as its name_arr function, except for the softmax cross entropy kernels:
+they write the sums below into their last argument instead of returning the cost (softmax_cross_entropy_arr() takes the log).
+Only available on x86, the kernels of an instruction set may only be called if the CPU supports it.*/
+
+#ifndef ACTIVATION_FUNCTIONS_SIMD_H
+#define ACTIVATION_FUNCTIONS_SIMD_H
+
+#include <stddef.h> // For size_t
+
+// Sums written by the softmax cross entropy kernels (index into their last argument)
+#define SOFTMAX_SUM_EXPS 0      // Sum of exp(logit - largest logit)
+#define SOFTMAX_SUM_LABELS 1    // Sum of the labels
+#define SOFTMAX_LABELS_DOT 2    // Sum of label * (logit - largest logit)
+#define NUM_SOFTMAX_SUMS 3
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define ACTIVATION_KERNELS_X86
+
+// SSE2 (2 doubles per vector)
+void sigmoid_arr_sse2(const double*, double*, size_t);
+void der_sigmoid_arr_sse2(const double*, double*, size_t);
+void tanh_arr_sse2(const double*, double*, size_t);
+void der_tanh_arr_sse2(const double*, double*, size_t);
+void relu_arr_sse2(const double*, double*, size_t);
+void der_relu_arr_sse2(const double*, double*, size_t);
+void leaky_relu_arr_sse2(const double*, double*, size_t, double);
+void der_leaky_relu_arr_sse2(const double*, double*, size_t, double);
+void softmax_cross_entropy_arr_sse2(const double*, const double*, double*, size_t, double*);
+
+// AVX2 + FMA (4 doubles per vector)
+void sigmoid_arr_avx2(const double*, double*, size_t);
+void der_sigmoid_arr_avx2(const double*, double*, size_t);
+void tanh_arr_avx2(const double*, double*, size_t);
+void der_tanh_arr_avx2(const double*, double*, size_t);
+void relu_arr_avx2(const double*, double*, size_t);
+void der_relu_arr_avx2(const double*, double*, size_t);
+void leaky_relu_arr_avx2(const double*, double*, size_t, double);
+void der_leaky_relu_arr_avx2(const double*, double*, size_t, double);
+void softmax_cross_entropy_arr_avx2(const double*, const double*, double*, size_t, double*);
+
+// AVX-512F (8 doubles per vector)
+void sigmoid_arr_avx512(const double*, double*, size_t);
+void der_sigmoid_arr_avx512(const double*, double*, size_t);
+void tanh_arr_avx512(const double*, double*, size_t);
+void der_tanh_arr_avx512(const double*, double*, size_t);
+void relu_arr_avx512(const double*, double*, size_t);
+void der_relu_arr_avx512(const double*, double*, size_t);
+void leaky_relu_arr_avx512(const double*, double*, size_t, double);
+void der_leaky_relu_arr_avx512(const double*, double*, size_t, double);
+void softmax_cross_entropy_arr_avx512(const double*, const double*, double*, size_t, double*);
+
+// float32 kernels (see activation_functions_simd_float.c), twice the values per vector
+void sigmoid_arr_float_sse2(const float*, float*, size_t);
+void der_sigmoid_arr_float_sse2(const float*, float*, size_t);
+void tanh_arr_float_sse2(const float*, float*, size_t);
+void der_tanh_arr_float_sse2(const float*, float*, size_t);
+void relu_arr_float_sse2(const float*, float*, size_t);
+void der_relu_arr_float_sse2(const float*, float*, size_t);
+void leaky_relu_arr_float_sse2(const float*, float*, size_t, float);
+void der_leaky_relu_arr_float_sse2(const float*, float*, size_t, float);
+void softmax_cross_entropy_arr_float_sse2(const float*, const double*, float*, size_t, double*);
+
+void sigmoid_arr_float_avx2(const float*, float*, size_t);
+void der_sigmoid_arr_float_avx2(const float*, float*, size_t);
+void tanh_arr_float_avx2(const float*, float*, size_t);
+void der_tanh_arr_float_avx2(const float*, float*, size_t);
+void relu_arr_float_avx2(const float*, float*, size_t);
+void der_relu_arr_float_avx2(const float*, float*, size_t);
+void leaky_relu_arr_float_avx2(const float*, float*, size_t, float);
+void der_leaky_relu_arr_float_avx2(const float*, float*, size_t, float);
+void softmax_cross_entropy_arr_float_avx2(const float*, const double*, float*, size_t, double*);
+
+void sigmoid_arr_float_avx512(const float*, float*, size_t);
+void der_sigmoid_arr_float_avx512(const float*, float*, size_t);
+void tanh_arr_float_avx512(const float*, float*, size_t);
+void der_tanh_arr_float_avx512(const float*, float*, size_t);
+void relu_arr_float_avx512(const float*, float*, size_t);
+void der_relu_arr_float_avx512(const float*, float*, size_t);
+void leaky_relu_arr_float_avx512(const float*, float*, size_t, float);
+void der_leaky_relu_arr_float_avx512(const float*, float*, size_t, float);
+void softmax_cross_entropy_arr_float_avx512(const float*, const double*, float*, size_t, double*);
+
+#endif // x86
+
+#endif // ACTIVATION_FUNCTIONS_SIMD_H
@@ -0,0 +1,500 @@
+/*
+This file holds the float32 SIMD kernels of the array versions of the activation functions (and their derivatives).
+They are used by the dense training engine in single and mixed precision (see configurations/precision.h).
+Same structure as activation_functions_simd.c, but every vector holds twice as many values:
+SSE2 (4 floats), AVX2 + FMA (8 floats) and AVX-512F (16 floats).
+
+exp() uses the same range reduction as the double kernels with a polynomial of degree 7 (relative error below 1e-7).
+Elements that do not fill a whole vector are computed with the double scalar functions and rounded to float.
+
+This file may not use any header files but its own.*/
+
+#include "activation_functions.h"
+#include "activation_functions_simd.h"
+
+#ifdef ACTIVATION_KERNELS_X86
+
+#include <immintrin.h>
+
+// Clamping of the inputs of exp (2^k has to fit into the exponent of a float)
+#define EXP_MAX_F 88.0f
+#define EXP_MIN_F -86.0f
+
+// Constants of the range reduction (ln(2) is split into two parts to keep k * ln(2) exact)
+#define LOG2E_F 1.44269504f
+#define LN2_HI_F 0.693359375f
+#define LN2_LO_F -2.12194440e-4f
+
+// Adding 1.5 * 2^23 rounds to an integer and stores it in the lowest bits of the mantissa
+#define SHIFTER_F 0x1.8p23f
+
+// Number of coefficients of the polynomial of exp(r)
+#define NUM_EXP_COEFFICIENTS_F 8
+
+// Taylor coefficients of exp(r), highest degree first (for the Horner scheme)
+static const float EXP_COEFFICIENTS_F[NUM_EXP_COEFFICIENTS_F] = {
+    1.0f / 5040.0f,  // 1/7!
+    1.0f / 720.0f,   // 1/6!
+    1.0f / 120.0f,   // 1/5!
+    1.0f / 24.0f,    // 1/4!
+    1.0f / 6.0f,     // 1/3!
+    1.0f / 2.0f,     // 1/2!
+    1.0f,            // 1/1!
+    1.0f             // 1/0!
+};
+
+
+/*
+Defines the float array kernel "name" from a vector function:
+full vectors of "width" floats use vector_func, the remaining elements use scalar_func.*/
+#define FLOAT_ARRAY_KERNEL(name, target_isa, width, load, store, vector_func, scalar_func) \
+    __attribute__((target(target_isa)))                                                   \
+    void name(const float* input, float* output, size_t size){                            \
+        size_t i = 0;                                                                      \
+        for (; i + (width) <= size; i += (width)){                                         \
+            store(output + i, vector_func(load(input + i)));                               \
+        }                                                                                  \
+        for (; i < size; i++){                                                             \
+            output[i] = (float) scalar_func(input[i]);                                     \
+        }                                                                                  \
+    }
+
+/*
+Same as FLOAT_ARRAY_KERNEL for the functions with a slope (leaky relu).*/
+#define FLOAT_SLOPE_ARRAY_KERNEL(name, target_isa, width, load, store, set1, vector_func, scalar_func) \
+    __attribute__((target(target_isa)))                                                               \
+    void name(const float* input, float* output, size_t size, float slope){                           \
+        size_t i = 0;                                                                                  \
+        for (; i + (width) <= size; i += (width)){                                                     \
+            store(output + i, vector_func(load(input + i), set1(slope)));                              \
+        }                                                                                              \
+        for (; i < size; i++){                                                                         \
+            output[i] = (float) scalar_func(input[i], slope);                                          \
+        }                                                                                              \
+    }
+
+
+/*
+Same as SOFTMAX_CROSS_ENTROPY_KERNEL (see activation_functions_simd.c) for float logits and outputs.
+The labels stay double (the training data) and are rounded to float vectors by load_labels,
+the sums are accumulated in float vectors and returned as doubles.*/
+#define FLOAT_SOFTMAX_CROSS_ENTROPY_KERNEL(name, target_isa, width, vec, load, load_labels, store, set1, vmax, vadd, vsub, vmul, reduce_max, reduce_add, vector_exp) \
+    __attribute__((target(target_isa)))                                                                             \
+    void name(const float* logits, const double* labels, float* output, size_t size, double* sums){                \
+        /* 1. Largest logit (subtracted, so that exp never overflows) */                                            \
+        float largest = logits[0];                                                                                  \
+        size_t i = 0;                                                                                               \
+        if (size >= (width)){                                                                                       \
+            vec largest_vec = load(logits);                                                                         \
+            for (i = (width); i + (width) <= size; i += (width)){                                                   \
+                largest_vec = vmax(largest_vec, load(logits + i));                                                  \
+            }                                                                                                       \
+            largest = reduce_max(largest_vec);                                                                      \
+        }                                                                                                           \
+        for (; i < size; i++){                                                                                      \
+            largest = (logits[i] > largest) ? logits[i] : largest;                                                  \
+        }                                                                                                           \
+                                                                                                                    \
+        /* 2. exp(logit - largest logit) and their sum */                                                           \
+        vec shift = set1(largest);                                                                                  \
+        vec sum_vec = set1(0.0f);                                                                                   \
+        for (i = 0; i + (width) <= size; i += (width)){                                                             \
+            vec exps = vector_exp(vsub(load(logits + i), shift));                                                   \
+            store(output + i, exps);                                                                                \
+            sum_vec = vadd(sum_vec, exps);                                                                          \
+        }                                                                                                           \
+        double sum = reduce_add(sum_vec);                                                                           \
+        if (i < size){                                                                                              \
+            float tail[(width)] = {0};                                                                              \
+            for (size_t j = 0; i + j < size; j++){                                                                  \
+                tail[j] = logits[i + j] - largest;                                                                  \
+            }                                                                                                       \
+            store(tail, vector_exp(load(tail)));                                                                    \
+            for (size_t j = 0; i + j < size; j++){                                                                  \
+                output[i + j] = tail[j];                                                                            \
+                sum += tail[j];                                                                                     \
+            }                                                                                                       \
+        }                                                                                                           \
+                                                                                                                    \
+        /* 3. Probabilities minus the labels */                                                                     \
+        float inverse = (float) (1.0 / sum);                                                                        \
+        vec inverse_vec = set1(inverse);                                                                            \
+        vec label_sum_vec = set1(0.0f);                                                                             \
+        vec label_dot_vec = set1(0.0f);                                                                             \
+        double label_sum = 0;                                                                                       \
+        double label_dot = 0;                                                                                       \
+        if (labels){                                                                                                \
+            for (i = 0; i + (width) <= size; i += (width)){                                                         \
+                vec label = load_labels(labels + i);                                                                \
+                store(output + i, vsub(vmul(load(output + i), inverse_vec), label));                                \
+                label_sum_vec = vadd(label_sum_vec, label);                                                         \
+                label_dot_vec = vadd(label_dot_vec, vmul(label, vsub(load(logits + i), shift)));                    \
+            }                                                                                                       \
+            label_sum = reduce_add(label_sum_vec);                                                                  \
+            label_dot = reduce_add(label_dot_vec);                                                                  \
+            for (; i < size; i++){                                                                                  \
+                output[i] = (float) (output[i] * inverse - labels[i]);                                              \
+                label_sum += labels[i];                                                                             \
+                label_dot += labels[i] * (logits[i] - largest);                                                     \
+            }                                                                                                       \
+        }                                                                                                           \
+        else{                                                                                                       \
+            for (i = 0; i + (width) <= size; i += (width)){                                                         \
+                store(output + i, vmul(load(output + i), inverse_vec));                                             \
+            }                                                                                                       \
+            for (; i < size; i++){                                                                                  \
+                output[i] *= inverse;                                                                               \
+            }                                                                                                       \
+        }                                                                                                           \
+        sums[SOFTMAX_SUM_EXPS] = sum;                                                                               \
+        sums[SOFTMAX_SUM_LABELS] = label_sum;                                                                       \
+        sums[SOFTMAX_LABELS_DOT] = label_dot;                                                                       \
+    }
+
+
+/*
+|--------------------------------|
+| SSE2 (4 floats per vector)     |
+|--------------------------------|
+*/
+
+__attribute__((target("sse2")))
+static inline __m128 exp_ps_sse2(__m128 x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_MIN_F)), _mm_set1_ps(EXP_MAX_F));
+    __m128 shifted = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E_F)), _mm_set1_ps(SHIFTER_F));
+    __m128 k = _mm_sub_ps(shifted, _mm_set1_ps(SHIFTER_F));
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(LN2_HI_F)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(LN2_LO_F)));
+
+    // 2. exp(r) with the Horner scheme
+    __m128 poly = _mm_set1_ps(EXP_COEFFICIENTS_F[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS_F; c++){
+        poly = _mm_add_ps(_mm_mul_ps(poly, r), _mm_set1_ps(EXP_COEFFICIENTS_F[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m128i scale = _mm_slli_epi32(_mm_castps_si128(shifted), 23);
+    return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(poly), scale));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 sigmoid_ps_sse2(__m128 x){
+    __m128 one = _mm_set1_ps(1.0f);
+    return _mm_div_ps(one, _mm_add_ps(one, exp_ps_sse2(_mm_sub_ps(_mm_setzero_ps(), x))));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 der_sigmoid_ps_sse2(__m128 x){
+    __m128 s = sigmoid_ps_sse2(x);
+    return _mm_mul_ps(s, _mm_sub_ps(_mm_set1_ps(1.0f), s));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 tanh_ps_sse2(__m128 x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), the sign of x is copied afterwards
+    __m128 sign_mask = _mm_set1_ps(-0.0f);
+    __m128 abs_x = _mm_andnot_ps(sign_mask, x);
+    __m128 e = exp_ps_sse2(_mm_add_ps(abs_x, abs_x));
+    __m128 t = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_set1_ps(2.0f), _mm_add_ps(e, _mm_set1_ps(1.0f))));
+    return _mm_or_ps(t, _mm_and_ps(sign_mask, x));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 der_tanh_ps_sse2(__m128 x){
+    __m128 t = tanh_ps_sse2(x);
+    return _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t, t));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 relu_ps_sse2(__m128 x){
+    return _mm_max_ps(x, _mm_setzero_ps());
+}
+
+__attribute__((target("sse2")))
+static inline __m128 der_relu_ps_sse2(__m128 x){
+    __m128 zero = _mm_setzero_ps();
+    __m128 positive = _mm_and_ps(_mm_cmpgt_ps(x, zero), _mm_set1_ps(1.0f));
+    __m128 at_zero = _mm_and_ps(_mm_cmpeq_ps(x, zero), _mm_set1_ps(0.5f));
+    return _mm_or_ps(positive, at_zero);
+}
+
+__attribute__((target("sse2")))
+static inline __m128 leaky_relu_ps_sse2(__m128 x, __m128 slope){
+    __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(positive, x), _mm_andnot_ps(positive, _mm_mul_ps(x, slope)));
+}
+
+__attribute__((target("sse2")))
+static inline __m128 der_leaky_relu_ps_sse2(__m128 x, __m128 slope){
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 positive = _mm_cmpgt_ps(x, zero);
+    __m128 at_zero = _mm_cmpeq_ps(x, zero);
+    __m128 half = _mm_mul_ps(_mm_add_ps(one, slope), _mm_set1_ps(0.5f));
+
+    __m128 result = _mm_andnot_ps(_mm_or_ps(positive, at_zero), slope);
+    result = _mm_or_ps(result, _mm_and_ps(at_zero, half));
+    return _mm_or_ps(result, _mm_and_ps(positive, one));
+}
+
+FLOAT_ARRAY_KERNEL(sigmoid_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, sigmoid_ps_sse2, sigmoid)
+FLOAT_ARRAY_KERNEL(der_sigmoid_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, der_sigmoid_ps_sse2, der_sigmoid)
+FLOAT_ARRAY_KERNEL(tanh_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, tanh_ps_sse2, tanh_)
+FLOAT_ARRAY_KERNEL(der_tanh_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, der_tanh_ps_sse2, der_tanh_)
+FLOAT_ARRAY_KERNEL(relu_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, relu_ps_sse2, relu)
+FLOAT_ARRAY_KERNEL(der_relu_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, der_relu_ps_sse2, der_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(leaky_relu_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, leaky_relu_ps_sse2, leaky_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_float_sse2, "sse2", 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps, der_leaky_relu_ps_sse2, der_leaky_relu)
+
+
+__attribute__((target("sse2")))
+static inline float reduce_max_ps_sse2(__m128 x){
+    __m128 half = _mm_max_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, 1)));
+}
+
+__attribute__((target("sse2")))
+static inline float reduce_add_ps_sse2(__m128 x){
+    __m128 half = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+}
+
+// Rounds 4 double labels to a float vector
+__attribute__((target("sse2")))
+static inline __m128 load_labels_ps_sse2(const double* labels){
+    return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(labels)), _mm_cvtpd_ps(_mm_loadu_pd(labels + 2)));
+}
+
+FLOAT_SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_float_sse2, "sse2", 4, __m128, _mm_loadu_ps, load_labels_ps_sse2, _mm_storeu_ps, _mm_set1_ps,
+                                   _mm_max_ps, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, reduce_max_ps_sse2, reduce_add_ps_sse2, exp_ps_sse2)
+
+
+/*
+|--------------------------------|
+| AVX2 + FMA (8 floats)          |
+|--------------------------------|
+*/
+
+__attribute__((target("avx2,fma")))
+static inline __m256 exp_ps_avx2(__m256 x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_MIN_F)), _mm256_set1_ps(EXP_MAX_F));
+    __m256 shifted = _mm256_fmadd_ps(x, _mm256_set1_ps(LOG2E_F), _mm256_set1_ps(SHIFTER_F));
+    __m256 k = _mm256_sub_ps(shifted, _mm256_set1_ps(SHIFTER_F));
+    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(LN2_HI_F), x);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(LN2_LO_F), r);
+
+    // 2. exp(r) with the Horner scheme
+    __m256 poly = _mm256_set1_ps(EXP_COEFFICIENTS_F[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS_F; c++){
+        poly = _mm256_fmadd_ps(poly, r, _mm256_set1_ps(EXP_COEFFICIENTS_F[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m256i scale = _mm256_slli_epi32(_mm256_castps_si256(shifted), 23);
+    return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(poly), scale));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 sigmoid_ps_avx2(__m256 x){
+    __m256 one = _mm256_set1_ps(1.0f);
+    return _mm256_div_ps(one, _mm256_add_ps(one, exp_ps_avx2(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 der_sigmoid_ps_avx2(__m256 x){
+    __m256 s = sigmoid_ps_avx2(x);
+    return _mm256_mul_ps(s, _mm256_sub_ps(_mm256_set1_ps(1.0f), s));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 tanh_ps_avx2(__m256 x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), the sign of x is copied afterwards
+    __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 abs_x = _mm256_andnot_ps(sign_mask, x);
+    __m256 e = exp_ps_avx2(_mm256_add_ps(abs_x, abs_x));
+    __m256 t = _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_div_ps(_mm256_set1_ps(2.0f), _mm256_add_ps(e, _mm256_set1_ps(1.0f))));
+    return _mm256_or_ps(t, _mm256_and_ps(sign_mask, x));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 der_tanh_ps_avx2(__m256 x){
+    __m256 t = tanh_ps_avx2(x);
+    return _mm256_fnmadd_ps(t, t, _mm256_set1_ps(1.0f));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 relu_ps_avx2(__m256 x){
+    return _mm256_max_ps(x, _mm256_setzero_ps());
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 der_relu_ps_avx2(__m256 x){
+    __m256 zero = _mm256_setzero_ps();
+    __m256 positive = _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+    __m256 at_zero = _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), _mm256_set1_ps(0.5f));
+    return _mm256_or_ps(positive, at_zero);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 leaky_relu_ps_avx2(__m256 x, __m256 slope){
+    __m256 positive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GT_OQ);
+    return _mm256_blendv_ps(_mm256_mul_ps(x, slope), x, positive);
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 der_leaky_relu_ps_avx2(__m256 x, __m256 slope){
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 half = _mm256_mul_ps(_mm256_add_ps(one, slope), _mm256_set1_ps(0.5f));
+
+    __m256 result = _mm256_blendv_ps(slope, half, _mm256_cmp_ps(x, zero, _CMP_EQ_OQ));
+    return _mm256_blendv_ps(result, one, _mm256_cmp_ps(x, zero, _CMP_GT_OQ));
+}
+
+FLOAT_ARRAY_KERNEL(sigmoid_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, sigmoid_ps_avx2, sigmoid)
+FLOAT_ARRAY_KERNEL(der_sigmoid_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, der_sigmoid_ps_avx2, der_sigmoid)
+FLOAT_ARRAY_KERNEL(tanh_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, tanh_ps_avx2, tanh_)
+FLOAT_ARRAY_KERNEL(der_tanh_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, der_tanh_ps_avx2, der_tanh_)
+FLOAT_ARRAY_KERNEL(relu_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, relu_ps_avx2, relu)
+FLOAT_ARRAY_KERNEL(der_relu_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, der_relu_ps_avx2, der_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(leaky_relu_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, leaky_relu_ps_avx2, leaky_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_float_avx2, "avx2,fma", 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps, der_leaky_relu_ps_avx2, der_leaky_relu)
+
+
+__attribute__((target("avx2,fma")))
+static inline float reduce_max_ps_avx2(__m256 x){
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, 1)));
+}
+
+__attribute__((target("avx2,fma")))
+static inline float reduce_add_ps_avx2(__m256 x){
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    return _mm_cvtss_f32(_mm_add_ss(half, _mm_shuffle_ps(half, half, 1)));
+}
+
+// Rounds 8 double labels to a float vector
+__attribute__((target("avx2,fma")))
+static inline __m256 load_labels_ps_avx2(const double* labels){
+    __m128 low = _mm256_cvtpd_ps(_mm256_loadu_pd(labels));
+    __m128 high = _mm256_cvtpd_ps(_mm256_loadu_pd(labels + 4));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+}
+
+FLOAT_SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_float_avx2, "avx2,fma", 8, __m256, _mm256_loadu_ps, load_labels_ps_avx2, _mm256_storeu_ps, _mm256_set1_ps,
+                                   _mm256_max_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, reduce_max_ps_avx2, reduce_add_ps_avx2, exp_ps_avx2)
+
+
+/*
+|--------------------------------|
+| AVX-512F (16 floats)           |
+|--------------------------------|
+*/
+
+__attribute__((target("avx512f")))
+static inline __m512 exp_ps_avx512(__m512 x){
+
+    // 1. Clamp and reduce the range: x = k * ln(2) + r
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(EXP_MIN_F)), _mm512_set1_ps(EXP_MAX_F));
+    __m512 shifted = _mm512_fmadd_ps(x, _mm512_set1_ps(LOG2E_F), _mm512_set1_ps(SHIFTER_F));
+    __m512 k = _mm512_sub_ps(shifted, _mm512_set1_ps(SHIFTER_F));
+    __m512 r = _mm512_fnmadd_ps(k, _mm512_set1_ps(LN2_HI_F), x);
+    r = _mm512_fnmadd_ps(k, _mm512_set1_ps(LN2_LO_F), r);
+
+    // 2. exp(r) with the Horner scheme
+    __m512 poly = _mm512_set1_ps(EXP_COEFFICIENTS_F[0]);
+    for (int c = 1; c < NUM_EXP_COEFFICIENTS_F; c++){
+        poly = _mm512_fmadd_ps(poly, r, _mm512_set1_ps(EXP_COEFFICIENTS_F[c]));
+    }
+
+    // 3. Multiply with 2^k by adding k to the exponent bits
+    __m512i scale = _mm512_slli_epi32(_mm512_castps_si512(shifted), 23);
+    return _mm512_castsi512_ps(_mm512_add_epi32(_mm512_castps_si512(poly), scale));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 sigmoid_ps_avx512(__m512 x){
+    __m512 one = _mm512_set1_ps(1.0f);
+    return _mm512_div_ps(one, _mm512_add_ps(one, exp_ps_avx512(_mm512_sub_ps(_mm512_setzero_ps(), x))));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 der_sigmoid_ps_avx512(__m512 x){
+    __m512 s = sigmoid_ps_avx512(x);
+    return _mm512_mul_ps(s, _mm512_sub_ps(_mm512_set1_ps(1.0f), s));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 tanh_ps_avx512(__m512 x){
+    // tanh(|x|) = 1 - 2 / (exp(2|x|) + 1), negated afterwards for negative x
+    __m512 abs_x = _mm512_abs_ps(x);
+    __m512 e = exp_ps_avx512(_mm512_add_ps(abs_x, abs_x));
+    __m512 t = _mm512_sub_ps(_mm512_set1_ps(1.0f), _mm512_div_ps(_mm512_set1_ps(2.0f), _mm512_add_ps(e, _mm512_set1_ps(1.0f))));
+    __mmask16 negative = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ);
+    return _mm512_mask_sub_ps(t, negative, _mm512_setzero_ps(), t);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 der_tanh_ps_avx512(__m512 x){
+    __m512 t = tanh_ps_avx512(x);
+    return _mm512_fnmadd_ps(t, t, _mm512_set1_ps(1.0f));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 relu_ps_avx512(__m512 x){
+    return _mm512_max_ps(x, _mm512_setzero_ps());
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 der_relu_ps_avx512(__m512 x){
+    __m512 zero = _mm512_setzero_ps();
+    __mmask16 positive = _mm512_cmp_ps_mask(x, zero, _CMP_GT_OQ);
+    __mmask16 at_zero = _mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ);
+    __m512 result = _mm512_mask_blend_ps(at_zero, zero, _mm512_set1_ps(0.5f));
+    return _mm512_mask_blend_ps(positive, result, _mm512_set1_ps(1.0f));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 leaky_relu_ps_avx512(__m512 x, __m512 slope){
+    __mmask16 positive = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_GT_OQ);
+    return _mm512_mask_blend_ps(positive, _mm512_mul_ps(x, slope), x);
+}
+
+__attribute__((target("avx512f")))
+static inline __m512 der_leaky_relu_ps_avx512(__m512 x, __m512 slope){
+    __m512 zero = _mm512_setzero_ps();
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 half = _mm512_mul_ps(_mm512_add_ps(one, slope), _mm512_set1_ps(0.5f));
+
+    __m512 result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, zero, _CMP_EQ_OQ), slope, half);
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(x, zero, _CMP_GT_OQ), result, one);
+}
+
+FLOAT_ARRAY_KERNEL(sigmoid_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, sigmoid_ps_avx512, sigmoid)
+FLOAT_ARRAY_KERNEL(der_sigmoid_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, der_sigmoid_ps_avx512, der_sigmoid)
+FLOAT_ARRAY_KERNEL(tanh_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, tanh_ps_avx512, tanh_)
+FLOAT_ARRAY_KERNEL(der_tanh_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, der_tanh_ps_avx512, der_tanh_)
+FLOAT_ARRAY_KERNEL(relu_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, relu_ps_avx512, relu)
+FLOAT_ARRAY_KERNEL(der_relu_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, der_relu_ps_avx512, der_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(leaky_relu_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, leaky_relu_ps_avx512, leaky_relu)
+FLOAT_SLOPE_ARRAY_KERNEL(der_leaky_relu_arr_float_avx512, "avx512f", 16, _mm512_loadu_ps, _mm512_storeu_ps, _mm512_set1_ps, der_leaky_relu_ps_avx512, der_leaky_relu)
+
+
+// Rounds 16 double labels to a float vector
+__attribute__((target("avx512f")))
+static inline __m512 load_labels_ps_avx512(const double* labels){
+    __m256 low = _mm512_cvtpd_ps(_mm512_loadu_pd(labels));
+    __m256 high = _mm512_cvtpd_ps(_mm512_loadu_pd(labels + 8));
+    return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(low)), _mm256_castps_pd(high), 1));
+}
+
+FLOAT_SOFTMAX_CROSS_ENTROPY_KERNEL(softmax_cross_entropy_arr_float_avx512, "avx512f", 16, __m512, _mm512_loadu_ps, load_labels_ps_avx512, _mm512_storeu_ps, _mm512_set1_ps,
+                                   _mm512_max_ps, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_reduce_max_ps, _mm512_reduce_add_ps, exp_ps_avx512)
+
+#endif // ACTIVATION_KERNELS_X86
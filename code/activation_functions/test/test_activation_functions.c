@@ -25,6 +25,244 @@ void test_leaky_relu(){
     return;
 }
 
+// Relative tolerance of the SIMD kernels compared to the scalar functions (much stricter than TOLERANCE)
+#define KERNEL_TOLERANCE 1e-13
+
+// Relative tolerance of the float32 kernels compared to the scalar functions rounded to float
+#define FLOAT_KERNEL_TOLERANCE 1e-6
+
+// Number of inputs (not a multiple of any vector width, so that the scalar remainder is tested)
+#define NUM_INPUTS 203
+
+/*
+Asserts that two arrays are equal up to KERNEL_TOLERANCE*/
+void compare_arrays(const double* act, const double* exp, size_t size){
+    for (size_t i = 0; i < size; i++){
+        double diff = fabs(act[i] - exp[i]);
+        if (diff > KERNEL_TOLERANCE * fmax(1, fabs(exp[i]))){
+            printf("Element %zu: got %.17g, expected %.17g\n", i, act[i], exp[i]);
+            assert(0);
+        }
+    }
+}
+
+/*
+Asserts that a float array is equal to the double array up to FLOAT_KERNEL_TOLERANCE*/
+void compare_float_arrays(const float* act, const double* exp, size_t size){
+    for (size_t i = 0; i < size; i++){
+        double diff = fabs((double) act[i] - exp[i]);
+        if (diff > FLOAT_KERNEL_TOLERANCE * fmax(1, fabs(exp[i]))){
+            printf("Element %zu: got %.9g, expected %.9g\n", i, (double) act[i], exp[i]);
+            assert(0);
+        }
+    }
+}
+
+/*
+Tests the array versions of all activation functions with the given kernels against the scalar functions*/
+void test_array_kernels(int kernels){
+    assert(select_activation_kernels(kernels) == 0);
+    assert(current_activation_kernels() == kernels);
+
+    // Inputs from -50 to 50 including 0, tiny values and values outside the range of exp
+    double input[NUM_INPUTS];
+    for (size_t i = 0; i < NUM_INPUTS - 5; i++){
+        input[i] = -50.0 + 100.0 * (double) i / (NUM_INPUTS - 6);
+    }
+    input[NUM_INPUTS - 5] = 0;
+    input[NUM_INPUTS - 4] = 1e-12;
+    input[NUM_INPUTS - 3] = -1e-12;
+    input[NUM_INPUTS - 2] = 1000;
+    input[NUM_INPUTS - 1] = -1000;
+
+    double output[NUM_INPUTS];
+    double expected[NUM_INPUTS];
+
+    sigmoid_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = sigmoid(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    der_sigmoid_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_sigmoid(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    tanh_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = tanh_(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    der_tanh_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_tanh_(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    relu_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = relu(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    der_relu_arr(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_relu(input[i]);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    leaky_relu_arr(input, output, NUM_INPUTS, 0.2);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = leaky_relu(input[i], 0.2);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    der_leaky_relu_arr(input, output, NUM_INPUTS, 0.2);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_leaky_relu(input[i], 0.2);
+    compare_arrays(output, expected, NUM_INPUTS);
+
+    // The output may be the input array
+    double inplace[NUM_INPUTS];
+    for (size_t i = 0; i < NUM_INPUTS; i++) inplace[i] = input[i];
+    sigmoid_arr(inplace, inplace, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = sigmoid(input[i]);
+    compare_arrays(inplace, expected, NUM_INPUTS);
+
+    printf("Array kernels (%s) successfully tested.\n", activation_kernels_name(kernels));
+    return;
+}
+
+/*
+Tests the float32 array versions of all activation functions with the given kernels against the scalar functions*/
+void test_float_array_kernels(int kernels){
+    assert(select_activation_kernels(kernels) == 0);
+
+    // Same inputs as test_array_kernels, the scalar functions get the inputs rounded to float
+    float input[NUM_INPUTS];
+    for (size_t i = 0; i < NUM_INPUTS - 5; i++){
+        input[i] = (float) (-50.0 + 100.0 * (double) i / (NUM_INPUTS - 6));
+    }
+    input[NUM_INPUTS - 5] = 0;
+    input[NUM_INPUTS - 4] = 1e-12f;
+    input[NUM_INPUTS - 3] = -1e-12f;
+    input[NUM_INPUTS - 2] = 1000;
+    input[NUM_INPUTS - 1] = -1000;
+
+    float output[NUM_INPUTS];
+    double expected[NUM_INPUTS];
+
+    sigmoid_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = sigmoid(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    der_sigmoid_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_sigmoid(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    tanh_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = tanh_(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    der_tanh_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_tanh_(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    relu_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = relu(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    der_relu_arr_float(input, output, NUM_INPUTS);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_relu(input[i]);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    leaky_relu_arr_float(input, output, NUM_INPUTS, 0.2f);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = leaky_relu(input[i], 0.2f);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    der_leaky_relu_arr_float(input, output, NUM_INPUTS, 0.2f);
+    for (size_t i = 0; i < NUM_INPUTS; i++) expected[i] = der_leaky_relu(input[i], 0.2f);
+    compare_float_arrays(output, expected, NUM_INPUTS);
+
+    printf("Float array kernels (%s) successfully tested.\n", activation_kernels_name(kernels));
+    return;
+}
+
+/*
+Tests the fused softmax and cross entropy of the given kernels against the probabilities and the cost computed with exp and log.
+Every size up to MAX_SOFTMAX_OUTPUTS is tested, so that every remainder of every vector width is covered.*/
+#define MAX_SOFTMAX_OUTPUTS 37
+
+void test_softmax_kernels(int kernels){
+    assert(select_activation_kernels(kernels) == 0);
+
+    double logits[MAX_SOFTMAX_OUTPUTS];
+    float float_logits[MAX_SOFTMAX_OUTPUTS];
+    double labels[MAX_SOFTMAX_OUTPUTS];
+    double output[MAX_SOFTMAX_OUTPUTS];
+    float float_output[MAX_SOFTMAX_OUTPUTS];
+    double expected[MAX_SOFTMAX_OUTPUTS];
+
+    for (size_t size = 1; size <= MAX_SOFTMAX_OUTPUTS; size++){
+
+        // Logits between -10 and 10, the label is one hot (or split between the last two outputs)
+        double sum = 0;
+        for (size_t i = 0; i < size; i++){
+            logits[i] = 10 * sin(1.7 * (double) i + (double) size);
+            float_logits[i] = (float) logits[i];
+            labels[i] = 0;
+        }
+        for (size_t i = 0; i < size; i++){
+            sum += exp(logits[i]);
+        }
+        for (int soft = 0; soft <= 1; soft++){
+            if (soft && size > 1){
+                labels[size / 2] = 0;
+                labels[size - 1] = 0.25;
+                labels[size - 2] = 0.75;
+            }
+            else{
+                labels[size / 2] = 1;
+            }
+
+            double expected_cost = 0;
+            for (size_t i = 0; i < size; i++){
+                double probability = exp(logits[i]) / sum;
+                expected[i] = probability - labels[i];
+                expected_cost -= labels[i] * log(probability);
+            }
+
+            double cost = softmax_cross_entropy_arr(logits, labels, output, size);
+            compare_arrays(output, expected, size);
+            assert(fabs(cost - expected_cost) <= KERNEL_TOLERANCE * fmax(1, expected_cost));
+
+            // The float kernels compute the probabilities of the logits rounded to float
+            double float_cost = softmax_cross_entropy_arr_float(float_logits, labels, float_output, size);
+            compare_float_arrays(float_output, expected, size);
+            assert(fabs(float_cost - expected_cost) <= 1e-5 * fmax(1, expected_cost));
+        }
+
+        // Without labels only the probabilities are written
+        for (size_t i = 0; i < size; i++){
+            expected[i] = exp(logits[i]) / sum;
+        }
+        assert(softmax_cross_entropy_arr(logits, NULL, output, size) == 0);
+        compare_arrays(output, expected, size);
+        assert(softmax_cross_entropy_arr_float(float_logits, NULL, float_output, size) == 0);
+        compare_float_arrays(float_output, expected, size);
+    }
+
+    // Logits far outside the range of exp neither overflow nor take the log of 0
+    logits[0] = 1000;
+    logits[1] = -1000;
+    logits[2] = 990;
+    labels[0] = 0;
+    labels[1] = 0;
+    labels[2] = 1;
+    double cost = softmax_cross_entropy_arr(logits, labels, output, 3);
+    assert(fabs(cost - (10 + log1p(exp(-10)))) < 1e-12);
+    assert(fabs(output[0] - 1 / (1 + exp(-10))) < 1e-12);
+    assert(fabs(output[1]) < 1e-300);
+
+    for (size_t i = 0; i < 3; i++){
+        float_logits[i] = (float) logits[i];
+    }
+    double float_cost = softmax_cross_entropy_arr_float(float_logits, labels, float_output, 3);
+    assert(fabs(float_cost - cost) < 1e-5);
+    assert(fabs(float_output[0] - output[0]) < 1e-6);
+
+    printf("Softmax cross entropy kernels (%s) successfully tested.\n", activation_kernels_name(kernels));
+    return;
+}
+
 int main(void){
 
     test_sigmoid();
@@ -32,5 +270,17 @@ int main(void){
     test_relu();
     test_leaky_relu();
 
+    // Test every instruction set supported by this CPU
+    int best = best_activation_kernels();
+    for (int kernels = ACTIVATION_KERNELS_SCALAR; kernels <= best; kernels++){
+        test_array_kernels(kernels);
+        test_float_array_kernels(kernels);
+        test_softmax_kernels(kernels);
+    }
+
+    // Instruction sets above the best one are refused
+    assert(select_activation_kernels(best + 1) == -1);
+    assert(current_activation_kernels() == best);
+
     return 0;
 }
\ No newline at end of file
@@ -9,4 +9,12 @@ void test_tanh();
 void test_relu();
 void test_leaky_relu();
 
+void compare_arrays(const double*, const double*, size_t);
+void test_array_kernels(int);
+
+void compare_float_arrays(const float*, const double*, size_t);
+void test_float_array_kernels(int);
+
+void test_softmax_kernels(int);
+
 #endif //TEST_ACTIVATION_FUNCTIONS_H
\ No newline at end of file
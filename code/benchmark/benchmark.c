@@ -0,0 +1,956 @@
+/*
+Micro benchmarks of the Neural Network, built and run by make bench (see the Makefile).
+
+The sizes of the layers are compile-time constants, so a benchmark binary is built for one width (BENCH_WIDTH) and one depth
+(HIDDEN_LAYERS) of the Neural Network, see bench_config.c. At runtime it goes through the dataset sizes and thread counts given by:
+--sizes N,N,...     Number of data points of the generated datasets (default 1024,8192)
+--threads N,N,...   Thread counts of the training passes (default 1,2,4, the other benchmarks run on one thread)
+--repeats N         Timed repeats of every benchmark after one warm up (default DEFAULT_BENCH_REPEATS)
+--json <file>       Append every result as one line of JSON to the file
+
+Benchmarks (a sample is the unit of work a benchmark is measured in):
+- distribute_input_data, forward_pass, backward_pass   per data point, on the linked list and on the dense network
+- gradient_descent                                      per param, one update per BENCH_UPDATE_ROWS data points
+- train_pass                                            per data point, a whole generation on the thread pool (work and gradient descent)
+- convergence                                           generations and wall time until the seeded dense network reaches a target cost,
+                                                        trained in mini batches (--mini-batch) and asynchronously (--hogwild)
+- parse_csv                                             per row of a generated CSV
+- save_state                                            per param
+- activation, activation_arr, activation_der_arr, cost_function, cost_function_der   per value
+
+Every result is printed and written as JSON with its ns/sample (mean and variance over the repeats), samples/sec and GFLOP/s.
+The convergence results are written with the generations and the wall time instead (one run, not repeated).
+The GFLOP/s use nominal counts (2 per multiply-add, 1 per activation), they compare runs with each other, not with the peak of the CPU.
+The clock is read around every call, which adds a few ns to every data point of the linked list.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR.*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "benchmark.h"
+
+// Timed repeats of every benchmark if --repeats is not given
+#define DEFAULT_BENCH_REPEATS 5
+
+// Maximum number of values of --sizes and --threads
+#define MAX_BENCH_VALUES 16
+
+// Data points per update of the params in the gradient descent benchmarks (a mini batch)
+#define BENCH_UPDATE_ROWS 64
+
+// Calls of save_state() per repeat
+#define BENCH_STATE_SAVES 256
+
+// Target cost of the convergence benchmark as a fraction of the average cost of predicting the mean output for every data point
+#define BENCH_TARGET_COST_RATIO 0.5
+
+// Generations after which a convergence run gives up (it is reported without generations and wall time)
+#define BENCH_MAX_GENERATIONS 500
+
+// Optimizer of the convergence runs (adam normalises the derivatives, so that one step size suits every width and depth)
+#define BENCH_OPTIMIZER OPTIMIZER_ADAM
+
+// Seed of the shuffles of the convergence runs (the same for both runs, so that they see the data points in the same order)
+#define BENCH_SHUFFLE_SEED 0x9E3779B97F4A7C15ULL
+
+// Options of the run
+static size_t BENCH_SIZES[MAX_BENCH_VALUES] = {1024, 8192};
+static size_t NUMBER_BENCH_SIZES = 2;
+static size_t BENCH_THREADS[MAX_BENCH_VALUES] = {1, 2, 4};
+static size_t NUMBER_BENCH_THREADS = 3;
+static size_t BENCH_REPEATS = DEFAULT_BENCH_REPEATS;
+static FILE* JSON_FILE = NULL;
+
+// Keeps the results of the scalar loops alive, so that the compiler can not remove them
+static volatile double BENCH_SINK;
+
+
+/*
+Returns the time of the monotonic clock in ns*/
+static inline double now_ns(void){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1e9 + (double) time.tv_nsec;
+}
+
+
+/*
+Parses a comma separated list of positive numbers into values.
+Returns the number of values, 0 if the list is invalid*/
+static size_t parse_number_list(const char* list, size_t* values){
+    size_t count = 0;
+    const char* position = list;
+
+    while (*position && count < MAX_BENCH_VALUES){
+        char* end;
+        unsigned long number = strtoul(position, &end, 10);
+        if (*position == '-' || end == position || number == 0 || (*end != ',' && *end != '\0')){
+            return 0;
+        }
+        values[count++] = (size_t) number;
+        position = (*end == ',') ? end + 1 : end;
+    }
+    return *position ? 0 : count;
+}
+
+
+/*
+Processes the command line arguments of the benchmarks (see the top of the file).
+Returns SUCCESSFULL_EXECUTION_CODE, OTHER_ERROR or FILE_ERROR*/
+static int process_bench_args(int argc, char* argv[]){
+    for (int arg = 1; arg < argc; arg++){
+        if (strcmp(argv[arg], "--sizes") == 0){
+            if (arg + 1 == argc || (NUMBER_BENCH_SIZES = parse_number_list(argv[arg + 1], BENCH_SIZES)) == 0){
+                printf("Invalid dataset sizes given.\nUse --sizes N,N,... with at most %d sizes > 0\n", MAX_BENCH_VALUES);
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--threads") == 0){
+            if (arg + 1 == argc || (NUMBER_BENCH_THREADS = parse_number_list(argv[arg + 1], BENCH_THREADS)) == 0){
+                printf("Invalid thread counts given.\nUse --threads N,N,... with at most %d counts > 0\n", MAX_BENCH_VALUES);
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--repeats") == 0){
+            size_t repeats;
+            if (arg + 1 == argc || parse_number_list(argv[arg + 1], &repeats) != 1){
+                printf("Invalid number of repeats given.\nUse --repeats N with N > 0\n");
+                return OTHER_ERROR;
+            }
+            BENCH_REPEATS = repeats;
+            arg++;
+        } else if (strcmp(argv[arg], "--json") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the results given.\nUse --json <file>\n");
+                return OTHER_ERROR;
+            }
+            JSON_FILE = fopen(argv[++arg], "a");
+            if (!JSON_FILE){
+                printf("Could not open %s to write the results.\n", argv[arg]);
+                return FILE_ERROR;
+            }
+        } else{
+            printf("Unknown option %s.\nUse %s [--sizes N,N,...] [--threads N,N,...] [--repeats N] [--json <file>]\n", argv[arg], argv[0]);
+            return OTHER_ERROR;
+        }
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Computes the mean and the variance of the time of one sample over the repeats (ns_per_sample[BENCH_REPEATS]),
+then prints the BENCH_RESULT and appends it to the JSON file*/
+static void report_result(BENCH_RESULT* result, const double* ns_per_sample){
+
+    double mean = 0;
+    for (size_t repeat = 0; repeat < BENCH_REPEATS; repeat++){
+        mean += ns_per_sample[repeat];
+    }
+    mean /= BENCH_REPEATS;
+
+    double variance = 0;
+    for (size_t repeat = 0; repeat < BENCH_REPEATS; repeat++){
+        variance += (ns_per_sample[repeat] - mean) * (ns_per_sample[repeat] - mean);
+    }
+    variance /= (BENCH_REPEATS > 1) ? BENCH_REPEATS - 1 : 1;
+
+    result->ns_per_sample = mean;
+    result->ns_variance = variance;
+
+    double samples_per_sec = 1e9 / mean;
+    double gflops = result->flops_per_sample / mean; // Operations per ns are GFLOP/s
+
+    printf("%-22s %-5s t=%-3zu n=%-8zu %12.2f ns/%-10s +-%6.2f%% %14.4g %s/s",
+           result->name, result->engine, result->threads, result->data_points,
+           mean, result->sample, 100 * sqrt(variance) / mean, samples_per_sec, result->sample);
+    if (result->flops_per_sample > 0){
+        printf(" %9.3f GFLOP/s", gflops);
+    }
+    printf("\n");
+
+    if (JSON_FILE){
+        fprintf(JSON_FILE, "{\"benchmark\": \"%s\", \"engine\": \"%s\", \"sample\": \"%s\", \"width\": %zu, \"hidden_layers\": %d, "
+                           "\"precision\": \"%s\", \"threads\": %zu, \"data_points\": %zu, \"repeats\": %zu, "
+                           "\"ns_per_sample\": %.6g, \"ns_per_sample_variance\": %.6g, \"ns_per_sample_stddev\": %.6g, \"samples_per_sec\": %.6g, ",
+                result->name, result->engine, result->sample, NEURON_NUMBERS[0], HIDDEN_LAYERS,
+                PRECISION_NAME, result->threads, result->data_points, BENCH_REPEATS,
+                mean, variance, sqrt(variance), samples_per_sec);
+        if (result->flops_per_sample > 0){
+            fprintf(JSON_FILE, "\"gflops\": %.6g}\n", gflops);
+        } else{
+            fprintf(JSON_FILE, "\"gflops\": null}\n");
+        }
+    }
+    return;
+}
+
+
+/*
+Nominal operations of the forward pass of one data point (a multiply-add per connection and an activation per neuron)*/
+static inline double forward_flops(void){
+    return 2.0 * NUM_CONNECTIONS + LENGTH_NETWORK;
+}
+
+/*
+Nominal operations of the backward pass of one data point (deltas and derivatives of the weights, derivatives of the biases)*/
+static inline double backward_flops(void){
+    return 4.0 * NUM_CONNECTIONS + LENGTH_NETWORK;
+}
+
+/*
+Nominal operations of the update of one param by the plain sgd (sum of the derivatives of the threads, average and step)*/
+static inline double update_flops(size_t threads){
+    return (double) threads + 2;
+}
+
+
+/*
+Allocates rows arrays of columns random values in [-1, 1] (one block, row i starts at rows[i]).
+Returns NULL if it fails*/
+static double** create_rows(size_t rows, size_t columns){
+    double** row_arr = malloc(rows * sizeof(double*));
+    double* values = malloc(rows * columns * sizeof(double));
+    if (!row_arr || !values){
+        printf("Memory allocation error for %zu rows of %zu values of the benchmarks.\n", rows, columns);
+        free(row_arr);
+        free(values);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < rows * columns; i++){
+        values[i] = 2.0 * rand() / RAND_MAX - 1;
+    }
+    for (size_t row = 0; row < rows; row++){
+        row_arr[row] = values + row * columns;
+    }
+    return row_arr;
+}
+
+static void free_rows(double** row_arr){
+    free(row_arr[0]);
+    free(row_arr);
+}
+
+
+/*
+Benchmarks distribute_input_data(), forward_pass(), backward_pass() and gradient_descent() of the linked list on one thread.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+static int bench_list_passes(neuron** network_arr, double** input, double** output, size_t size){
+
+    LIST_WORKSPACE* workspace = initialise_list_workspaces();
+    double* times = calloc(4 * BENCH_REPEATS, sizeof(double));
+    if (!workspace || !times){
+        printf("Memory allocation error for the benchmarks of the linked list.\n");
+        if (workspace){
+            free_list_workspaces(workspace);
+        }
+        free(times);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    size_t updates = (size + BENCH_UPDATE_ROWS - 1) / BENCH_UPDATE_ROWS;
+    size_t num_params = LENGTH_NETWORK + NUM_CONNECTIONS;
+    double cost = 0;
+
+    // Repeat 0 warms up the caches and is not timed
+    for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+        double time_distribute = 0, time_forward = 0, time_backward = 0;
+
+        for (size_t data_ptr = 0; data_ptr < size; data_ptr++){
+            double start = now_ns();
+            distribute_input_data(network_arr, workspace, input[data_ptr]);
+            double distributed = now_ns();
+            cost += forward_pass(network_arr, workspace, output[data_ptr]);
+            double forwarded = now_ns();
+            backward_pass(network_arr, workspace);
+            double end = now_ns();
+
+            time_distribute += distributed - start;
+            time_forward += forwarded - distributed;
+            time_backward += end - forwarded;
+        }
+
+        double start = now_ns();
+        for (size_t update = 0; update < updates; update++){
+            gradient_descent(network_arr, workspace, NULL);
+        }
+        double time_descent = now_ns() - start;
+
+        if (repeat > 0){
+            times[repeat - 1] = time_distribute / size;
+            times[BENCH_REPEATS + repeat - 1] = time_forward / size;
+            times[2 * BENCH_REPEATS + repeat - 1] = time_backward / size;
+            times[3 * BENCH_REPEATS + repeat - 1] = time_descent / (updates * num_params);
+        }
+    }
+    BENCH_SINK = cost;
+
+    BENCH_RESULT distribute = {"distribute_input_data", "list", "point", 1, size, (double) DIMENSIONS_DATA, 0, 0};
+    BENCH_RESULT forward = {"forward_pass", "list", "point", 1, size, forward_flops(), 0, 0};
+    BENCH_RESULT backward = {"backward_pass", "list", "point", 1, size, backward_flops(), 0, 0};
+    BENCH_RESULT descent = {"gradient_descent", "list", "param", 1, size, update_flops(1), 0, 0};
+    report_result(&distribute, times);
+    report_result(&forward, times + BENCH_REPEATS);
+    report_result(&backward, times + 2 * BENCH_REPEATS);
+    report_result(&descent, times + 3 * BENCH_REPEATS);
+
+    free(times);
+    free_list_workspaces(workspace);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Benchmarks the distribution of the inputs, the forward pass, the backward pass and the gradient descent of the dense network
+on one thread (batches of BATCH_SIZE data points).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+static int bench_dense_passes(DENSE_NETWORK* dense_network, double** input, double** output, size_t size){
+
+    DENSE_WORKSPACE* workspace = initialise_dense_workspaces(dense_network);
+    double* times = calloc(4 * BENCH_REPEATS, sizeof(double));
+    if (!workspace || !times){
+        printf("Memory allocation error for the benchmarks of the dense network.\n");
+        if (workspace){
+            free_dense_workspaces(workspace);
+        }
+        free(times);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    size_t updates = (size + BENCH_UPDATE_ROWS - 1) / BENCH_UPDATE_ROWS;
+    double cost = 0;
+
+    for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+        double time_distribute = 0, time_forward = 0, time_backward = 0;
+
+        for (size_t data_ptr = 0; data_ptr < size; data_ptr += BATCH_SIZE){
+            size_t batch_size = (size - data_ptr < BATCH_SIZE) ? size - data_ptr : BATCH_SIZE;
+
+            double start = now_ns();
+            dense_distribute_input_data(dense_network, workspace, &input[data_ptr], batch_size);
+            double distributed = now_ns();
+            cost += dense_forward_pass(dense_network, workspace, &output[data_ptr], batch_size);
+            double forwarded = now_ns();
+            dense_backward_pass(dense_network, workspace, batch_size);
+            double end = now_ns();
+
+            time_distribute += distributed - start;
+            time_forward += forwarded - distributed;
+            time_backward += end - forwarded;
+        }
+
+        double start = now_ns();
+        for (size_t update = 0; update < updates; update++){
+            dense_gradient_descent(dense_network, workspace, NULL);
+        }
+        double time_descent = now_ns() - start;
+
+        if (repeat > 0){
+            times[repeat - 1] = time_distribute / size;
+            times[BENCH_REPEATS + repeat - 1] = time_forward / size;
+            times[2 * BENCH_REPEATS + repeat - 1] = time_backward / size;
+            times[3 * BENCH_REPEATS + repeat - 1] = time_descent / (updates * dense_network->num_params);
+        }
+    }
+    BENCH_SINK = cost;
+
+    BENCH_RESULT distribute = {"distribute_input_data", "dense", "point", 1, size, (double) DIMENSIONS_DATA, 0, 0};
+    BENCH_RESULT forward = {"forward_pass", "dense", "point", 1, size, forward_flops(), 0, 0};
+    BENCH_RESULT backward = {"backward_pass", "dense", "point", 1, size, backward_flops(), 0, 0};
+    BENCH_RESULT descent = {"gradient_descent", "dense", "param", 1, size, update_flops(1), 0, 0};
+    report_result(&distribute, times);
+    report_result(&forward, times + BENCH_REPEATS);
+    report_result(&backward, times + 2 * BENCH_REPEATS);
+    report_result(&descent, times + 3 * BENCH_REPEATS);
+
+    free(times);
+    free_dense_workspaces(workspace);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Benchmarks one generation of the training (work of the threads and gradient descent on the thread pool, like run_neural_network())
+with threads threads, on the linked list and on the dense network.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+static int bench_train_pass(neuron** network_arr, DENSE_NETWORK* dense_network, double** input, double** output, size_t size, size_t threads){
+
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+    NUM_THREADS = threads; // The workspaces and the shards depend on the number of threads
+
+    THREAD_POOL* thread_pool = create_thread_pool(threads);
+    THREAD_DATA* thread_data = calloc(threads, size_thread_data);
+    THREAD_ARGS* thread_args_arr = calloc(threads, size_thread_args);
+    GRADIENT_DESCENT_ARGS* gradient_descent_args_arr = calloc(threads, sizeof(GRADIENT_DESCENT_ARGS));
+    LIST_WORKSPACE* list_workspaces = initialise_list_workspaces();
+    DENSE_WORKSPACE* dense_workspaces = initialise_dense_workspaces(dense_network);
+    WORK_QUEUE* work_queue = create_work_queue(threads, WORK_CHUNK_ROWS);
+    double* times = calloc(BENCH_REPEATS, sizeof(double));
+
+    if (!thread_pool || !thread_data || !thread_args_arr || !gradient_descent_args_arr || !list_workspaces || !dense_workspaces || !work_queue || !times){
+        printf("Could not set up the training pass on %zu threads for the benchmarks.\n", threads);
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_all;
+    }
+
+    distribute_mini_batch_among_threads(input, output, size, thread_data);
+
+    // 0: linked list, 1: dense network
+    for (int dense = 0; dense <= 1; dense++){
+        for (size_t thread_pos = 0; thread_pos < threads; thread_pos++){
+            thread_args_arr[thread_pos].pos = thread_pos;
+            thread_args_arr[thread_pos].data = &thread_data[thread_pos];
+            thread_args_arr[thread_pos].network_arr = network_arr;
+            thread_args_arr[thread_pos].dense_network = dense ? dense_network : NULL;
+            thread_args_arr[thread_pos].workspace = dense ? &dense_workspaces[thread_pos] : NULL;
+            thread_args_arr[thread_pos].list_workspace = dense ? NULL : &list_workspaces[thread_pos];
+            thread_args_arr[thread_pos].work_queue = work_queue;
+
+            gradient_descent_args_arr[thread_pos].network_arr = network_arr;
+            gradient_descent_args_arr[thread_pos].dense_network = dense ? dense_network : NULL;
+            gradient_descent_args_arr[thread_pos].workspaces = dense_workspaces;
+            gradient_descent_args_arr[thread_pos].list_workspaces = list_workspaces;
+            gradient_descent_args_arr[thread_pos].start = (LENGTH_NETWORK * thread_pos) / threads;
+            gradient_descent_args_arr[thread_pos].end = (LENGTH_NETWORK * (thread_pos + 1)) / threads;
+            dense_param_shard(dense_network, thread_pos, threads,
+                              &gradient_descent_args_arr[thread_pos].params_start, &gradient_descent_args_arr[thread_pos].params_end);
+        }
+        void* (*thread_function)(void*) = dense ? &dense_work_thread : &work_thread;
+
+        for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+            double start = now_ns();
+            reset_work_queue(work_queue, thread_args_arr); // Like every job of the training
+            if (run_thread_pool(thread_pool, thread_function, (void*) thread_args_arr, size_thread_args) != SUCCESSFULL_EXECUTION_CODE ||
+                run_thread_pool(thread_pool, &gradient_descent_thread, (void*) gradient_descent_args_arr, sizeof(GRADIENT_DESCENT_ARGS)) != SUCCESSFULL_EXECUTION_CODE){
+                printf("The training pass on %zu threads failed in the benchmarks.\n", threads);
+                exit_code = OTHER_ERROR;
+                goto free_all;
+            }
+            if (repeat > 0){
+                times[repeat - 1] = (now_ns() - start) / size;
+            }
+        }
+
+        size_t num_params = dense ? dense_network->num_params : LENGTH_NETWORK + NUM_CONNECTIONS;
+        BENCH_RESULT result = {"train_pass", dense ? "dense" : "list", "point", threads, size,
+                               forward_flops() + backward_flops() + num_params * update_flops(threads) / size, 0, 0};
+        report_result(&result, times);
+    }
+
+free_all:
+    free(times);
+    free_work_queue(work_queue);
+    if (dense_workspaces){
+        free_dense_workspaces(dense_workspaces);
+    }
+    if (list_workspaces){
+        free_list_workspaces(list_workspaces);
+    }
+    free(gradient_descent_args_arr);
+    free(thread_args_arr);
+    free(thread_data); // The rows belong to the dataset of the benchmarks
+    if (thread_pool){
+        free_thread_pool(thread_pool);
+    }
+    NUM_THREADS = 1;
+    return exit_code;
+}
+
+
+/*
+Trains the dense network until the average cost of a generation falls below target_cost, either synchronously in shuffled mini
+batches of BENCH_UPDATE_ROWS data points (work of the threads, then the gradient descent on the thread pool, like --mini-batch)
+or asynchronously (every thread updates the params itself after BENCH_UPDATE_ROWS of its data points, like --hogwild).
+The args of the threads are set up by bench_convergence().
+Writes the generations needed to generations (0 if the target is not reached in BENCH_MAX_GENERATIONS) and the wall time to time_ns.
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR*/
+static int train_to_target_cost(THREAD_POOL* thread_pool, double** input, double** output, size_t size, THREAD_DATA* thread_data,
+                                THREAD_ARGS* thread_args_arr, GRADIENT_DESCENT_ARGS* gradient_descent_args_arr, int hogwild,
+                                double target_cost, size_t* generations, double* time_ns){
+
+    uint64_t random_state = BENCH_SHUFFLE_SEED;
+    void* (*thread_function)(void*) = hogwild ? &dense_hogwild_thread : &dense_work_thread;
+    *generations = 0;
+
+    double start = now_ns();
+    for (size_t generation = 1; generation <= BENCH_MAX_GENERATIONS; generation++){
+        for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+            thread_args_arr[thread_pos].cost = 0;
+        }
+        shuffle_data_points(input, output, size, &random_state);
+
+        // Like run_mini_batch_pass() of main.c (SIZE_TRAIN is the size of the mini batch for its gradient descent)
+        for (size_t first = 0; first < size && !hogwild; first += BENCH_UPDATE_ROWS){
+            size_t rows = (size - first < BENCH_UPDATE_ROWS) ? size - first : BENCH_UPDATE_ROWS;
+
+            distribute_mini_batch_among_threads(input + first, output + first, rows, thread_data);
+            reset_work_queue(thread_args_arr[0].work_queue, thread_args_arr);
+            if (run_thread_pool(thread_pool, thread_function, (void*) thread_args_arr, size_thread_args) != SUCCESSFULL_EXECUTION_CODE){
+                return OTHER_ERROR;
+            }
+
+            SIZE_TRAIN = rows;
+            next_optimizer_step(thread_args_arr[0].optimizer);
+            int exit_code = run_thread_pool(thread_pool, &gradient_descent_thread, (void*) gradient_descent_args_arr, sizeof(GRADIENT_DESCENT_ARGS));
+            SIZE_TRAIN = size;
+            if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+                return OTHER_ERROR;
+            }
+        }
+
+        // The asynchronous threads update the params during the whole pass, each thread on its part of the shuffled data
+        if (hogwild){
+            distribute_mini_batch_among_threads(input, output, size, thread_data);
+            if (run_thread_pool(thread_pool, thread_function, (void*) thread_args_arr, size_thread_args) != SUCCESSFULL_EXECUTION_CODE){
+                return OTHER_ERROR;
+            }
+        }
+
+        if (calc_average_cost(thread_args_arr) < target_cost){
+            *generations = generation;
+            break;
+        }
+    }
+    *time_ns = now_ns() - start;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Prints the result of one convergence run and appends it to the JSON file (generations and wall time are null if the run gave up)*/
+static void report_convergence(const char* mode, size_t threads, size_t size, double target_cost, size_t generations, double time_ns){
+
+    printf("%-22s %-8s t=%-3zu n=%-8zu target cost %-10.4g ", "convergence", mode, threads, size, target_cost);
+    if (generations){
+        printf("%6zu generations %12.2f ms\n", generations, time_ns / 1e6);
+    } else{
+        printf("not reached in %d generations\n", BENCH_MAX_GENERATIONS);
+    }
+
+    if (JSON_FILE){
+        fprintf(JSON_FILE, "{\"benchmark\": \"convergence\", \"engine\": \"dense\", \"mode\": \"%s\", \"width\": %zu, \"hidden_layers\": %d, "
+                           "\"precision\": \"%s\", \"threads\": %zu, \"data_points\": %zu, \"update_rows\": %d, \"target_cost\": %.6g, ",
+                mode, NEURON_NUMBERS[0], HIDDEN_LAYERS, PRECISION_NAME, threads, size, BENCH_UPDATE_ROWS, target_cost);
+        if (generations){
+            fprintf(JSON_FILE, "\"generations\": %zu, \"wall_time_ms\": %.6g}\n", generations, time_ns / 1e6);
+        } else{
+            fprintf(JSON_FILE, "\"generations\": null, \"wall_time_ms\": null}\n");
+        }
+    }
+    return;
+}
+
+
+/*
+Divides the seeded weights of every layer by the number of its neurons (the fan-in of the next layer).
+The seeded weights are in [0, 1], so that the sums of the wide layers would start far outside the range the training can recover
+from in the generations of a convergence run*/
+static void scale_seeded_weights(DENSE_NETWORK* seeded_network){
+    for (size_t layer = 0; layer < NUMBER_LAYERS - 1; layer++){
+        DENSE_LAYER* dense_layer = &seeded_network->layers[layer];
+        for (size_t i = 0; i < dense_layer->size * dense_layer->size_next; i++){
+            size_t index = dense_layer->weights_offset + i;
+            seeded_network->params[index] = (scalar) (seeded_network->params[index] / dense_layer->size);
+            if (seeded_network->master_params){
+                seeded_network->master_params[index] /= dense_layer->size;
+            }
+        }
+    }
+}
+
+
+/*
+Copies the params of the seeded network (compiled before any benchmark trained) into the dense network*/
+static void restore_seeded_params(DENSE_NETWORK* dense_network, const DENSE_NETWORK* seeded_network){
+    memcpy(dense_network->params, seeded_network->params, dense_network->num_params * sizeof(scalar));
+    if (dense_network->master_params){
+        memcpy(dense_network->master_params, seeded_network->master_params, dense_network->num_params * sizeof(double));
+    }
+}
+
+
+/*
+Benchmarks the convergence of the synchronous training in mini batches against the asynchronous training (Hogwild!) on threads
+threads with the same update size (BENCH_UPDATE_ROWS data points).
+Both runs train the dense network from the params of the seeded network with BENCH_OPTIMIZER and see the data points in the same
+order, on a dataset they can learn (every output is the mean of the inputs). The target cost is BENCH_TARGET_COST_RATIO of the
+cost of predicting the mean output, the same for every seeded network.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+static int bench_convergence(neuron** network_arr, DENSE_NETWORK* dense_network, const DENSE_NETWORK* seeded_network, size_t size, size_t threads){
+
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+    NUM_THREADS = threads; // The workspaces and the shards depend on the number of threads
+    OPTIMIZER* optimizer = NULL;
+
+    THREAD_POOL* thread_pool = create_thread_pool(threads);
+    THREAD_DATA* thread_data = calloc(threads, size_thread_data);
+    THREAD_ARGS* thread_args_arr = calloc(threads, size_thread_args);
+    GRADIENT_DESCENT_ARGS* gradient_descent_args_arr = calloc(threads, sizeof(GRADIENT_DESCENT_ARGS));
+    DENSE_WORKSPACE* dense_workspaces = initialise_dense_workspaces(dense_network);
+    WORK_QUEUE* work_queue = create_work_queue(threads, WORK_CHUNK_ROWS);
+    double** input = create_rows(size, DIMENSIONS_DATA);
+    double** output = create_rows(size, NUM_OUTPUT);
+    double* input_values = input ? input[0] : NULL;     // The shuffles move the rows, free_rows() needs the first one
+    double* output_values = output ? output[0] : NULL;
+
+    if (!thread_pool || !thread_data || !thread_args_arr || !gradient_descent_args_arr || !dense_workspaces || !work_queue || !input || !output){
+        printf("Could not set up the convergence runs on %zu threads for the benchmarks.\n", threads);
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_all;
+    }
+
+    // The output is the mean of the inputs, the target cost is a fraction of the cost of predicting its mean over the data points
+    double mean_output = 0;
+    for (size_t row = 0; row < size; row++){
+        double mean = 0;
+        for (size_t d = 0; d < DIMENSIONS_DATA; d++){
+            mean += input[row][d];
+        }
+        for (size_t o = 0; o < NUM_OUTPUT; o++){
+            output[row][o] = mean / DIMENSIONS_DATA;
+        }
+        mean_output += output[row][0] / size;
+    }
+    double target_cost = 0;
+    for (size_t row = 0; row < size; row++){
+        for (size_t o = 0; o < NUM_OUTPUT; o++){
+            target_cost += COST_FUNCTION(output[row][o], mean_output);
+        }
+    }
+    target_cost *= BENCH_TARGET_COST_RATIO / size;
+
+    for (size_t thread_pos = 0; thread_pos < threads; thread_pos++){
+        thread_args_arr[thread_pos].pos = thread_pos;
+        thread_args_arr[thread_pos].data = &thread_data[thread_pos];
+        thread_args_arr[thread_pos].network_arr = network_arr;
+        thread_args_arr[thread_pos].dense_network = dense_network;
+        thread_args_arr[thread_pos].workspace = &dense_workspaces[thread_pos];
+        thread_args_arr[thread_pos].update_rows = BENCH_UPDATE_ROWS;
+        thread_args_arr[thread_pos].work_queue = work_queue;
+
+        gradient_descent_args_arr[thread_pos].network_arr = network_arr;
+        gradient_descent_args_arr[thread_pos].dense_network = dense_network;
+        gradient_descent_args_arr[thread_pos].workspaces = dense_workspaces;
+        dense_param_shard(dense_network, thread_pos, threads,
+                          &gradient_descent_args_arr[thread_pos].params_start, &gradient_descent_args_arr[thread_pos].params_end);
+    }
+
+    // 0: mini batches, 1: hogwild
+    for (int hogwild = 0; hogwild <= 1; hogwild++){
+        optimizer = create_optimizer(BENCH_OPTIMIZER, dense_network->num_params);
+        if (!optimizer){
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto free_all;
+        }
+        restore_seeded_params(dense_network, seeded_network);
+        for (size_t thread_pos = 0; thread_pos < threads; thread_pos++){
+            thread_args_arr[thread_pos].optimizer = optimizer;
+            gradient_descent_args_arr[thread_pos].optimizer = optimizer;
+        }
+
+        size_t generations;
+        double time_ns;
+        if (train_to_target_cost(thread_pool, input, output, size, thread_data, thread_args_arr, gradient_descent_args_arr,
+                                 hogwild, target_cost, &generations, &time_ns) != SUCCESSFULL_EXECUTION_CODE){
+            printf("The convergence run on %zu threads failed in the benchmarks.\n", threads);
+            exit_code = OTHER_ERROR;
+            goto free_all;
+        }
+        report_convergence(hogwild ? "hogwild" : "mini_batch", threads, size, target_cost, generations, time_ns);
+
+        free_optimizer(optimizer);
+        optimizer = NULL;
+    }
+
+free_all:
+    if (optimizer){
+        free_optimizer(optimizer);
+    }
+    if (input){
+        input[0] = input_values;
+        free_rows(input);
+    }
+    if (output){
+        output[0] = output_values;
+        free_rows(output);
+    }
+    free_work_queue(work_queue);
+    if (dense_workspaces){
+        free_dense_workspaces(dense_workspaces);
+    }
+    free(gradient_descent_args_arr);
+    free(thread_args_arr);
+    free(thread_data);
+    if (thread_pool){
+        free_thread_pool(thread_pool);
+    }
+    NUM_THREADS = 1;
+    return exit_code;
+}
+
+
+/*
+Benchmarks parse_csv() on a CSV of the data points written to a temporary file.
+Returns SUCCESSFULL_EXECUTION_CODE, FILE_ERROR or OTHER_ERROR*/
+static int bench_parse_csv(double** input, double** output, size_t size){
+
+    char filename[] = "/tmp/neural_network_bench_XXXXXX";
+    int descriptor = mkstemp(filename);
+    FILE* file = (descriptor >= 0) ? fdopen(descriptor, "w") : NULL;
+    if (!file){
+        printf("Could not create a temporary CSV for the benchmarks.\n");
+        return FILE_ERROR;
+    }
+
+    for (size_t row = 0; row < size; row++){
+        for (size_t d = 0; d < DIMENSIONS_DATA; d++){
+            fprintf(file, "%.17g,", input[row][d]);
+        }
+        fprintf(file, "%.17g\n", output[row][0]);
+    }
+    fclose(file);
+
+    // parse_csv() sets the dimensions and the size of the data (to the same values)
+    size_t dimensions_data = DIMENSIONS_DATA;
+    size_t size_train = SIZE_TRAIN;
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+    double times[BENCH_REPEATS];
+
+    for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+        double start = now_ns();
+        INPUT_OUTPUT_MAPPING* mapping = parse_csv(filename);
+        double end = now_ns();
+
+        if (!mapping){
+            printf("Could not parse the CSV of the benchmarks.\n");
+            exit_code = OTHER_ERROR;
+            break;
+        }
+        free_input_output_mapping(mapping);
+        if (repeat > 0){
+            times[repeat - 1] = (end - start) / size;
+        }
+    }
+    remove(filename);
+    DIMENSIONS_DATA = dimensions_data;
+    SIZE_TRAIN = size_train;
+
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+        BENCH_RESULT result = {"parse_csv", "-", "row", 1, size, 0, 0, 0};
+        report_result(&result, times);
+    }
+    return exit_code;
+}
+
+
+/*
+Benchmarks save_state() (copy of the params of the linked list into the STATE).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+static int bench_save_state(neuron** network_arr){
+
+    STATE* state = initialise_state(network_arr);
+    if (!state){
+        printf("Memory allocation error for the state of the benchmarks.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    double times[BENCH_REPEATS];
+    for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+        double start = now_ns();
+        for (size_t save = 0; save < BENCH_STATE_SAVES; save++){
+            save_state(network_arr, state);
+        }
+        if (repeat > 0){
+            times[repeat - 1] = (now_ns() - start) / (BENCH_STATE_SAVES * (LENGTH_NETWORK + NUM_CONNECTIONS));
+        }
+    }
+
+    BENCH_RESULT result = {"save_state", "list", "param", 1, 0, 0, 0, 0};
+    report_result(&result, times);
+
+    free_state(state);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Benchmarks the activation function (scalar and array versions) and the cost function of the configurations
+on the values of one layer of the input width for every data point.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+static int bench_activation_cost_functions(size_t size){
+
+    size_t num_values = size * NEURON_NUMBERS[0];
+    double* values = malloc(num_values * sizeof(double));
+    double* results = malloc(num_values * sizeof(double));
+    scalar* scalar_values = malloc(num_values * sizeof(scalar));
+    scalar* scalar_results = malloc(num_values * sizeof(scalar));
+    double* times = calloc(5 * BENCH_REPEATS, sizeof(double));
+    if (!values || !results || !scalar_values || !scalar_results || !times){
+        printf("Memory allocation error for the values of the activation benchmarks.\n");
+        free(values);
+        free(results);
+        free(scalar_values);
+        free(scalar_results);
+        free(times);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    for (size_t i = 0; i < num_values; i++){
+        values[i] = 4.0 * rand() / RAND_MAX - 2;
+        scalar_values[i] = (scalar) values[i];
+    }
+
+    for (size_t repeat = 0; repeat <= BENCH_REPEATS; repeat++){
+        double timestamps[6];
+        double cost = 0;
+
+        timestamps[0] = now_ns();
+        for (size_t i = 0; i < num_values; i++){
+            results[i] = ACTIVATION_FUNCTION(values[i]);
+        }
+        timestamps[1] = now_ns();
+        ACTIVATION_FUNCTION_ARR(scalar_values, scalar_results, num_values);
+        timestamps[2] = now_ns();
+        ACTIVATION_FUNCTION_DER_ARR(scalar_values, scalar_results, num_values);
+        timestamps[3] = now_ns();
+        for (size_t i = 0; i < num_values; i++){
+            cost += COST_FUNCTION(values[i], results[i]);
+        }
+        timestamps[4] = now_ns();
+        for (size_t i = 0; i < num_values; i++){
+            results[i] = COST_FUNCTION_DER(values[i], results[i]);
+        }
+        timestamps[5] = now_ns();
+
+        BENCH_SINK = cost + results[num_values - 1] + scalar_results[num_values - 1];
+        if (repeat > 0){
+            for (size_t bench = 0; bench < 5; bench++){
+                times[bench * BENCH_REPEATS + repeat - 1] = (timestamps[bench + 1] - timestamps[bench]) / num_values;
+            }
+        }
+    }
+
+    BENCH_RESULT activation = {"activation", "-", "value", 1, size, 1, 0, 0};
+    BENCH_RESULT activation_arr = {"activation_arr", "-", "value", 1, size, 1, 0, 0};
+    BENCH_RESULT activation_der_arr = {"activation_der_arr", "-", "value", 1, size, 1, 0, 0};
+    BENCH_RESULT cost_function = {"cost_function", "-", "value", 1, size, 4, 0, 0};
+    BENCH_RESULT cost_function_der = {"cost_function_der", "-", "value", 1, size, 1, 0, 0};
+    report_result(&activation, times);
+    report_result(&activation_arr, times + BENCH_REPEATS);
+    report_result(&activation_der_arr, times + 2 * BENCH_REPEATS);
+    report_result(&cost_function, times + 3 * BENCH_REPEATS);
+    report_result(&cost_function_der, times + 4 * BENCH_REPEATS);
+
+    free(values);
+    free(results);
+    free(scalar_values);
+    free(scalar_results);
+    free(times);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Runs all benchmarks for every dataset size and thread count of the command line.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+int run_benchmarks(int argc, char* argv[]){
+
+    int exit_code = process_bench_args(argc, argv);
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        return exit_code;
+    }
+
+    // 1. Build the Neural Network of the topology of the build (the inputs have the width of the input layer)
+    NUM_THREADS = 1;
+    DIMENSIONS_DATA = NEURON_NUMBERS[0];
+
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array failed in the benchmarks.\n");
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto close_json;
+    }
+    // The network array is freed by the function in case of an error
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Connecting the neurons failed in the benchmarks.\n");
+        exit_code = OTHER_ERROR;
+        goto close_json;
+    }
+    // The second copy keeps the seeded params for the convergence benchmarks (the other benchmarks train the network)
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    DENSE_NETWORK* seeded_network = dense_network ? compile_network(network_arr) : NULL;
+    if (!seeded_network){
+        printf("Compiling the network failed in the benchmarks.\n");
+        if (dense_network){
+            free_dense_network(dense_network);
+        }
+        exit_code = OTHER_ERROR;
+        goto free_network;
+    }
+    scale_seeded_weights(seeded_network);
+
+    printf("Benchmarks of %d layers of width %zu (%zu connections, %s precision, %zu repeats)\n",
+           NUMBER_LAYERS, NEURON_NUMBERS[0], NUM_CONNECTIONS, PRECISION_NAME, BENCH_REPEATS);
+
+    exit_code = bench_save_state(network_arr);
+
+    // 2. Every benchmark of the data on every dataset size
+    for (size_t size_pos = 0; size_pos < NUMBER_BENCH_SIZES && exit_code == SUCCESSFULL_EXECUTION_CODE; size_pos++){
+        size_t size = BENCH_SIZES[size_pos];
+        SIZE_TRAIN = size;
+
+        double** input = create_rows(size, DIMENSIONS_DATA);
+        double** output = input ? create_rows(size, NUM_OUTPUT) : NULL;
+        if (!output){
+            if (input){
+                free_rows(input);
+            }
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            break;
+        }
+
+        exit_code = bench_parse_csv(input, output, size);
+        if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+            exit_code = bench_activation_cost_functions(size);
+        }
+        if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+            exit_code = bench_list_passes(network_arr, input, output, size);
+        }
+        if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+            exit_code = bench_dense_passes(dense_network, input, output, size);
+        }
+        for (size_t threads_pos = 0; threads_pos < NUMBER_BENCH_THREADS && exit_code == SUCCESSFULL_EXECUTION_CODE; threads_pos++){
+            exit_code = bench_train_pass(network_arr, dense_network, input, output, size, BENCH_THREADS[threads_pos]);
+        }
+        for (size_t threads_pos = 0; threads_pos < NUMBER_BENCH_THREADS && exit_code == SUCCESSFULL_EXECUTION_CODE; threads_pos++){
+            exit_code = bench_convergence(network_arr, dense_network, seeded_network, size, BENCH_THREADS[threads_pos]);
+        }
+
+        free_rows(input);
+        free_rows(output);
+    }
+
+    free_dense_network(seeded_network);
+    free_dense_network(dense_network);
+free_network:
+    free_network(network_arr);
+close_json:
+    if (JSON_FILE){
+        fclose(JSON_FILE);
+    }
+    return exit_code;
+}
+
+
+int main(int argc, char* argv[]){
+    return run_benchmarks(argc, argv);
+}
@@ -0,0 +1,21 @@
+/*
+Header file of the benchmarks.
+Includes process_input.h first to use DIMENSIONS_DATA and SIZE_TRAIN, and every module whose functions are benchmarked.
+May only be included in its own .c file (it is built by make bench, not into the Neural Network).*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../process_input/process_input.h"
+#include "../structs/structs.h"
+#include "../neurons/neurons.h"
+#include "../feed_forward/feed_forward.h"
+#include "../gradient_descent/gradient_descent.h"
+#include "../dense_network/dense_network.h"
+#include "../thread_pool/thread_pool.h"
+#include "../work_queue/work_queue.h"
+#include "../save_state/save_state.h"
+
+int run_benchmarks(int, char*[]);
+
+#endif // BENCHMARK_H
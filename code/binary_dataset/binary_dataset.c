@@ -0,0 +1,334 @@
+/*
+This file is responsible for the binary format of the training data.
+A CSV is parsed once and converted into a binary dataset (see BINARY_DATASET_HEADER in structs.h),
+which is then loaded with mmap on every run instead of tokenising the CSV again:
+- float64 files are used in place, the rows of the INPUT_OUTPUT_MAPPING point straight into the mapping
+- float32 files are half the size on disk and are widened into one block of doubles when loaded
+
+The pages of the file are only read by the kernel when they are touched, so loading a dataset of any size
+only costs the validation of the header and the arrays of row pointers.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR or NULL if pointers are returned.*/
+
+#define _POSIX_C_SOURCE 200809L // For mmap, open and fstat
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "binary_dataset.h"
+
+// Number of values converted to float32 at once when writing
+#define WRITE_CHUNK 256
+
+// Rounds a number of bytes up to a multiple of BINARY_DATASET_ALIGNMENT
+#define ALIGN_OFFSET(bytes) ((((bytes) + BINARY_DATASET_ALIGNMENT - 1) / BINARY_DATASET_ALIGNMENT) * BINARY_DATASET_ALIGNMENT)
+
+
+/*
+Returns 1 if the file starts with BINARY_DATASET_MAGIC, else 0 (also if it can not be opened)*/
+int is_binary_dataset(const char* filename){
+    FILE* file = fopen(filename, "rb");
+    if (!file){
+        return 0;
+    }
+
+    char magic[8];
+    int is_binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, BINARY_DATASET_MAGIC, sizeof(magic)) == 0;
+
+    fclose(file);
+    return is_binary;
+}
+
+
+/*
+Writes count doubles as values of scalar_size bytes (8 for float64, 4 for float32).
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int write_values(FILE* file, const double* values, size_t count, size_t scalar_size){
+
+    if (scalar_size == sizeof(double)){
+        return fwrite(values, sizeof(double), count, file) == count ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+    }
+
+    float chunk[WRITE_CHUNK];
+    for (size_t start = 0; start < count; start += WRITE_CHUNK){
+        size_t size = (count - start < WRITE_CHUNK) ? count - start : WRITE_CHUNK;
+        for (size_t i = 0; i < size; i++){
+            chunk[i] = (float) values[start + i];
+        }
+        if (fwrite(chunk, sizeof(float), size, file) != size){
+            return FILE_ERROR;
+        }
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Writes zero bytes until the file reaches the offset.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int pad_to_offset(FILE* file, size_t offset){
+    static const char zeros[BINARY_DATASET_ALIGNMENT] = {0};
+
+    long position = ftell(file);
+    if (position < 0 || (size_t) position > offset){
+        return FILE_ERROR;
+    }
+    size_t padding = offset - (size_t) position;
+    return fwrite(zeros, 1, padding, file) == padding ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+}
+
+
+/*
+Function to write the used rows of an INPUT_OUTPUT_MAPPING into a binary dataset.
+scalar_size selects the type of the values in the file (sizeof(double) or sizeof(float)).
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+int write_binary_dataset(INPUT_OUTPUT_MAPPING* mapping, const char* filename, size_t scalar_size){
+
+    if (scalar_size != sizeof(double) && scalar_size != sizeof(float)){
+        printf("Binary datasets can only store float64 or float32 values, not values of %zu bytes.\n", scalar_size);
+        return OTHER_ERROR;
+    }
+
+    // 1. Calculate the layout of the file
+    BINARY_DATASET_HEADER header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic));
+    header.version = BINARY_DATASET_VERSION;
+    header.scalar_size = scalar_size;
+    header.rows = mapping->used;
+    header.input_dims = DIMENSIONS_DATA;
+    header.outputs = NUM_OUTPUT;
+    header.input_offset = ALIGN_OFFSET(sizeof(BINARY_DATASET_HEADER));
+    header.output_offset = ALIGN_OFFSET(header.input_offset + header.rows * header.input_dims * scalar_size);
+
+    FILE* file = fopen(filename, "wb");
+    if (!file){
+        printf("Could not open %s to write the binary dataset.\n", filename);
+        return FILE_ERROR;
+    }
+
+    // 2. Write the header, the block of inputs and the block of outputs
+    int exit_code = fwrite(&header, sizeof(header), 1, file) == 1 ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = pad_to_offset(file, header.input_offset);
+    }
+    for (size_t row = 0; row < mapping->used && exit_code == SUCCESSFULL_EXECUTION_CODE; row++){
+        exit_code = write_values(file, mapping->input[row], DIMENSIONS_DATA, scalar_size);
+    }
+
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = pad_to_offset(file, header.output_offset);
+    }
+    for (size_t row = 0; row < mapping->used && exit_code == SUCCESSFULL_EXECUTION_CODE; row++){
+        exit_code = write_values(file, mapping->output[row], NUM_OUTPUT, scalar_size);
+    }
+
+    if (fclose(file) != 0){
+        exit_code = FILE_ERROR;
+    }
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when writing the binary dataset %s.\n", filename);
+    }
+    return exit_code;
+}
+
+
+/*
+Function to convert a CSV into a binary dataset.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+int convert_csv_to_binary(const char* csv_filename, const char* binary_filename, size_t scalar_size){
+
+    INPUT_OUTPUT_MAPPING* mapping = parse_csv(csv_filename);
+    if (!mapping){
+        printf("Could not read in the data of the csv %s.\n", csv_filename);
+        return OTHER_ERROR;
+    }
+
+    int exit_code = write_binary_dataset(mapping, binary_filename, scalar_size);
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+        printf("Converted %zu data points of %s into %s.\n", mapping->used, csv_filename, binary_filename);
+    }
+
+    free_input_output_mapping(mapping);
+    return exit_code;
+}
+
+
+/*
+Checks that the header describes a dataset that fits into a file of file_size bytes and matches the Neural Network.
+Returns 1 if it is valid, else 0 (and prints the reason)*/
+int valid_binary_dataset_header(const BINARY_DATASET_HEADER* header, size_t file_size, const char* filename){
+
+    if (memcmp(header->magic, BINARY_DATASET_MAGIC, sizeof(header->magic)) != 0 || header->version != BINARY_DATASET_VERSION){
+        printf("%s is not a binary dataset of version %d.\n", filename, BINARY_DATASET_VERSION);
+        return 0;
+    }
+    if (header->scalar_size != sizeof(double) && header->scalar_size != sizeof(float)){
+        printf("%s stores values of %zu bytes, only float64 and float32 are supported.\n", filename, (size_t) header->scalar_size);
+        return 0;
+    }
+    if (header->outputs != NUM_OUTPUT){
+        printf("%s has %zu outputs, but the Neural Network has %zu.\n", filename, (size_t) header->outputs, (size_t) NUM_OUTPUT);
+        return 0;
+    }
+    if (header->rows == 0 || header->input_dims == 0){
+        printf("%s does not hold any data.\n", filename);
+        return 0;
+    }
+    if (header->input_offset % BINARY_DATASET_ALIGNMENT != 0 || header->output_offset % BINARY_DATASET_ALIGNMENT != 0){
+        printf("The blocks of %s are not aligned to %d bytes.\n", filename, BINARY_DATASET_ALIGNMENT);
+        return 0;
+    }
+
+    // Both blocks have to lie inside the file (checked with divisions, so that the products can not overflow)
+    size_t max_values = file_size / header->scalar_size;
+    if (header->input_dims > max_values / header->rows || header->outputs > max_values / header->rows){
+        printf("%s is shorter than its header claims.\n", filename);
+        return 0;
+    }
+    size_t size_inputs = header->rows * header->input_dims * header->scalar_size;
+    size_t size_outputs = header->rows * header->outputs * header->scalar_size;
+    if (header->input_offset > file_size - size_inputs || header->output_offset > file_size - size_outputs ||
+        header->input_offset < sizeof(BINARY_DATASET_HEADER)){
+        printf("%s is shorter than its header claims.\n", filename);
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+Function to load a binary dataset into an INPUT_OUTPUT_MAPPING (the counterpart of parse_csv()).
+The file is mapped read-only into memory and the memory behind the rows is kept in the BINARY_DATASET,
+which has to be freed with free_binary_dataset() after the rows are no longer used.
+Sets DIMENSIONS_DATA, SIZE_TRAIN and the sizes of the THREAD_DATA.
+Returns NULL if it fails*/
+INPUT_OUTPUT_MAPPING* load_binary_dataset(const char* filename, BINARY_DATASET* dataset){
+
+    dataset->mapping = NULL;
+    dataset->size_mapping = 0;
+    dataset->converted = NULL;
+
+    // 1. Map the file
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        printf("Could not open the binary dataset %s.\n", filename);
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t) file_stat.st_size < sizeof(BINARY_DATASET_HEADER)){
+        printf("The binary dataset %s is too short to hold a header.\n", filename);
+        close(fd);
+        return NULL;
+    }
+    size_t file_size = (size_t) file_stat.st_size;
+
+    void* file_mapping = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after closing the file
+    if (file_mapping == MAP_FAILED){
+        printf("Could not map the binary dataset %s into memory.\n", filename);
+        return NULL;
+    }
+    dataset->mapping = file_mapping;
+    dataset->size_mapping = file_size;
+
+    const BINARY_DATASET_HEADER* header = (const BINARY_DATASET_HEADER*) file_mapping;
+    if (!valid_binary_dataset_header(header, file_size, filename)){
+        free_binary_dataset(dataset);
+        return NULL;
+    }
+
+    // Every data point is read in every generation, so let the kernel read ahead
+    posix_madvise(file_mapping, file_size, POSIX_MADV_WILLNEED);
+
+    size_t rows = header->rows;
+    size_t input_dims = header->input_dims;
+    size_t outputs = header->outputs;
+
+    // 2. Get the blocks of doubles (in place for float64, widened for float32)
+    // The rows are never written by the Neural Network, so the read-only mapping can be used for the double* of the mapping
+    double* inputs;
+    double* outputs_block;
+    if (header->scalar_size == sizeof(double)){
+        inputs = (double*) ((char*) file_mapping + header->input_offset);
+        outputs_block = (double*) ((char*) file_mapping + header->output_offset);
+    } else{
+        // Both blocks keep the alignment they have in the file
+        size_t size_inputs = ALIGN_OFFSET(rows * input_dims * sizeof(double));
+        size_t size_outputs = ALIGN_OFFSET(rows * outputs * sizeof(double));
+        dataset->converted = aligned_alloc(BINARY_DATASET_ALIGNMENT, size_inputs + size_outputs);
+        if (!dataset->converted){
+            perror("Memory allocation error when trying to widen the float32 binary dataset.\n");
+            free_binary_dataset(dataset);
+            return NULL;
+        }
+        inputs = dataset->converted;
+        outputs_block = (double*) ((char*) dataset->converted + size_inputs);
+
+        const float* inputs_file = (const float*) ((const char*) file_mapping + header->input_offset);
+        const float* outputs_file = (const float*) ((const char*) file_mapping + header->output_offset);
+        for (size_t i = 0; i < rows * input_dims; i++){
+            inputs[i] = inputs_file[i];
+        }
+        for (size_t i = 0; i < rows * outputs; i++){
+            outputs_block[i] = outputs_file[i];
+        }
+    }
+
+    // 3. Point the rows of the mapping into the blocks
+    INPUT_OUTPUT_MAPPING* mapping = malloc(sizeof(INPUT_OUTPUT_MAPPING));
+    if (!mapping){
+        perror("Memory allocation failed for the mapping structure.\n");
+        free_binary_dataset(dataset);
+        return NULL;
+    }
+    mapping->input = malloc(rows * sizeof(double*));
+    mapping->output = malloc(rows * sizeof(double*));
+    if (!mapping->input || !mapping->output){
+        perror("Memory allocation failed for the rows of the binary dataset.\n");
+        free(mapping->input);
+        free(mapping->output);
+        free(mapping);
+        free_binary_dataset(dataset);
+        return NULL;
+    }
+    mapping->size = rows;
+    mapping->used = rows;
+    mapping->rows_owned = 0;
+
+    for (size_t row = 0; row < rows; row++){
+        mapping->input[row] = inputs + row * input_dims;
+        mapping->output[row] = outputs_block + row * outputs;
+    }
+
+    // 4. Set the constants of the data (see parse_csv())
+    DIMENSIONS_DATA = input_dims;
+    SIZE_TRAIN = rows;
+    BASE_SIZE_THREAD_DATA = SIZE_TRAIN / NUM_THREADS;
+    REMAINDER_THREAD_DATA = SIZE_TRAIN % NUM_THREADS;
+
+    return mapping;
+}
+
+
+/*
+Function to unmap the file and free the widened data of a BINARY_DATASET.
+Works for datasets that failed to load.*/
+void free_binary_dataset(BINARY_DATASET* dataset){
+    if (dataset->mapping){
+        munmap(dataset->mapping, dataset->size_mapping);
+    }
+    free(dataset->converted);
+
+    dataset->mapping = NULL;
+    dataset->size_mapping = 0;
+    dataset->converted = NULL;
+}
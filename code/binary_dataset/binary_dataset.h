@@ -0,0 +1,29 @@
+/*
+Header file of the binary dataset file.
+Includes process_input.h to set the constants of the data (DIMENSIONS_DATA, SIZE_TRAIN, ...) like parse_csv()*/
+
+#ifndef BINARY_DATASET_H
+#define BINARY_DATASET_H
+
+#include "../process_input/process_input.h"
+
+// First 8 bytes of every binary dataset
+#define BINARY_DATASET_MAGIC "NNDATA01"
+
+// Version of the layout of the file (increment on every change of the BINARY_DATASET_HEADER)
+#define BINARY_DATASET_VERSION 1
+
+// Alignment of the blocks of inputs and outputs in the file (and therefore in the mapping) in bytes
+#define BINARY_DATASET_ALIGNMENT 64
+
+int is_binary_dataset(const char*);
+
+int write_binary_dataset(INPUT_OUTPUT_MAPPING*, const char*, size_t);
+int convert_csv_to_binary(const char*, const char*, size_t);
+
+int valid_binary_dataset_header(const BINARY_DATASET_HEADER*, size_t, const char*);
+
+INPUT_OUTPUT_MAPPING* load_binary_dataset(const char*, BINARY_DATASET*);
+void free_binary_dataset(BINARY_DATASET*);
+
+#endif // BINARY_DATASET_H
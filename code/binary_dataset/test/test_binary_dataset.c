@@ -0,0 +1,181 @@
+/*
+Test file for the binary dataset.
+May not be included in any other files. Its own purpose is for testing.
+
+The test files are written into the current directory and removed again.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_binary_dataset.h"
+
+// Shape of the test data
+#define TEST_ROWS 5
+#define TEST_DIMENSIONS 3
+
+// Files written by the tests
+#define TEST_FILE "test_binary_dataset.bin"
+#define TRUNCATED_FILE "test_binary_dataset_truncated.bin"
+
+
+/*
+Creates a mapping of TEST_ROWS rows like parse_csv() (one block, the output of every row follows its input).
+Value j of row i is i + j / 8 (exactly representable as float32), the output is -i.
+Returns NULL if it fails*/
+INPUT_OUTPUT_MAPPING* create_test_mapping(void){
+
+    DIMENSIONS_DATA = TEST_DIMENSIONS;
+
+    INPUT_OUTPUT_MAPPING* mapping = initialise_mapping();
+    if (!mapping){
+        return NULL;
+    }
+
+    double* values = malloc(TEST_ROWS * (TEST_DIMENSIONS + NUM_OUTPUT) * sizeof(double));
+    if (!values){
+        free_input_output_mapping(mapping);
+        return NULL;
+    }
+
+    for (size_t row = 0; row < TEST_ROWS; row++){
+        double* row_values = values + row * (TEST_DIMENSIONS + NUM_OUTPUT);
+        for (size_t j = 0; j < TEST_DIMENSIONS; j++){
+            row_values[j] = (double) row + (double) j / 8;
+        }
+        row_values[TEST_DIMENSIONS] = -(double) row;
+
+        mapping->input[row] = row_values;
+        mapping->output[row] = row_values + TEST_DIMENSIONS;
+        mapping->used++;
+    }
+    return mapping;
+}
+
+
+/*
+Tests that a dataset written with values of scalar_size bytes is loaded with the same values*/
+void test_round_trip(INPUT_OUTPUT_MAPPING* mapping, size_t scalar_size){
+
+    assert(write_binary_dataset(mapping, TEST_FILE, scalar_size) == SUCCESSFULL_EXECUTION_CODE);
+    assert(is_binary_dataset(TEST_FILE));
+
+    // Make sure that the constants are set by the loader
+    DIMENSIONS_DATA = 0;
+    SIZE_TRAIN = 0;
+
+    BINARY_DATASET dataset;
+    INPUT_OUTPUT_MAPPING* loaded = load_binary_dataset(TEST_FILE, &dataset);
+    assert(loaded != NULL);
+
+    assert(DIMENSIONS_DATA == TEST_DIMENSIONS);
+    assert(SIZE_TRAIN == TEST_ROWS);
+    assert(loaded->used == TEST_ROWS);
+    assert(loaded->rows_owned == 0);
+
+    // float64 is used in place, float32 is widened
+    if (scalar_size == sizeof(double)){
+        assert(dataset.converted == NULL);
+        assert((char*) loaded->input[0] >= (char*) dataset.mapping);
+        assert((char*) loaded->input[0] < (char*) dataset.mapping + dataset.size_mapping);
+    } else{
+        assert(dataset.converted != NULL);
+    }
+
+    // The rows are contiguous and aligned
+    assert((size_t) loaded->input[0] % BINARY_DATASET_ALIGNMENT == 0);
+    assert((size_t) loaded->output[0] % BINARY_DATASET_ALIGNMENT == 0);
+    assert(loaded->input[1] == loaded->input[0] + TEST_DIMENSIONS);
+
+    for (size_t row = 0; row < TEST_ROWS; row++){
+        for (size_t j = 0; j < TEST_DIMENSIONS; j++){
+            COMPARE(loaded->input[row][j], mapping->input[row][j]);
+        }
+        COMPARE(loaded->output[row][0], mapping->output[row][0]);
+    }
+
+    // The loaded rows can be distributed among the threads like the rows of a CSV
+    THREAD_DATA* thread_data = distribute_data_among_threads(loaded);
+    assert(thread_data != NULL);
+
+    size_t total = 0;
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        total += thread_data[thread_pos].size;
+    }
+    assert(total == TEST_ROWS);
+    COMPARE(thread_data[NUM_THREADS - 1].output[0][0], -(double) (TEST_ROWS - 1));
+
+    free_thread_data_array(thread_data);
+    free_binary_dataset(&dataset);
+    assert(dataset.mapping == NULL);
+
+    remove(TEST_FILE);
+    return;
+}
+
+
+/*
+Tests that files which are not (complete) binary datasets are rejected*/
+void test_invalid_files(INPUT_OUTPUT_MAPPING* mapping){
+
+    BINARY_DATASET dataset;
+
+    // 1. A missing file
+    assert(!is_binary_dataset(TEST_FILE));
+    assert(load_binary_dataset(TEST_FILE, &dataset) == NULL);
+
+    // 2. A file that is cut off after the header
+    assert(write_binary_dataset(mapping, TEST_FILE, sizeof(double)) == SUCCESSFULL_EXECUTION_CODE);
+
+    char header[sizeof(BINARY_DATASET_HEADER)];
+    FILE* file = fopen(TEST_FILE, "rb");
+    assert(file != NULL);
+    assert(fread(header, 1, sizeof(header), file) == sizeof(header));
+    fclose(file);
+
+    file = fopen(TRUNCATED_FILE, "wb");
+    assert(file != NULL);
+    assert(fwrite(header, 1, sizeof(header), file) == sizeof(header));
+    fclose(file);
+
+    assert(is_binary_dataset(TRUNCATED_FILE));
+    assert(load_binary_dataset(TRUNCATED_FILE, &dataset) == NULL);
+    assert(dataset.mapping == NULL);
+
+    // 3. Values that are neither float64 nor float32
+    assert(write_binary_dataset(mapping, TEST_FILE, 2) != SUCCESSFULL_EXECUTION_CODE);
+
+    remove(TRUNCATED_FILE);
+    remove(TEST_FILE);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    INPUT_OUTPUT_MAPPING* mapping = create_test_mapping();
+    if (!mapping){
+        printf("Creating the test data was unsuccessfull in test_binary_dataset.\n");
+        return OTHER_ERROR;
+    }
+
+    test_round_trip(mapping, sizeof(double));
+    test_round_trip(mapping, sizeof(float));
+
+    DIMENSIONS_DATA = TEST_DIMENSIONS;
+    test_invalid_files(mapping);
+
+    printf("All tests for binary_dataset successfully executed.\n");
+
+    free_input_output_mapping(mapping);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
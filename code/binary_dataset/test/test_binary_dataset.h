@@ -0,0 +1,17 @@
+/*
+Header file of the file to test the binary dataset file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_BINARY_DATASET_H
+#define TEST_BINARY_DATASET_H
+
+#include "../binary_dataset.h"
+
+INPUT_OUTPUT_MAPPING* create_test_mapping(void);
+
+void test_round_trip(INPUT_OUTPUT_MAPPING*, size_t);
+void test_invalid_files(INPUT_OUTPUT_MAPPING*);
+
+int test_handler_func(void);
+
+#endif //TEST_BINARY_DATASET_H
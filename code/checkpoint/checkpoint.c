@@ -0,0 +1,380 @@
+/*
+This file is responsible for the binary checkpoint of the Neural Network (see CHECKPOINT_HEADER in structs.h).
+The checkpoint holds the topology (the connections of the linked lists), the parameters as raw doubles and
+optionally the state of the optimizer, so that no value is formatted when saving or parsed when loading:
+- save_checkpoint() gathers the linked lists into the blocks of the file, WRITE_CHUNK values per write
+- load_checkpoint() maps the file and rebuilds the linked lists straight from the blocks of the mapping
+
+The checkpoint is written into a temporary file that is renamed at the end, so that an interrupted save
+never destroys the previous checkpoint.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR or NULL if pointers are returned.*/
+
+#define _POSIX_C_SOURCE 200809L // For mmap, open and fstat
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "checkpoint.h"
+#include "../neurons/neurons.h"
+
+// Number of values gathered from the linked lists before they are written
+#define WRITE_CHUNK 4096
+
+// Rounds a number of bytes up to a multiple of CHECKPOINT_ALIGNMENT
+#define ALIGN_OFFSET(bytes) ((((bytes) + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT) * CHECKPOINT_ALIGNMENT)
+
+// Blocks of the checkpoint gathered from the linked lists (see write_block())
+#define BLOCK_COUNTS 0
+#define BLOCK_TARGETS 1
+#define BLOCK_BIASES 2
+#define BLOCK_WEIGHTS 3
+
+
+/*
+Returns 1 if the file starts with CHECKPOINT_MAGIC, else 0 (also if it can not be opened)*/
+int is_checkpoint(const char* filename){
+    FILE* file = fopen(filename, "rb");
+    if (!file){
+        return 0;
+    }
+
+    char magic[8];
+    int is_checkpoint_ = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0;
+
+    fclose(file);
+    return is_checkpoint_;
+}
+
+
+/*
+Writes zero bytes until the file reaches the offset.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int pad_to_offset(FILE* file, size_t offset){
+    static const char zeros[CHECKPOINT_ALIGNMENT] = {0};
+
+    long position = ftell(file);
+    if (position < 0 || (size_t) position > offset){
+        return FILE_ERROR;
+    }
+    size_t padding = offset - (size_t) position;
+    return fwrite(zeros, 1, padding, file) == padding ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+}
+
+
+/*
+Writes the gathered values once at least min_values of them are in the chunk.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static inline int flush_chunk(FILE* file, const uint64_t* chunk, size_t* used, size_t min_values){
+    if (*used < min_values || *used == 0){
+        return SUCCESSFULL_EXECUTION_CODE;
+    }
+    size_t written = fwrite(chunk, sizeof(uint64_t), *used, file);
+    int exit_code = (written == *used) ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+    *used = 0;
+    return exit_code;
+}
+
+
+/*
+Writes one block of 8 byte values gathered from the linked lists (BLOCK_COUNTS, BLOCK_TARGETS, BLOCK_BIASES or BLOCK_WEIGHTS).
+The doubles are copied bit for bit, so that the loaded parameters are exactly the saved ones.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int write_block(FILE* file, neuron** network_arr, int block){
+    uint64_t chunk[WRITE_CHUNK];
+    size_t used = 0;
+
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        neuron* neuron_ = network_arr[pos];
+
+        if (block == BLOCK_BIASES){
+            memcpy(&chunk[used++], &neuron_->bias, sizeof(double));
+        } else if (block == BLOCK_COUNTS){
+            uint64_t count_connections = 0;
+            for (node_linked_list_connection* connection = neuron_->next_layer; connection; connection = connection->next){
+                count_connections++;
+            }
+            chunk[used++] = count_connections;
+        } else{
+            for (node_linked_list_connection* connection = neuron_->next_layer; connection; connection = connection->next){
+                if (block == BLOCK_TARGETS){
+                    chunk[used++] = connection->data->pos;
+                } else{
+                    memcpy(&chunk[used++], &connection->weight, sizeof(double));
+                }
+                if (flush_chunk(file, chunk, &used, WRITE_CHUNK) != SUCCESSFULL_EXECUTION_CODE){
+                    return FILE_ERROR;
+                }
+            }
+        }
+
+        if (flush_chunk(file, chunk, &used, WRITE_CHUNK) != SUCCESSFULL_EXECUTION_CODE){
+            return FILE_ERROR;
+        }
+    }
+
+    // Write the rest of the chunk
+    return flush_chunk(file, chunk, &used, 1);
+}
+
+
+/*
+Function to save the Neural Network (topology and parameters) and the state of the optimizer in a checkpoint.
+The moments of the optimizer are written one after the other. optimizer may be NULL (no state is saved).
+Returns SUCCESSFULL_EXECUTION_CODE or an error code*/
+int save_checkpoint(neuron** network_arr, const char* filename, const OPTIMIZER* optimizer){
+
+    // 1. Calculate the layout of the file
+    size_t connections = 0;
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        for (node_linked_list_connection* connection = network_arr[pos]->next_layer; connection; connection = connection->next){
+            connections++;
+        }
+    }
+
+    // Moments of the optimizer saved in the checkpoint
+    const double* moments[2] = {optimizer ? optimizer->first_moment : NULL, optimizer ? optimizer->second_moment : NULL};
+    size_t values_per_moment = optimizer ? optimizer->num_values : 0;
+
+    CHECKPOINT_HEADER header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.dimensions_data = DIMENSIONS_DATA;
+    header.layers = NUMBER_LAYERS;
+    header.neurons = LENGTH_NETWORK;
+    header.connections = connections;
+    header.optimizer_type = optimizer ? (uint64_t) optimizer->type : 0;
+    header.optimizer_values = ((moments[0] != NULL) + (moments[1] != NULL)) * values_per_moment;
+    header.optimizer_step = optimizer ? optimizer->step : 0;
+    header.layers_offset = ALIGN_OFFSET(sizeof(CHECKPOINT_HEADER));
+    header.counts_offset = ALIGN_OFFSET(header.layers_offset + header.layers * sizeof(uint64_t));
+    header.targets_offset = ALIGN_OFFSET(header.counts_offset + header.neurons * sizeof(uint64_t));
+    header.biases_offset = ALIGN_OFFSET(header.targets_offset + header.connections * sizeof(uint64_t));
+    header.weights_offset = ALIGN_OFFSET(header.biases_offset + header.neurons * sizeof(double));
+    header.optimizer_offset = ALIGN_OFFSET(header.weights_offset + header.connections * sizeof(double));
+
+    uint64_t layer_sizes[NUMBER_LAYERS];
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        layer_sizes[layer] = NEURON_NUMBERS[layer];
+    }
+
+    // 2. Write everything into a temporary file, which replaces the checkpoint once it is complete
+    size_t length_filename = strlen(filename);
+    char* temporary_filename = malloc(length_filename + sizeof(".tmp"));
+    if (!temporary_filename){
+        perror("Memory allocation error when trying to save the checkpoint.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    memcpy(temporary_filename, filename, length_filename);
+    memcpy(temporary_filename + length_filename, ".tmp", sizeof(".tmp"));
+
+    FILE* file = fopen(temporary_filename, "wb");
+    if (!file){
+        printf("Could not open %s to write the checkpoint.\n", temporary_filename);
+        free(temporary_filename);
+        return FILE_ERROR;
+    }
+
+    int exit_code = fwrite(&header, sizeof(header), 1, file) == 1 ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.layers_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = fwrite(layer_sizes, sizeof(uint64_t), NUMBER_LAYERS, file) == NUMBER_LAYERS ? SUCCESSFULL_EXECUTION_CODE : FILE_ERROR;
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.counts_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = write_block(file, network_arr, BLOCK_COUNTS);
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.targets_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = write_block(file, network_arr, BLOCK_TARGETS);
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.biases_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = write_block(file, network_arr, BLOCK_BIASES);
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.weights_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        exit_code = write_block(file, network_arr, BLOCK_WEIGHTS);
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && (exit_code = pad_to_offset(file, header.optimizer_offset)) == SUCCESSFULL_EXECUTION_CODE){
+        for (size_t moment = 0; moment < 2 && exit_code == SUCCESSFULL_EXECUTION_CODE; moment++){
+            if (moments[moment] && fwrite(moments[moment], sizeof(double), values_per_moment, file) != values_per_moment){
+                exit_code = FILE_ERROR;
+            }
+        }
+    }
+
+    if (fclose(file) != 0){
+        exit_code = FILE_ERROR;
+    }
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE && rename(temporary_filename, filename) != 0){
+        exit_code = FILE_ERROR;
+    }
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when writing the checkpoint %s.\n", filename);
+        remove(temporary_filename);
+    }
+
+    free(temporary_filename);
+    return exit_code;
+}
+
+
+/*
+Checks that a block of count values of 8 bytes at offset lies inside a file of file_size bytes.
+Returns 1 if it does, else 0*/
+static int valid_block(uint64_t offset, uint64_t count, size_t file_size){
+    return offset % CHECKPOINT_ALIGNMENT == 0 && offset >= sizeof(CHECKPOINT_HEADER) && offset <= file_size &&
+           count <= (file_size - offset) / sizeof(uint64_t);
+}
+
+
+/*
+Checks that the header describes a checkpoint that fits into a file of file_size bytes.
+Returns 1 if it is valid, else 0 (and prints the reason)*/
+static int valid_checkpoint_header(const CHECKPOINT_HEADER* header, size_t file_size, const char* filename){
+
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0 || header->version != CHECKPOINT_VERSION){
+        printf("%s is not a checkpoint of version %d.\n", filename, CHECKPOINT_VERSION);
+        return 0;
+    }
+    if (!valid_block(header->layers_offset, header->layers, file_size) ||
+        !valid_block(header->counts_offset, header->neurons, file_size) ||
+        !valid_block(header->targets_offset, header->connections, file_size) ||
+        !valid_block(header->biases_offset, header->neurons, file_size) ||
+        !valid_block(header->weights_offset, header->connections, file_size) ||
+        !valid_block(header->optimizer_offset, header->optimizer_values, file_size)){
+        printf("%s is shorter than its header claims.\n", filename);
+        return 0;
+    }
+    return 1;
+}
+
+
+/*
+Function to load a checkpoint into a new Neural Network (the counterpart of seed_neural_network() and connect_neurons()).
+The file is mapped read-only into memory and the linked lists are rebuilt straight from its blocks.
+The mapping is kept in the CHECKPOINT for the optimizer state and has to be released with close_checkpoint().
+Returns NULL if it fails (the CHECKPOINT does not need to be closed in this case)*/
+neuron** load_checkpoint(const char* filename, CHECKPOINT* checkpoint){
+
+    checkpoint->mapping = NULL;
+    checkpoint->size_mapping = 0;
+    checkpoint->header = NULL;
+    checkpoint->optimizer_state = NULL;
+
+    // 1. Map the file
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0){
+        printf("Could not open the checkpoint %s.\n", filename);
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t) file_stat.st_size < sizeof(CHECKPOINT_HEADER)){
+        printf("The checkpoint %s is too short to hold a header.\n", filename);
+        close(fd);
+        return NULL;
+    }
+    size_t file_size = (size_t) file_stat.st_size;
+
+    void* file_mapping = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after closing the file
+    if (file_mapping == MAP_FAILED){
+        printf("Could not map the checkpoint %s into memory.\n", filename);
+        return NULL;
+    }
+    checkpoint->mapping = file_mapping;
+    checkpoint->size_mapping = file_size;
+
+    const CHECKPOINT_HEADER* header = (const CHECKPOINT_HEADER*) file_mapping;
+    if (!valid_checkpoint_header(header, file_size, filename)){
+        close_checkpoint(checkpoint);
+        return NULL;
+    }
+    checkpoint->header = header;
+
+    // The blocks are read once from the front to the back
+    posix_madvise(file_mapping, file_size, POSIX_MADV_SEQUENTIAL);
+
+    const char* base = (const char*) file_mapping;
+    const uint64_t* layer_sizes = (const uint64_t*) (base + header->layers_offset);
+    const uint64_t* counts = (const uint64_t*) (base + header->counts_offset);
+    const uint64_t* targets = (const uint64_t*) (base + header->targets_offset);
+    const double* biases = (const double*) (base + header->biases_offset);
+    const double* weights = (const double*) (base + header->weights_offset);
+
+    // 2. The architecture has to match the one of the configurations
+    int matches = (header->layers == NUMBER_LAYERS);
+    for (size_t layer = 0; layer < NUMBER_LAYERS && matches; layer++){
+        matches = (layer_sizes[layer] == NEURON_NUMBERS[layer]);
+    }
+    if (!matches){
+        printf("The architecture of the checkpoint %s does not match the Neural Network.\n", filename);
+        close_checkpoint(checkpoint);
+        return NULL;
+    }
+
+    // 3. Seed the neurons and rebuild the connections
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        close_checkpoint(checkpoint);
+        return NULL;
+    }
+    if (header->neurons != LENGTH_NETWORK){
+        printf("The checkpoint %s holds %zu neurons instead of %zu.\n", filename, (size_t) header->neurons, LENGTH_NETWORK);
+        goto error;
+    }
+
+    size_t first_connection = 0; // Position of the first connection of the neuron in the blocks of targets and weights
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        neuron* neuron_ = network_arr[pos];
+        neuron_->bias = biases[pos];
+
+        if (counts[pos] > header->connections - first_connection){
+            printf("The checkpoint %s holds more connections than its header claims.\n", filename);
+            goto error;
+        }
+
+        // add_connection() puts the new connection in front, so the connections are added from the last to the first
+        for (size_t connection_ptr = first_connection + counts[pos]; connection_ptr-- > first_connection;){
+            if (targets[connection_ptr] >= LENGTH_NETWORK){
+                printf("Connection %zu of the checkpoint %s leads to a neuron that does not exist.\n", connection_ptr, filename);
+                goto error;
+            }
+            if (add_connection(network_arr, pos, targets[connection_ptr]) != SUCCESSFULL_EXECUTION_CODE){
+                goto error;
+            }
+            neuron_->next_layer->weight = weights[connection_ptr];
+        }
+        first_connection += counts[pos];
+    }
+    if (first_connection != header->connections){
+        printf("The checkpoint %s holds fewer connections than its header claims.\n", filename);
+        goto error;
+    }
+
+    checkpoint->optimizer_state = header->optimizer_values ? (const double*) (base + header->optimizer_offset) : NULL;
+    return network_arr;
+
+error:
+    free_network(network_arr);
+    close_checkpoint(checkpoint);
+    return NULL;
+}
+
+
+/*
+Function to unmap a checkpoint (the optimizer state may not be used afterwards).
+Works for checkpoints that failed to load.*/
+void close_checkpoint(CHECKPOINT* checkpoint){
+    if (checkpoint->mapping){
+        munmap(checkpoint->mapping, checkpoint->size_mapping);
+    }
+    checkpoint->mapping = NULL;
+    checkpoint->header = NULL;
+    checkpoint->optimizer_state = NULL;
+}
@@ -0,0 +1,26 @@
+/*
+Header file of the checkpoint file.
+Includes process_input.h to use DIMENSIONS_DATA (the checkpoint stores the dimensions of the data)*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "../process_input/process_input.h"
+
+// First 8 bytes of every checkpoint
+#define CHECKPOINT_MAGIC "NNCKPT01"
+
+// Version of the layout of the file (increment on every change of the CHECKPOINT_HEADER)
+#define CHECKPOINT_VERSION 2
+
+// Alignment of the blocks in the file (and therefore in the mapping) in bytes
+#define CHECKPOINT_ALIGNMENT 64
+
+int is_checkpoint(const char*);
+
+int save_checkpoint(neuron**, const char*, const OPTIMIZER*);
+
+neuron** load_checkpoint(const char*, CHECKPOINT*);
+void close_checkpoint(CHECKPOINT*);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,180 @@
+/*
+Test file for the binary checkpoint.
+May not be included in any other files. Its own purpose is for testing.
+
+The test files are written into the current directory and removed again.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_checkpoint.h"
+
+// File written by the tests
+#define TEST_CHECKPOINT "test_checkpoint.ckpt"
+
+
+/*
+Tests that the topology, the parameters (bit for bit) and the optimizer state (moments, type and step) are restored.
+Neuron 0 gets a second connection, so that the order of the linked list is tested as well.*/
+void test_checkpoint_round_trip(neuron** network_arr){
+
+    DIMENSIONS_DATA = 3;
+    set_bias(network_arr, 0, 0.1);
+    set_bias(network_arr, 1, -1.0 / 3);
+    network_arr[0]->next_layer->weight = 2.5e-7;
+    assert(add_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    network_arr[0]->next_layer->weight = -7;
+
+    const double first_moment[3] = {1, -0.5, 1e-300};
+    const double second_moment[3] = {2, 0, 4e300};
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_ADAM, 3);
+    assert(optimizer != NULL);
+    memcpy(optimizer->first_moment, first_moment, sizeof(first_moment));
+    memcpy(optimizer->second_moment, second_moment, sizeof(second_moment));
+    optimizer->step = 42;
+    assert(save_checkpoint(network_arr, TEST_CHECKPOINT, optimizer) == SUCCESSFULL_EXECUTION_CODE);
+    assert(is_checkpoint(TEST_CHECKPOINT));
+
+    CHECKPOINT checkpoint;
+    neuron** loaded = load_checkpoint(TEST_CHECKPOINT, &checkpoint);
+    assert(loaded != NULL);
+
+    assert(checkpoint.header->dimensions_data == 3);
+    assert(checkpoint.header->optimizer_type == OPTIMIZER_ADAM);
+    assert(checkpoint.header->optimizer_step == 42);
+    assert(checkpoint.header->optimizer_values == 6);
+    assert(memcmp(checkpoint.optimizer_state, first_moment, sizeof(first_moment)) == 0);
+    assert(memcmp(checkpoint.optimizer_state + 3, second_moment, sizeof(second_moment)) == 0);
+    assert((size_t) checkpoint.optimizer_state % CHECKPOINT_ALIGNMENT == 0);
+
+    // The state is only restored into an optimizer of the same type and size
+    free_optimizer(optimizer);
+    optimizer = create_optimizer(OPTIMIZER_MOMENTUM, 3);
+    assert(optimizer != NULL);
+    assert(restore_optimizer(optimizer, &checkpoint) != SUCCESSFULL_EXECUTION_CODE);
+    assert(optimizer->step == 0 && optimizer->first_moment[0] == 0);
+    free_optimizer(optimizer);
+
+    optimizer = create_optimizer(OPTIMIZER_ADAM, 3);
+    assert(optimizer != NULL);
+    assert(restore_optimizer(optimizer, &checkpoint) == SUCCESSFULL_EXECUTION_CODE);
+    assert(optimizer->step == 42);
+    assert(memcmp(optimizer->first_moment, first_moment, sizeof(first_moment)) == 0);
+    assert(memcmp(optimizer->second_moment, second_moment, sizeof(second_moment)) == 0);
+    free_optimizer(optimizer);
+
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        assert(loaded[pos]->bias == network_arr[pos]->bias);
+
+        node_linked_list_connection* connection = network_arr[pos]->next_layer;
+        node_linked_list_connection* loaded_connection = loaded[pos]->next_layer;
+        while (connection){
+            assert(loaded_connection != NULL);
+            assert(loaded_connection->data == loaded[connection->data->pos]);
+            assert(loaded_connection->weight == connection->weight);
+            connection = connection->next;
+            loaded_connection = loaded_connection->next;
+        }
+        assert(loaded_connection == NULL);
+    }
+
+    close_checkpoint(&checkpoint);
+    free_network(loaded);
+    assert(del_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+
+    // A checkpoint without optimizer state
+    assert(save_checkpoint(network_arr, TEST_CHECKPOINT, NULL) == SUCCESSFULL_EXECUTION_CODE);
+    loaded = load_checkpoint(TEST_CHECKPOINT, &checkpoint);
+    assert(loaded != NULL);
+    assert(checkpoint.optimizer_state == NULL);
+    close_checkpoint(&checkpoint);
+    free_network(loaded);
+
+    remove(TEST_CHECKPOINT);
+    return;
+}
+
+
+/*
+Tests that truncated or foreign files and checkpoints of other architectures are rejected*/
+void test_invalid_checkpoint(neuron** network_arr){
+
+    CHECKPOINT checkpoint;
+    assert(save_checkpoint(network_arr, TEST_CHECKPOINT, NULL) == SUCCESSFULL_EXECUTION_CODE);
+
+    FILE* file = fopen(TEST_CHECKPOINT, "rb");
+    assert(file != NULL);
+    char content[4096];
+    size_t size = fread(content, 1, sizeof(content), file);
+    fclose(file);
+    CHECKPOINT_HEADER* header = (CHECKPOINT_HEADER*) content;
+
+    // 1. Truncated file
+    file = fopen(TEST_CHECKPOINT, "wb");
+    fwrite(content, 1, size - sizeof(double), file);
+    fclose(file);
+    assert(load_checkpoint(TEST_CHECKPOINT, &checkpoint) == NULL);
+
+    // 2. Other architecture
+    uint64_t* layer_sizes = (uint64_t*) (content + header->layers_offset);
+    layer_sizes[0]++;
+    file = fopen(TEST_CHECKPOINT, "wb");
+    fwrite(content, 1, size, file);
+    fclose(file);
+    assert(load_checkpoint(TEST_CHECKPOINT, &checkpoint) == NULL);
+    layer_sizes[0]--;
+
+    // 3. Connection to a neuron that does not exist
+    uint64_t* targets = (uint64_t*) (content + header->targets_offset);
+    targets[0] = LENGTH_NETWORK;
+    file = fopen(TEST_CHECKPOINT, "wb");
+    fwrite(content, 1, size, file);
+    fclose(file);
+    assert(load_checkpoint(TEST_CHECKPOINT, &checkpoint) == NULL);
+
+    // 4. Not a checkpoint
+    file = fopen(TEST_CHECKPOINT, "wb");
+    fputs("1,2,3\n", file);
+    fclose(file);
+    assert(!is_checkpoint(TEST_CHECKPOINT));
+    assert(load_checkpoint(TEST_CHECKPOINT, &checkpoint) == NULL);
+
+    remove(TEST_CHECKPOINT);
+    assert(load_checkpoint(TEST_CHECKPOINT, &checkpoint) == NULL);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Create a Simple 2 layer Neural Network
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_checkpoint.\n");
+        return OTHER_ERROR;
+    }
+
+    // Connect the neurons (the network array will be freed by the function in case of an error)
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    test_checkpoint_round_trip(network_arr);
+    test_invalid_checkpoint(network_arr);
+
+    printf("All tests for checkpoint successfully executed.\n");
+
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,17 @@
+/*
+Header file of the file to test the checkpoint file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_CHECKPOINT_H
+#define TEST_CHECKPOINT_H
+
+#include "../checkpoint.h"
+#include "../../neurons/neurons.h"
+#include "../../gradient_descent/gradient_descent.h"
+
+void test_checkpoint_round_trip(neuron**);
+void test_invalid_checkpoint(neuron**);
+
+int test_handler_func(void);
+
+#endif //TEST_CHECKPOINT_H
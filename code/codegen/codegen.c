@@ -0,0 +1,284 @@
+/*
+This file generates a standalone C file that scores data points with a trained (frozen) Neural Network.
+The generated scorer is specialised on the topology of the model:
+- the sizes of the layers are compile-time constants, so that every loop has a fixed trip count
+- the biases and weights are static const arrays aligned to SCORER_ALIGNMENT bytes (one dense matrix per layer)
+- the activation function of the configurations is inlined (the outputs get the softmax with SOFTMAX_OUTPUT)
+so that the compiler can unroll and vectorise the whole forward pass, without the linked lists or the library.
+
+The generated file only needs the C standard library (and libm for sigmoid, tanh and the softmax). It defines
+    void nn_score(const double input[NN_INPUTS], double output[NN_OUTPUTS]);
+and, if compiled with -DNN_SCORER_MAIN, a main() that scores the comma separated data points read from stdin.
+
+Only connections between adjacent layers can be generated, missing connections get a weight of 0.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR or NULL if pointers are returned.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "codegen.h"
+
+// Turns the activation function of the configurations into the string of its call
+#define STRINGIFY(x) #x
+#define STRINGIFY_EXPANDED(x) STRINGIFY(x)
+
+// Number of values written per line of the arrays of the generated file
+#define VALUES_PER_LINE 4
+
+/*
+Activation functions that may be used in ACTIVATION_FUNCTION (same definitions as in activation_functions.c).
+Static inline, so that the unused ones do not end up in the scorer.*/
+static const char ACTIVATION_DEFINITIONS[] =
+    "static inline double sigmoid(double number){\n"
+    "    return 1 / (1 + exp(-number));\n"
+    "}\n"
+    "\n"
+    "static inline double tanh_(double number){\n"
+    "    return tanh(number);\n"
+    "}\n"
+    "\n"
+    "static inline double relu(double number){\n"
+    "    return number > 0 ? number : 0;\n"
+    "}\n"
+    "\n"
+    "static inline double leaky_relu(double number, double factor){\n"
+    "    return number > 0 ? number : factor * number;\n"
+    "}\n";
+
+// Command line scorer of the generated file (reads NN_INPUTS values per line, writes NN_OUTPUTS values per line)
+static const char SCORER_MAIN[] =
+    "#ifdef NN_SCORER_MAIN\n"
+    "int main(void){\n"
+    "    double input[NN_INPUTS];\n"
+    "    double output[NN_OUTPUTS];\n"
+    "\n"
+    "    for (;;){\n"
+    "        for (size_t d = 0; d < NN_INPUTS; d++){\n"
+    "            if (scanf(d == 0 ? \" %lf\" : \" ,%lf\", &input[d]) != 1){\n"
+    "                return (d == 0 && feof(stdin)) ? 0 : 1;\n"
+    "            }\n"
+    "        }\n"
+    "\n"
+    "        nn_score(input, output);\n"
+    "\n"
+    "        for (size_t k = 0; k < NN_OUTPUTS; k++){\n"
+    "            printf(k == 0 ? \"%.17g\" : \",%.17g\", output[k]);\n"
+    "        }\n"
+    "        printf(\"\\n\");\n"
+    "    }\n"
+    "}\n"
+    "#endif // NN_SCORER_MAIN\n";
+
+
+/*
+Writes the values as the initializer of an array (VALUES_PER_LINE values per line, indented by indent spaces).
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR if a value is not finite (it has no C literal)*/
+static int write_values(FILE* file, const double* values, size_t size, int indent){
+    for (size_t i = 0; i < size; i++){
+        if (!isfinite(values[i])){
+            printf("The model holds a parameter that is not finite (%g), no scorer can be generated.\n", values[i]);
+            return OTHER_ERROR;
+        }
+
+        if (i % VALUES_PER_LINE == 0){
+            fprintf(file, "%*s", indent, "");
+        }
+        fprintf(file, "%.17g%s", values[i], (i + 1 == size) ? "\n" : ((i + 1) % VALUES_PER_LINE == 0) ? ",\n" : ", ");
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Writes the biases and the weights to the next layer of the layer starting at first_pos.
+Row i of nn_weights_<layer> holds the weights of neuron i of the layer to all neurons of the next layer.
+Returns SUCCESSFULL_EXECUTION_CODE, OTHER_ERROR or MEMORY_ALLOCATION_ERROR*/
+static int write_layer(FILE* file, neuron** network_arr, size_t layer, size_t first_pos){
+    size_t size = NEURON_NUMBERS[layer];
+
+    // Biases of the layer
+    double* biases = malloc(size * sizeof(double));
+    if (!biases){
+        printf("Memory allocation for the biases of layer %zu failed in the code generation.\n", layer);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    for (size_t i = 0; i < size; i++){
+        biases[i] = network_arr[first_pos + i]->bias;
+    }
+
+    fprintf(file, "static const _Alignas(%d) double nn_biases_%zu[NN_LAYER_%zu] = {\n", SCORER_ALIGNMENT, layer, layer);
+    int exit_code = write_values(file, biases, size, 4);
+    fprintf(file, "};\n\n");
+    free(biases);
+
+    // The output layer has no weights
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE || layer == NUMBER_LAYERS - 1){
+        return exit_code;
+    }
+
+    size_t size_next = NEURON_NUMBERS[layer + 1];
+    size_t first_pos_next = first_pos + size;
+
+    double* row = malloc(size_next * sizeof(double));
+    if (!row){
+        printf("Memory allocation for the weights of layer %zu failed in the code generation.\n", layer);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    fprintf(file, "static const _Alignas(%d) double nn_weights_%zu[NN_LAYER_%zu][NN_LAYER_%zu] = {\n", SCORER_ALIGNMENT, layer, layer, layer + 1);
+    for (size_t i = 0; i < size && exit_code == SUCCESSFULL_EXECUTION_CODE; i++){
+
+        // Scatter the connections of the linked list into the dense row
+        for (size_t j = 0; j < size_next; j++){
+            row[j] = 0;
+        }
+        node_linked_list_connection* connection = network_arr[first_pos + i]->next_layer;
+        while (connection){
+            size_t target = connection->data->pos;
+            if (target < first_pos_next || target >= first_pos_next + size_next){
+                printf("Neuron %zu is connected to neuron %zu which is not in the next layer, no scorer can be generated.\n", first_pos + i, target);
+                exit_code = OTHER_ERROR;
+                break;
+            }
+            row[target - first_pos_next] += connection->weight;
+            connection = connection->next;
+        }
+
+        if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+            fprintf(file, "    {\n");
+            exit_code = write_values(file, row, size_next, 8);
+            fprintf(file, "    },\n");
+        }
+    }
+    fprintf(file, "};\n\n");
+
+    free(row);
+    return exit_code;
+}
+
+
+/*
+Writes the forward pass nn_score() of the generated file*/
+static void write_score_function(FILE* file){
+    fprintf(file, "void nn_score(const double input[NN_INPUTS], double output[NN_OUTPUTS]){\n");
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        fprintf(file, "    _Alignas(%d) double layer_%zu[NN_LAYER_%zu];\n", SCORER_ALIGNMENT, layer, layer);
+    }
+
+    // Every layer starts from its biases
+    fprintf(file, "\n");
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        fprintf(file, "    for (size_t i = 0; i < NN_LAYER_%zu; i++){\n", layer);
+        fprintf(file, "        layer_%zu[i] = nn_biases_%zu[i];\n", layer, layer);
+        fprintf(file, "    }\n");
+    }
+
+    // Same distribution of the inputs as in the training (more dimensions than input neurons are added up)
+    fprintf(file, "\n");
+    fprintf(file, "    for (size_t d = 0; d < NN_INPUTS; d++){\n");
+    fprintf(file, "        layer_0[d %% NN_LAYER_0] += input[d];\n");
+    fprintf(file, "    }\n");
+
+    for (size_t layer = 0; layer + 1 < NUMBER_LAYERS; layer++){
+        fprintf(file, "\n");
+        fprintf(file, "    for (size_t i = 0; i < NN_LAYER_%zu; i++){\n", layer);
+        fprintf(file, "        const double activated = NN_ACTIVATION(layer_%zu[i]);\n", layer);
+        fprintf(file, "        for (size_t j = 0; j < NN_LAYER_%zu; j++){\n", layer + 1);
+        fprintf(file, "            layer_%zu[j] += activated * nn_weights_%zu[i][j];\n", layer + 1, layer);
+        fprintf(file, "        }\n");
+        fprintf(file, "    }\n");
+    }
+
+    fprintf(file, "\n");
+    if (SOFTMAX_OUTPUT){
+        // Same softmax of the outputs as in the training (the largest output is subtracted, so that exp never overflows)
+        fprintf(file, "    double largest = layer_%zu[0];\n", (size_t) NUMBER_LAYERS - 1);
+        fprintf(file, "    for (size_t k = 1; k < NN_OUTPUTS; k++){\n");
+        fprintf(file, "        largest = (layer_%zu[k] > largest) ? layer_%zu[k] : largest;\n", (size_t) NUMBER_LAYERS - 1, (size_t) NUMBER_LAYERS - 1);
+        fprintf(file, "    }\n");
+        fprintf(file, "    double sum = 0;\n");
+        fprintf(file, "    for (size_t k = 0; k < NN_OUTPUTS; k++){\n");
+        fprintf(file, "        output[k] = exp(layer_%zu[k] - largest);\n", (size_t) NUMBER_LAYERS - 1);
+        fprintf(file, "        sum += output[k];\n");
+        fprintf(file, "    }\n");
+        fprintf(file, "    for (size_t k = 0; k < NN_OUTPUTS; k++){\n");
+        fprintf(file, "        output[k] /= sum;\n");
+        fprintf(file, "    }\n");
+    }
+    else{
+        fprintf(file, "    for (size_t k = 0; k < NN_OUTPUTS; k++){\n");
+        fprintf(file, "        output[k] = NN_ACTIVATION(layer_%zu[k]);\n", (size_t) NUMBER_LAYERS - 1);
+        fprintf(file, "    }\n");
+    }
+    fprintf(file, "}\n\n");
+    return;
+}
+
+
+/*
+Generates the standalone scorer of the trained Neural Network into filename.
+dimensions_data is the number of inputs of a data point of the model.
+Returns SUCCESSFULL_EXECUTION_CODE, FILE_ERROR, OTHER_ERROR or MEMORY_ALLOCATION_ERROR*/
+int generate_scorer(neuron** network_arr, size_t dimensions_data, const char* filename){
+
+    if (NEURON_NUMBERS[NUMBER_LAYERS - 1] != NUM_OUTPUT){
+        printf("The output layer has %zu neurons but the model has %d outputs, no scorer can be generated.\n", NEURON_NUMBERS[NUMBER_LAYERS - 1], NUM_OUTPUT);
+        return OTHER_ERROR;
+    }
+
+    FILE* file = fopen(filename, "w");
+    if (!file){
+        printf("Could not open %s to write the scorer.\n", filename);
+        return FILE_ERROR;
+    }
+
+    // 1. Header, sizes and activation
+    fprintf(file, "/*\nScorer of a trained Neural Network, generated by neural_network --codegen. Regenerate it instead of editing it.\n");
+    fprintf(file, "Layers:");
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        fprintf(file, " %zu", NEURON_NUMBERS[layer]);
+    }
+    fprintf(file, " (%zu inputs)\n", dimensions_data);
+    fprintf(file, "Build with -lm, add -DNN_SCORER_MAIN for a command line scorer of the comma separated data points of stdin.*/\n\n");
+
+    fprintf(file, "#include <stddef.h>\n#include <math.h>\n#ifdef NN_SCORER_MAIN\n#include <stdio.h>\n#endif\n\n");
+
+    fprintf(file, "#define NN_INPUTS %zu\n", dimensions_data);
+    fprintf(file, "#define NN_OUTPUTS %d\n", NUM_OUTPUT);
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        fprintf(file, "#define NN_LAYER_%zu %zu\n", layer, NEURON_NUMBERS[layer]);
+    }
+    fprintf(file, "\n");
+
+    fputs(ACTIVATION_DEFINITIONS, file);
+    fprintf(file, "\n#define NN_ACTIVATION(value) %s\n\n", STRINGIFY_EXPANDED(ACTIVATION_FUNCTION(value)));
+
+    // 2. Parameters
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+    size_t first_pos = 0;
+    for (size_t layer = 0; layer < NUMBER_LAYERS && exit_code == SUCCESSFULL_EXECUTION_CODE; layer++){
+        exit_code = write_layer(file, network_arr, layer, first_pos);
+        first_pos += NEURON_NUMBERS[layer];
+    }
+
+    // 3. Forward pass and command line scorer
+    if (exit_code == SUCCESSFULL_EXECUTION_CODE){
+        write_score_function(file);
+        fputs(SCORER_MAIN, file);
+    }
+
+    if (ferror(file) && exit_code == SUCCESSFULL_EXECUTION_CODE){
+        printf("Writing the scorer to %s failed.\n", filename);
+        exit_code = FILE_ERROR;
+    }
+    fclose(file);
+
+    // Do not leave a broken scorer behind
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        remove(filename);
+    }
+    return exit_code;
+}
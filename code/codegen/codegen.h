@@ -0,0 +1,15 @@
+/*
+Header file of the code generation file.
+Includes structs.h to use the neurons of the Neural Network*/
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include "../structs/structs.h"
+
+// Alignment of the arrays of weights and biases in the generated file in bytes
+#define SCORER_ALIGNMENT 64
+
+int generate_scorer(neuron**, size_t, const char*);
+
+#endif // CODEGEN_H
@@ -0,0 +1,108 @@
+/*
+Test file for the code generation.
+May not be included in any other files. Its own purpose is for testing.
+
+The generated scorer is compiled with the C compiler of the system (cc) and run on a few data points.
+The test files are written into the current directory and removed again.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_codegen.h"
+
+// Files written by the tests
+#define TEST_SCORER "test_codegen_scorer.c"
+#define TEST_BINARY "./test_codegen_scorer"
+#define TEST_INPUT "test_codegen_input.csv"
+#define TEST_OUTPUT "test_codegen_output.csv"
+
+// Number of data points scored by the test
+#define TEST_POINTS 3
+
+
+/*
+Tests that the generated scorer compiles standalone without warnings and matches the network.
+With the test configurations (relu, layers 1 -> 1) and 2 dimensions: output = relu(b1 + w * relu(b0 + x0 + x1))*/
+void test_generated_scorer(neuron** network_arr){
+
+    set_bias(network_arr, 0, 0.5);
+    set_bias(network_arr, 1, -0.25);
+    network_arr[0]->next_layer->weight = 1.5;
+
+    assert(generate_scorer(network_arr, 2, TEST_SCORER) == SUCCESSFULL_EXECUTION_CODE);
+    assert(system("cc -std=c11 -Wall -Wextra -Werror -O2 -DNN_SCORER_MAIN " TEST_SCORER " -o " TEST_BINARY " -lm") == 0);
+
+    const double inputs[TEST_POINTS][2] = {{1, 2}, {-3, 0.5}, {0.125, -0.5}};
+    FILE* file = fopen(TEST_INPUT, "w");
+    assert(file != NULL);
+    for (size_t i = 0; i < TEST_POINTS; i++){
+        fprintf(file, "%g,%g\n", inputs[i][0], inputs[i][1]);
+    }
+    fclose(file);
+
+    assert(system(TEST_BINARY " < " TEST_INPUT " > " TEST_OUTPUT) == 0);
+
+    file = fopen(TEST_OUTPUT, "r");
+    assert(file != NULL);
+    for (size_t i = 0; i < TEST_POINTS; i++){
+        double output;
+        assert(fscanf(file, "%lf", &output) == 1);
+        double hidden = relu(0.5 + inputs[i][0] + inputs[i][1]);
+        COMPARE(output, relu(-0.25 + 1.5 * hidden));
+    }
+    fclose(file);
+
+    remove(TEST_SCORER);
+    remove(TEST_BINARY);
+    remove(TEST_INPUT);
+    remove(TEST_OUTPUT);
+    return;
+}
+
+
+/*
+Tests that parameters without a C literal are rejected and no scorer is left behind*/
+void test_invalid_scorer(neuron** network_arr){
+
+    set_bias(network_arr, 1, NAN);
+    assert(generate_scorer(network_arr, 2, TEST_SCORER) != SUCCESSFULL_EXECUTION_CODE);
+    assert(fopen(TEST_SCORER, "r") == NULL);
+    set_bias(network_arr, 1, 0);
+
+    assert(generate_scorer(network_arr, 2, "missing_directory/" TEST_SCORER) == FILE_ERROR);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Create a Simple 2 layer Neural Network
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_codegen.\n");
+        return OTHER_ERROR;
+    }
+
+    // Connect the neurons (the network array will be freed by the function in case of an error)
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    test_generated_scorer(network_arr);
+    test_invalid_scorer(network_arr);
+
+    printf("All tests for codegen successfully executed.\n");
+
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
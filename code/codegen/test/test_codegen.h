@@ -0,0 +1,16 @@
+/*
+Header file of the file to test the code generation file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_CODEGEN_H
+#define TEST_CODEGEN_H
+
+#include "../codegen.h"
+#include "../../neurons/neurons.h"
+
+void test_generated_scorer(neuron**);
+void test_invalid_scorer(neuron**);
+
+int test_handler_func(void);
+
+#endif //TEST_CODEGEN_H
@@ -15,7 +15,7 @@ Is prohibited from using any other header files.
 // Include configurations for access to constants
 #include "../../configurations/config_manager.h"
 
-// Include structs for access to SUM_COST
+// Include structs for access to the THREAD_ARGS
 #include "../structs/structs.h"
 
 
@@ -55,31 +55,20 @@ double absolute_error_der(double act, double pred){
 
 
 
+// The predictions of the cross entropy are clamped to [CROSS_ENTROPY_EPSILON, 1 - CROSS_ENTROPY_EPSILON], so that the log stays finite
+#define CROSS_ENTROPY_EPSILON 1e-12
+
 double cross_entropy_cost(double act, double pred){
-    // Cross Entropy Cost
-    // Used for classification
-    // As a result, act can only take the value 0 or 1
-     if (act == 0){
-        return -log(1 - pred);
-     }
-     if (act == 1){
-        return -log(pred);
-     }
-     // Else, nor 0 or 1 have been entered --> error condition
-     perror("A value different than 0 or 1 was passed to the cross entropy cost designed for classification.\n");
-     exit(OTHER_ERROR);
+    // Binary Cross Entropy Cost
+    // Used for classification, act is the probability of the class (0 or 1, soft labels in between are allowed)
+    // For several classes in one network, use the softmax output layer instead (SOFTMAX_OUTPUT, see softmax_cross_entropy_arr())
+    double clamped = fmin(fmax(pred, CROSS_ENTROPY_EPSILON), 1 - CROSS_ENTROPY_EPSILON);
+    return -(act * log(clamped) + (1 - act) * log(1 - clamped));
 }
 
 double cross_entropy_cost_der(double act, double pred){
-         if (act == 0){
-        return -1/(1-pred);
-     }
-     if (act == 1){
-        return -1/pred;
-     }
-     // Else, nor 0 or 1 have been entered --> error condition
-     perror("A value different than 0 or 1 was passed to the cross-entropy cost derivative function designed for classification.\n");
-     exit(OTHER_ERROR);
+    double clamped = fmin(fmax(pred, CROSS_ENTROPY_EPSILON), 1 - CROSS_ENTROPY_EPSILON);
+    return -act / clamped + (1 - act) / (1 - clamped);
 }
 
 
@@ -108,11 +97,11 @@ double kl_divergence_der(double act, double pred){
 
 
 /*
-Function to calculate the average cost of the neural network*/
-double calc_average_cost(void){
+Function to calculate the average cost of the neural network from the costs of the threads*/
+double calc_average_cost(THREAD_ARGS* thread_args_arr){
     double average_cost_ = 0;
     for(size_t i = 0; i < NUM_THREADS; i++){
-        average_cost_ += SUM_COST[i];
+        average_cost_ += thread_args_arr[i].cost;
     }
     return average_cost_ / SIZE_TRAIN;
 }
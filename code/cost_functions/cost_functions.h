@@ -41,6 +41,9 @@ double kl_divergence(double, double);
 double kl_divergence_der(double, double);
 
 
-double calc_average_cost(void);
+// Forward definition of the args of the threads (holding their costs)
+struct THREAD_ARGS;
+
+double calc_average_cost(struct THREAD_ARGS*);
 
 #endif // COST_FUNCTIONS_H
@@ -0,0 +1,408 @@
+/*
+This file is responsible for training on datasets that do not fit into the memory.
+Instead of loading the whole file, a DATA_STREAM holds two windows of STREAM_WINDOW_ROWS data points:
+- a loader thread reads the next window from the disk (CSV or binary dataset)
+- at the same time the worker threads train on the previous window
+Once the workers are done with a window, it is released to the loader, which fills it with the window after the next one.
+At the end of the file the loader marks the window as the last one of the pass and starts at the beginning again,
+so the first window of the next generation is already in memory when the gradient descent is finished.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR or NULL if pointers are returned.*/
+
+#define _POSIX_C_SOURCE 200809L // For getline, fseeko and ftello
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "data_stream.h"
+#include "../binary_dataset/binary_dataset.h"
+
+
+/*
+Reads the next window of a binary dataset (float32 values are widened into the window).
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int load_binary_window(DATA_STREAM* stream, DATA_WINDOW* window){
+
+    const BINARY_DATASET_HEADER* header = &stream->header;
+    size_t rows = header->rows - stream->next_row;
+    if (rows > stream->window_rows){
+        rows = stream->window_rows;
+    }
+
+    // Read the inputs and then the outputs of the rows (both are contiguous blocks in the file)
+    double* blocks[2] = {window->inputs, window->outputs};
+    size_t widths[2] = {header->input_dims, header->outputs};
+    off_t offsets[2] = {(off_t) header->input_offset, (off_t) header->output_offset};
+
+    for (size_t block = 0; block < 2; block++){
+        size_t count = rows * widths[block];
+        off_t offset = offsets[block] + (off_t) (stream->next_row * widths[block] * header->scalar_size);
+
+        if (fseeko(stream->file, offset, SEEK_SET) != 0){
+            printf("Could not seek to data point %zu of the binary dataset.\n", stream->next_row + 1);
+            return FILE_ERROR;
+        }
+
+        if (header->scalar_size == sizeof(double)){
+            if (fread(blocks[block], sizeof(double), count, stream->file) != count){
+                printf("Could not read data points %zu to %zu of the binary dataset.\n", stream->next_row + 1, stream->next_row + rows);
+                return FILE_ERROR;
+            }
+            continue;
+        }
+
+        float* values = stream->staging;
+        if (fread(values, sizeof(float), count, stream->file) != count){
+            printf("Could not read data points %zu to %zu of the binary dataset.\n", stream->next_row + 1, stream->next_row + rows);
+            return FILE_ERROR;
+        }
+        for (size_t i = 0; i < count; i++){
+            blocks[block][i] = (double) values[i];
+        }
+    }
+
+    window->rows = rows;
+    stream->next_row += rows;
+
+    // Start the next pass at the first data point again
+    window->last = stream->next_row == header->rows;
+    if (window->last){
+        stream->next_row = 0;
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Reads the next window of a CSV line by line.
+If the file ends exactly at the end of a full window, the next window is an empty last window.
+Returns SUCCESSFULL_EXECUTION_CODE, FILE_ERROR or OTHER_ERROR if a line is invalid*/
+static int load_csv_window(DATA_STREAM* stream, DATA_WINDOW* window){
+
+    size_t rows = 0;
+    window->last = 0;
+
+    while (rows < stream->window_rows){
+        ssize_t length = getline(&stream->line, &stream->size_line, stream->file);
+
+        // End of the file: rewind for the next pass
+        if (length < 0){
+            if (ferror(stream->file)){
+                printf("Could not read data point %zu of the csv.\n", stream->next_row + 1);
+                return FILE_ERROR;
+            }
+            rewind(stream->file);
+            stream->next_row = 0;
+            window->last = 1;
+            break;
+        }
+
+        const char* line = stream->line;
+        const char* line_end = line + length;
+        if (line_end > line && line_end[-1] == '\n'){
+            line_end--;
+        }
+
+        // Empty lines are skipped (see parse_csv())
+        if (line == line_end || (line + 1 == line_end && *line == '\r')){
+            continue;
+        }
+
+        if (parse_csv_line(line, line_end, window->input[rows], DIMENSIONS_DATA, window->output[rows], NUM_OUTPUT) != SUCCESSFULL_EXECUTION_CODE){
+            printf("Could not parse data point %zu of the csv.\n", stream->next_row + 1);
+            return OTHER_ERROR;
+        }
+        rows++;
+        stream->next_row++;
+    }
+
+    window->rows = rows;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function run by the loader thread.
+Fills the windows alternately as soon as they are released by the trainer.
+After an error the window is marked as last and the loader waits for the shutdown.*/
+static void* load_windows(void* args){
+
+    DATA_STREAM* stream = (DATA_STREAM*) args;
+    size_t slot = 0;
+
+    while (1){
+        // 1. Wait until the trainer released the window
+        pthread_mutex_lock(&stream->lock);
+        while (stream->window_full[slot] && !stream->shutdown){
+            pthread_cond_wait(&stream->changed, &stream->lock);
+        }
+        int shutdown = stream->shutdown;
+        pthread_mutex_unlock(&stream->lock);
+
+        if (shutdown){
+            return NULL;
+        }
+
+        // 2. Fill it (without holding the lock, the trainer works on the other window)
+        DATA_WINDOW* window = &stream->windows[slot];
+        window->exit_code = stream->binary ? load_binary_window(stream, window) : load_csv_window(stream, window);
+        if (window->exit_code != SUCCESSFULL_EXECUTION_CODE){
+            window->rows = 0;
+            window->last = 1;
+        }
+
+        // 3. Hand it to the trainer
+        pthread_mutex_lock(&stream->lock);
+        stream->window_full[slot] = 1;
+        pthread_cond_broadcast(&stream->changed);
+
+        if (window->exit_code != SUCCESSFULL_EXECUTION_CODE){
+            while (!stream->shutdown){
+                pthread_cond_wait(&stream->changed, &stream->lock);
+            }
+            pthread_mutex_unlock(&stream->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&stream->lock);
+
+        slot ^= 1;
+    }
+}
+
+
+/*
+Reads and validates the header of a binary dataset and sets DIMENSIONS_DATA.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int read_binary_header(DATA_STREAM* stream, const char* filename){
+
+    if (fseeko(stream->file, 0, SEEK_END) != 0){
+        printf("Could not get the size of the binary dataset %s.\n", filename);
+        return FILE_ERROR;
+    }
+    off_t file_size = ftello(stream->file);
+    rewind(stream->file);
+
+    if (file_size < (off_t) sizeof(BINARY_DATASET_HEADER) || fread(&stream->header, sizeof(BINARY_DATASET_HEADER), 1, stream->file) != 1){
+        printf("The binary dataset %s is too short to hold a header.\n", filename);
+        return FILE_ERROR;
+    }
+    if (!valid_binary_dataset_header(&stream->header, (size_t) file_size, filename)){
+        return FILE_ERROR;
+    }
+
+    DIMENSIONS_DATA = stream->header.input_dims;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Gets the number of values per row from the first non-empty line of a CSV and sets DIMENSIONS_DATA.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+static int read_csv_dimensions(DATA_STREAM* stream, const char* filename){
+
+    ssize_t length;
+    do{
+        length = getline(&stream->line, &stream->size_line, stream->file);
+    } while (length >= 0 && (length == 0 || stream->line[0] == '\n' || strcmp(stream->line, "\r\n") == 0 || strcmp(stream->line, "\r") == 0));
+
+    size_t values_per_row = 1;
+    for (ssize_t i = 0; i < length; i++){
+        values_per_row += (stream->line[i] == ',');
+    }
+    if (length < 0 || values_per_row <= NUM_OUTPUT){
+        printf("The first line of the csv %s has to hold more than %zu values. Perhaps empty.\n", filename, (size_t) NUM_OUTPUT);
+        return FILE_ERROR;
+    }
+
+    rewind(stream->file);
+    DIMENSIONS_DATA = values_per_row - NUM_OUTPUT;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Allocates the blocks and the row pointers of a window of window_rows data points.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR (the caller frees what was allocated)*/
+static int allocate_window(DATA_WINDOW* window, size_t window_rows){
+
+    window->inputs = malloc(window_rows * DIMENSIONS_DATA * sizeof(double));
+    window->outputs = malloc(window_rows * NUM_OUTPUT * sizeof(double));
+    window->input = malloc(window_rows * sizeof(double*));
+    window->output = malloc(window_rows * sizeof(double*));
+    if (!window->inputs || !window->outputs || !window->input || !window->output){
+        perror("Memory allocation error when trying to allocate a window of the data stream.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    for (size_t row = 0; row < window_rows; row++){
+        window->input[row] = window->inputs + row * DIMENSIONS_DATA;
+        window->output[row] = window->outputs + row * NUM_OUTPUT;
+    }
+    window->rows = 0;
+    window->last = 0;
+    window->exit_code = SUCCESSFULL_EXECUTION_CODE;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Frees the memory of a DATA_STREAM whose loader is not running*/
+static void free_data_stream(DATA_STREAM* stream){
+    for (size_t slot = 0; slot < 2; slot++){
+        free(stream->windows[slot].inputs);
+        free(stream->windows[slot].outputs);
+        free(stream->windows[slot].input);
+        free(stream->windows[slot].output);
+    }
+    free(stream->staging);
+    free(stream->line);
+    if (stream->file){
+        fclose(stream->file);
+    }
+    free(stream);
+}
+
+
+/*
+Function to open a CSV or binary dataset (detected by its magic) for streaming in windows of window_rows data points.
+Sets DIMENSIONS_DATA and starts loading the first window.
+SIZE_TRAIN is only known after the first pass (see next_data_window()).
+Returns NULL if it fails*/
+DATA_STREAM* open_data_stream(const char* filename, size_t window_rows){
+
+    if (window_rows == 0){
+        printf("A window of the data stream has to hold at least one data point.\n");
+        return NULL;
+    }
+
+    // Calloc, so that free_data_stream() works on a partly opened stream
+    DATA_STREAM* stream = calloc(1, sizeof(DATA_STREAM));
+    if (!stream){
+        perror("Memory allocation error when trying to allocate the DATA_STREAM.\n");
+        return NULL;
+    }
+    stream->window_rows = window_rows;
+    stream->held = -1;
+    stream->binary = is_binary_dataset(filename);
+
+    // 1. Open the file and get the dimensions of the data
+    stream->file = fopen(filename, stream->binary ? "rb" : "r");
+    if (!stream->file){
+        printf("Could not open the file %s.\n", filename);
+        free_data_stream(stream);
+        return NULL;
+    }
+
+    int exit_code = stream->binary ? read_binary_header(stream, filename) : read_csv_dimensions(stream, filename);
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        free_data_stream(stream);
+        return NULL;
+    }
+
+    // 2. Allocate the windows and the staging memory (float32 values of a window, the lines of a CSV are parsed into the window)
+    if (stream->binary && stream->header.scalar_size == sizeof(float)){
+        stream->staging = malloc(window_rows * ((DIMENSIONS_DATA > NUM_OUTPUT) ? DIMENSIONS_DATA : NUM_OUTPUT) * sizeof(float));
+        if (!stream->staging){
+            perror("Memory allocation error when trying to allocate the staging memory of the data stream.\n");
+            free_data_stream(stream);
+            return NULL;
+        }
+    }
+
+    for (size_t slot = 0; slot < 2; slot++){
+        if (allocate_window(&stream->windows[slot], window_rows) != SUCCESSFULL_EXECUTION_CODE){
+            free_data_stream(stream);
+            return NULL;
+        }
+    }
+
+    // 3. Start the loader
+    if (pthread_mutex_init(&stream->lock, NULL) != 0){
+        printf("Could not initialise the lock of the data stream.\n");
+        free_data_stream(stream);
+        return NULL;
+    }
+    if (pthread_cond_init(&stream->changed, NULL) != 0){
+        printf("Could not initialise the condition of the data stream.\n");
+        pthread_mutex_destroy(&stream->lock);
+        free_data_stream(stream);
+        return NULL;
+    }
+    if (pthread_create(&stream->loader, NULL, load_windows, stream) != 0){
+        printf("Could not create the loader thread of the data stream.\n");
+        pthread_cond_destroy(&stream->changed);
+        pthread_mutex_destroy(&stream->lock);
+        free_data_stream(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+
+/*
+Function to get the next window of the stream.
+Releases the window returned by the previous call to the loader, so its rows may not be used anymore.
+Blocks until the window is loaded. If window->last is set, the next call returns the first window of the next pass.
+Check window->exit_code before using the rows.*/
+DATA_WINDOW* next_data_window(DATA_STREAM* stream){
+
+    pthread_mutex_lock(&stream->lock);
+
+    // 1. Release the previous window
+    if (stream->held >= 0){
+        stream->window_full[stream->held] = 0;
+        pthread_cond_broadcast(&stream->changed);
+    }
+
+    // 2. Wait for the next one (the windows are loaded and handed out in turns)
+    size_t slot = stream->next_window;
+    while (!stream->window_full[slot]){
+        pthread_cond_wait(&stream->changed, &stream->lock);
+    }
+    stream->held = (int) slot;
+    stream->next_window = slot ^ 1;
+
+    pthread_mutex_unlock(&stream->lock);
+    return &stream->windows[slot];
+}
+
+
+/*
+Function to stop the loader and free the DATA_STREAM*/
+void close_data_stream(DATA_STREAM* stream){
+
+    pthread_mutex_lock(&stream->lock);
+    stream->shutdown = 1;
+    pthread_cond_broadcast(&stream->changed);
+    pthread_mutex_unlock(&stream->lock);
+
+    pthread_join(stream->loader, NULL);
+    pthread_cond_destroy(&stream->changed);
+    pthread_mutex_destroy(&stream->lock);
+
+    free_data_stream(stream);
+}
+
+
+/*
+Function to split the rows of a window into contiguous parts for the threads (like distribute_data_among_threads()).
+The THREAD_DATA array is only updated, the rows stay owned by the window.*/
+void distribute_window_among_threads(DATA_WINDOW* window, THREAD_DATA* thread_data){
+
+    size_t base_size = window->rows / NUM_THREADS;
+    size_t remainder = window->rows % NUM_THREADS;
+    size_t data_used_so_far = 0;
+
+    for (size_t thread_num = 0; thread_num < NUM_THREADS; thread_num++){
+        size_t size_of_thread_data = base_size + (thread_num < remainder);
+
+        thread_data[thread_num].input = window->input + data_used_so_far;
+        thread_data[thread_num].output = window->output + data_used_so_far;
+        thread_data[thread_num].size = size_of_thread_data;
+        data_used_so_far += size_of_thread_data;
+    }
+}
@@ -0,0 +1,16 @@
+/*
+Header file of the data stream file.
+Includes process_input.h to set the constants of the data (DIMENSIONS_DATA, SIZE_TRAIN, ...) like parse_csv()*/
+
+#ifndef DATA_STREAM_H
+#define DATA_STREAM_H
+
+#include "../process_input/process_input.h"
+
+DATA_STREAM* open_data_stream(const char*, size_t);
+DATA_WINDOW* next_data_window(DATA_STREAM*);
+void close_data_stream(DATA_STREAM*);
+
+void distribute_window_among_threads(DATA_WINDOW*, THREAD_DATA*);
+
+#endif // DATA_STREAM_H
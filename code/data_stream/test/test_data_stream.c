@@ -0,0 +1,172 @@
+/*
+Test file for the data stream.
+May not be included in any other files. Its own purpose is for testing.
+
+The test files are written into the current directory and removed again.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_data_stream.h"
+#include "../../binary_dataset/binary_dataset.h"
+
+// Shape of the test data (the windows do not divide the rows evenly)
+#define TEST_ROWS 10
+#define TEST_DIMENSIONS 2
+#define TEST_WINDOW_ROWS 4
+
+// Files written by the tests
+#define TEST_CSV "test_data_stream.csv"
+#define TEST_BINARY "test_data_stream.bin"
+
+
+/*
+Writes a CSV of rows data points. Value j of row i is i + j / 4, the output is -i.
+If broken is set, the last row misses its output.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+int write_test_csv(const char* filename, size_t rows, int broken){
+    FILE* file = fopen(filename, "w");
+    if (!file){
+        return FILE_ERROR;
+    }
+
+    for (size_t row = 0; row < rows; row++){
+        for (size_t j = 0; j < TEST_DIMENSIONS; j++){
+            fprintf(file, "%g,", (double) row + (double) j / 4);
+        }
+        if (broken && row == rows - 1){
+            fprintf(file, "\n");
+        } else{
+            fprintf(file, "%g\n", -(double) row);
+        }
+
+        // Empty lines are skipped
+        if (row == 1){
+            fprintf(file, "\n");
+        }
+    }
+
+    fclose(file);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Tests that two passes over the stream return all data points in order and in windows of TEST_WINDOW_ROWS*/
+void test_stream_passes(const char* filename){
+
+    DIMENSIONS_DATA = 0;
+    DATA_STREAM* stream = open_data_stream(filename, TEST_WINDOW_ROWS);
+    assert(stream != NULL);
+    assert(DIMENSIONS_DATA == TEST_DIMENSIONS);
+
+    for (size_t pass = 0; pass < 2; pass++){
+        size_t row = 0;
+        DATA_WINDOW* window;
+
+        do{
+            window = next_data_window(stream);
+            assert(window->exit_code == SUCCESSFULL_EXECUTION_CODE);
+            assert(window->rows <= TEST_WINDOW_ROWS);
+
+            for (size_t i = 0; i < window->rows; i++, row++){
+                for (size_t j = 0; j < TEST_DIMENSIONS; j++){
+                    COMPARE(window->input[i][j], (double) row + (double) j / 4);
+                }
+                COMPARE(window->output[i][0], -(double) row);
+            }
+        } while (!window->last);
+
+        assert(row == TEST_ROWS);
+    }
+
+    close_data_stream(stream);
+    return;
+}
+
+
+/*
+Tests that the rows of a window are split among the threads without gaps*/
+void test_distribute_window(const char* filename){
+
+    DATA_STREAM* stream = open_data_stream(filename, TEST_WINDOW_ROWS);
+    assert(stream != NULL);
+
+    THREAD_DATA* thread_data = calloc(NUM_THREADS, size_thread_data);
+    assert(thread_data != NULL);
+
+    DATA_WINDOW* window = next_data_window(stream);
+    distribute_window_among_threads(window, thread_data);
+
+    size_t total = 0;
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        assert(thread_data[thread_pos].input == window->input + total);
+        total += thread_data[thread_pos].size;
+    }
+    assert(total == window->rows);
+
+    free(thread_data);
+    close_data_stream(stream);
+    return;
+}
+
+
+/*
+Tests that missing files and invalid lines stop the stream*/
+void test_invalid_stream(void){
+
+    // 1. A missing file
+    remove(TEST_CSV);
+    assert(open_data_stream(TEST_CSV, TEST_WINDOW_ROWS) == NULL);
+
+    // 2. The last row of the second window is missing its output
+    assert(write_test_csv(TEST_CSV, 2 * TEST_WINDOW_ROWS, 1) == SUCCESSFULL_EXECUTION_CODE);
+    DATA_STREAM* stream = open_data_stream(TEST_CSV, TEST_WINDOW_ROWS);
+    assert(stream != NULL);
+
+    DATA_WINDOW* window = next_data_window(stream);
+    assert(window->exit_code == SUCCESSFULL_EXECUTION_CODE);
+    assert(window->rows == TEST_WINDOW_ROWS);
+
+    window = next_data_window(stream);
+    assert(window->exit_code != SUCCESSFULL_EXECUTION_CODE);
+    assert(window->last);
+
+    close_data_stream(stream);
+    remove(TEST_CSV);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    if (write_test_csv(TEST_CSV, TEST_ROWS, 0) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Writing the test csv was unsuccessfull in test_data_stream.\n");
+        return FILE_ERROR;
+    }
+
+    // 1. CSV
+    test_stream_passes(TEST_CSV);
+    test_distribute_window(TEST_CSV);
+
+    // 2. Binary datasets of both scalar sizes
+    assert(convert_csv_to_binary(TEST_CSV, TEST_BINARY, sizeof(double)) == SUCCESSFULL_EXECUTION_CODE);
+    test_stream_passes(TEST_BINARY);
+    assert(convert_csv_to_binary(TEST_CSV, TEST_BINARY, sizeof(float)) == SUCCESSFULL_EXECUTION_CODE);
+    test_stream_passes(TEST_BINARY);
+    remove(TEST_BINARY);
+
+    test_invalid_stream();
+
+    printf("All tests for data_stream successfully executed.\n");
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
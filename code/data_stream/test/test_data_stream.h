@@ -0,0 +1,18 @@
+/*
+Header file of the file to test the data stream file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_DATA_STREAM_H
+#define TEST_DATA_STREAM_H
+
+#include "../data_stream.h"
+
+int write_test_csv(const char*, size_t, int);
+
+void test_stream_passes(const char*);
+void test_distribute_window(const char*);
+void test_invalid_stream(void);
+
+int test_handler_func(void);
+
+#endif //TEST_DATA_STREAM_H
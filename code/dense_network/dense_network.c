@@ -0,0 +1,373 @@
+/*
+This file is responsible for compiling the linked list of neurons into a dense representation.
+The dense representation stores the parameters of every layer in contiguous, row-major arrays,
+so that the training engine can walk memory sequentially instead of chasing pointers.
+
+The linked list stays the source of truth of the architecture:
+- compile_network() builds the DENSE_NETWORK after connect_neurons()
+- sync_dense_network() reloads it after add_connection()/del_connection()
+- write_back_dense_network() copies the trained parameters back into the linked list
+
+Only connections between adjacent layers can be compiled. Other topologies return an error,
+in which case the linked list has to be used for training.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR or NULL if pointers are returned.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dense_network.h"
+#include "../neurons/neurons.h"
+#include "../system_info/system_info.h"
+
+// Number of params in one cache line (the params and the derivatives of every workspace start at a cache line)
+#define PARAMS_PER_CACHE_LINE (cache_line_size() / sizeof(scalar))
+
+// Rounds a number of params up to whole cache lines
+#define ROUND_TO_CACHE_LINES(num) ((((num) + PARAMS_PER_CACHE_LINE - 1) / PARAMS_PER_CACHE_LINE) * PARAMS_PER_CACHE_LINE)
+
+
+/*
+Function to compile the (connected) linked list of neurons into a DENSE_NETWORK.
+Returns NULL if it fails or if the topology can not be represented by dense layers.*/
+DENSE_NETWORK* compile_network(neuron** network_arr){
+
+    // 1. Allocate memory for the data structure and its layers
+    DENSE_NETWORK* dense_network = malloc(sizeof(DENSE_NETWORK));
+    if (!dense_network){
+        perror("Memory allocation error when trying to allocate the DENSE_NETWORK.\n");
+        return NULL;
+    }
+
+    dense_network->layers = calloc(NUMBER_LAYERS, sizeof(DENSE_LAYER));
+    if (!dense_network->layers){
+        perror("Memory allocation error when trying to allocate the layers of the DENSE_NETWORK.\n");
+        free(dense_network);
+        return NULL;
+    }
+
+    // 2. Calculate the layout of the params (weights of a layer directly followed by its biases)
+    size_t offset = 0; // Offset of the next free param
+    size_t pos = 0;    // Position of the first neuron of the layer in the network array
+
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        DENSE_LAYER* this_layer = &dense_network->layers[layer];
+
+        this_layer->size = NEURON_NUMBERS[layer];
+        this_layer->pos = pos;
+        this_layer->size_next = (layer < NUMBER_LAYERS - 1) ? NEURON_NUMBERS[layer + 1] : 0;
+
+        this_layer->weights_offset = offset;
+        offset += this_layer->size * this_layer->size_next;
+
+        this_layer->biases_offset = offset;
+        offset += this_layer->size;
+
+        pos += this_layer->size;
+    }
+
+    dense_network->num_params = offset;
+    dense_network->connected = NULL;
+    dense_network->master_params = NULL;
+
+    // 3. Allocate the contiguous block of params (aligned to whole cache lines, so that shards of the params never share one)
+    size_t size_params = ROUND_TO_CACHE_LINES(dense_network->num_params) * sizeof(scalar);
+    dense_network->params = cache_aligned_calloc(size_params);
+    if (!dense_network->params){
+        perror("Memory allocation error when trying to allocate the params of the DENSE_NETWORK.\n");
+        free(dense_network->layers);
+        free(dense_network);
+        return NULL;
+    }
+
+#ifdef MIXED_PRECISION
+    // The shards of the params start at a multiple of PARAMS_PER_CACHE_LINE, which is also at a cache line of the doubles
+    dense_network->master_params = cache_aligned_calloc(ROUND_TO_CACHE_LINES(dense_network->num_params) * sizeof(double));
+    if (!dense_network->master_params){
+        perror("Memory allocation error when trying to allocate the master params of the DENSE_NETWORK.\n");
+        free_dense_network(dense_network);
+        return NULL;
+    }
+#endif
+
+    // 4. Copy the parameters of the linked list
+    if (sync_dense_network(network_arr, dense_network) != SUCCESSFULL_EXECUTION_CODE){
+        free_dense_network(dense_network);
+        return NULL;
+    }
+
+    return dense_network;
+}
+
+
+/*
+Sets the param at index to value (and its master copy in mixed precision)*/
+static inline void set_param(DENSE_NETWORK* dense_network, size_t index, double value){
+    dense_network->params[index] = (scalar) value;
+    if (dense_network->master_params){
+        dense_network->master_params[index] = value;
+    }
+}
+
+
+/*
+Returns the param at index in double precision (the master copy in mixed precision)*/
+static inline double get_param(DENSE_NETWORK* dense_network, size_t index){
+    return dense_network->master_params ? dense_network->master_params[index] : (double) dense_network->params[index];
+}
+
+
+/*
+Function to (re)load the parameters and connections of the linked list into the DENSE_NETWORK.
+Has to be called after the topology of the linked list changed.
+Note that parameters trained in the DENSE_NETWORK are overwritten, write them back first if needed.
+
+Returns SUCCESSFULL_EXECUTION_CODE or an error code if the topology can not be compiled.*/
+int sync_dense_network(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    size_t num_params = dense_network->num_params;
+
+    // Mask of the parameters found in the linked list (missing connections stay 0)
+    unsigned char* connected = calloc(num_params, sizeof(unsigned char));
+    if (!connected){
+        perror("Memory allocation error when trying to allocate the connected mask of the DENSE_NETWORK.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    // Missing connections have a weight of 0
+    memset(dense_network->params, 0, num_params * sizeof(scalar));
+    if (dense_network->master_params){
+        memset(dense_network->master_params, 0, num_params * sizeof(double));
+    }
+
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        DENSE_LAYER* this_layer = &dense_network->layers[layer];
+
+        // Position of the first neuron of the next layer (only used if there is a next layer)
+        size_t pos_next_layer = this_layer->pos + this_layer->size;
+
+        for (size_t i = 0; i < this_layer->size; i++){
+            neuron* this_neuron = network_arr[this_layer->pos + i];
+
+            // 1. Copy the bias
+            set_param(dense_network, this_layer->biases_offset + i, this_neuron->bias);
+            connected[this_layer->biases_offset + i] = 1;
+
+            // 2. Copy the weights into the row of this neuron
+            size_t row = this_layer->weights_offset + i * this_layer->size_next;
+
+            node_linked_list_connection* con = this_neuron->next_layer;
+            while (con){
+                size_t pos_connected = con->data->pos;
+
+                // Case when the connection does not go to the next layer
+                if (pos_connected < pos_next_layer || pos_connected >= pos_next_layer + this_layer->size_next){
+                    printf("The connection from neuron %zu to neuron %zu does not connect adjacent layers and can not be compiled.\n", this_neuron->pos, pos_connected);
+                    free(connected);
+                    return OTHER_ERROR;
+                }
+
+                size_t index = row + (pos_connected - pos_next_layer);
+
+                // Case when the same two neurons are connected twice
+                if (connected[index]){
+                    printf("The neurons %zu and %zu are connected more than once and can not be compiled.\n", this_neuron->pos, pos_connected);
+                    free(connected);
+                    return OTHER_ERROR;
+                }
+
+                set_param(dense_network, index, con->weight);
+                connected[index] = 1;
+
+                con = con->next;
+            }
+        }
+    }
+
+    // Only keep the mask if some connections are missing
+    size_t num_connected = 0;
+    for (size_t i = 0; i < num_params; i++){
+        num_connected += connected[i];
+    }
+    if (num_connected == num_params){
+        free(connected);
+        connected = NULL;
+    }
+
+    free(dense_network->connected);
+    dense_network->connected = connected;
+    dense_network->topology_version = TOPOLOGY_VERSION;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to copy the parameters of the DENSE_NETWORK back into the linked list.
+Updates the network_arr inplace.*/
+void write_back_dense_network(DENSE_NETWORK* dense_network, neuron** network_arr){
+
+    for (size_t layer = 0; layer < NUMBER_LAYERS; layer++){
+        DENSE_LAYER* this_layer = &dense_network->layers[layer];
+        size_t pos_next_layer = this_layer->pos + this_layer->size;
+
+        for (size_t i = 0; i < this_layer->size; i++){
+            size_t pos = this_layer->pos + i;
+
+            // 1. Restore the bias
+            set_bias(network_arr, pos, get_param(dense_network, this_layer->biases_offset + i));
+
+            // 2. Restore the weights
+            size_t row = this_layer->weights_offset + i * this_layer->size_next;
+
+            node_linked_list_connection* con = network_arr[pos]->next_layer;
+            while (con){
+                con->weight = get_param(dense_network, row + (con->data->pos - pos_next_layer));
+                con = con->next;
+            }
+        }
+    }
+}
+
+
+/*
+Returns 1 if the linked list was changed since the last sync of the DENSE_NETWORK, else 0*/
+int dense_network_is_stale(DENSE_NETWORK* dense_network){
+    return dense_network->topology_version != TOPOLOGY_VERSION;
+}
+
+
+/*
+Function to free the DENSE_NETWORK*/
+void free_dense_network(DENSE_NETWORK* dense_network){
+    free(dense_network->connected);
+    free(dense_network->master_params);
+    free(dense_network->params);
+    free(dense_network->layers);
+    free(dense_network);
+}
+
+
+/*
+Function to get the shard of the params updated by one of num_shards threads during the gradient descent.
+The params are split into equal, contiguous shards of whole cache lines, so that no two threads write to the same cache line.
+Stores the shard [from, to) in the pointers (empty if there are less cache lines than shards).*/
+void dense_param_shard(DENSE_NETWORK* dense_network, size_t shard, size_t num_shards, size_t* from, size_t* to){
+
+    size_t num_params = dense_network->num_params;
+    size_t num_lines = ROUND_TO_CACHE_LINES(num_params) / PARAMS_PER_CACHE_LINE;
+
+    size_t first = (num_lines * shard / num_shards) * PARAMS_PER_CACHE_LINE;
+    size_t last = (num_lines * (shard + 1) / num_shards) * PARAMS_PER_CACHE_LINE;
+
+    // The last cache line is only partly used
+    *from = (first < num_params) ? first : num_params;
+    *to = (last < num_params) ? last : num_params;
+}
+
+
+/*
+Returns the number of values of the block of a DENSE_WORKSPACE (without deltas and derivatives if training is 0):
+inputs, outputs and deltas of every neuron for a full batch followed by the derivatives of every param.
+Every array starts at a cache line (the derivatives are summed up in shards of whole cache lines)*/
+static size_t dense_workspace_size(DENSE_NETWORK* dense_network, int training){
+    size_t size_batch = ROUND_TO_CACHE_LINES(BATCH_SIZE * LENGTH_NETWORK);
+    return training ? 3 * size_batch + ROUND_TO_CACHE_LINES(dense_network->num_params) : 2 * size_batch;
+}
+
+
+/*
+Allocates the arrays of one DENSE_WORKSPACE in one zeroed block starting at a cache line.
+If training is 0, only the inputs and outputs are allocated (deltas and der_params are NULL), which is all the predictions need.
+Returns MEMORY_ALLOCATION_ERROR if it fails (the workspace is not changed)*/
+static int allocate_dense_workspace(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, int training){
+
+    size_t size_batch = ROUND_TO_CACHE_LINES(BATCH_SIZE * LENGTH_NETWORK);
+    scalar* block = cache_aligned_calloc(dense_workspace_size(dense_network, training) * sizeof(scalar));
+    if (!block){
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    workspace->inputs = block;
+    workspace->outputs = block + size_batch;
+    workspace->deltas = training ? block + 2 * size_batch : NULL;
+    workspace->der_params = training ? block + 3 * size_batch : NULL;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to allocate one DENSE_WORKSPACE for every thread.
+Every workspace is one contiguous block, so that threads never write to the memory of each other.
+If training is 0, only the inputs and outputs are allocated (deltas and der_params are NULL), which is all the predictions need.
+Returns NULL if it fails*/
+static DENSE_WORKSPACE* allocate_dense_workspaces(DENSE_NETWORK* dense_network, int training){
+
+    DENSE_WORKSPACE* workspaces = calloc(NUM_THREADS, sizeof(DENSE_WORKSPACE));
+    if (!workspaces){
+        perror("Memory allocation error when trying to allocate the DENSE_WORKSPACE array.\n");
+        return NULL;
+    }
+
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        if (allocate_dense_workspace(dense_network, &workspaces[thread_pos], training) != SUCCESSFULL_EXECUTION_CODE){
+            printf("Memory allocation error when trying to allocate the DENSE_WORKSPACE of thread %zu.\n", thread_pos);
+            free_dense_workspaces(workspaces); // Works as the workspaces are calloced (unallocated blocks are NULL)
+            return NULL;
+        }
+    }
+
+    return workspaces;
+}
+
+
+/*
+Function to allocate the DENSE_WORKSPACE of every thread for the training.
+Returns NULL if it fails*/
+DENSE_WORKSPACE* initialise_dense_workspaces(DENSE_NETWORK* dense_network){
+    return allocate_dense_workspaces(dense_network, 1);
+}
+
+
+/*
+Function to allocate the DENSE_WORKSPACE of every thread for the predictions (without deltas and derivatives).
+Returns NULL if it fails*/
+DENSE_WORKSPACE* initialise_dense_predict_workspaces(DENSE_NETWORK* dense_network){
+    return allocate_dense_workspaces(dense_network, 0);
+}
+
+
+/*
+Function to move the DENSE_WORKSPACE of a thread into a new block allocated (and first touched) by the calling thread.
+Called by the pinned worker of the workspace, so that the kernel places the workspace on the NUMA node of the worker.
+Has to be called between two jobs (the contents are kept).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR (the workspace is not changed)*/
+int localise_dense_workspace(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace){
+    int training = workspace->deltas != NULL;
+
+    DENSE_WORKSPACE local;
+    if (allocate_dense_workspace(dense_network, &local, training) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Memory allocation error when trying to move a DENSE_WORKSPACE.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    memcpy(local.inputs, workspace->inputs, dense_workspace_size(dense_network, training) * sizeof(scalar));
+
+    free(workspace->inputs); // Start of the block of the workspace
+    *workspace = local;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to free the array of DENSE_WORKSPACE*/
+void free_dense_workspaces(DENSE_WORKSPACE* workspaces){
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        free(workspaces[thread_pos].inputs); // Start of the block of the workspace
+    }
+    free(workspaces);
+}
@@ -0,0 +1,22 @@
+/*
+Header file of the dense network file.
+Includes structs.h to use the DENSE_NETWORK and DENSE_WORKSPACE structs*/
+
+#ifndef DENSE_NETWORK_H
+#define DENSE_NETWORK_H
+
+#include "../structs/structs.h"
+
+DENSE_NETWORK* compile_network(neuron**);
+int sync_dense_network(neuron**, DENSE_NETWORK*);
+void write_back_dense_network(DENSE_NETWORK*, neuron**);
+int dense_network_is_stale(DENSE_NETWORK*);
+void free_dense_network(DENSE_NETWORK*);
+void dense_param_shard(DENSE_NETWORK*, size_t, size_t, size_t*, size_t*);
+
+DENSE_WORKSPACE* initialise_dense_workspaces(DENSE_NETWORK*);
+DENSE_WORKSPACE* initialise_dense_predict_workspaces(DENSE_NETWORK*);
+int localise_dense_workspace(DENSE_NETWORK*, DENSE_WORKSPACE*);
+void free_dense_workspaces(DENSE_WORKSPACE*);
+
+#endif // DENSE_NETWORK_H
@@ -0,0 +1,261 @@
+/*
+Test file for the compilation of the Neural Network into dense layers.
+May not be included in any other files. Its own purpose is for testing.
+
+For testing purposes (see test_config.h):
+- NEURON_NUMBERS = {1, 1}
+- ACTIVATION_FUNCTION_DER(x) = 1;
+- COST_FUNCTION_DER(act, pred) = pred - act;
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_dense_network.h"
+#include "../../gradient_descent/gradient_descent.h"
+
+
+/*
+Tests that the layout and the params of the compiled network match the linked list*/
+void test_compile_network(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    // Layout: weights of layer 0, biases of layer 0, biases of layer 1 (output layer has no weights)
+    assert(dense_network->num_params == 3);
+    assert(dense_network->layers[0].weights_offset == 0);
+    assert(dense_network->layers[0].biases_offset == 1);
+    assert(dense_network->layers[1].size_next == 0);
+    assert(dense_network->layers[1].biases_offset == 2);
+    assert(dense_network->layers[1].pos == 1);
+
+    // Fully connected layers do not need a mask
+    assert(dense_network->connected == NULL);
+
+    COMPARE(dense_network->params[0], network_arr[0]->next_layer->weight);
+    COMPARE(dense_network->params[1], network_arr[0]->bias);
+    COMPARE(dense_network->params[2], network_arr[1]->bias);
+    return;
+}
+
+
+/*
+Tests that the dense engine calculates the same deltas as the linked list*/
+void test_dense_create_output(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    LIST_WORKSPACE* list_workspaces = initialise_list_workspaces();
+    assert(list_workspaces != NULL);
+
+    // 1. Correct prediction (see test2 of test_feed_forward)
+    set_bias(network_arr, 0, 1);
+    set_bias(network_arr, 1, 1);
+    network_arr[0]->next_layer->weight = 2;
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+
+    double input1[1] = {4};
+    double output1[1] = {11};
+    double* input_batch1[1] = {input1};
+    double* output_batch1[1] = {output1};
+    double cost = dense_create_output(dense_network, &workspaces[0], input_batch1, output_batch1, 1);
+
+    COMPARE(cost, 0);
+    COMPARE(workspaces[0].deltas[1], 0);
+
+    // 2. Wrong prediction (see test4 of test_feed_forward)
+    set_bias(network_arr, 0, -1);
+    set_bias(network_arr, 1, 8);
+    network_arr[0]->next_layer->weight = -1.5;
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+
+    double input2[1] = {-3};
+    double output2[1] = {4};
+    double* input_batch2[1] = {input2};
+    double* output_batch2[1] = {output2};
+    dense_create_output(dense_network, &workspaces[1], input_batch2, output_batch2, 1);
+    create_output(network_arr, &list_workspaces[1], input2, output2);
+
+    // Deltas of both engines have to match
+    COMPARE(workspaces[1].deltas[1], 4);
+    COMPARE(workspaces[1].deltas[1], list_workspaces[1].deltas[1]);
+    COMPARE(workspaces[1].deltas[0], list_workspaces[1].deltas[0]);
+    COMPARE(workspaces[1].der_params[0], list_workspaces[1].der_weights[network_arr[0]->next_layer->index]);
+    COMPARE(workspaces[1].der_params[1], list_workspaces[1].der_biases[0]);
+    COMPARE(workspaces[1].der_params[2], list_workspaces[1].der_biases[1]);
+
+    // Accumulated derivatives: output of neuron 0 is relu(-4) = 0, so the weight derivative is 0
+    COMPARE(workspaces[1].der_params[0], 0);
+    COMPARE(workspaces[1].der_params[1], -6);
+    COMPARE(workspaces[1].der_params[2], 4);
+
+    // 3. Both data points as one batch: same deltas per row, summed derivatives
+    double* input_batch3[2] = {input1, input2};
+    double* output_batch3[2] = {output1, output2};
+    dense_create_output(dense_network, &workspaces[2], input_batch3, output_batch3, 2);
+
+    // Rows of the output layer start at batch_size * pos = 2
+    COMPARE(workspaces[2].deltas[2 + 1], 4);
+    COMPARE(workspaces[2].deltas[1], -6);
+
+    // First data point: output of neuron 0 is 3, prediction 3.5 => delta -7.5 (and 11.25 for neuron 0)
+    COMPARE(workspaces[2].der_params[0], 3 * -7.5);
+    COMPARE(workspaces[2].der_params[1], 11.25 - 6);
+    COMPARE(workspaces[2].der_params[2], -7.5 + 4);
+
+    free_list_workspaces(list_workspaces);
+    free_dense_workspaces(workspaces);
+    return;
+}
+
+
+/*
+Tests that deleting and adding connections marks the dense network as stale and that it can be resynced*/
+void test_resync(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    assert(!dense_network_is_stale(dense_network));
+
+    // 1. Delete the only connection
+    assert(del_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(dense_network_is_stale(dense_network));
+
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    assert(!dense_network_is_stale(dense_network));
+    assert(dense_network->connected != NULL);
+    assert(dense_network->connected[0] == 0);
+    COMPARE(dense_network->params[0], 0);
+
+    // The missing connection may not be trained
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    workspaces[0].der_params[0] = 100;
+    dense_gradient_descent(dense_network, workspaces, NULL);
+    COMPARE(dense_network->params[0], 0);
+    COMPARE(workspaces[0].der_params[0], 0);
+    free_dense_workspaces(workspaces);
+
+    // 2. Add the connection again
+    assert(add_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(dense_network_is_stale(dense_network));
+
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    assert(dense_network->connected == NULL);
+    COMPARE(dense_network->params[0], network_arr[0]->next_layer->weight);
+    return;
+}
+
+
+/*
+Tests that the shards of the params cover all params without overlap and start at a cache line*/
+void test_param_shards(DENSE_NETWORK* dense_network){
+
+    size_t params_per_cache_line = cache_line_size() / sizeof(scalar);
+    assert((size_t) dense_network->params % cache_line_size() == 0);
+
+    // More shards than cache lines: only the first shard gets the params
+    size_t expected_from = 0;
+    for (size_t shard = 0; shard < NUM_THREADS; shard++){
+        size_t from, to;
+        dense_param_shard(dense_network, shard, NUM_THREADS, &from, &to);
+
+        assert(from == expected_from);
+        assert(from <= to);
+        assert(from % params_per_cache_line == 0 || from == dense_network->num_params);
+        expected_from = to;
+    }
+    assert(expected_from == dense_network->num_params);
+
+    // Updating the shards one by one is the same as updating all params at once
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    assert((size_t) workspaces[0].der_params % cache_line_size() == 0);
+
+    double params_before[3] = {dense_network->params[0], dense_network->params[1], dense_network->params[2]};
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        for (size_t i = 0; i < dense_network->num_params; i++){
+            workspaces[thread_pos].der_params[i] = (double) (i + 1);
+        }
+    }
+
+    for (size_t shard = 0; shard < NUM_THREADS; shard++){
+        size_t from, to;
+        dense_param_shard(dense_network, shard, NUM_THREADS, &from, &to);
+        dense_gradient_descent_shard(dense_network, workspaces, NULL, from, to);
+    }
+
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        COMPARE(dense_network->params[i], params_before[i] - LEARNING_RATE * (NUM_THREADS * (double) (i + 1) / SIZE_TRAIN));
+        for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+            COMPARE(workspaces[thread_pos].der_params[i], 0);
+        }
+    }
+
+    free_dense_workspaces(workspaces);
+    return;
+}
+
+
+/*
+Tests that trained params are written back into the linked list*/
+void test_write_back(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    dense_network->params[0] = 3;
+    dense_network->params[1] = 0.5;
+    dense_network->params[2] = -2;
+
+    // In mixed precision the trained values live in the master params
+    if (dense_network->master_params){
+        dense_network->master_params[0] = 3;
+        dense_network->master_params[1] = 0.5;
+        dense_network->master_params[2] = -2;
+    }
+
+    write_back_dense_network(dense_network, network_arr);
+
+    COMPARE(network_arr[0]->next_layer->weight, 3);
+    COMPARE(network_arr[0]->bias, 0.5);
+    COMPARE(network_arr[1]->bias, -2);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Create a Simple 2 layer Neural Network
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_dense_network.\n");
+        return OTHER_ERROR;
+    }
+
+    // Connect the neurons (the network array will be freed by the function in case of an error)
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    if (!dense_network){
+        printf("Compiling the network was unsuccessfull in test_dense_network.\n");
+        free_network(network_arr);
+        return OTHER_ERROR;
+    }
+
+    test_compile_network(network_arr, dense_network);
+    test_dense_create_output(network_arr, dense_network);
+    test_resync(network_arr, dense_network);
+    test_param_shards(dense_network);
+    test_write_back(network_arr, dense_network);
+
+    printf("All tests for dense_network successfully executed.\n");
+
+    free_dense_network(dense_network);
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,22 @@
+/*
+Header file of the file to test the dense_network file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_DENSE_NETWORK_H
+#define TEST_DENSE_NETWORK_H
+
+#include "../../../configurations/config_manager.h"
+#include "../dense_network.h"
+#include "../../neurons/neurons.h"
+#include "../../feed_forward/feed_forward.h"
+#include "../../system_info/system_info.h"
+
+void test_compile_network(neuron**, DENSE_NETWORK*);
+void test_dense_create_output(neuron**, DENSE_NETWORK*);
+void test_resync(neuron**, DENSE_NETWORK*);
+void test_param_shards(DENSE_NETWORK*);
+void test_write_back(neuron**, DENSE_NETWORK*);
+
+int test_handler_func(void);
+
+#endif //TEST_DENSE_NETWORK_H
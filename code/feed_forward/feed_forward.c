@@ -1,21 +1,32 @@
 /*
 File responsible for the Feed Forward logic of the Neural Network
 May not alter or interfere with the architecture of the Neural Network
-Uses multithreading for faster execution
+Uses multithreading for faster execution (the work functions are run as jobs of the THREAD_POOL)
+The work and validation functions take their data points in chunks from the WORK_QUEUE of their THREAD_ARGS (see work_queue.c)
 
-Includes pthread.h for multithreading
 Includes config.h for the different configurations of the model*/
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <pthread.h> // Include pthread for pthread_exit
+#include <string.h>  // Include string for memcpy
 
 #include "feed_forward.h"
+#include "../matrix/matrix.h"
 #include "../helper_functions/helper_functions.h"
+#include "../profiling/profiling.h"
+#include "../work_queue/work_queue.h"
 
 /*
-This function distributes the input data to the input nodes*/
-inline void distribute_input_data(neuron** neuron_arr, double input_data[DIMENSIONS_DATA], size_t thread_pos){
+This function distributes the input data to the input nodes.
+The inputs of all neurons in the workspace are initialised with their biases first.*/
+inline void distribute_input_data(neuron** neuron_arr, LIST_WORKSPACE* workspace, double input_data[DIMENSIONS_DATA]){
+    double* inputs = workspace->inputs;
+
+    // Start every neuron from its bias
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        inputs[pos] = neuron_arr[pos]->bias;
+    }
+
     size_t pos = 0;                                   // Pointer to the location of the first neuron in the Neural Network array
     size_t number_input_neurons = NEURON_NUMBERS[0];  // Number of neurons in the input layer
 
@@ -27,7 +38,7 @@ inline void distribute_input_data(neuron** neuron_arr, double input_data[DIMENSI
             pos = 0; // Go back to the first input neurons
         }
 
-        neuron_arr[pos]->input[thread_pos] += input_data[ptr_dimension];
+        inputs[pos] += input_data[ptr_dimension];
         // Increment the position to go to the next neurons
         pos++;
     }
@@ -37,61 +48,80 @@ inline void distribute_input_data(neuron** neuron_arr, double input_data[DIMENSI
 
 
 /*
-This function manages the forward pass of the data through the neural network.
-Note that it already calculates the deltas for the output neurons*/
-inline void forward_pass(neuron** neuron_arr, double output_data[NUM_OUTPUT], size_t thread_pos){
+This function propagates the outputs of all connected neurons to the inputs of their next layer.
+Afterwards, the inputs of the output neurons hold the (not activated) output of the Neural Network.*/
+static inline void propagate_inputs(neuron** neuron_arr, LIST_WORKSPACE* workspace){
 
-    int pos;
-
-    // Set the SUM_COST to 0
-    SUM_COST[thread_pos] = 0;
+    double* inputs = workspace->inputs;
 
     // Iterate over all connected neurons in the array
-    for (pos = 0; pos < (int) WORKING_NEURONS; pos++){
+    for (size_t pos = 0; pos < WORKING_NEURONS; pos++){
         neuron* curr_neuron = neuron_arr[pos];
 
         // Calculate the output
-        double output = ACTIVATION_FUNCTION(curr_neuron->input[thread_pos]);
+        double output = ACTIVATION_FUNCTION(inputs[pos]);
 
         // Propagate the output to the next layer
         node_linked_list_connection* next_layer = curr_neuron->next_layer;
         while(next_layer){
-            neuron* next_neuron = next_layer->data;
-            next_neuron->input[thread_pos] += next_layer->weight * output; // Add the respective value to the input of the next neuron
+            inputs[next_layer->data->pos] += next_layer->weight * output; // Add the respective value to the input of the next neuron
             next_layer = next_layer->next;                                 // Move to the next neuron
         }
     }
+    return;
+}
+
+
+/*
+This function manages the forward pass of the data through the neural network.
+Note that it already calculates the deltas for the output neurons.
+Returns the cost of the data point.*/
+inline double forward_pass(neuron** neuron_arr, LIST_WORKSPACE* workspace, double output_data[NUM_OUTPUT]){
+
+    double* inputs = workspace->inputs;
+    size_t pos = WORKING_NEURONS; // Position of the first output neuron
+    double cost = 0;
+
+    propagate_inputs(neuron_arr, workspace);
+
+    if (SOFTMAX_OUTPUT){
+        // Softmax, cross entropy and the deltas (probabilities - labels) of all outputs at once
+        cost = softmax_cross_entropy_arr(inputs + pos, output_data, workspace->deltas + pos, NUM_OUTPUT);
+        for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+            workspace->der_biases[pos + output_ptr] += workspace->deltas[pos + output_ptr];
+        }
+        return cost;
+    }
 
     // Get the different outputs from each output neuron and calculate their respective derivatives
     for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
-        neuron* output_neuron = neuron_arr[pos];
 
-        double pred_output = ACTIVATION_FUNCTION(output_neuron->input[thread_pos]); // Calculate the "actual" output of this node
+        double pred_output = ACTIVATION_FUNCTION(inputs[pos]);                      // Calculate the "actual" output of this node
 
         double act_output = output_data[output_ptr];                                // Retrieve the value of the output from the training data
 
         double cost_der = COST_FUNCTION_DER(act_output, pred_output);               // Calculate the cost derivative associated to this output neuron
 
         double delta = cost_der * ACTIVATION_FUNCTION_DER(pred_output);             // Calculate the delta of the neuron
-        
-        SUM_COST[thread_pos] += COST_FUNCTION(act_output, pred_output);             // Update the SUM_COST to visualize the effectiveness of the Neural Network later
 
-        output_neuron->delta[thread_pos] = delta;                                   // Update the delta arr
-        output_neuron->der_biases[thread_pos] += delta;                             // Add the delta to the accumulated derivative of the bias
+        cost += COST_FUNCTION(act_output, pred_output);                             // Sum up the cost to visualize the effectiveness of the Neural Network later
 
-        output_neuron->input[thread_pos] = output_neuron->bias;                     // Reset the input to the bias
+        workspace->deltas[pos] = delta;                                             // Update the delta arr
+        workspace->der_biases[pos] += delta;                                        // Add the delta to the accumulated derivative of the bias
 
         pos++;
     }
-    return; 
+    return cost;
 }
 
 
 /*
 Backwards pass through the Neural Network to calculate the derivatives and deltas for each node.
-Note that no change may be done in this function to the actual neuron itself.*/
-void backward_pass(neuron** neuron_arr, size_t thread_pos){
+Note that no change may be done in this function to the actual neuron itself (only the workspace is written).*/
+void backward_pass(neuron** neuron_arr, LIST_WORKSPACE* workspace){
 
+    double* inputs = workspace->inputs;
+    double* deltas = workspace->deltas;
     double cum_delta; // Double to carry all the deltas from the next layers
 
     // Walk backwards through the connected layers to update their deltas
@@ -103,93 +133,477 @@ void backward_pass(neuron** neuron_arr, size_t thread_pos){
         // Get the deltas from all connected neurons in the next layer
         node_linked_list_connection* next_layer = curr_neuron->next_layer;
         while(next_layer){
-            cum_delta += next_layer->data->delta[thread_pos] * next_layer->weight;
+            cum_delta += deltas[next_layer->data->pos] * next_layer->weight;
             next_layer = next_layer->next;
         }
 
         // Update the delta of this neuron
-        double delta = cum_delta * ACTIVATION_FUNCTION_DER(curr_neuron->input[thread_pos]);
-        curr_neuron->delta[thread_pos] = delta;
-        curr_neuron->der_biases[thread_pos] += delta;                                     // Add the delta to the accumulated derivative of the bias
+        double delta = cum_delta * ACTIVATION_FUNCTION_DER(inputs[pos]);
+        deltas[pos] = delta;
+        workspace->der_biases[pos] += delta;                                     // Add the delta to the accumulated derivative of the bias
 
         // Update the derivatives for the weights
-        double output_this_neuron = ACTIVATION_FUNCTION(curr_neuron->input[thread_pos]);  // Activated output of this neuron
+        double output_this_neuron = ACTIVATION_FUNCTION(inputs[pos]);            // Activated output of this neuron
 
         // Iterate over all connected neurons
         node_linked_list_connection* con = curr_neuron->next_layer;
         while (con){
-            con->der_weight[thread_pos] += output_this_neuron * con->data->delta[thread_pos];
+            workspace->der_weights[con->index] += output_this_neuron * deltas[con->data->pos];
             con = con->next;
         }
-
-        curr_neuron->input[thread_pos] = curr_neuron->bias;                               // Reset the input field to the bias
     }
     return;
 }
 
 
 /*
-This function calculates the transformation of the input data to the output with the current Neural Network*/
-inline void create_output(neuron** neuron_arr, double input_data[DIMENSIONS_DATA], double output_data[NUM_OUTPUT], size_t thread_pos){
+This function calculates the transformation of the input data to the output with the current Neural Network.
+Accumulates the derivatives in the workspace and returns the cost of the data point.*/
+inline double create_output(neuron** neuron_arr, LIST_WORKSPACE* workspace, double input_data[DIMENSIONS_DATA], double output_data[NUM_OUTPUT]){
 
     /***************************************************
      * 1. Distribute the input data to the input nodes *
      ***************************************************/
     
-    distribute_input_data(neuron_arr, input_data, thread_pos);
+    PROFILE_BEGIN(forward_start);
+    distribute_input_data(neuron_arr, workspace, input_data);
 
     /*******************************************************************
      * 2. Continue the flow of input->output through the hidden layers *
     ********************************************************************/
 
-    forward_pass(neuron_arr, output_data, thread_pos);
+    double cost = forward_pass(neuron_arr, workspace, output_data);
+    PROFILE_END(forward_start, PHASE_FORWARD);
 
     /******************************************************
      * 3. Calculate the respective deltas and derivatives *
      ******************************************************/
 
-    backward_pass(neuron_arr, thread_pos);
+    PROFILE_BEGIN(backward_start);
+    backward_pass(neuron_arr, workspace);
+    PROFILE_END(backward_start, PHASE_BACKWARD);
+
+    return cost;
+}
+
+
+/*
+This function predicts the output of one data point with the current Neural Network.
+Only runs the forward pass: no cost, deltas or derivatives are calculated.
+Only the inputs of the workspace are written.*/
+void predict_output(neuron** neuron_arr, LIST_WORKSPACE* workspace, double input_data[DIMENSIONS_DATA], double prediction[NUM_OUTPUT]){
+
+    distribute_input_data(neuron_arr, workspace, input_data);
+    propagate_inputs(neuron_arr, workspace);
 
+    if (SOFTMAX_OUTPUT){
+        softmax_cross_entropy_arr(workspace->inputs + WORKING_NEURONS, NULL, prediction, NUM_OUTPUT);
+        return;
+    }
+
+    for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+        prediction[output_ptr] = ACTIVATION_FUNCTION(workspace->inputs[WORKING_NEURONS + output_ptr]);
+    }
     return;
 }
 
 
 /*
 Work of one thread
-Note that this function assumes that the output is one dimensional
-This returns the cost calculated for its data.
+The summed cost is added to the cost of the THREAD_ARGS (reset before every generation).
 As such, no mean_cost_function() should be used.
+Runs as a job of the THREAD_POOL, so it may not exit the thread.
 */
 void* work_thread(void* args){
 
-    double* total_cost = malloc(sizeof(double)); // Will be freed in the main.c function after being returned
-    if (!total_cost){
-        // Case if memory allocation fails
-        perror("Failure to allocate memory for a double in a thread.\n");
-        pthread_exit(NULL); // Exit the thread with NULL to indicate an error
+    // Cast thread args to the right type
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    // Unpack the thread_args
+    neuron** network_arr = thread_args->network_arr;   // Pointer to the Neural Network
+    LIST_WORKSPACE* workspace = thread_args->list_workspace;
+
+    // Sum up the cost locally and only write it once
+    double sum_cost = 0;
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    while (take_work_chunk(thread_args, &chunk)){
+        double** input_arr = chunk.data->input + chunk.first;        // Array[chunk.rows] of arrays[DIMENSIONS_INPUT] of input doubles
+        double** output_arr_true = chunk.data->output + chunk.first; // Array of arrays[chunk.rows] of output[NUM_OUTPUT] doubles
+
+        for (size_t data_ptr = 0; data_ptr < chunk.rows; data_ptr++){
+            sum_cost += create_output(network_arr, workspace, input_arr[data_ptr], output_arr_true[data_ptr]);
+        }
     }
-    
+
+    thread_args->cost += sum_cost;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Prediction work of one thread on the linked list.
+The predictions of the data points are written into the outputs of the THREAD_DATA (the cost of the THREAD_ARGS is not touched).
+Runs as a job of the THREAD_POOL, so it may not exit the thread.*/
+void* predict_thread(void* args){
+
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+    THREAD_DATA* data_for_thread = thread_args->data;
+
+    for (size_t data_ptr = 0; data_ptr < data_for_thread->size; data_ptr++){
+        predict_output(thread_args->network_arr, thread_args->list_workspace, data_for_thread->input[data_ptr], data_for_thread->output[data_ptr]);
+    }
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Validation work of one thread on the linked list.
+Adds the summed cost of the predictions of its (held out) data points to the THREAD_ARGS, without deltas or derivatives.
+Runs as a job of the THREAD_POOL, so it may not exit the thread.*/
+void* validation_thread(void* args){
+
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    double prediction[NUM_OUTPUT];
+    double sum_cost = 0;
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    while (take_work_chunk(thread_args, &chunk)){
+        for (size_t data_ptr = chunk.first; data_ptr < chunk.first + chunk.rows; data_ptr++){
+            if (SOFTMAX_OUTPUT){
+                // The cross entropy is taken from the logits (the deltas written into prediction are not needed)
+                distribute_input_data(thread_args->network_arr, thread_args->list_workspace, chunk.data->input[data_ptr]);
+                propagate_inputs(thread_args->network_arr, thread_args->list_workspace);
+                sum_cost += softmax_cross_entropy_arr(thread_args->list_workspace->inputs + WORKING_NEURONS, chunk.data->output[data_ptr], prediction, NUM_OUTPUT);
+                continue;
+            }
+
+            predict_output(thread_args->network_arr, thread_args->list_workspace, chunk.data->input[data_ptr], prediction);
+
+            for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+                sum_cost += COST_FUNCTION(chunk.data->output[data_ptr][output_ptr], prediction[output_ptr]);
+            }
+        }
+    }
+
+    thread_args->cost += sum_cost;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+|--------------------------------------------------|
+| Training engine on the compiled DENSE_NETWORK    |
+|--------------------------------------------------|
+
+The dense engine pushes a batch of data points through the network at once.
+For a batch of size B, the inputs, outputs and deltas of a layer are [B][size of the layer] matrices
+starting at B * (position of the first neuron of the layer) in the workspace,
+so that every layer is computed as one matrix product.
+The workspace holds scalars (float in single and mixed precision), the training data and the cost stay double.
+*/
+
+/*
+This function distributes a batch of input data to the input layer of the dense network.
+The inputs of the layer are initialised with the biases, so that no reset is needed after the pass.*/
+inline void dense_distribute_input_data(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, double** input_data, size_t batch_size){
+    DENSE_LAYER* input_layer = &dense_network->layers[0];
+    scalar* inputs = workspace->inputs + batch_size * input_layer->pos;
+
+    // Start from the biases of the input layer
+    matrix_broadcast_row(dense_network->params + input_layer->biases_offset, inputs, batch_size, input_layer->size);
+
+    for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+        scalar* row = inputs + batch_ptr * input_layer->size;
+
+        // Same "double loop" as distribute_input_data() for more dimensions than input neurons
+        size_t pos = 0;
+        for (size_t ptr_dimension = 0; ptr_dimension < DIMENSIONS_DATA; ptr_dimension++){
+            if (pos == input_layer->size){
+                pos = 0;
+            }
+            row[pos] += (scalar) input_data[batch_ptr][ptr_dimension];
+            pos++;
+        }
+    }
+    return;
+}
+
+
+/*
+This function propagates a batch through the dense network, one layer (matrix product) at a time.
+Afterwards, the outputs of every layer (including the output layer) are activated in the workspace.
+With SOFTMAX_OUTPUT, the output layer is left to the softmax of its callers (fused with the cost in the forward pass).*/
+static inline void dense_propagate_layers(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, size_t batch_size){
+
+    scalar* params = dense_network->params;
+
+    // Propagate the outputs of every layer to the inputs of the next layer
+    for (size_t layer = 0; layer < NUMBER_LAYERS - 1; layer++){
+        DENSE_LAYER* this_layer = &dense_network->layers[layer];
+        DENSE_LAYER* next_layer = &dense_network->layers[layer + 1];
+
+        scalar* this_inputs = workspace->inputs + batch_size * this_layer->pos;
+        scalar* this_outputs = workspace->outputs + batch_size * this_layer->pos;
+        scalar* next_inputs = workspace->inputs + batch_size * next_layer->pos;
+
+        // 1.1 Activate this layer (kept for the backward pass)
+        ACTIVATION_FUNCTION_ARR(this_inputs, this_outputs, batch_size * this_layer->size);
+
+        // 1.2 Start from the biases of the next layer and add outputs * weights
+        matrix_broadcast_row(params + next_layer->biases_offset, next_inputs, batch_size, next_layer->size);
+        matrix_multiply_add(this_outputs, params + this_layer->weights_offset, next_inputs, batch_size, this_layer->size, this_layer->size_next);
+    }
+
+    if (SOFTMAX_OUTPUT){
+        return;
+    }
+
+    // Calculate the "actual" outputs of the batch
+    DENSE_LAYER* output_layer = &dense_network->layers[NUMBER_LAYERS - 1];
+    ACTIVATION_FUNCTION_ARR(workspace->inputs + batch_size * output_layer->pos, workspace->outputs + batch_size * output_layer->pos, batch_size * NUM_OUTPUT);
+    return;
+}
+
+
+/*
+This function manages the forward pass of a batch through the dense network, one layer (matrix product) at a time.
+Note that it already calculates the deltas for the output neurons.
+Returns the summed cost of the batch.*/
+inline double dense_forward_pass(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, double** output_data, size_t batch_size){
+
+    // 1. Propagate the outputs of every layer to the inputs of the next layer
+    dense_propagate_layers(dense_network, workspace, batch_size);
+
+    // 2. Get the outputs of the output layer and calculate their respective deltas
+    DENSE_LAYER* output_layer = &dense_network->layers[NUMBER_LAYERS - 1];
+    scalar* outputs = workspace->outputs + batch_size * output_layer->pos;
+    scalar* deltas = workspace->deltas + batch_size * output_layer->pos;
+    scalar* der_biases = workspace->der_params + output_layer->biases_offset;
+
+    double cost = 0;
+
+    if (SOFTMAX_OUTPUT){
+        // Softmax, cross entropy and the deltas (probabilities - labels) of the outputs of every data point at once
+        scalar* logits = workspace->inputs + batch_size * output_layer->pos;
+        for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+            cost += SCALAR_ARR(softmax_cross_entropy_arr)(logits + batch_ptr * NUM_OUTPUT, output_data[batch_ptr], deltas + batch_ptr * NUM_OUTPUT, NUM_OUTPUT);
+        }
+        matrix_add_column_sums(deltas, der_biases, batch_size, NUM_OUTPUT);
+        return cost;
+    }
+
+    for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+        for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+            size_t index = batch_ptr * NUM_OUTPUT + output_ptr;
+
+            double pred_output = outputs[index];
+
+            double act_output = output_data[batch_ptr][output_ptr];             // Retrieve the value of the output from the training data
+
+            double cost_der = COST_FUNCTION_DER(act_output, pred_output);       // Calculate the cost derivative associated to this output neuron
+
+            double delta = cost_der * ACTIVATION_FUNCTION_DER(pred_output);     // Calculate the delta of the neuron
+
+            cost += COST_FUNCTION(act_output, pred_output);
+
+            deltas[index] = (scalar) delta;
+            der_biases[output_ptr] += (scalar) delta;                           // Accumulated derivative of the bias
+        }
+    }
+    return cost;
+}
+
+
+/*
+Backwards pass of a batch through the dense network to calculate the derivatives and deltas for each layer.
+Only writes to the workspace, the parameters are not changed.*/
+void dense_backward_pass(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, size_t batch_size){
+
+    scalar* params = dense_network->params;
+    scalar* der_params = workspace->der_params;
+
+    // Walk backwards through the connected layers
+    for (int layer = NUMBER_LAYERS - 2; layer >= 0; layer--){
+        DENSE_LAYER* this_layer = &dense_network->layers[layer];
+        DENSE_LAYER* next_layer = &dense_network->layers[layer + 1];
+
+        size_t offset = batch_size * this_layer->pos; // Offset of the matrices of this layer in the workspace
+        scalar* this_outputs = workspace->outputs + offset;
+        scalar* this_deltas = workspace->deltas + offset;
+        scalar* next_deltas = workspace->deltas + batch_size * next_layer->pos;
+
+        // 1. Derivatives of the weights: outputs^T * deltas of the next layer
+        matrix_multiply_add_transposed_a(this_outputs, next_deltas, der_params + this_layer->weights_offset, this_layer->size, batch_size, this_layer->size_next);
+
+        // 2. Deltas of this layer: (deltas of the next layer * weights^T) times the derivative of the activation
+        // The outputs of this layer are not needed anymore and are overwritten with the derivatives of the activation
+        matrix_multiply_transposed_b(next_deltas, params + this_layer->weights_offset, this_deltas, batch_size, this_layer->size_next, this_layer->size);
+        ACTIVATION_FUNCTION_DER_ARR(workspace->inputs + offset, this_outputs, batch_size * this_layer->size);
+        for (size_t i = 0; i < batch_size * this_layer->size; i++){
+            this_deltas[i] *= this_outputs[i];
+        }
+
+        // 3. Derivatives of the biases: sum of the deltas of the batch
+        matrix_add_column_sums(this_deltas, der_params + this_layer->biases_offset, batch_size, this_layer->size);
+    }
+    return;
+}
+
+
+/*
+This function calculates the transformation of a batch of input data to the output with the dense network
+and accumulates the derivatives in the workspace.
+batch_size may not be bigger than BATCH_SIZE (the size of the workspace).
+Returns the summed cost of the batch.*/
+inline double dense_create_output(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, double** input_data, double** output_data, size_t batch_size){
+
+    PROFILE_BEGIN(forward_start);
+    dense_distribute_input_data(dense_network, workspace, input_data, batch_size);
+
+    double cost = dense_forward_pass(dense_network, workspace, output_data, batch_size);
+    PROFILE_END(forward_start, PHASE_FORWARD);
+
+    PROFILE_BEGIN(backward_start);
+    dense_backward_pass(dense_network, workspace, batch_size);
+    PROFILE_END(backward_start, PHASE_BACKWARD);
+
+    return cost;
+}
+
+
+/*
+This function predicts the outputs of a batch of input data with the dense network.
+Only runs the forward pass: no cost, deltas or derivatives are calculated, so the workspace needs no deltas and der_params.
+batch_size may not be bigger than BATCH_SIZE (the size of the workspace).*/
+void dense_predict_output(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, double** input_data, double** predictions, size_t batch_size){
+
+    dense_distribute_input_data(dense_network, workspace, input_data, batch_size);
+    dense_propagate_layers(dense_network, workspace, batch_size);
+
+    size_t offset = batch_size * dense_network->layers[NUMBER_LAYERS - 1].pos;
+    scalar* outputs = workspace->outputs + offset;
+    if (SOFTMAX_OUTPUT){
+        for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+            SCALAR_ARR(softmax_cross_entropy_arr)(workspace->inputs + offset + batch_ptr * NUM_OUTPUT, NULL, outputs + batch_ptr * NUM_OUTPUT, NUM_OUTPUT);
+        }
+    }
+    for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+        for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+            predictions[batch_ptr][output_ptr] = outputs[batch_ptr * NUM_OUTPUT + output_ptr];
+        }
+    }
+    return;
+}
+
+
+/*
+This function calculates the summed cost of a batch of data points with the dense network.
+Only runs the forward pass like dense_predict_output(), no deltas or derivatives are calculated.
+batch_size may not be bigger than BATCH_SIZE (the size of the workspace).*/
+double dense_validation_cost(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, double** input_data, double** output_data, size_t batch_size){
+
+    dense_distribute_input_data(dense_network, workspace, input_data, batch_size);
+    dense_propagate_layers(dense_network, workspace, batch_size);
+
+    size_t offset = batch_size * dense_network->layers[NUMBER_LAYERS - 1].pos;
+    scalar* outputs = workspace->outputs + offset;
+    double cost = 0;
+    for (size_t batch_ptr = 0; batch_ptr < batch_size; batch_ptr++){
+        if (SOFTMAX_OUTPUT){
+            // Cross entropy of the logits (the deltas written into the outputs are not needed)
+            cost += SCALAR_ARR(softmax_cross_entropy_arr)(workspace->inputs + offset + batch_ptr * NUM_OUTPUT, output_data[batch_ptr], outputs + batch_ptr * NUM_OUTPUT, NUM_OUTPUT);
+            continue;
+        }
+        for (size_t output_ptr = 0; output_ptr < NUM_OUTPUT; output_ptr++){
+            cost += COST_FUNCTION(output_data[batch_ptr][output_ptr], (double) outputs[batch_ptr * NUM_OUTPUT + output_ptr]);
+        }
+    }
+    return cost;
+}
+
+
+/*
+Work of one thread on the dense network.
+Every chunk of data points the thread takes is processed in batches of BATCH_SIZE data points.
+Accumulates the derivatives in the workspace of the thread and adds the summed cost to the THREAD_ARGS.*/
+void* dense_work_thread(void* args){
+
     // Cast thread args to the right type
     THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
 
     // Unpack the thread_args
+    DENSE_NETWORK* dense_network = thread_args->dense_network;
+    DENSE_WORKSPACE* workspace = thread_args->workspace;
+
+    // Sum up the cost locally and only write it once
+    double sum_cost = 0;
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    while (take_work_chunk(thread_args, &chunk)){
+        double** input_arr = chunk.data->input + chunk.first;
+        double** output_arr_true = chunk.data->output + chunk.first;
+
+        for (size_t data_ptr = 0; data_ptr < chunk.rows; data_ptr += BATCH_SIZE){
+            size_t batch_size = (chunk.rows - data_ptr < BATCH_SIZE) ? chunk.rows - data_ptr : BATCH_SIZE;
+
+            sum_cost += dense_create_output(dense_network, workspace, &input_arr[data_ptr], &output_arr_true[data_ptr], batch_size);
+        }
+    }
+
+    thread_args->cost += sum_cost;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Prediction work of one thread on the dense network.
+The data of the thread is processed in batches of BATCH_SIZE data points, the predictions are written into the outputs of the THREAD_DATA.*/
+void* dense_predict_thread(void* args){
+
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
     THREAD_DATA* data_for_thread = thread_args->data;
-    size_t pos_thread = thread_args->pos;              // Position of the thread in the Neural Network and Thread array
-    neuron** network_arr = thread_args->network_arr;   // Pointer to the Neural Network
-    
-    // Unpack the thread data
-    size_t num_data = data_for_thread->size;            // Number of input-output pairs of this thread
-    double** input_arr = data_for_thread->input;        // Array[num_data] of arrays[DIMENSIONS_INPUT] of input doubles
-    double** output_arr_true = data_for_thread->output; // Array of arrays[num_data] of output[NUM_OUTPUT] doubles
+    size_t num_data = data_for_thread->size;
 
-    // Case if the thread has no work to do
-    if (num_data == 0){
-        return SUCCESSFULL_EXECUTION_CODE;
+    for (size_t data_ptr = 0; data_ptr < num_data; data_ptr += BATCH_SIZE){
+        size_t batch_size = (num_data - data_ptr < BATCH_SIZE) ? num_data - data_ptr : BATCH_SIZE;
+
+        dense_predict_output(thread_args->dense_network, thread_args->workspace, &data_for_thread->input[data_ptr], &data_for_thread->output[data_ptr], batch_size);
     }
 
-    for (size_t data_ptr = 0; data_ptr < num_data; data_ptr++){
-        create_output(network_arr,input_arr[data_ptr], output_arr_true[data_ptr], pos_thread);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Validation work of one thread on the dense network.
+Every chunk of the (held out) data points the thread takes is processed in batches of BATCH_SIZE data points,
+the summed cost is added to the THREAD_ARGS.*/
+void* dense_validation_thread(void* args){
+
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    double sum_cost = 0;
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    while (take_work_chunk(thread_args, &chunk)){
+        double** input_arr = chunk.data->input + chunk.first;
+        double** output_arr = chunk.data->output + chunk.first;
+
+        for (size_t data_ptr = 0; data_ptr < chunk.rows; data_ptr += BATCH_SIZE){
+            size_t batch_size = (chunk.rows - data_ptr < BATCH_SIZE) ? chunk.rows - data_ptr : BATCH_SIZE;
+
+            sum_cost += dense_validation_cost(thread_args->dense_network, thread_args->workspace,
+                                              &input_arr[data_ptr], &output_arr[data_ptr], batch_size);
+        }
     }
 
+    thread_args->cost += sum_cost;
+
     return SUCCESSFULL_EXECUTION_CODE;
-}
\ No newline at end of file
+}
@@ -9,10 +9,27 @@ Includes structs.h to use THREAD_ARGS and THREAD_DATA*/
 #include "../cost_functions/cost_functions.h" // Include cost functions 
 
 void* work_thread(void*);
-void create_output(neuron**, double[DIMENSIONS_DATA], double[NUM_OUTPUT], size_t);
+double create_output(neuron**, LIST_WORKSPACE*, double[DIMENSIONS_DATA], double[NUM_OUTPUT]);
 
-void distribute_input_data(neuron**, double[DIMENSIONS_DATA], size_t);
-void forward_pass(neuron**, double[NUM_OUTPUT], size_t);
-void backward_pass(neuron**, size_t);
+void distribute_input_data(neuron**, LIST_WORKSPACE*, double[DIMENSIONS_DATA]);
+double forward_pass(neuron**, LIST_WORKSPACE*, double[NUM_OUTPUT]);
+void backward_pass(neuron**, LIST_WORKSPACE*);
+
+void* predict_thread(void*);
+void predict_output(neuron**, LIST_WORKSPACE*, double[DIMENSIONS_DATA], double[NUM_OUTPUT]);
+void* validation_thread(void*);
+
+void* dense_work_thread(void*);
+double dense_create_output(DENSE_NETWORK*, DENSE_WORKSPACE*, double**, double**, size_t);
+
+void dense_distribute_input_data(DENSE_NETWORK*, DENSE_WORKSPACE*, double**, size_t);
+double dense_forward_pass(DENSE_NETWORK*, DENSE_WORKSPACE*, double**, size_t);
+void dense_backward_pass(DENSE_NETWORK*, DENSE_WORKSPACE*, size_t);
+
+void* dense_predict_thread(void*);
+void dense_predict_output(DENSE_NETWORK*, DENSE_WORKSPACE*, double**, double**, size_t);
+
+void* dense_validation_thread(void*);
+double dense_validation_cost(DENSE_NETWORK*, DENSE_WORKSPACE*, double**, double**, size_t);
 
 #endif // FEED_FORWARD_H
\ No newline at end of file
@@ -21,7 +21,7 @@ For testing purposes:
 
 
 // Basic test
-void test1(neuron** network_arr){
+void test1(neuron** network_arr, LIST_WORKSPACE* workspace){
 
     // Manipulate the neural network such that we have easy to work with data
     set_bias(network_arr, 0, 0); // Set the bias for node 0 to 0
@@ -31,7 +31,7 @@ void test1(neuron** network_arr){
 
     double input[1] = {4};
     double output[1] = {8};
-    create_output(network_arr, input, output, 0);
+    create_output(network_arr, workspace, input, output);
 
     /*
     The output should be: 
@@ -40,14 +40,14 @@ void test1(neuron** network_arr){
     */
 
    // Use the delta to check if we got the right answer
-   double delta = network_arr[1]->delta[0];
+   double delta = workspace->deltas[1];
 
    COMPARE(delta, 0);
    return;
 }
 
 // Basic test
-void test2(neuron** network_arr){
+void test2(neuron** network_arr, LIST_WORKSPACE* workspace){
 
     // Manipulate the neural network such that we have easy to work with data
     set_bias(network_arr, 0, 1); // Set the bias for node 0 to 1
@@ -57,7 +57,7 @@ void test2(neuron** network_arr){
 
     double input[1] = {4};
     double output[1] = {11};
-    create_output(network_arr, input, output, 0);
+    create_output(network_arr, workspace, input, output);
 
     /*
     The output should be: 
@@ -66,14 +66,14 @@ void test2(neuron** network_arr){
     */
 
    // Use the delta to check if we got the right answer
-   double delta = network_arr[1]->delta[0];
+   double delta = workspace->deltas[1];
 
    COMPARE(delta, 0);
    return;
 }
 
 // Basic test
-void test3(neuron** network_arr){
+void test3(neuron** network_arr, LIST_WORKSPACE* workspace){
 
     // Manipulate the neural network such that we have easy to work with data
     set_bias(network_arr, 0, 0); // Set the bias for node 0 to 0
@@ -84,7 +84,7 @@ void test3(neuron** network_arr){
     double input[1] = {8};
     double output[1] = {0};
 
-    create_output(network_arr, input, output, 0);
+    create_output(network_arr, workspace, input, output);
 
     /*
     The output should be: 
@@ -92,14 +92,14 @@ void test3(neuron** network_arr){
     */
 
    // Use the delta to check if we got the right answer
-   double delta = network_arr[1]->delta[0];
+   double delta = workspace->deltas[1];
 
    COMPARE(delta, 0);
    return;
 }
 
 // Test for delta != 0
-void test4(neuron** network_arr){
+void test4(neuron** network_arr, LIST_WORKSPACE* workspace){
 
     // Manipulate the neural network such that we have easy to work with data
     set_bias(network_arr, 0, -1); // Set the bias for node 0 to -1
@@ -109,7 +109,7 @@ void test4(neuron** network_arr){
 
     double input[1] = {-3};
     double output[1] = {4};
-    create_output(network_arr, input, output, 0);
+    create_output(network_arr, workspace, input, output);
 
     /*
     The output should be: 
@@ -118,7 +118,7 @@ void test4(neuron** network_arr){
     */
 
    // Use the delta to check if we got the right answer
-   double delta = network_arr[1]->delta[0]; 
+   double delta = workspace->deltas[1]; 
 
    // Calculate the delta (as the expected output is not the output of the NN)
    // cost_der = 4-2 = 2
@@ -130,7 +130,7 @@ void test4(neuron** network_arr){
 }
 
 // Multiprocessing test
-int test5(neuron** network_array){
+int test5(neuron** network_array, LIST_WORKSPACE* list_workspaces){
 
     // Manipulate the neural network such that we have easy to work with data
     set_bias(network_array, 0, 0); // Set the bias for node 0 to 0
@@ -220,6 +220,7 @@ int test5(neuron** network_array){
         thread_args_arr[thread_pos].pos = thread_pos;
         thread_args_arr[thread_pos].data = &thread_data[thread_pos]; // Pointer to the THREAD_DATA datastructure for this thread
         thread_args_arr[thread_pos].network_arr = network_array;
+        thread_args_arr[thread_pos].list_workspace = &list_workspaces[thread_pos];
     }
 
     // 3.3 Distribute the workload among the threads and run them
@@ -252,9 +253,10 @@ int test5(neuron** network_array){
   }
 
     for (int i = 0; i < NUM_THREADS; i++){
-        double act = network_array[1]->delta[i];
+        double act = list_workspaces[i].deltas[1];
         double exp = 0; // We expect a delta of 0, as the input is the right one
         COMPARE(act, exp);
+        COMPARE(thread_args_arr[i].cost, 0);
     }
 
 free_thread_args_arr:
@@ -266,6 +268,140 @@ exit:
 }
 
 
+// Workspace test
+void test6(neuron** network_arr, LIST_WORKSPACE* list_workspaces){
+
+    // Every workspace starts at a cache line
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        assert((size_t) list_workspaces[i].inputs % cache_line_size() == 0);
+        assert(list_workspaces[i].capacity == NUM_CONNECTIONS);
+    }
+
+    // Accumulated derivatives are kept when the workspaces grow for a new connection
+    size_t old_index = network_arr[0]->next_layer->index;
+    list_workspaces[0].der_weights[old_index] = 5;
+    list_workspaces[0].der_biases[1] = 3;
+
+    assert(del_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(add_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(update_list_workspaces(list_workspaces) == SUCCESSFULL_EXECUTION_CODE);
+
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        assert((size_t) list_workspaces[i].inputs % cache_line_size() == 0);
+        assert(list_workspaces[i].capacity == NUM_CONNECTIONS);
+        assert(network_arr[0]->next_layer->index < list_workspaces[i].capacity);
+    }
+    assert(network_arr[0]->next_layer->index != old_index); // Indices are never reused
+    COMPARE(list_workspaces[0].der_weights[old_index], 5);
+    COMPARE(list_workspaces[0].der_biases[1], 3);
+    COMPARE(list_workspaces[0].der_weights[network_arr[0]->next_layer->index], 0);
+    return;
+}
+
+
+// Prediction test (forward pass only, on the linked list and on the dense network)
+void test7(neuron** network_arr, LIST_WORKSPACE* list_workspaces){
+
+    set_bias(network_arr, 0, 0.5);
+    set_bias(network_arr, 1, -1);
+    network_arr[0]->next_layer->weight = 2;
+
+    // More data points than BATCH_SIZE, so that the dense engine predicts more than one batch
+    double inputs[5][1] = {{-2}, {0.5}, {3}, {7}, {1}};
+    double expected[5] = {0, 1, 6, 14, 2}; // relu(relu(input + 0.5) * 2 - 1)
+    double predictions[5][1];
+    double* input_rows[5];
+    double* prediction_rows[5];
+    for (size_t i = 0; i < 5; i++){
+        input_rows[i] = inputs[i];
+        prediction_rows[i] = predictions[i];
+    }
+
+    THREAD_DATA thread_data = {5, input_rows, prediction_rows, NULL};
+    THREAD_ARGS thread_args = {0};
+    thread_args.data = &thread_data;
+    thread_args.network_arr = network_arr;
+    thread_args.list_workspace = &list_workspaces[0];
+    thread_args.cost = 3;
+
+    // 1. Linked list
+    predict_thread((void*) &thread_args);
+    for (size_t i = 0; i < 5; i++){
+        COMPARE(predictions[i][0], expected[i]);
+        predictions[i][0] = 0;
+    }
+    COMPARE(thread_args.cost, 3); // The predictions do not calculate a cost
+
+    // 2. Dense network, the workspaces only hold the inputs and outputs
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    assert(dense_network != NULL);
+    DENSE_WORKSPACE* dense_workspaces = initialise_dense_predict_workspaces(dense_network);
+    assert(dense_workspaces != NULL);
+    assert(dense_workspaces[0].deltas == NULL && dense_workspaces[0].der_params == NULL);
+
+    thread_args.dense_network = dense_network;
+    thread_args.workspace = &dense_workspaces[0];
+    dense_predict_thread((void*) &thread_args);
+    for (size_t i = 0; i < 5; i++){
+        COMPARE(predictions[i][0], expected[i]);
+    }
+    COMPARE(thread_args.cost, 3);
+
+    free_dense_workspaces(dense_workspaces);
+    free_dense_network(dense_network);
+    return;
+}
+
+
+// Validation test (cost of the forward pass only, on the linked list and on the dense network)
+void test8(neuron** network_arr, LIST_WORKSPACE* list_workspaces){
+
+    set_bias(network_arr, 0, 0.5);
+    set_bias(network_arr, 1, -1);
+    network_arr[0]->next_layer->weight = 2;
+
+    // Predictions are {0, 1, 6, 14, 2} (see test7), so the summed cost is (1 + 0 + 1 + 0 + 4) / 2 = 3
+    double inputs[5][1] = {{-2}, {0.5}, {3}, {7}, {1}};
+    double outputs[5][1] = {{1}, {1}, {5}, {14}, {0}};
+    double* input_rows[5];
+    double* output_rows[5];
+    for (size_t i = 0; i < 5; i++){
+        input_rows[i] = inputs[i];
+        output_rows[i] = outputs[i];
+    }
+
+    THREAD_DATA thread_data = {5, input_rows, output_rows, NULL};
+    THREAD_ARGS thread_args = {0};
+    thread_args.data = &thread_data;
+    thread_args.network_arr = network_arr;
+    thread_args.list_workspace = &list_workspaces[0];
+    thread_args.cost = 1;
+
+    // 1. Linked list (the cost is added)
+    validation_thread((void*) &thread_args);
+    COMPARE(thread_args.cost, 4);
+    COMPARE(outputs[4][0], 0); // The outputs are not overwritten by the predictions
+
+    // 2. Dense network, the derivatives are not touched
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    assert(dense_network != NULL);
+    DENSE_WORKSPACE* dense_workspaces = initialise_dense_workspaces(dense_network);
+    assert(dense_workspaces != NULL);
+
+    thread_args.dense_network = dense_network;
+    thread_args.workspace = &dense_workspaces[0];
+    thread_args.cost = 0;
+    dense_validation_thread((void*) &thread_args);
+    COMPARE(thread_args.cost, 3);
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        COMPARE(dense_workspaces[0].der_params[i], 0);
+    }
+
+    free_dense_workspaces(dense_workspaces);
+    free_dense_network(dense_network);
+    return;
+}
+
 
 /*
 Function that manages the Testing*/
@@ -288,28 +424,58 @@ int test_handler_func(void){
         return OTHER_ERROR;
     }
 
+    // Create the workspaces of the threads
+    LIST_WORKSPACE* list_workspaces = initialise_list_workspaces();
+    if (!list_workspaces){
+        printf("Allocating the workspaces was unsuccessfull in test_feed_forward.\n");
+        free_network(network_arr);
+        return OTHER_ERROR;
+    }
+
 
     /***********************************
      * Test the create_output function *
      ***********************************/
 
-    test1(network_arr);
-    test2(network_arr);
-    test3(network_arr);
-    test4(network_arr);
+    test1(network_arr, &list_workspaces[0]);
+    test2(network_arr, &list_workspaces[0]);
+    test3(network_arr, &list_workspaces[0]);
+    test4(network_arr, &list_workspaces[0]);
 
 
     /*********************************
      * Test the threading capability *
      *********************************/
 
-    if(SUCCESSFULL_EXECUTION_CODE != test5(network_arr)){
+    if(SUCCESSFULL_EXECUTION_CODE != test5(network_arr, list_workspaces)){
         printf("Problem with the multiprocessing.\n");
         return OTHER_ERROR;
     }
 
 
+    /***************************
+     * Test the workspaces     *
+     ***************************/
+
+    test6(network_arr, list_workspaces);
+
+
+    /***************************
+     * Test the predictions    *
+     ***************************/
+
+    test7(network_arr, list_workspaces);
+
+
+    /***************************
+     * Test the validation     *
+     ***************************/
+
+    test8(network_arr, list_workspaces);
+
+
     printf("All tests for feed_forward successfully executed.\n");
+    free_list_workspaces(list_workspaces);
     free_network(network_arr);
     return return_code;
 }
@@ -6,14 +6,19 @@
 #include "../../../configurations/config_manager.h"
 #include "../feed_forward.h"
 #include "../../neurons/neurons.h"
+#include "../../dense_network/dense_network.h"
 #include "../../helper_functions/helper_functions.h"
+#include "../../system_info/system_info.h"
 
-void test1(neuron**);
-void test2(neuron**);
-void test3(neuron**);
-void test4(neuron**);
+void test1(neuron**, LIST_WORKSPACE*);
+void test2(neuron**, LIST_WORKSPACE*);
+void test3(neuron**, LIST_WORKSPACE*);
+void test4(neuron**, LIST_WORKSPACE*);
 
-int test5(neuron**);
+int test5(neuron**, LIST_WORKSPACE*);
+void test6(neuron**, LIST_WORKSPACE*);
+void test7(neuron**, LIST_WORKSPACE*);
+void test8(neuron**, LIST_WORKSPACE*);
 
 
 int test_handler_func(void);
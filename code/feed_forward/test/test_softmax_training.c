@@ -0,0 +1,178 @@
+/*
+Test file for the training with the softmax output layer (multi-class classification).
+May not be included in any other files. Its own purpose is for testing.
+
+Built by make test_softmax_training with NUM_OUTPUT 3 and SOFTMAX_OUTPUT 1 (see the Makefile), so that the test config
+has a network of one input neuron and 3 output neurons trained on SIZE_TRAIN data points of 3 classes.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h> // For fabs and exp
+
+#include "test_softmax_training.h"
+
+#if NUM_OUTPUT != 3 || !SOFTMAX_OUTPUT
+#error "The softmax training is tested on 3 classes, build it with make test_softmax_training"
+#endif
+
+// Generations of the training test (one update of the params per generation)
+#define TEST_GENERATIONS 1000
+
+// Data points of the 3 classes, separable by the one input: the intervals [10, 11], [15, 16] and [20, 21]
+// (far from 0, so that the relu of the input neuron stays active while its bias is trained)
+static double INPUT_VALUES[SIZE_TRAIN][1] = {{10}, {15}, {20}, {11}, {16}, {21}};
+static double LABEL_VALUES[SIZE_TRAIN][NUM_OUTPUT] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+static const size_t CLASSES[SIZE_TRAIN] = {0, 1, 2, 0, 1, 2};
+
+
+/*
+Tests the forward pass of one batch: the outputs are the probabilities of the softmax of the logits (they sum up to 1)
+and the deltas of the output layer are the probabilities minus the labels*/
+void test_softmax_forward_pass(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace){
+
+    double* input[BATCH_SIZE];
+    double* labels[BATCH_SIZE];
+    double prediction_values[BATCH_SIZE][NUM_OUTPUT];
+    double* predictions[BATCH_SIZE];
+    for (size_t row = 0; row < BATCH_SIZE; row++){
+        input[row] = INPUT_VALUES[row];
+        labels[row] = LABEL_VALUES[row];
+        predictions[row] = prediction_values[row];
+    }
+
+    DENSE_LAYER* input_layer = &dense_network->layers[0];
+    DENSE_LAYER* output_layer = &dense_network->layers[NUMBER_LAYERS - 1];
+
+    dense_distribute_input_data(dense_network, workspace, input, BATCH_SIZE);
+    double cost = dense_forward_pass(dense_network, workspace, labels, BATCH_SIZE);
+
+    // Keep the deltas, the predictions overwrite the outputs of the workspace
+    scalar deltas[BATCH_SIZE * NUM_OUTPUT];
+    memcpy(deltas, workspace->deltas + BATCH_SIZE * output_layer->pos, sizeof(deltas));
+    dense_predict_output(dense_network, workspace, input, predictions, BATCH_SIZE);
+
+    double expected_cost = 0;
+    for (size_t row = 0; row < BATCH_SIZE; row++){
+
+        // Logits of the one input neuron (relu) times its weights plus the biases of the outputs
+        double hidden = INPUT_VALUES[row][0] + dense_network->params[input_layer->biases_offset];
+        hidden = hidden > 0 ? hidden : 0;
+        double exps[NUM_OUTPUT];
+        double sum_exps = 0;
+        for (size_t k = 0; k < NUM_OUTPUT; k++){
+            exps[k] = exp(dense_network->params[output_layer->biases_offset + k] + hidden * dense_network->params[input_layer->weights_offset + k]);
+            sum_exps += exps[k];
+        }
+
+        double sum_probabilities = 0;
+        for (size_t k = 0; k < NUM_OUTPUT; k++){
+            COMPARE(predictions[row][k], exps[k] / sum_exps);
+            COMPARE(deltas[row * NUM_OUTPUT + k], predictions[row][k] - LABEL_VALUES[row][k]);
+            sum_probabilities += predictions[row][k];
+        }
+        COMPARE(sum_probabilities, 1);
+        expected_cost -= log(exps[CLASSES[row]] / sum_exps);
+    }
+    COMPARE(cost, expected_cost);
+
+    // The derivatives of the biases of the outputs are the summed deltas, the training starts from 0 again
+    for (size_t k = 0; k < NUM_OUTPUT; k++){
+        double sum_deltas = 0;
+        for (size_t row = 0; row < BATCH_SIZE; row++){
+            sum_deltas += deltas[row * NUM_OUTPUT + k];
+        }
+        COMPARE(workspace->der_params[output_layer->biases_offset + k], sum_deltas);
+    }
+    memset(workspace->der_params, 0, dense_network->num_params * sizeof(scalar));
+    return;
+}
+
+
+/*
+Tests the training on the 3 classes: the cost of the generations falls and every data point is classified correctly afterwards*/
+void test_softmax_training(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces){
+
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_ADAM, dense_network->num_params);
+    assert(optimizer);
+
+    double* input[SIZE_TRAIN];
+    double* labels[SIZE_TRAIN];
+    for (size_t row = 0; row < SIZE_TRAIN; row++){
+        input[row] = INPUT_VALUES[row];
+        labels[row] = LABEL_VALUES[row];
+    }
+
+    double first_cost = 0, last_cost = 0;
+    for (size_t generation = 0; generation < TEST_GENERATIONS; generation++){
+        double cost = 0;
+        for (size_t first = 0; first < SIZE_TRAIN; first += BATCH_SIZE){
+            size_t batch_size = (SIZE_TRAIN - first < BATCH_SIZE) ? SIZE_TRAIN - first : BATCH_SIZE;
+            cost += dense_create_output(dense_network, &workspaces[0], &input[first], &labels[first], batch_size);
+        }
+        next_optimizer_step(optimizer);
+        dense_gradient_descent(dense_network, workspaces, optimizer);
+
+        first_cost = (generation == 0) ? cost : first_cost;
+        last_cost = cost;
+    }
+    assert(last_cost < first_cost / 4);
+
+    // The most likely class of every data point is its label
+    double prediction_values[SIZE_TRAIN][NUM_OUTPUT];
+    double* predictions[SIZE_TRAIN];
+    for (size_t row = 0; row < SIZE_TRAIN; row++){
+        predictions[row] = prediction_values[row];
+    }
+    for (size_t first = 0; first < SIZE_TRAIN; first += BATCH_SIZE){
+        size_t batch_size = (SIZE_TRAIN - first < BATCH_SIZE) ? SIZE_TRAIN - first : BATCH_SIZE;
+        dense_predict_output(dense_network, &workspaces[0], &input[first], &predictions[first], batch_size);
+    }
+    for (size_t row = 0; row < SIZE_TRAIN; row++){
+        size_t best = 0;
+        for (size_t k = 1; k < NUM_OUTPUT; k++){
+            best = (predictions[row][k] > predictions[row][best]) ? k : best;
+        }
+        assert(best == CLASSES[row]);
+    }
+
+    free_optimizer(optimizer);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_softmax_training.\n");
+        return OTHER_ERROR;
+    }
+    // Note that the network array will be freed in the function
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    DENSE_WORKSPACE* workspaces = dense_network ? initialise_dense_workspaces(dense_network) : NULL;
+    assert(dense_network && workspaces);
+
+    test_softmax_forward_pass(dense_network, &workspaces[0]);
+    test_softmax_training(dense_network, workspaces);
+
+    printf("All tests for the softmax training successfully executed.\n");
+    free_dense_workspaces(workspaces);
+    free_dense_network(dense_network);
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,20 @@
+/*
+Header file for the test of the training with the softmax output layer.
+May only be included in its own .c file.
+*/
+
+#ifndef TEST_SOFTMAX_TRAINING_H
+#define TEST_SOFTMAX_TRAINING_H
+
+#include "../../../configurations/config_manager.h"
+#include "../feed_forward.h"
+#include "../../neurons/neurons.h"
+#include "../../dense_network/dense_network.h"
+#include "../../gradient_descent/gradient_descent.h"
+
+void test_softmax_forward_pass(DENSE_NETWORK*, DENSE_WORKSPACE*);
+void test_softmax_training(DENSE_NETWORK*, DENSE_WORKSPACE*);
+
+int test_handler_func(void);
+
+#endif //TEST_SOFTMAX_TRAINING_H
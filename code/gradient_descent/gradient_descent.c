@@ -3,16 +3,231 @@ File for gradient descent of the Neural Network.
 This file may change the attributes of the Neural Network in place.
 It takes a sole (!) total_cost variable to update the weights.
 Note that it changes the weigths in-place
+
+The step of every param is computed by the OPTIMIZER (see structs.h):
+- sgd:      param -= LEARNING_RATE * derivative
+- momentum: the velocity adds up the derivatives (decayed by MOMENTUM_DECAY) and is the step
+- rmsprop:  the step is divided by the root of the (decayed) mean of the squared derivatives
+- adam:     momentum and rmsprop together, with the bias correction of the means (Kingma & Ba, 2015)
+On the dense network, the moments and the params of a shard are updated in one fused pass over contiguous arrays.
+A NULL OPTIMIZER is plain sgd.
+In the asynchronous training (--hogwild) every thread applies the updates of its own derivatives, see dense_hogwild_thread().
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
 #include "gradient_descent.h"
+#include "../feed_forward/feed_forward.h"
+#include "../system_info/system_info.h"
+#include "../profiling/profiling.h"
+
+// Names of the optimizers for --optimizer (indexed by the type)
+static const char* const OPTIMIZER_NAMES[NUMBER_OPTIMIZERS] = {"sgd", "momentum", "rmsprop", "adam"};
+
+
+/*
+Returns the type of the optimizer with the name, or -1 if there is none*/
+int parse_optimizer(const char* name){
+    for (int type = 0; type < NUMBER_OPTIMIZERS; type++){
+        if (strcmp(name, OPTIMIZER_NAMES[type]) == 0){
+            return type;
+        }
+    }
+    return -1;
+}
+
+
+/*
+Returns the name of the type of optimizer*/
+const char* optimizer_name(int type){
+    return (type >= 0 && type < NUMBER_OPTIMIZERS) ? OPTIMIZER_NAMES[type] : "unknown";
+}
+
+
+/*
+Returns 1 if the optimizer keeps the mean of the derivatives (first_moment), else 0*/
+static inline int uses_first_moment(int type){
+    return type == OPTIMIZER_MOMENTUM || type == OPTIMIZER_ADAM;
+}
+
+
+/*
+Returns 1 if the optimizer keeps the mean of the squared derivatives (second_moment), else 0*/
+static inline int uses_second_moment(int type){
+    return type == OPTIMIZER_RMSPROP || type == OPTIMIZER_ADAM;
+}
+
+
+/*
+Function to create an OPTIMIZER with (zeroed) moments for num_values params.
+Returns NULL if it fails*/
+OPTIMIZER* create_optimizer(int type, size_t num_values){
+
+    OPTIMIZER* optimizer = calloc(1, sizeof(OPTIMIZER));
+    if (!optimizer){
+        perror("Memory allocation error when trying to allocate the OPTIMIZER.\n");
+        return NULL;
+    }
+    optimizer->type = type;
+    optimizer->learning_rate = LEARNING_RATE;
+
+    if (resize_optimizer(optimizer, num_values) != SUCCESSFULL_EXECUTION_CODE){
+        free_optimizer(optimizer);
+        return NULL;
+    }
+    return optimizer;
+}
+
+
+/*
+Grows one array of moments to num_values (the existing moments are kept, the new ones start at 0).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+static int grow_moment(double** moment, size_t old_values, size_t num_values){
+    double* grown = cache_aligned_calloc(num_values * sizeof(double));
+    if (!grown){
+        printf("Memory allocation error when trying to grow the moments of the OPTIMIZER to %zu params.\n", num_values);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    if (*moment){
+        memcpy(grown, *moment, old_values * sizeof(double));
+        free(*moment);
+    }
+    *moment = grown;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to grow the moments of the OPTIMIZER to num_values params (if connections were added to the linked list).
+Has to be called between two generations.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+int resize_optimizer(OPTIMIZER* optimizer, size_t num_values){
+    if (num_values <= optimizer->num_values){
+        return SUCCESSFULL_EXECUTION_CODE;
+    }
+
+    if (uses_first_moment(optimizer->type) && grow_moment(&optimizer->first_moment, optimizer->num_values, num_values) != SUCCESSFULL_EXECUTION_CODE){
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    if (uses_second_moment(optimizer->type) && grow_moment(&optimizer->second_moment, optimizer->num_values, num_values) != SUCCESSFULL_EXECUTION_CODE){
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    optimizer->num_values = num_values;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to continue with the optimizer state of a checkpoint (see save_checkpoint()).
+The state has to belong to the same type of optimizer and to the same number of params.
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR (the OPTIMIZER is not changed in this case)*/
+int restore_optimizer(OPTIMIZER* optimizer, const CHECKPOINT* checkpoint){
+
+    const CHECKPOINT_HEADER* header = checkpoint->header;
+    size_t expected_values = (uses_first_moment(optimizer->type) + uses_second_moment(optimizer->type)) * optimizer->num_values;
+
+    if (header->optimizer_type != (uint64_t) optimizer->type || header->optimizer_values != expected_values){
+        printf("The checkpoint holds the state of %s for %zu values, not of %s for %zu values.\n",
+               optimizer_name((int) header->optimizer_type), (size_t) header->optimizer_values, optimizer_name(optimizer->type), expected_values);
+        return OTHER_ERROR;
+    }
+
+    const double* state = checkpoint->optimizer_state;
+    if (optimizer->first_moment){
+        memcpy(optimizer->first_moment, state, optimizer->num_values * sizeof(double));
+        state += optimizer->num_values;
+    }
+    if (optimizer->second_moment){
+        memcpy(optimizer->second_moment, state, optimizer->num_values * sizeof(double));
+    }
+    optimizer->step = header->optimizer_step;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Returns the step size of the update number step of an optimizer of the type (Adam folds the bias correction of both means into it)*/
+static double step_learning_rate(int type, size_t step){
+    switch (type){
+        case OPTIMIZER_RMSPROP:
+            return ADAPTIVE_LEARNING_RATE;
+        case OPTIMIZER_ADAM:
+            return ADAPTIVE_LEARNING_RATE * sqrt(1 - pow(SQUARED_DECAY, (double) step)) / (1 - pow(MOMENTUM_DECAY, (double) step));
+        default:
+            return LEARNING_RATE;
+    }
+}
+
+
+/*
+Function to start the next update of the OPTIMIZER (called once per synchronous update, before the gradient descent).
+Sets the step size of the update.*/
+void next_optimizer_step(OPTIMIZER* optimizer){
+    size_t step = atomic_fetch_add_explicit(&optimizer->step, 1, memory_order_relaxed) + 1;
+    optimizer->learning_rate = step_learning_rate(optimizer->type, step);
+}
+
+
+/*
+Function to free the OPTIMIZER*/
+void free_optimizer(OPTIMIZER* optimizer){
+    free(optimizer->first_moment);
+    free(optimizer->second_moment);
+    free(optimizer);
+}
+
+
+/*
+Steps of the optimizers for one param (derivative is the average derivative of the training data).
+They update the moments of the param and return the value subtracted from it.
+They are inlined into the loops of the fused kernels, so that these loops stay free of calls.*/
+static inline __attribute__((always_inline)) double momentum_step(double* velocity, double derivative, double learning_rate){
+    *velocity = MOMENTUM_DECAY * *velocity + derivative;
+    return learning_rate * *velocity;
+}
+
+static inline __attribute__((always_inline)) double rmsprop_step(double* squared, double derivative, double learning_rate){
+    *squared = SQUARED_DECAY * *squared + (1 - SQUARED_DECAY) * derivative * derivative;
+    return learning_rate * derivative / (sqrt(*squared) + OPTIMIZER_EPSILON);
+}
+
+static inline __attribute__((always_inline)) double adam_step(double* mean, double* squared, double derivative, double learning_rate){
+    *mean = MOMENTUM_DECAY * *mean + (1 - MOMENTUM_DECAY) * derivative;
+    *squared = SQUARED_DECAY * *squared + (1 - SQUARED_DECAY) * derivative * derivative;
+    return learning_rate * *mean / (sqrt(*squared) + OPTIMIZER_EPSILON);
+}
+
 
 /*
-Update of the parameters for one neuron.*/
-inline void gradient_descent_neuron(neuron* this_neuron){
+Step of the param at index of the OPTIMIZER (plain sgd if the OPTIMIZER is NULL)*/
+static inline double optimizer_step(OPTIMIZER* optimizer, size_t index, double derivative){
+    if (!optimizer){
+        return LEARNING_RATE * derivative;
+    }
+
+    switch (optimizer->type){
+        case OPTIMIZER_MOMENTUM:
+            return momentum_step(&optimizer->first_moment[index], derivative, optimizer->learning_rate);
+        case OPTIMIZER_RMSPROP:
+            return rmsprop_step(&optimizer->second_moment[index], derivative, optimizer->learning_rate);
+        case OPTIMIZER_ADAM:
+            return adam_step(&optimizer->first_moment[index], &optimizer->second_moment[index], derivative, optimizer->learning_rate);
+        default:
+            return optimizer->learning_rate * derivative;
+    }
+}
+
+
+/*
+Update of the parameters for one neuron.
+Sums up the derivatives of the workspaces of all threads and resets them to 0.
+The moments of the bias are at the position of the neuron, those of a weight at LENGTH_NETWORK + the index of its connection.*/
+inline void gradient_descent_neuron(neuron* this_neuron, LIST_WORKSPACE* workspaces, OPTIMIZER* optimizer){
+
+    size_t pos = this_neuron->pos;
 
     /**********************
      * 1. Update the bias *
@@ -21,18 +236,11 @@ inline void gradient_descent_neuron(neuron* this_neuron){
     double bias_der = 0;
     // Sum up all the biases calculated from the different threads
     for (size_t i = 0; i < NUM_THREADS; i++){
-        bias_der += this_neuron->der_biases[i];
-        this_neuron->der_biases[i] = 0;                             // Reset the derivative to 0
+        bias_der += workspaces[i].der_biases[pos];
+        workspaces[i].der_biases[pos] = 0;                          // Reset the derivative to 0
     }
 
-    double new_bias = this_neuron->bias - LEARNING_RATE * (bias_der / SIZE_TRAIN); // Updated bias
-
-    this_neuron->bias = new_bias;
-
-    // Set the input equal to the bias (design choice)
-    for (size_t i = 0; i < NUM_THREADS; i++){
-        this_neuron->input[i] = new_bias;
-    }
+    this_neuron->bias -= optimizer_step(optimizer, pos, bias_der / SIZE_TRAIN);  // Updated bias
 
     /*************************
      * 2. Update the weigths *
@@ -43,48 +251,274 @@ inline void gradient_descent_neuron(neuron* this_neuron){
         double weight_der = 0;
 
         for (size_t i = 0; i < NUM_THREADS; i++){
-            weight_der += con->der_weight[i];
-            con->der_weight[i] = 0;                             // Reset the derivative to 0
+            weight_der += workspaces[i].der_weights[con->index];
+            workspaces[i].der_weights[con->index] = 0;              // Reset the derivative to 0
         }
-        con->weight -= (weight_der / SIZE_TRAIN) * LEARNING_RATE;
+        con->weight -= optimizer_step(optimizer, LENGTH_NETWORK + con->index, weight_der / SIZE_TRAIN);
 
         con = con->next;
     }
 }
 
+/*
+Update of the parameters (only the bias) for one output neuron.*/
+inline void gradient_descent_output_neuron(neuron* output_neuron, LIST_WORKSPACE* workspaces, OPTIMIZER* optimizer){
+
+    size_t pos = output_neuron->pos;
+
+    double bias_der = 0;
+    // Sum up all the biases calculated from the different threads
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        bias_der += workspaces[i].der_biases[pos];
+        workspaces[i].der_biases[pos] = 0;                          // Reset the derivative to 0
+    }
+
+    output_neuron->bias -= optimizer_step(optimizer, pos, bias_der / SIZE_TRAIN); // Updated bias
+}
+
+/*
+Gradient descent for the neurons at the positions [start, end) of the Neural Network.
+Neurons are independent of each other, so different ranges can be updated by different threads.*/
+void gradient_descent_range(neuron** network_arr, LIST_WORKSPACE* workspaces, OPTIMIZER* optimizer, size_t start, size_t end){
+    PROFILE_BEGIN(update_start);
+    for (size_t pos = start; pos < end; pos++){
+        if (pos < WORKING_NEURONS){
+            // 1. Input/ hidden layers
+            gradient_descent_neuron(network_arr[pos], workspaces, optimizer);
+        } else{
+            // 2. Output layer (only bias)
+            gradient_descent_output_neuron(network_arr[pos], workspaces, optimizer);
+        }
+    }
+    PROFILE_END(update_start, PHASE_UPDATE); // The linked list sums up the derivatives of the threads in the same loop
+}
+
 /*
 Gradient descent function to make the Neural Network learn.
 Note that this updates the Neural Network in-place.
 Nothing is returned.
 No errors will be caught.*/
-void gradient_descent(neuron** network_arr){
+void gradient_descent(neuron** network_arr, LIST_WORKSPACE* workspaces, OPTIMIZER* optimizer){
+    gradient_descent_range(network_arr, workspaces, optimizer, 0, LENGTH_NETWORK);
+}
 
-    // 1. Update all input/ hidden layers
-    size_t pos;
-    for (pos = 0; pos < WORKING_NEURONS; pos++){
-        gradient_descent_neuron(network_arr[pos]);
-    }
 
-    // 2. Update all the output layers (only bias)
-    for (size_t i = 0; i < NUM_OUTPUT; i++){
-        neuron* output_neuron = network_arr[pos];
+// Number of params summed up at once (the sums stay in the L1 cache)
+#define REDUCE_CHUNK 512
 
-        double bias_der = 0;
-        // Sum up all the biases calculated from the different threads
-        for (size_t i = 0; i < NUM_THREADS; i++){
-            bias_der += output_neuron->der_biases[i];
-            output_neuron->der_biases[i] = 0;                             // Reset the derivative to 0
+// Mask of the param i of the chunk (1 if all params are connected). The check is hoisted out of the loops by the compiler.
+#define CHUNK_MASK(i) (chunk_connected ? (double) chunk_connected[i] : 1.0)
+
+/*
+Sums the derivatives of the num_workspaces workspaces for the params [from, to) of the DENSE_NETWORK,
+resets them to 0 and updates the params in-place with their average over size_data data points.
+Missing connections (see the connected mask) are never updated and stay 0: their derivative is 0 and so is their step.
+The derivatives are summed up in double in every precision. In mixed precision the double master params are updated
+and rounded into the float params.
+
+The moments of the OPTIMIZER are updated in the same (fused) pass as the params.
+The loops run over contiguous arrays without branches, so that the compiler vectorises them.
+It is always inlined into the versions for the different instruction sets below.*/
+static inline __attribute__((always_inline)) void dense_update_shard(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, size_t num_workspaces,
+                                                                     OPTIMIZER* optimizer, double learning_rate, double size_data, size_t from, size_t to){
+
+    scalar* restrict params = dense_network->params;
+    const unsigned char* restrict connected = dense_network->connected;
+    double sums[REDUCE_CHUNK];
+
+    int type = optimizer ? optimizer->type : OPTIMIZER_SGD;
+
+    for (size_t chunk = from; chunk < to; chunk += REDUCE_CHUNK){
+        size_t size = (to - chunk < REDUCE_CHUNK) ? to - chunk : REDUCE_CHUNK;
+
+        // 1. Sum up the derivatives calculated by the different threads and reset them to 0
+        PROFILE_BEGIN(reduction_start);
+        scalar* restrict der = workspaces[0].der_params + chunk;
+        for (size_t i = 0; i < size; i++){
+            sums[i] = der[i];
+            der[i] = 0;
+        }
+        for (size_t thread_pos = 1; thread_pos < num_workspaces; thread_pos++){
+            der = workspaces[thread_pos].der_params + chunk;
+            for (size_t i = 0; i < size; i++){
+                sums[i] += der[i];
+                der[i] = 0;
+            }
         }
 
-        double new_bias = output_neuron->bias - LEARNING_RATE * (bias_der / SIZE_TRAIN); // Updated bias
+        PROFILE_END(reduction_start, PHASE_REDUCTION);
 
-        output_neuron->bias = new_bias;
+        // 2. Update the moments and the params (missing connections are multiplied by 0)
+        PROFILE_BEGIN(update_start);
+#ifdef MIXED_PRECISION
+        double* restrict chunk_params = dense_network->master_params + chunk;
+#else
+        scalar* restrict chunk_params = params + chunk;
+#endif
+        const unsigned char* restrict chunk_connected = connected ? connected + chunk : NULL;
+        double* restrict first_moment = (optimizer && optimizer->first_moment) ? optimizer->first_moment + chunk : NULL;
+        double* restrict second_moment = (optimizer && optimizer->second_moment) ? optimizer->second_moment + chunk : NULL;
 
-        // Set the input equal to the bias (design choice)
-        for (size_t i = 0; i < NUM_THREADS; i++){
-            output_neuron->input[i] = new_bias;
+        switch (type){
+            case OPTIMIZER_MOMENTUM:
+                for (size_t i = 0; i < size; i++){
+                    chunk_params[i] -= CHUNK_MASK(i) * momentum_step(&first_moment[i], CHUNK_MASK(i) * (sums[i] / size_data), learning_rate);
+                }
+                break;
+            case OPTIMIZER_RMSPROP:
+                for (size_t i = 0; i < size; i++){
+                    chunk_params[i] -= CHUNK_MASK(i) * rmsprop_step(&second_moment[i], CHUNK_MASK(i) * (sums[i] / size_data), learning_rate);
+                }
+                break;
+            case OPTIMIZER_ADAM:
+                for (size_t i = 0; i < size; i++){
+                    chunk_params[i] -= CHUNK_MASK(i) * adam_step(&first_moment[i], &second_moment[i], CHUNK_MASK(i) * (sums[i] / size_data), learning_rate);
+                }
+                break;
+            default:
+                for (size_t i = 0; i < size; i++){
+                    chunk_params[i] -= learning_rate * (sums[i] / size_data) * CHUNK_MASK(i);
+                }
+                break;
         }
 
-        pos++;
+#ifdef MIXED_PRECISION
+        // 3. Round the master params into the params used by the forward and backward pass
+        for (size_t i = 0; i < size; i++){
+            params[chunk + i] = (scalar) chunk_params[i];
+        }
+#endif
+        PROFILE_END(update_start, PHASE_UPDATE);
     }
 }
+
+static void dense_update_shard_default(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, size_t num_workspaces,
+                                       OPTIMIZER* optimizer, double learning_rate, double size_data, size_t from, size_t to){
+    dense_update_shard(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+static void dense_update_shard_avx2(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, size_t num_workspaces,
+                                    OPTIMIZER* optimizer, double learning_rate, double size_data, size_t from, size_t to){
+    dense_update_shard(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+}
+
+__attribute__((target("avx512f")))
+static void dense_update_shard_avx512(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, size_t num_workspaces,
+                                      OPTIMIZER* optimizer, double learning_rate, double size_data, size_t from, size_t to){
+    dense_update_shard(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+}
+#endif
+
+/*
+Runs the version of dense_update_shard() for the same instruction set as the array versions of the activation functions.*/
+static void dense_update(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, size_t num_workspaces,
+                         OPTIMIZER* optimizer, double learning_rate, double size_data, size_t from, size_t to){
+    switch (current_activation_kernels()){
+#if defined(__x86_64__) || defined(__i386__)
+        case ACTIVATION_KERNELS_AVX512:
+            dense_update_shard_avx512(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+            break;
+        case ACTIVATION_KERNELS_AVX2:
+            dense_update_shard_avx2(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+            break;
+#endif
+        default:
+            dense_update_shard_default(dense_network, workspaces, num_workspaces, optimizer, learning_rate, size_data, from, to);
+            break;
+    }
+}
+
+/*
+Gradient descent on the shard [from, to) of the params of the compiled DENSE_NETWORK.
+Shards are independent of each other, so different shards can be updated by different threads (see dense_param_shard()).
+The moments of the OPTIMIZER are parallel to the params. A NULL OPTIMIZER is plain sgd.*/
+void dense_gradient_descent_shard(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, OPTIMIZER* optimizer, size_t from, size_t to){
+    dense_update(dense_network, workspaces, NUM_THREADS, optimizer, optimizer ? optimizer->learning_rate : LEARNING_RATE, (double) SIZE_TRAIN, from, to);
+}
+
+/*
+Gradient descent on the compiled DENSE_NETWORK.
+Note that this updates the params in-place.*/
+void dense_gradient_descent(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspaces, OPTIMIZER* optimizer){
+    dense_gradient_descent_shard(dense_network, workspaces, optimizer, 0, dense_network->num_params);
+}
+
+
+/*
+Asynchronous (Hogwild!) update of all params of the DENSE_NETWORK with the derivatives of one thread only,
+averaged over the rows data points they were accumulated on. The derivatives of the workspace are reset to 0.
+Called by every thread on its own while the other threads read and update the same params: there is no lock and no barrier,
+so an update may be lost or read half applied by another thread (Niu et al., 2011). This does not hurt the convergence as long
+as the updates are small, and the loads and stores of aligned floats and doubles are never torn on the supported platforms.
+The moments of the OPTIMIZER are shared by the threads the same way.
+Every update counts as one step of the OPTIMIZER: it takes its step number with a relaxed atomic increment and computes its
+step size locally, so that the bias correction of Adam follows the updates actually applied, like with --mini-batch.
+next_optimizer_step() is not called in the asynchronous training.*/
+void dense_hogwild_update(DENSE_NETWORK* dense_network, DENSE_WORKSPACE* workspace, OPTIMIZER* optimizer, size_t rows){
+    double learning_rate = LEARNING_RATE;
+    if (optimizer){
+        size_t step = atomic_fetch_add_explicit(&optimizer->step, 1, memory_order_relaxed) + 1;
+        learning_rate = step_learning_rate(optimizer->type, step);
+    }
+    dense_update(dense_network, workspace, 1, optimizer, learning_rate, (double) rows, 0, dense_network->num_params);
+}
+
+
+/*
+Work of one thread during the gradient descent.
+Updates the shard of the params (dense network) or the neurons [start, end) (linked list) given by the GRADIENT_DESCENT_ARGS.*/
+void* gradient_descent_thread(void* args){
+
+    GRADIENT_DESCENT_ARGS* gradient_descent_args = (GRADIENT_DESCENT_ARGS*) args;
+
+    if (gradient_descent_args->dense_network){
+        dense_gradient_descent_shard(gradient_descent_args->dense_network, gradient_descent_args->workspaces, gradient_descent_args->optimizer,
+                                     gradient_descent_args->params_start, gradient_descent_args->params_end);
+    } else{
+        gradient_descent_range(gradient_descent_args->network_arr, gradient_descent_args->list_workspaces, gradient_descent_args->optimizer,
+                               gradient_descent_args->start, gradient_descent_args->end);
+    }
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Work of one thread in the asynchronous (Hogwild!) training on the dense network.
+The data of the thread is processed in batches of BATCH_SIZE data points like in dense_work_thread(), but the thread updates the
+shared params itself after every update_rows of its data points (see dense_hogwild_update()) instead of waiting for the others.
+Adds the summed cost to the THREAD_ARGS (every data point is scored with the params at the time it is processed).*/
+void* dense_hogwild_thread(void* args){
+
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    THREAD_DATA* data_for_thread = thread_args->data;
+    DENSE_NETWORK* dense_network = thread_args->dense_network;
+    DENSE_WORKSPACE* workspace = thread_args->workspace;
+    size_t update_rows = thread_args->update_rows;
+
+    size_t num_data = data_for_thread->size;
+    double** input_arr = data_for_thread->input;
+    double** output_arr_true = data_for_thread->output;
+
+    // Sum up the cost locally and only write it once
+    double sum_cost = 0;
+
+    for (size_t first = 0; first < num_data; first += update_rows){
+        size_t rows = (num_data - first < update_rows) ? num_data - first : update_rows;
+
+        for (size_t data_ptr = first; data_ptr < first + rows; data_ptr += BATCH_SIZE){
+            size_t batch_size = (first + rows - data_ptr < BATCH_SIZE) ? first + rows - data_ptr : BATCH_SIZE;
+
+            sum_cost += dense_create_output(dense_network, workspace, &input_arr[data_ptr], &output_arr_true[data_ptr], batch_size);
+        }
+
+        dense_hogwild_update(dense_network, workspace, thread_args->optimizer, rows);
+    }
+
+    thread_args->cost += sum_cost;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
@@ -2,8 +2,38 @@
 Header fle for the gradient descent file.
 Includes neurons.h for the neuron** input */
 
+#ifndef GRADIENT_DESCENT_H
+#define GRADIENT_DESCENT_H
+
 #include "../neurons/neurons.h"
 
-void gradient_descent_neuron(neuron*);
+// Optimizers of the gradient descent (type of the OPTIMIZER, selected with --optimizer)
+#define OPTIMIZER_SGD 0
+#define OPTIMIZER_MOMENTUM 1
+#define OPTIMIZER_RMSPROP 2
+#define OPTIMIZER_ADAM 3
+#define NUMBER_OPTIMIZERS 4
+
+int parse_optimizer(const char*);
+const char* optimizer_name(int);
+
+OPTIMIZER* create_optimizer(int, size_t);
+int resize_optimizer(OPTIMIZER*, size_t);
+int restore_optimizer(OPTIMIZER*, const CHECKPOINT*);
+void next_optimizer_step(OPTIMIZER*);
+void free_optimizer(OPTIMIZER*);
+
+void gradient_descent_neuron(neuron*, LIST_WORKSPACE*, OPTIMIZER*);
+void gradient_descent_output_neuron(neuron*, LIST_WORKSPACE*, OPTIMIZER*);
+
+void gradient_descent_range(neuron**, LIST_WORKSPACE*, OPTIMIZER*, size_t, size_t);
+void gradient_descent(neuron**, LIST_WORKSPACE*, OPTIMIZER*);
+
+void dense_gradient_descent_shard(DENSE_NETWORK*, DENSE_WORKSPACE*, OPTIMIZER*, size_t, size_t);
+void dense_gradient_descent(DENSE_NETWORK*, DENSE_WORKSPACE*, OPTIMIZER*);
+void dense_hogwild_update(DENSE_NETWORK*, DENSE_WORKSPACE*, OPTIMIZER*, size_t);
+
+void* gradient_descent_thread(void*);
+void* dense_hogwild_thread(void*);
 
-void gradient_descent(neuron**);
+#endif // GRADIENT_DESCENT_H
@@ -1,10 +1,379 @@
 /*
 Test file for the gradient_descent file for a Neural Network.
 This file may not be included in any other file or define any structs/functions needed in other places.
+
+For testing purposes (see test_config.h):
+- NEURON_NUMBERS = {1, 1}, so the dense network has 3 params (weight, bias of neuron 0, bias of neuron 1)
+- SIZE_TRAIN = 6
+- NUM_THREADS = 4
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <math.h> // For fabs and sqrt
 
 #include "test_gradient_descent.h"
+
+// Number of updates done by the tests
+#define TEST_STEPS 3
+
+
+/*
+Sets the derivative of param i of every thread to (i + 1) * scale (param i of the dense network)*/
+static void set_dense_derivatives(DENSE_WORKSPACE* workspaces, size_t num_params, double scale){
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        for (size_t i = 0; i < num_params; i++){
+            workspaces[thread_pos].der_params[i] = (scalar) ((double) (i + 1) * scale);
+        }
+    }
+}
+
+
+/*
+Tests that the names of the optimizers are parsed*/
+void test_parse_optimizer(void){
+    for (int type = 0; type < NUMBER_OPTIMIZERS; type++){
+        assert(parse_optimizer(optimizer_name(type)) == type);
+    }
+    assert(parse_optimizer("adam") == OPTIMIZER_ADAM);
+    assert(parse_optimizer("Adam") == -1);
+    assert(parse_optimizer("") == -1);
+    return;
+}
+
+
+/*
+Tests the fused updates of every optimizer against the formulas, step by step.
+The derivative of param i is (i + 1) * (-1)^step summed over NUM_THREADS threads.*/
+void test_dense_optimizers(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    size_t num_params = dense_network->num_params;
+
+    for (int type = 0; type < NUMBER_OPTIMIZERS; type++){
+        assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+        OPTIMIZER* optimizer = create_optimizer(type, num_params);
+        assert(optimizer != NULL);
+        assert(optimizer->step == 0);
+
+        // Reference of the params and the moments
+        double params[3], first[3] = {0}, second[3] = {0};
+        for (size_t i = 0; i < num_params; i++){
+            params[i] = dense_network->params[i];
+        }
+
+        for (size_t step = 1; step <= TEST_STEPS; step++){
+            double sign = (step % 2) ? 1 : -1;
+            set_dense_derivatives(workspaces, num_params, sign);
+            next_optimizer_step(optimizer);
+            dense_gradient_descent(dense_network, workspaces, optimizer);
+
+            for (size_t i = 0; i < num_params; i++){
+                double derivative = sign * NUM_THREADS * (double) (i + 1) / SIZE_TRAIN;
+
+                switch (type){
+                    case OPTIMIZER_MOMENTUM:
+                        first[i] = MOMENTUM_DECAY * first[i] + derivative;
+                        params[i] -= LEARNING_RATE * first[i];
+                        break;
+                    case OPTIMIZER_RMSPROP:
+                        second[i] = SQUARED_DECAY * second[i] + (1 - SQUARED_DECAY) * derivative * derivative;
+                        params[i] -= ADAPTIVE_LEARNING_RATE * derivative / (sqrt(second[i]) + OPTIMIZER_EPSILON);
+                        break;
+                    case OPTIMIZER_ADAM:{
+                        first[i] = MOMENTUM_DECAY * first[i] + (1 - MOMENTUM_DECAY) * derivative;
+                        second[i] = SQUARED_DECAY * second[i] + (1 - SQUARED_DECAY) * derivative * derivative;
+                        double corrected_first = first[i] / (1 - pow(MOMENTUM_DECAY, (double) step));
+                        double corrected_second = second[i] / (1 - pow(SQUARED_DECAY, (double) step));
+                        params[i] -= ADAPTIVE_LEARNING_RATE * corrected_first / sqrt(corrected_second); // epsilon is negligible here
+                        break;
+                    }
+                    default:
+                        params[i] -= LEARNING_RATE * derivative;
+                        break;
+                }
+
+                COMPARE(dense_network->params[i], params[i]);
+                COMPARE(workspaces[0].der_params[i], 0);
+            }
+        }
+
+        assert(optimizer->step == TEST_STEPS);
+        free_optimizer(optimizer);
+    }
+
+    free_dense_workspaces(workspaces);
+    return;
+}
+
+
+/*
+Tests that the linked list and the dense network take the same steps with the same derivatives*/
+void test_list_matches_dense(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    LIST_WORKSPACE* list_workspaces = initialise_list_workspaces();
+    DENSE_WORKSPACE* dense_workspaces = initialise_dense_workspaces(dense_network);
+    assert(list_workspaces != NULL && dense_workspaces != NULL);
+
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    OPTIMIZER* list_optimizer = create_optimizer(OPTIMIZER_ADAM, LENGTH_NETWORK + NUM_CONNECTIONS);
+    OPTIMIZER* dense_optimizer = create_optimizer(OPTIMIZER_ADAM, dense_network->num_params);
+    assert(list_optimizer != NULL && dense_optimizer != NULL);
+
+    for (size_t step = 0; step < TEST_STEPS; step++){
+        // Param 0 is the weight, 1 and 2 the biases of neurons 0 and 1
+        set_dense_derivatives(dense_workspaces, dense_network->num_params, 0.5);
+        for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+            list_workspaces[thread_pos].der_weights[network_arr[0]->next_layer->index] = 0.5;
+            list_workspaces[thread_pos].der_biases[0] = 1;
+            list_workspaces[thread_pos].der_biases[1] = 1.5;
+        }
+
+        next_optimizer_step(list_optimizer);
+        next_optimizer_step(dense_optimizer);
+        gradient_descent(network_arr, list_workspaces, list_optimizer);
+        dense_gradient_descent(dense_network, dense_workspaces, dense_optimizer);
+
+        COMPARE(network_arr[0]->next_layer->weight, dense_network->params[0]);
+        COMPARE(network_arr[0]->bias, dense_network->params[1]);
+        COMPARE(network_arr[1]->bias, dense_network->params[2]);
+        COMPARE(list_workspaces[0].der_biases[1], 0);
+    }
+
+    free_optimizer(list_optimizer);
+    free_optimizer(dense_optimizer);
+    free_list_workspaces(list_workspaces);
+    free_dense_workspaces(dense_workspaces);
+    return;
+}
+
+
+/*
+Tests that a missing connection is not moved by the moments it gathered before it was deleted*/
+void test_optimizer_masked_connection(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_MOMENTUM, dense_network->num_params);
+    assert(optimizer != NULL);
+
+    set_dense_derivatives(workspaces, dense_network->num_params, 1);
+    next_optimizer_step(optimizer);
+    dense_gradient_descent(dense_network, workspaces, optimizer);
+    assert(optimizer->first_moment[0] != 0);
+
+    // Delete the connection, its velocity is still set
+    assert(del_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+
+    set_dense_derivatives(workspaces, dense_network->num_params, 1);
+    next_optimizer_step(optimizer);
+    dense_gradient_descent(dense_network, workspaces, optimizer);
+    COMPARE(dense_network->params[0], 0);
+
+    free_optimizer(optimizer);
+    free_dense_workspaces(workspaces);
+
+    assert(add_connection(network_arr, 0, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    return;
+}
+
+
+/*
+Tests that growing the optimizer keeps the moments and starts the new ones at 0*/
+void test_resize_optimizer(void){
+
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_RMSPROP, 2);
+    assert(optimizer != NULL);
+    assert(optimizer->first_moment == NULL);
+    assert(optimizer->second_moment != NULL);
+
+    optimizer->second_moment[1] = 3;
+    assert(resize_optimizer(optimizer, 100) == SUCCESSFULL_EXECUTION_CODE);
+    assert(optimizer->num_values == 100);
+    COMPARE(optimizer->second_moment[1], 3);
+    COMPARE(optimizer->second_moment[99], 0);
+
+    // Shrinking keeps the moments
+    assert(resize_optimizer(optimizer, 1) == SUCCESSFULL_EXECUTION_CODE);
+    assert(optimizer->num_values == 100);
+
+    free_optimizer(optimizer);
+    return;
+}
+
+
+/*
+Tests that an asynchronous update only applies (and resets) the derivatives of its own workspace, averaged over its rows*/
+void test_dense_hogwild_update(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    assert(workspaces != NULL);
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+
+    double params[3];
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        params[i] = dense_network->params[i];
+    }
+
+    set_dense_derivatives(workspaces, dense_network->num_params, 1);
+    dense_hogwild_update(dense_network, &workspaces[1], NULL, 2);
+
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        COMPARE(dense_network->params[i], params[i] - LEARNING_RATE * (double) (i + 1) / 2);
+        COMPARE(workspaces[1].der_params[i], 0);
+        COMPARE(workspaces[0].der_params[i], (double) (i + 1)); // The other threads keep their derivatives
+    }
+
+    free_dense_workspaces(workspaces);
+    return;
+}
+
+
+/*
+Tests that a thread of the asynchronous training updates the params after every update_rows of its data points
+(one thread, so the result has to match the same updates run one after the other)*/
+void test_dense_hogwild_thread(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    DENSE_NETWORK* reference = compile_network(network_arr);
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    DENSE_WORKSPACE* reference_workspaces = initialise_dense_workspaces(reference);
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_ADAM, dense_network->num_params);
+    OPTIMIZER* reference_optimizer = create_optimizer(OPTIMIZER_ADAM, reference->num_params);
+    assert(reference && workspaces && reference_workspaces && optimizer && reference_optimizer);
+
+    // 5 data points updated in groups of 2, 2 and 1
+    double inputs[5][1] = {{1}, {2}, {-1}, {0.5}, {3}};
+    double outputs[5][1] = {{2}, {3}, {0}, {1}, {4}};
+    double* input_rows[5];
+    double* output_rows[5];
+    for (size_t i = 0; i < 5; i++){
+        input_rows[i] = inputs[i];
+        output_rows[i] = outputs[i];
+    }
+
+    THREAD_DATA thread_data = {5, input_rows, output_rows, NULL};
+    THREAD_ARGS thread_args = {0};
+    thread_args.data = &thread_data;
+    thread_args.dense_network = dense_network;
+    thread_args.workspace = &workspaces[0];
+    thread_args.optimizer = optimizer;
+    thread_args.update_rows = 2;
+
+    dense_hogwild_thread((void*) &thread_args);
+
+    double cost = 0;
+    for (size_t first = 0; first < 5; first += 2){
+        size_t rows = (5 - first < 2) ? 5 - first : 2;
+        cost += dense_create_output(reference, &reference_workspaces[0], &input_rows[first], &output_rows[first], rows);
+        dense_hogwild_update(reference, &reference_workspaces[0], reference_optimizer, rows);
+    }
+
+    COMPARE(thread_args.cost, cost);
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        COMPARE(dense_network->params[i], reference->params[i]);
+        COMPARE(optimizer->first_moment[i], reference_optimizer->first_moment[i]);
+        COMPARE(workspaces[0].der_params[i], 0);
+    }
+    assert(dense_network->params[0] != network_arr[0]->next_layer->weight); // The params were updated
+    assert(optimizer->step == 3 && reference_optimizer->step == 3);             // Every update is one step of the optimizer
+
+    free_optimizer(reference_optimizer);
+    free_optimizer(optimizer);
+    free_dense_workspaces(reference_workspaces);
+    free_dense_workspaces(workspaces);
+    free_dense_network(reference);
+    return;
+}
+
+
+/*
+Tests that every asynchronous update is one step of the optimizer: two Adam updates of one thread match two synchronous
+updates with the same average derivatives (same moments, step and bias correction)*/
+void test_dense_hogwild_adam_steps(neuron** network_arr, DENSE_NETWORK* dense_network){
+
+    assert(sync_dense_network(network_arr, dense_network) == SUCCESSFULL_EXECUTION_CODE);
+    DENSE_NETWORK* reference = compile_network(network_arr);
+    DENSE_WORKSPACE* workspaces = initialise_dense_workspaces(dense_network);
+    DENSE_WORKSPACE* reference_workspaces = initialise_dense_workspaces(reference);
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_ADAM, dense_network->num_params);
+    OPTIMIZER* reference_optimizer = create_optimizer(OPTIMIZER_ADAM, reference->num_params);
+    assert(reference && workspaces && reference_workspaces && optimizer && reference_optimizer);
+
+    for (size_t update = 0; update < 2; update++){
+        // Synchronous: the derivatives of NUM_THREADS workspaces averaged over SIZE_TRAIN data points
+        set_dense_derivatives(reference_workspaces, reference->num_params, 1);
+        next_optimizer_step(reference_optimizer);
+        dense_gradient_descent(reference, reference_workspaces, reference_optimizer);
+
+        // Asynchronous: the same average from the derivatives of one workspace over 2 data points (no next_optimizer_step())
+        set_dense_derivatives(workspaces, dense_network->num_params, 2.0 * NUM_THREADS / SIZE_TRAIN);
+        dense_hogwild_update(dense_network, &workspaces[0], optimizer, 2);
+    }
+
+    assert(optimizer->step == 2 && reference_optimizer->step == 2);
+    for (size_t i = 0; i < dense_network->num_params; i++){
+        COMPARE(dense_network->params[i], reference->params[i]);
+        COMPARE(optimizer->first_moment[i], reference_optimizer->first_moment[i]);
+        COMPARE(optimizer->second_moment[i], reference_optimizer->second_moment[i]);
+    }
+
+    free_optimizer(reference_optimizer);
+    free_optimizer(optimizer);
+    free_dense_workspaces(reference_workspaces);
+    free_dense_workspaces(workspaces);
+    free_dense_network(reference);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Create a Simple 2 layer Neural Network
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_gradient_descent.\n");
+        return OTHER_ERROR;
+    }
+
+    // Connect the neurons (the network array will be freed by the function in case of an error)
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    DENSE_NETWORK* dense_network = compile_network(network_arr);
+    if (!dense_network){
+        printf("Compiling the network was unsuccessfull in test_gradient_descent.\n");
+        free_network(network_arr);
+        return OTHER_ERROR;
+    }
+
+    test_parse_optimizer();
+    test_dense_optimizers(network_arr, dense_network);
+    test_list_matches_dense(network_arr, dense_network);
+    test_optimizer_masked_connection(network_arr, dense_network);
+    test_resize_optimizer();
+    test_dense_hogwild_update(network_arr, dense_network);
+    test_dense_hogwild_thread(network_arr, dense_network);
+    test_dense_hogwild_adam_steps(network_arr, dense_network);
+
+    printf("All tests for gradient_descent successfully executed.\n");
+
+    free_dense_network(dense_network);
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
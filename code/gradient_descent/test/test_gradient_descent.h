@@ -9,6 +9,18 @@ May only be included in its own .c file.
 #include "../../../configurations/test_config/test_config.h"
 #include "../../structs/structs.h"
 #include "../gradient_descent.h"
-#include "../../helper_functions/helper_functions.h"
+#include "../../dense_network/dense_network.h"
+#include "../../feed_forward/feed_forward.h"
 
-#endif //TEST_GRADIENT_DESCENT_H
\ No newline at end of file
+void test_parse_optimizer(void);
+void test_dense_optimizers(neuron**, DENSE_NETWORK*);
+void test_list_matches_dense(neuron**, DENSE_NETWORK*);
+void test_optimizer_masked_connection(neuron**, DENSE_NETWORK*);
+void test_resize_optimizer(void);
+void test_dense_hogwild_update(neuron**, DENSE_NETWORK*);
+void test_dense_hogwild_thread(neuron**, DENSE_NETWORK*);
+void test_dense_hogwild_adam_steps(neuron**, DENSE_NETWORK*);
+
+int test_handler_func(void);
+
+#endif //TEST_GRADIENT_DESCENT_H
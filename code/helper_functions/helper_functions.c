@@ -155,88 +155,29 @@ void print_network(neuron** neuron_array){
 
 void print_neuron(neuron* neuron_to_print){
 
-    // get a fat char with the formated string for neuron_to_print -> input
-    FAT_CHAR* fat_char_input = fat_char(neuron_to_print->input);
-    if (!fat_char_input){
-        printf("Memory allocation error for FAT_CHAR input_str.\n");
-        // Case when input_str failed
-        exit(OTHER_ERROR);
-    }
-    // Unpack the fat char
-    char* string_input = fat_char_input->string;
-    int length_fat_char_input = (int) fat_char_input->length;
-
-    // get a fat char with the formated string for neuron_to_print -> der_biases
-    FAT_CHAR* fat_char_der_biases = fat_char(neuron_to_print->der_biases);
-    if (!fat_char_der_biases){
-        printf("Memory allocation error for FAT_CHAR der_biases.\n");
-        // Case when input_str failed
-        free_fat_char(fat_char_input);
-        exit(OTHER_ERROR);
-    }
-    // Unpack the fat char
-    char* string_der_biases = fat_char_der_biases->string;
-    int length_fat_char_der_biases = (int) fat_char_der_biases->length;
-
-
-    // Get enough "-" to print the most amount 
-    char repeated_[] = "------------------------------------\
-    --------------------------------------------------------\
-    --------------------------------------------------------";
-
+    // Only the parameters are printed, the inputs and derivatives of the threads are kept in their LIST_WORKSPACE
     printf("\n\n\
-|--------------------------------|----------------|----------|--------%.*s|-------------%.*s|\n\
-| next_layer: %18p | bias: %8.2f | pos: %3zu | Input: %s| Der_biases: %s|\n\
-|--------------------------------|----------------|----------|--------%.*s|-------------%.*s|\n\n",
-    length_fat_char_input, repeated_,       // First array "padding" first line
-    length_fat_char_der_biases, repeated_,  // Second array "padding" first line
-    (void*) neuron_to_print->next_layer,neuron_to_print->bias, neuron_to_print->pos, string_input, string_der_biases,
-    length_fat_char_input, repeated_,       // First array "padding" third line
-    length_fat_char_der_biases, repeated_   // Second array "padding" third line
+|--------------------------------|----------------|----------|\n\
+| next_layer: %18p | bias: %8.2f | pos: %3zu |\n\
+|--------------------------------|----------------|----------|\n\n",
+    (void*) neuron_to_print->next_layer, neuron_to_print->bias, neuron_to_print->pos
     );
 
-
-    free_fat_char(fat_char_input);
-    free_fat_char(fat_char_der_biases);
-
     return;
 }
 
 
 void print_linked_list_connection(node_linked_list_connection* linked_list_conn){
 
-    
     while(linked_list_conn != NULL){
 
-
-        // get a fat char with the formated string for linked_list_conn -> der_weight
-        FAT_CHAR* fat_char_der_weight = fat_char(linked_list_conn->der_weight);
-        if (!fat_char_der_weight){
-            printf("Memory allocation error for FAT_CHAR der_weight.\n");
-            // Case when input_str failed
-            exit(OTHER_ERROR);
-        }
-        // Unpack the fat char
-        char* string_der_weight = fat_char_der_weight->string;
-        int length_fat_char_der_weight = (int) fat_char_der_weight->length;
-        
-
-            // Get enough "-" to print the most amount 
-        char repeated_[] = "------------------------------------\
-        --------------------------------------------------------\
-        --------------------------------------------------------";
-        
         printf("\n\
-|-----------------|--------------------------|---------------|------------%.*s|\n\
-| data (pos): %3zu | next: %18p | weight: %5.2f | Der_weight:%s|\n\
-|-----------------|--------------------------|---------------|------------%.*s|\n",
-        length_fat_char_der_weight, repeated_,       // First array "padding" first line
-        linked_list_conn->data->pos, (void*) linked_list_conn->next, linked_list_conn->weight, string_der_weight,
-        length_fat_char_der_weight, repeated_        // First array "padding" third line
+|-----------------|--------------------------|---------------|--------------|\n\
+| data (pos): %3zu | next: %18p | weight: %5.2f | index: %6zu |\n\
+|-----------------|--------------------------|---------------|--------------|\n",
+        linked_list_conn->data->pos, (void*) linked_list_conn->next, linked_list_conn->weight, linked_list_conn->index
         );
 
-        free_fat_char(fat_char_der_weight);
-
         // Move to the next node
         linked_list_conn = linked_list_conn->next;
     }
@@ -324,7 +265,7 @@ FAT_CHAR* double_arr_to_str(double*double_arr, size_t num_doubles){
 
 
 /*
-Converts the an array of type double[NUM_THREADS] of a neuron into a nice string for printing.
+Converts the an array of type double[NUM_THREADS] (one value per thread) into a nice string for printing.
 Returns NULL if it fails*/
 FAT_CHAR* fat_char(double data[NUM_THREADS]) {
 
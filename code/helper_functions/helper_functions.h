@@ -57,15 +57,17 @@ void free_fat_char(FAT_CHAR*);
 /*************************
  * 5. Macro to time code *
  *************************/
-#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
+// Include system_info for the monotonic clock
+#include "../system_info/system_info.h"
 
+// Prints the wall-clock time of expr (clock() would add up the CPU time of all threads)
 #define TIME_THIS(expr) ({                                              \
-    clock_t start = clock();                                            \
+    double start = monotonic_ns();                                      \
     __typeof__(expr) result = (expr);  /* Store return value */         \
-    clock_t end = clock();                                              \
-    double time_taken = (double)(end - start) / CLOCKS_PER_SEC;         \
+    double end = monotonic_ns();                                        \
+    double time_taken = (end - start) / 1e9;                            \
     printf("Time taken: %f seconds\n", time_taken);                     \
     result;  /* Return the result */                                    \
 })
@@ -9,6 +9,7 @@ This file may not be included in any other file.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 
 #include "test_helper_functions.h"
 #include "../../neurons/neurons.h"
@@ -25,10 +26,6 @@ int test_print_neuron(void){
     this_neuron->bias = 22.34;
     this_neuron->pos = 2;
 
-    // Initialise the input[NUM_THREADS]
-    double values[NUM_THREADS] = {156752.34, 56.7878978, 90, 0};
-    memcpy(this_neuron->input, values, sizeof(values));
-
     print_neuron(this_neuron);
 
     free(this_neuron);
@@ -37,10 +34,11 @@ int test_print_neuron(void){
 
 int test_input_str(void){
 
-    neuron neuron_ = {.input = {156752.34, 56.7878978, 90, 0}};
+    // One value per thread, like the input of one neuron in the LIST_WORKSPACE of every thread
+    double values[NUM_THREADS] = {156752.34, 56.7878978, 90, 0};
 
 
-    FAT_CHAR* return_fat_char = input_str(&neuron_);
+    FAT_CHAR* return_fat_char = fat_char(values);
 
     if (return_fat_char == NULL){
         // Case where memory allocation failed
@@ -53,6 +51,9 @@ int test_input_str(void){
 
     printf("\nLength of fat char: %zu\n", return_fat_char->length);
 
+    assert(strcmp(string, "| 156752.34 | 56.79 | 90.00 | 0.00 ") == 0);
+    assert(return_fat_char->length == strlen(string));
+
     free_fat_char(return_fat_char);
 
     return SUCCESSFULL_EXECUTION_CODE;
@@ -98,21 +99,23 @@ int test_print_linked_list_connection(void){
     // We need to initialise node->next to NULL to inhibit unexpected behavior
     node->next = NULL;
     node->data = neuron_;
+    node->weight = 0;
+    node->index = 0;
 
     // Print the linked list
     print_linked_list_connection(node);
 
-    // Free the memory allocated for the printed node
+    // Free the memory allocated for the printed node and its neuron
+    free(neuron_);
     free(node);
     return SUCCESSFULL_EXECUTION_CODE;
 }
 
 int main(void){
-    if (test_print_linked_list_connection() == SUCCESSFULL_EXECUTION_CODE){
-        return 0;
-    }else{
+    if (test_print_linked_list_connection() != SUCCESSFULL_EXECUTION_CODE || test_input_str() != SUCCESSFULL_EXECUTION_CODE){
         return OTHER_ERROR;
     }
+    return 0;
     //if (test_print_network() == SUCCESSFULL_EXECUTION_CODE){
         //return 0;
     //}else{
@@ -124,5 +127,4 @@ int main(void){
     //} else {
         //return OTHER_ERROR;
     //}
-    //test_input_str();
 }
\ No newline at end of file
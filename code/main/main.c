@@ -1,35 +1,383 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <pthread.h>
-// Include pthread here, as it is spun of here.
 #include <float.h>
 // For max double value of the system
 
 #include "main.h"
 #include "../feed_forward/feed_forward.h"
 #include "../gradient_descent/gradient_descent.h"
+#include "../thread_pool/thread_pool.h"
 #include "../helper_functions/helper_functions.h"
 #include "../neurons/neurons.h"
+#include "../dense_network/dense_network.h"
 #include "../save_state/save_state.h"
 #include "../process_input/process_input.h"
-#include "../feed_forward/feed_forward.h"
+#include "../system_info/system_info.h"
+#include "../binary_dataset/binary_dataset.h"
+#include "../data_stream/data_stream.h"
+#include "../checkpoint/checkpoint.h"
+#include "../codegen/codegen.h"
+#include "../profiling/profiling.h"
+#include "../work_queue/work_queue.h"
 #include "../../configurations/config_manager.h"
 
 
+// Name of the binary dataset the CSV is converted into (NULL if the Neural Network is trained)
+static const char* CONVERT_FILENAME = NULL;
+// Size of the values written by the conversion (float64 unless --float32 is given)
+static size_t CONVERT_SCALAR_SIZE = sizeof(double);
+// 1 if the file is streamed from the disk in windows instead of being loaded into memory (--stream)
+static int STREAM_DATA = 0;
+// Name of the file the best model is saved in after the training (NULL if it is not saved)
+static const char* SAVE_FILENAME = NULL;
+// Name of the binary checkpoint the best model is saved in after the training (NULL if it is not saved)
+static const char* CHECKPOINT_FILENAME = NULL;
+// Name of the checkpoint the training starts from (NULL starts from a new, random Neural Network)
+static const char* RESUME_FILENAME = NULL;
+// Name of the model used to predict the outputs of the file (NULL if the Neural Network is trained)
+static const char* MODEL_FILENAME = NULL;
+// Name of the file the predictions are written to (NULL writes them to stdout)
+static const char* PREDICTIONS_FILENAME = NULL;
+// Name of the C file the scorer of the model is generated into (NULL if the Neural Network is trained)
+static const char* CODEGEN_FILENAME = NULL;
+// Optimizer of the gradient descent (see gradient_descent.h)
+static int OPTIMIZER_TYPE = DEFAULT_OPTIMIZER;
+// Number of data points per update of the params (0 updates once per pass over the data)
+static size_t MINI_BATCH_SIZE = DEFAULT_MINI_BATCH_SIZE;
+// 1 if every thread updates the shared params itself without waiting for the other threads (--hogwild)
+static int HOGWILD_TRAINING = 0;
+// Number of generations without an improvement of the cost after which the training stops (0 runs all GENERATIONS)
+static size_t PATIENCE = DEFAULT_PATIENCE;
+// Relative decrease of the best cost a generation needs to count as an improvement
+static double MIN_IMPROVEMENT = DEFAULT_MIN_IMPROVEMENT;
+// Fraction of the data points held out to validate the Neural Network on (0 decides on the cost of the training data)
+static double VALIDATION_FRACTION = 0;
+// 1 if every worker thread is pinned to a CPU and its rows and workspace are moved onto the NUMA node of the CPU (--pin)
+static int PIN_THREADS = 0;
+
+
+/*
+This function parses a positive number of an option.
+Returns 0 if the value is invalid.*/
+static size_t parse_positive_number(const char* value){
+    char* end;
+    unsigned long number = strtoul(value, &end, 10);
+    if (*end != '\0' || value[0] == '-' || number == 0){
+        return 0;
+    }
+    return (size_t) number;
+}
+
+
+/*
+This function parses a fraction in [0, 1) of an option.
+Returns -1 if the value is invalid.*/
+static double parse_fraction(const char* value){
+    char* end;
+    double fraction = strtod(value, &end);
+    if (end == value || *end != '\0' || !(fraction >= 0 && fraction < 1)){
+        return -1;
+    }
+    return fraction;
+}
+
+
+/*
+This function parses the value of the --threads option.
+Accepts a positive number or "auto" (number of CPUs available to the process).
+A number above MAX_THREADS_PER_CPU threads per available CPU is clamped to it, so that the same command line runs on smaller machines.
+Returns 0 if the value is invalid.*/
+static size_t parse_num_threads(const char* value){
+    if (strcmp(value, "auto") == 0){
+        return available_cpus();
+    }
+    size_t num_threads = parse_positive_number(value);
+    size_t max_threads = MAX_THREADS_PER_CPU * available_cpus();
+    if (num_threads > max_threads){
+        printf("Using %zu instead of %zu threads (at most %d per available CPU).\n", max_threads, num_threads, MAX_THREADS_PER_CPU);
+        return max_threads;
+    }
+    return num_threads;
+}
+
+
 /*
 This function processes the command line arguments.
-Used to get the file on which to train.*/
+Used to get the file on which to train (CSV or binary dataset) and the options:
+--threads N|auto     Number of threads (clamped to MAX_THREADS_PER_CPU per CPU, auto uses all CPUs available to the process)
+--optimizer <name>   Optimizer of the gradient descent (sgd, momentum, rmsprop or adam)
+--mini-batch N       Update the params after every N data points of a shuffled pass over the data (instead of once per pass)
+--hogwild            Asynchronous training: every thread updates the params itself after every N (--mini-batch, default BATCH_SIZE)
+                     of its data points, without locks or barriers between the threads
+--patience N         Stop the training after N generations without a relative improvement of the best cost by --min-improvement
+--min-improvement R  Relative decrease of the best cost that counts as an improvement (0 <= R < 1, default DEFAULT_MIN_IMPROVEMENT)
+--validation F       Hold out the fraction F of the data points (0 < F < 1): their cost selects the best model and decides on the stopping
+--pin                Pin every thread to a CPU (spread evenly over the NUMA nodes) and copy its data points and workspace onto the node of its CPU
+--convert <file>     Convert the CSV into a binary dataset instead of training
+--float32            Store float32 values in the converted binary dataset
+--stream             Stream the file from the disk in windows of STREAM_WINDOW_ROWS data points (for files larger than the memory)
+--save <file>        Save the best model of the training as csv
+--checkpoint <file>  Save the best model of the training as binary checkpoint (exact and fast to load)
+--resume <file>      Start the training from a binary checkpoint
+--predict <model>    Predict the outputs of the file (a CSV of inputs only) with a saved model or checkpoint instead of training
+--output <file>      Write the predictions into the file instead of stdout
+--codegen <file>     Generate a standalone C scorer of the model (the file given is a saved model or checkpoint) instead of training*/
 int process_command_args(int argc, char *argv[]){
-    if (argc < 2){
-        printf("No file to read given.\nUse the Neural Network with %s <filename>\n", argv[0]);
+    for (int arg = 1; arg < argc; arg++){
+        if (strcmp(argv[arg], "--threads") == 0){
+            if (arg + 1 == argc || (NUM_THREADS = parse_num_threads(argv[arg + 1])) == 0){
+                printf("Invalid number of threads given.\nUse --threads N with N > 0 or --threads auto\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--optimizer") == 0){
+            if (arg + 1 == argc || (OPTIMIZER_TYPE = parse_optimizer(argv[arg + 1])) < 0){
+                printf("Invalid optimizer given.\nUse --optimizer sgd|momentum|rmsprop|adam\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--mini-batch") == 0){
+            if (arg + 1 == argc || (MINI_BATCH_SIZE = parse_positive_number(argv[arg + 1])) == 0){
+                printf("Invalid size of the mini batches given.\nUse --mini-batch N with N > 0\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--hogwild") == 0){
+            HOGWILD_TRAINING = 1;
+        } else if (strcmp(argv[arg], "--patience") == 0){
+            if (arg + 1 == argc || (PATIENCE = parse_positive_number(argv[arg + 1])) == 0){
+                printf("Invalid patience given.\nUse --patience N with N > 0\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--min-improvement") == 0){
+            if (arg + 1 == argc || (MIN_IMPROVEMENT = parse_fraction(argv[arg + 1])) < 0){
+                printf("Invalid minimum improvement given.\nUse --min-improvement R with 0 <= R < 1\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--validation") == 0){
+            if (arg + 1 == argc || (VALIDATION_FRACTION = parse_fraction(argv[arg + 1])) <= 0){
+                printf("Invalid fraction of validation data given.\nUse --validation F with 0 < F < 1\n");
+                return OTHER_ERROR;
+            }
+            arg++;
+        } else if (strcmp(argv[arg], "--pin") == 0){
+            PIN_THREADS = 1;
+        } else if (strcmp(argv[arg], "--convert") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the binary dataset given.\nUse --convert <file>\n");
+                return OTHER_ERROR;
+            }
+            CONVERT_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--float32") == 0){
+            CONVERT_SCALAR_SIZE = sizeof(float);
+        } else if (strcmp(argv[arg], "--stream") == 0){
+            STREAM_DATA = 1;
+        } else if (strcmp(argv[arg], "--save") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the model given.\nUse --save <file>\n");
+                return OTHER_ERROR;
+            }
+            SAVE_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--checkpoint") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the checkpoint given.\nUse --checkpoint <file>\n");
+                return OTHER_ERROR;
+            }
+            CHECKPOINT_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--resume") == 0){
+            if (arg + 1 == argc){
+                printf("No checkpoint given.\nUse --resume <file>\n");
+                return OTHER_ERROR;
+            }
+            RESUME_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--predict") == 0){
+            if (arg + 1 == argc){
+                printf("No model given.\nUse --predict <model>\n");
+                return OTHER_ERROR;
+            }
+            MODEL_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--codegen") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the generated scorer given.\nUse --codegen <file>\n");
+                return OTHER_ERROR;
+            }
+            CODEGEN_FILENAME = argv[++arg];
+        } else if (strcmp(argv[arg], "--output") == 0){
+            if (arg + 1 == argc){
+                printf("No file for the predictions given.\nUse --output <file>\n");
+                return OTHER_ERROR;
+            }
+            PREDICTIONS_FILENAME = argv[++arg];
+        } else{
+            FILENAME = argv[arg];
+        }
+    }
+
+    if (!FILENAME){
+        printf("No file to read given.\nUse the Neural Network with %s [--threads N|auto] [--optimizer <name>] [--mini-batch N] [--hogwild] [--patience N] [--min-improvement R] [--validation F] [--pin] [--stream] [--save <file>] [--checkpoint <file>] [--resume <file>] [--predict <model> [--output <file>]] [--codegen <file>] [--convert <file> [--float32]] <filename>\n", argv[0]);
         return FILE_ERROR;
     }
-    FILENAME = argv[1];
+    // The asynchronous training only uses the size of the mini batches for the updates of every thread
+    if (MINI_BATCH_SIZE && STREAM_DATA && !HOGWILD_TRAINING){
+        printf("Mini batches are drawn from the whole (shuffled) data in memory and can not be used with --stream.\n");
+        return OTHER_ERROR;
+    }
+    if (VALIDATION_FRACTION > 0 && STREAM_DATA){
+        printf("The validation data is held out of the (shuffled) data in memory and can not be used with --stream.\n");
+        return OTHER_ERROR;
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+This function detects the CPUs and NUMA nodes of the process, reports them and creates the pool of threads of the training.
+With --pin the threads are spread evenly over the CPUs (sorted by node) and every worker is pinned to its CPU.
+Returns NULL if it fails*/
+static THREAD_POOL* create_training_thread_pool(void){
+
+    CPU_TOPOLOGY topology;
+    if (detect_cpu_topology(&topology) != SUCCESSFULL_EXECUTION_CODE){
+        return NULL;
+    }
+    print_cpu_topology(&topology);
+
+    THREAD_POOL* thread_pool = NULL;
+    if (!PIN_THREADS){
+        thread_pool = create_thread_pool(NUM_THREADS);
+    } else{
+        int* cpus = malloc(NUM_THREADS * sizeof(int));
+        if (!cpus){
+            perror("Memory allocation error when trying to allocate the CPUs of the threads.\n");
+            free_cpu_topology(&topology);
+            return NULL;
+        }
+
+        printf("Pinning %zu threads to the CPUs:", NUM_THREADS);
+        for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+            size_t cpu_pos = cpu_of_thread(&topology, thread_pos, NUM_THREADS);
+            cpus[thread_pos] = topology.cpus[cpu_pos];
+            printf(" %d (node %d)", topology.cpus[cpu_pos], topology.cpu_nodes[cpu_pos]);
+        }
+        printf("\n");
+
+        thread_pool = create_pinned_thread_pool(NUM_THREADS, cpus);
+        free(cpus); // Copied by the pool
+    }
+
+    free_cpu_topology(&topology);
+    return thread_pool;
+}
+
+
+/*
+Job run by every pinned worker to move its workspace onto the NUMA node of its CPU (see localise_dense_workspace()).
+The workspace stays where it is if it can not be moved.*/
+static void* localise_workspace_thread(void* args){
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    int exit_code = thread_args->dense_network ? localise_dense_workspace(thread_args->dense_network, thread_args->workspace)
+                                               : localise_list_workspace(thread_args->list_workspace);
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        printf("The workspace of thread %zu stays on its node.\n", thread_args->pos);
+    }
+    return NULL;
+}
+
+
+/*
+Job run by every pinned worker to copy its data points onto the NUMA node of its CPU (see localise_thread_data()).
+The data points stay where they are if they can not be copied.*/
+static void* localise_data_thread(void* args){
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    if (localise_thread_data(thread_args->data) != SUCCESSFULL_EXECUTION_CODE){
+        printf("The data points of thread %zu stay on their node.\n", thread_args->pos);
+    }
+    return NULL;
+}
+
+
+/*
+This function runs a work job (work or validation function) on the pool of threads.
+If the threads have a WORK_QUEUE, the chunks of their data points are handed out first (see work_queue.c).
+Returns SUCCESSFULL_EXECUTION_CODE or an error code.*/
+static int run_work_job(THREAD_POOL* thread_pool, void* (*job)(void*), THREAD_ARGS* args_arr){
+    if (args_arr[0].work_queue){
+        reset_work_queue(args_arr[0].work_queue, args_arr);
+    }
+    return run_thread_pool(thread_pool, job, (void*) args_arr, size_thread_args);
+}
+
+
+/*
+This function runs the threads on every window of one pass over the streamed file.
+The next window is loaded while the threads work on the current one.
+Sets SIZE_TRAIN to the number of data points of the pass (needed by the gradient descent).
+Returns SUCCESSFULL_EXECUTION_CODE or an error code.*/
+static int run_data_stream_pass(THREAD_POOL* thread_pool, DATA_STREAM* data_stream, THREAD_DATA* thread_data,
+                                 void* (*thread_function)(void*), THREAD_ARGS* thread_args_arr){
+    size_t rows_of_pass = 0;
+    DATA_WINDOW* window;
+
+    do{
+        window = next_data_window(data_stream);
+        if (window->exit_code != SUCCESSFULL_EXECUTION_CODE){
+            return window->exit_code;
+        }
+
+        distribute_window_among_threads(window, thread_data);
+        if (run_work_job(thread_pool, thread_function, thread_args_arr) != SUCCESSFULL_EXECUTION_CODE){
+            return OTHER_ERROR;
+        }
+        rows_of_pass += window->rows;
+    } while (!window->last);
+
+    if (rows_of_pass == 0){
+        printf("The streamed file does not hold any data points.\n");
+        return OTHER_ERROR;
+    }
+    SIZE_TRAIN = rows_of_pass;
     return SUCCESSFULL_EXECUTION_CODE;
 }
 
 
+/*
+This function runs one pass over the data in shuffled mini batches of MINI_BATCH_SIZE data points.
+The data points (input and output arrays of all SIZE_TRAIN rows) are shuffled in place first, only the pointers to the rows move.
+The threads work on one mini batch after the other and the params are updated after every mini batch:
+SIZE_TRAIN is set to the size of the mini batch for its gradient descent and restored afterwards.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code.*/
+static int run_mini_batch_pass(THREAD_POOL* thread_pool, double** input, double** output, THREAD_DATA* thread_data,
+                               void* (*thread_function)(void*), THREAD_ARGS* thread_args_arr,
+                               GRADIENT_DESCENT_ARGS* gradient_descent_args_arr, OPTIMIZER* optimizer, uint64_t* random_state){
+    size_t size_data = SIZE_TRAIN;
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+
+    shuffle_data_points(input, output, size_data, random_state);
+
+    for (size_t first = 0; first < size_data && exit_code == SUCCESSFULL_EXECUTION_CODE; first += MINI_BATCH_SIZE){
+        size_t rows = (size_data - first < MINI_BATCH_SIZE) ? size_data - first : MINI_BATCH_SIZE;
+
+        distribute_mini_batch_among_threads(input + first, output + first, rows, thread_data);
+        if (run_work_job(thread_pool, thread_function, thread_args_arr) != SUCCESSFULL_EXECUTION_CODE){
+            return OTHER_ERROR;
+        }
+
+        SIZE_TRAIN = rows;
+        next_optimizer_step(optimizer);
+        if (run_thread_pool(thread_pool, &gradient_descent_thread, (void*) gradient_descent_args_arr, sizeof(GRADIENT_DESCENT_ARGS)) != SUCCESSFULL_EXECUTION_CODE){
+            exit_code = OTHER_ERROR;
+        }
+        SIZE_TRAIN = size_data;
+    }
+    return exit_code;
+}
+
+
 int run_neural_network(void){
 
     // Main exit code (returned to main)
@@ -39,13 +387,18 @@ int run_neural_network(void){
     double min_av_cost = DBL_MAX;
     // Generation of the min average cost
     int best_generation = 0;
+    // Cost of the last generation that improved by MIN_IMPROVEMENT and the number of generations since then (early stopping)
+    double improved_cost = DBL_MAX;
+    size_t stale_generations = 0;
 
 /********************************************
  * 1. Build the Neural Network architecture *
  ********************************************/
 
-    // 1.1 Seed the Neural Network
-    neuron** network_array = seed_neural_network();
+    // 1.1 Seed the Neural Network (or rebuild it from the checkpoint to resume from)
+    CHECKPOINT checkpoint = {NULL, 0, NULL, NULL}; // Stays mapped until the optimizer state is restored (see 1.6)
+    size_t resumed_dimensions = 0; // Dimensions of the data the resumed Neural Network was trained on
+    neuron** network_array = RESUME_FILENAME ? load_checkpoint(RESUME_FILENAME, &checkpoint) : seed_neural_network();
 
     if (network_array == NULL){
         //Memory allocation error
@@ -53,6 +406,9 @@ int run_neural_network(void){
         exit_code = MEMORY_ALLOCATION_ERROR;
         goto exit;
     }
+    if (RESUME_FILENAME){
+        resumed_dimensions = checkpoint.header->dimensions_data;
+    }
 
     // 1.2 Create the Output Node and Initialise it
     // Node whose only purpose is to receive the output of the neural network in its input field
@@ -64,8 +420,8 @@ int run_neural_network(void){
         goto free_network;
     }
 
-    // 1.3 Connect the Neurons to complete the building of the Neural Network itself
-    if (connect_neurons(network_array) != SUCCESSFULL_EXECUTION_CODE){
+    // 1.3 Connect the Neurons to complete the building of the Neural Network itself (a resumed Neural Network is already connected)
+    if (!RESUME_FILENAME && connect_neurons(network_array) != SUCCESSFULL_EXECUTION_CODE){
         // Case when there was a problem when connecting the neurons
         perror("Unsuccessfull connection of the network array.\n");
         exit_code = OTHER_ERROR;
@@ -81,34 +437,149 @@ int run_neural_network(void){
         goto free_network;
     }
 
+    // 1.5 Compile the linked list into dense layers for the training engine
+    // If the topology can not be compiled (e.g. connections skipping layers), the linked list is used for training
+    DENSE_NETWORK* dense_network = compile_network(network_array);
+    DENSE_WORKSPACE* dense_workspaces = NULL;
+    LIST_WORKSPACE* list_workspaces = NULL;
+    if (!dense_network){
+        printf("Could not compile the Neural Network into dense layers. Training on the linked list instead.\n");
+        list_workspaces = initialise_list_workspaces();
+        if (!list_workspaces){
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto free_dense_network;
+        }
+    } else{
+        dense_workspaces = initialise_dense_workspaces(dense_network);
+        if (!dense_workspaces){
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto free_dense_network;
+        }
+    }
+
+    // The threads can only update the params themselves on the dense network
+    int hogwild = HOGWILD_TRAINING && dense_network;
+    if (HOGWILD_TRAINING && !hogwild){
+        printf("The asynchronous training needs the dense layers. Training synchronously instead.\n");
+    }
+
+    // 1.6 Create the optimizer (its moments are parallel to the params of the training engine)
+    OPTIMIZER* optimizer = create_optimizer(OPTIMIZER_TYPE, dense_network ? dense_network->num_params : LENGTH_NETWORK + NUM_CONNECTIONS);
+    if (!optimizer){
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_dense_workspaces;
+    }
+
+    // Continue with the optimizer state of the resumed checkpoint (only the dense network saves it, see 5.)
+    if (checkpoint.optimizer_state && dense_network && restore_optimizer(optimizer, &checkpoint) != SUCCESSFULL_EXECUTION_CODE){
+        printf("The optimizer starts from a new state.\n");
+    }
+    close_checkpoint(&checkpoint);
+
 /************************************
  * 2. Read in the data from the CSV *
  ************************************/
 
-    // 2.1 Open the file and read in the entire data into an INPUT_OUTPUT_MAPPING
-    INPUT_OUTPUT_MAPPING* data_of_file = parse_csv(FILENAME);
-    if(!data_of_file){
-        printf("Could not read in the data of the csv %s.\n", FILENAME);
-        exit_code = OTHER_ERROR;
-        goto free_state;
+    BINARY_DATASET binary_dataset = {NULL, 0, NULL};
+    DATA_STREAM* data_stream = NULL;
+    THREAD_DATA* thread_data;
+    double** data_input = NULL;  // Arrays of the rows of all data points (the mini batches point into them)
+    double** data_output = NULL;
+    THREAD_DATA* validation_data = NULL;   // Held out data points of every thread (they point behind the training data, see 2.4)
+    THREAD_ARGS* validation_args_arr = NULL;
+    size_t validation_rows = 0;
+
+    // State of the generator shuffling the data points (seeded from rand(), which is seeded with the Neural Network; never 0)
+    uint64_t random_state = ((uint64_t) rand() << 32) ^ (uint64_t) rand() ^ 0x9E3779B97F4A7C15ULL;
+
+    if (STREAM_DATA){
+        // 2.1 Open the file as a stream, only two windows of it are held in memory
+        data_stream = open_data_stream(FILENAME, STREAM_WINDOW_ROWS);
+        if (!data_stream){
+            printf("Could not stream the data of the file %s.\n", FILENAME);
+            exit_code = OTHER_ERROR;
+            goto free_optimizer;
+        }
+
+        // 2.2 The rows of the threads are set for every window (see distribute_window_among_threads())
+        thread_data = calloc(NUM_THREADS, size_thread_data);
+        if (!thread_data){
+            perror("Memory allocation error when trying to calloc memory of THREAD_DATA array.\n");
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto close_data_stream;
+        }
+    } else{
+        // 2.1 Open the file and read in the entire data into an INPUT_OUTPUT_MAPPING
+        // Binary datasets are mapped into memory (the rows point into the BINARY_DATASET), CSVs are parsed
+        INPUT_OUTPUT_MAPPING* data_of_file = is_binary_dataset(FILENAME) ? load_binary_dataset(FILENAME, &binary_dataset) : parse_csv(FILENAME);
+        if(!data_of_file){
+            printf("Could not read in the data of the file %s.\n", FILENAME);
+            exit_code = OTHER_ERROR;
+            goto free_optimizer;
+        }
+
+        // 2.2 Distribute the data among the threads. (Note that this will free the INPUT_OUTPUT_MAPPING)
+        thread_data = distribute_data_among_threads(data_of_file);
+        if (!thread_data){
+            perror("Could not distribute the data to the different threads.\n");
+            exit_code = OTHER_ERROR;
+            free_input_output_mapping(data_of_file); // In this case we will still free the INPUT_OUTPUT_MAPPING as the function has failed.
+            goto free_binary_dataset;                // Free the dataset, the dense network, the state and return
+        }
+        data_input = thread_data[0].input;
+        data_output = thread_data[0].output;
     }
 
-    // 2.2 Distribute the data among the threads. (Note that this will free the INPUT_OUTPUT_MAPPING)
-    THREAD_DATA* thread_data = distribute_data_among_threads(data_of_file);
-    if (!thread_data){
-        perror("Could not distribute the data to the different threads.\n");
+    // 2.3 A resumed Neural Network has to be trained on data of the same dimensions
+    if (RESUME_FILENAME && DIMENSIONS_DATA != resumed_dimensions){
+        printf("The data points of %s have %zu dimensions, the checkpoint was trained on %zu.\n", FILENAME, DIMENSIONS_DATA, resumed_dimensions);
         exit_code = OTHER_ERROR;
-        free_input_output_mapping(data_of_file); // In this case we will still free the INPUT_OUTPUT_MAPPING as the function has failed.
-        goto free_state;                         // Free the state and return
+        goto free_threads;
+    }
+
+    // 2.4 Hold out the last VALIDATION_FRACTION of the shuffled data points, the training only sees the first SIZE_TRAIN
+    if (VALIDATION_FRACTION > 0){
+        validation_rows = (size_t) (VALIDATION_FRACTION * SIZE_TRAIN);
+        if (validation_rows == 0 || validation_rows == SIZE_TRAIN){
+            printf("Holding out %g of the %zu data points leaves no validation or no training data.\n", VALIDATION_FRACTION, SIZE_TRAIN);
+            exit_code = OTHER_ERROR;
+            goto free_threads;
+        }
+
+        validation_data = calloc(NUM_THREADS, size_thread_data);
+        validation_args_arr = calloc(NUM_THREADS, size_thread_args);
+        if (!validation_data || !validation_args_arr){
+            perror("Memory allocation error when trying to calloc memory of the validation data.\n");
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto free_threads;
+        }
+
+        shuffle_data_points(data_input, data_output, SIZE_TRAIN, &random_state);
+        SIZE_TRAIN -= validation_rows;
+        distribute_mini_batch_among_threads(data_input, data_output, SIZE_TRAIN, thread_data);
+        distribute_mini_batch_among_threads(data_input + SIZE_TRAIN, data_output + SIZE_TRAIN, validation_rows, validation_data);
+
+        for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+            validation_args_arr[thread_pos].pos = thread_pos;
+            validation_args_arr[thread_pos].data = &validation_data[thread_pos];
+            validation_args_arr[thread_pos].network_arr = network_array;
+            validation_args_arr[thread_pos].dense_network = dense_network;
+            validation_args_arr[thread_pos].workspace = dense_network ? &dense_workspaces[thread_pos] : NULL;
+            validation_args_arr[thread_pos].list_workspace = dense_network ? NULL : &list_workspaces[thread_pos];
+        }
     }
 
 /*******************************************************************************
  * 3. Feed the data into the Neural Network and run the Feed Forward algorithm *
  *******************************************************************************/
 
-    // 3.1 Spin off the different threads
-    // Array of the different threads
-    pthread_t threads[NUM_THREADS];
+    // 3.1 Spin off the pool of threads (the threads stay alive for all generations)
+    THREAD_POOL* thread_pool = create_training_thread_pool();
+    if (!thread_pool){
+        perror("Could not create the thread pool.\n");
+        exit_code = THREAD_CREATION_ERROR;
+        goto free_threads;
+    }
 
     // 3.2 Set up the data for each thread to work on
     THREAD_ARGS* thread_args_arr = calloc(NUM_THREADS, size_thread_args);
@@ -116,7 +587,24 @@ int run_neural_network(void){
         // Case where memory allocation failed
         perror("Memory allocation error when trying to calloc memory of THREAD_ARGS array.\n");
         exit_code = MEMORY_ALLOCATION_ERROR;
-        goto free_threads;
+        goto free_thread_pool;
+    }
+
+    // Set up the part of the Neural Network each thread updates during the gradient descent
+    GRADIENT_DESCENT_ARGS* gradient_descent_args_arr = calloc(NUM_THREADS, sizeof(GRADIENT_DESCENT_ARGS));
+    if (!gradient_descent_args_arr){
+        // Case where memory allocation failed
+        perror("Memory allocation error when trying to calloc memory of GRADIENT_DESCENT_ARGS array.\n");
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_thread_args_arr;
+    }
+
+    // Chunks of WORK_CHUNK_ROWS data points the threads take their work from, so that idle threads steal from busy ones.
+    // The asynchronous training keeps the static split: every thread updates the params after a number of its own data points.
+    WORK_QUEUE* work_queue = create_work_queue(NUM_THREADS, WORK_CHUNK_ROWS);
+    if (!work_queue){
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_gradient_descent_args_arr;
     }
 
     // Create variables that will be accessed repeatedly throughout the next loops.
@@ -127,79 +615,430 @@ int run_neural_network(void){
         thread_args_arr[thread_pos].pos = thread_pos;
         thread_args_arr[thread_pos].data = &thread_data[thread_pos]; //Pointer to the THREAD_DATA datastructure for this thread
         thread_args_arr[thread_pos].network_arr = network_array;
+        thread_args_arr[thread_pos].dense_network = dense_network;
+        thread_args_arr[thread_pos].workspace = dense_network ? &dense_workspaces[thread_pos] : NULL;
+        thread_args_arr[thread_pos].list_workspace = dense_network ? NULL : &list_workspaces[thread_pos];
+        thread_args_arr[thread_pos].optimizer = optimizer;
+        thread_args_arr[thread_pos].update_rows = MINI_BATCH_SIZE ? MINI_BATCH_SIZE : BATCH_SIZE;
+        thread_args_arr[thread_pos].work_queue = hogwild ? NULL : work_queue;
+        if (validation_args_arr){
+            validation_args_arr[thread_pos].work_queue = work_queue;
+        }
+
+        // Every thread updates an equal share of the neurons (linked list) or of the params (dense network)
+        gradient_descent_args_arr[thread_pos].network_arr = network_array;
+        gradient_descent_args_arr[thread_pos].dense_network = dense_network;
+        gradient_descent_args_arr[thread_pos].workspaces = dense_workspaces;
+        gradient_descent_args_arr[thread_pos].list_workspaces = list_workspaces;
+        gradient_descent_args_arr[thread_pos].optimizer = optimizer;
+        gradient_descent_args_arr[thread_pos].start = (LENGTH_NETWORK * thread_pos) / NUM_THREADS;
+        gradient_descent_args_arr[thread_pos].end = (LENGTH_NETWORK * (thread_pos + 1)) / NUM_THREADS;
+        if (dense_network){
+            dense_param_shard(dense_network, thread_pos, NUM_THREADS,
+                              &gradient_descent_args_arr[thread_pos].params_start, &gradient_descent_args_arr[thread_pos].params_end);
+        }
+    }
+
+    // Function run by every thread (depends on the training engine and on the asynchronous training)
+    void* (*thread_function)(void*) = hogwild ? &dense_hogwild_thread : dense_network ? &dense_work_thread : &work_thread;
+    void* (*validation_function)(void*) = dense_network ? &dense_validation_thread : &validation_thread;
+
+    // 3.2.1 Move the workspace and the data points of every pinned thread onto the NUMA node of its CPU (first touch by the thread).
+    // The data points are copied (held twice) unless they are shuffled among the threads every generation (mini batches and hogwild).
+    // The streamed windows are shared by all threads and stay where they are.
+    if (PIN_THREADS){
+        run_thread_pool(thread_pool, &localise_workspace_thread, (void*) thread_args_arr, size_thread_args);
+        if (!data_stream && !MINI_BATCH_SIZE && !hogwild){
+            run_thread_pool(thread_pool, &localise_data_thread, (void*) thread_args_arr, size_thread_args);
+        }
+        if (validation_data){
+            run_thread_pool(thread_pool, &localise_data_thread, (void*) validation_args_arr, size_thread_args);
+        }
+    }
+
+    // Measure the phases of every generation (only if built with make PROFILE=1)
+    if (PROFILING && initialise_profile(NUM_THREADS) != SUCCESSFULL_EXECUTION_CODE){
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_work_queue;
     }
 
     // 3.3 Distribute the workload among the threads and run them
     // Every step from now on can be done in a loop
     for (size_t generation = 0; generation < GENERATIONS; generation++){
 
-
-        // 3.3.1 Make the different threads work        
-        for(thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
-            if (pthread_create(&threads[thread_pos], NULL, &work_thread, (void*) &thread_args_arr[thread_pos]) != 0){
-                printf("Creation of Thread %zu was unsuccessfull in generation %zu.\n", thread_pos, generation);
-                exit_code = THREAD_CREATION_ERROR;
-                goto free_thread_args_arr;
+        // 3.3.0 Resync the dense layers if the connections of the linked list changed
+        if (dense_network && dense_network_is_stale(dense_network)){
+            if (sync_dense_network(network_array, dense_network) != SUCCESSFULL_EXECUTION_CODE){
+                printf("Could not resync the dense layers in generation %zu.\n", generation);
+                exit_code = OTHER_ERROR;
+                goto free_work_queue;
             }
         }
 
-        // 3.3.2 Join the threads back together and update the total error
+        // Grow the workspaces and the moments of the linked list if connections were added
+        if (list_workspaces && (update_list_workspaces(list_workspaces) != SUCCESSFULL_EXECUTION_CODE ||
+                                resize_optimizer(optimizer, LENGTH_NETWORK + NUM_CONNECTIONS) != SUCCESSFULL_EXECUTION_CODE)){
+            exit_code = MEMORY_ALLOCATION_ERROR;
+            goto free_work_queue;
+        }
+
+        // The threads add up their costs over all jobs of the generation (one job per window when streaming)
         for (thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
-            if (pthread_join(threads[thread_pos], NULL) != 0){
-                printf("Joining of thread %zu was unsuccessfull in generation %zu\n", thread_pos, generation);
-                exit_code = THREAD_JOINING_ERROR;
-                goto free_thread_args_arr;
+            thread_args_arr[thread_pos].cost = 0;
+        }
+
+        // 3.3.1 Make the different threads work and wait for all of them (mini batches and hogwild also update the params, see 4.)
+        if (MINI_BATCH_SIZE && !hogwild){
+            exit_code = run_mini_batch_pass(thread_pool, data_input, data_output, thread_data, thread_function, thread_args_arr,
+                                            gradient_descent_args_arr, optimizer, &random_state);
+        } else{
+            // The threads of the asynchronous training update the params during the whole pass, each thread on its part of the
+            // shuffled data (every update counts as one step of the optimizer, see dense_hogwild_update())
+            if (hogwild){
+                if (!data_stream){
+                    shuffle_data_points(data_input, data_output, SIZE_TRAIN, &random_state);
+                }
             }
+            exit_code = data_stream ? run_data_stream_pass(thread_pool, data_stream, thread_data, thread_function, thread_args_arr)
+                                    : run_work_job(thread_pool, thread_function, thread_args_arr);
         }
-        
-        // Check if there was a problem with the thread behavior
         if (exit_code != SUCCESSFULL_EXECUTION_CODE){
             printf("Problems in generation %zu\n", generation);
-            goto free_thread_args_arr; // terminate the execution program and start cleanup
+            exit_code = OTHER_ERROR;
+            goto free_work_queue; // terminate the execution program and start cleanup
         }
 
 
 /***************************************************************************************************
  * 4. Run the backwards propagation algorithm to update the variables and train the Neural Network *
  ***************************************************************************************************/
-        gradient_descent(network_array);
+        // With mini batches or hogwild the params were already updated during the pass
+        if (!MINI_BATCH_SIZE && !hogwild){
+            next_optimizer_step(optimizer);
+            if (run_thread_pool(thread_pool, &gradient_descent_thread, (void*) gradient_descent_args_arr, sizeof(GRADIENT_DESCENT_ARGS)) != SUCCESSFULL_EXECUTION_CODE){
+                printf("Problems in the gradient descent of generation %zu\n", generation);
+                exit_code = OTHER_ERROR;
+                goto free_work_queue;
+            }
+        }
 
         // Calculate the sum of the different costs
-        double average_cost = calc_average_cost();
+        PROFILE_BEGIN(cost_start);
+        double average_cost = calc_average_cost(thread_args_arr);
         printf("The average cost of generation %zu was %f\n", generation, average_cost);
-        if (average_cost < min_av_cost){
-            min_av_cost = average_cost;
+
+        // 4.1 The cost of the held out data points with the updated params selects the best state and decides on the stopping
+        double monitored_cost = average_cost;
+        if (validation_data){
+            for (thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+                validation_args_arr[thread_pos].cost = 0;
+            }
+            if (run_work_job(thread_pool, validation_function, validation_args_arr) != SUCCESSFULL_EXECUTION_CODE){
+                printf("Problems in the validation of generation %zu\n", generation);
+                exit_code = OTHER_ERROR;
+                goto free_work_queue;
+            }
+            monitored_cost = 0;
+            for (thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+                monitored_cost += validation_args_arr[thread_pos].cost;
+            }
+            monitored_cost /= validation_rows;
+            printf("The validation cost of generation %zu was %f\n", generation, monitored_cost);
+        }
+        PROFILE_END(cost_start, PHASE_COST);
+
+        if (monitored_cost < min_av_cost){
+            PROFILE_BEGIN(save_start);
+            min_av_cost = monitored_cost;
             best_generation = generation;
+            if (dense_network){
+                write_back_dense_network(dense_network, network_array); // The state is saved from the linked list
+            }
             save_state(network_array,best_state); // Save the state
+            PROFILE_END(save_start, PHASE_SAVE_STATE);
+        }
+
+        if (PROFILING){
+            end_profile_generation(generation);
+        }
+
+        // 4.2 Stop once the cost did not decrease by MIN_IMPROVEMENT (relative) for PATIENCE generations
+        if (monitored_cost < improved_cost * (1 - MIN_IMPROVEMENT)){
+            improved_cost = monitored_cost;
+            stale_generations = 0;
+        } else if (PATIENCE && ++stale_generations >= PATIENCE){
+            printf("The cost did not improve by %g%% in the last %zu generations, stopping after generation %zu.\n",
+                   100 * MIN_IMPROVEMENT, PATIENCE, generation);
+            break;
         }
     }
 
-    printf("\nThe minimum average cost was %f in generation %i.\n", min_av_cost, best_generation);
+    if (PROFILING){
+        print_profile_summary();
+    }
+
+    printf("\nThe minimum %s cost was %f in generation %i.\n", validation_data ? "validation" : "average", min_av_cost, best_generation);
 
+    // Save the best model (the linked list is reset to the best state first)
+    if (SAVE_FILENAME || CHECKPOINT_FILENAME){
+        restore_state(network_array, best_state);
+    }
+    if (SAVE_FILENAME && save_network_to_csv(network_array, SAVE_FILENAME) != SUCCESSFULL_EXECUTION_CODE){
+        exit_code = FILE_ERROR;
+    }
+    // The optimizer state is only saved for the dense network: the moments of the linked list follow the indices of the connections,
+    // which are assigned in a different order when the checkpoint is loaded
+    if (CHECKPOINT_FILENAME && save_checkpoint(network_array, CHECKPOINT_FILENAME, dense_network ? optimizer : NULL) != SUCCESSFULL_EXECUTION_CODE){
+        exit_code = FILE_ERROR;
+    }
+
+free_work_queue:
+    free_work_queue(work_queue);
+free_gradient_descent_args_arr:
+    free(gradient_descent_args_arr);
 free_thread_args_arr:
     free(thread_args_arr);
+free_thread_pool:
+    free_thread_pool(thread_pool);
 free_threads:
-    free_thread_data_array(thread_data);
-free_state:
+    free_profile();
+    if (data_stream){
+        free(thread_data); // The rows belong to the windows of the stream
+    } else{
+        thread_data[0].input = data_input;   // The first thread may point into the middle of the rows after the mini batches
+        thread_data[0].output = data_output;
+        free_thread_data_array(thread_data);
+    }
+    free(validation_args_arr); // The held out rows belong to the data of the threads
+    for (size_t validation_pos = 0; validation_data && validation_pos < NUM_THREADS; validation_pos++){
+        free(validation_data[validation_pos].local_rows); // Copies of the held out rows (see 3.2.1)
+    }
+    free(validation_data);
+free_binary_dataset:
+    free_binary_dataset(&binary_dataset);
+close_data_stream:
+    if (data_stream){
+        close_data_stream(data_stream);
+    }
+free_optimizer:
+    free_optimizer(optimizer);
+free_dense_workspaces:
+    if (dense_workspaces){
+        free_dense_workspaces(dense_workspaces);
+    }
+    if (list_workspaces){
+        free_list_workspaces(list_workspaces);
+    }
+free_dense_network:
+    if (dense_network){
+        free_dense_network(dense_network);
+    }
     free_state(best_state);
 free_network:
+    close_checkpoint(&checkpoint);
     free_network(network_array);
 exit:
     return exit_code;
 }
 
 
+/*
+This function builds the Neural Network of a saved model (csv model or binary checkpoint).
+Stores the dimensions of the data the model was trained on in the pointer.
+Returns NULL if it fails*/
+static neuron** load_model(const char* filename, size_t* model_dimensions){
+
+    // Checkpoints rebuild the whole Neural Network, csv models are loaded into a new connected one
+    if (is_checkpoint(filename)){
+        CHECKPOINT checkpoint;
+        neuron** network_array = load_checkpoint(filename, &checkpoint);
+        if (!network_array){
+            printf("Could not load the checkpoint %s.\n", filename);
+            return NULL;
+        }
+        *model_dimensions = checkpoint.header->dimensions_data;
+        close_checkpoint(&checkpoint); // The optimizer state is not needed for a frozen model
+        return network_array;
+    }
+
+    neuron** network_array = seed_neural_network();
+    if (network_array == NULL){
+        perror("Memory allocation error for the  network array");
+        return NULL;
+    }
+
+    // The network array is freed by the function in case of an error
+    if (connect_neurons(network_array) != SUCCESSFULL_EXECUTION_CODE){
+        perror("Unsuccessfull connection of the network array.\n");
+        return NULL;
+    }
+
+    if (load_network_from_csv(network_array, filename, model_dimensions) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Could not load the model %s.\n", filename);
+        free_network(network_array);
+        return NULL;
+    }
+    return network_array;
+}
+
+
+/*
+This function predicts the outputs of the file with the model (MODEL_FILENAME) and writes them as csv.
+Only the forward pass is run: no costs, deltas, derivatives or gradient descent.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code.*/
+int run_predictions(void){
+
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+
+/**************************************************
+ * 1. Build the Neural Network and load the model *
+ *************************************************/
+
+    size_t model_dimensions; // Dimensions of the data the model was trained on
+    neuron** network_array = load_model(MODEL_FILENAME, &model_dimensions);
+    if (!network_array){
+        return OTHER_ERROR;
+    }
+
+/*****************************************
+ * 2. Read in the data and distribute it *
+ ****************************************/
+
+    // The outputs of the rows are left for the predictions
+    INPUT_OUTPUT_MAPPING* data_of_file = parse_unlabelled_csv(FILENAME);
+    if (!data_of_file){
+        printf("Could not read in the data of the file %s.\n", FILENAME);
+        exit_code = OTHER_ERROR;
+        goto free_network;
+    }
+    if (DIMENSIONS_DATA != model_dimensions){
+        printf("The data points of %s have %zu dimensions, the model was trained on %zu.\n", FILENAME, DIMENSIONS_DATA, model_dimensions);
+        free_input_output_mapping(data_of_file);
+        exit_code = OTHER_ERROR;
+        goto free_network;
+    }
+    size_t num_data = SIZE_TRAIN;
+
+    THREAD_DATA* thread_data = distribute_data_among_threads(data_of_file);
+    if (!thread_data){
+        perror("Could not distribute the data to the different threads.\n");
+        free_input_output_mapping(data_of_file);
+        exit_code = OTHER_ERROR;
+        goto free_network;
+    }
+
+/***************************************************
+ * 3. Predict the outputs with the pool of threads *
+ **************************************************/
+
+    // The predictions only need the inputs and outputs of the neurons (no derivatives)
+    DENSE_NETWORK* dense_network = compile_network(network_array);
+    DENSE_WORKSPACE* dense_workspaces = NULL;
+    LIST_WORKSPACE* list_workspaces = NULL;
+    if (dense_network){
+        dense_workspaces = initialise_dense_predict_workspaces(dense_network);
+    } else{
+        list_workspaces = initialise_list_workspaces();
+    }
+    if (!dense_workspaces && !list_workspaces){
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_dense_network;
+    }
+
+    THREAD_POOL* thread_pool = create_thread_pool(NUM_THREADS);
+    if (!thread_pool){
+        perror("Could not create the thread pool.\n");
+        exit_code = THREAD_CREATION_ERROR;
+        goto free_workspaces;
+    }
+
+    THREAD_ARGS* thread_args_arr = calloc(NUM_THREADS, size_thread_args);
+    if (!thread_args_arr){
+        perror("Memory allocation error when trying to calloc memory of THREAD_ARGS array.\n");
+        exit_code = MEMORY_ALLOCATION_ERROR;
+        goto free_thread_pool;
+    }
+
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        thread_args_arr[thread_pos].pos = thread_pos;
+        thread_args_arr[thread_pos].data = &thread_data[thread_pos];
+        thread_args_arr[thread_pos].network_arr = network_array;
+        thread_args_arr[thread_pos].dense_network = dense_network;
+        thread_args_arr[thread_pos].workspace = dense_network ? &dense_workspaces[thread_pos] : NULL;
+        thread_args_arr[thread_pos].list_workspace = dense_network ? NULL : &list_workspaces[thread_pos];
+    }
+
+    if (run_thread_pool(thread_pool, dense_network ? &dense_predict_thread : &predict_thread, (void*) thread_args_arr, size_thread_args) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Problems when predicting the outputs.\n");
+        exit_code = OTHER_ERROR;
+        goto free_thread_args_arr;
+    }
+
+    // 4. Write the predictions (the rows of all threads are one array starting at the rows of the first thread)
+    exit_code = save_predictions_to_csv(thread_data[0].output, num_data, PREDICTIONS_FILENAME);
+
+free_thread_args_arr:
+    free(thread_args_arr);
+free_thread_pool:
+    free_thread_pool(thread_pool);
+free_workspaces:
+    if (dense_workspaces){
+        free_dense_workspaces(dense_workspaces);
+    }
+    if (list_workspaces){
+        free_list_workspaces(list_workspaces);
+    }
+free_dense_network:
+    if (dense_network){
+        free_dense_network(dense_network);
+    }
+    free_thread_data_array(thread_data);
+free_network:
+    free_network(network_array);
+    return exit_code;
+}
+
+
+/*
+This function writes the standalone C scorer of the model (FILENAME) into CODEGEN_FILENAME.
+Returns SUCCESSFULL_EXECUTION_CODE or an error code.*/
+int run_code_generation(void){
+
+    size_t model_dimensions; // Dimensions of the data the model was trained on
+    neuron** network_array = load_model(FILENAME, &model_dimensions);
+    if (!network_array){
+        return OTHER_ERROR;
+    }
+
+    int exit_code = generate_scorer(network_array, model_dimensions, CODEGEN_FILENAME);
+
+    free_network(network_array);
+    return exit_code;
+}
+
+
 int main(int argc, char *argv[]){
 
-    // Check if the name of the file is supposed to come from the command line
-    #if  !defined(DEMO) && !defined(DEBUG)
-    if (process_command_args(argc, argv) != SUCCESSFULL_EXECUTION_CODE){
-        return FILE_ERROR;
+    // Get the options and the file (DEMO and DEBUG already set the name of the file)
+    int exit_code = process_command_args(argc, argv);
+    if (exit_code != SUCCESSFULL_EXECUTION_CODE){
+        return exit_code;
+    }
+
+    // Only convert the CSV if asked to
+    if (CONVERT_FILENAME){
+        return convert_csv_to_binary(FILENAME, CONVERT_FILENAME, CONVERT_SCALAR_SIZE);
+    }
+
+    // Only predict the outputs if a model is given
+    if (MODEL_FILENAME){
+        return run_predictions();
+    }
+
+    // Only generate the scorer of the model if asked to
+    if (CODEGEN_FILENAME){
+        return run_code_generation();
     }
-    #else
-    (void) argc;  // Shut "argc unused" warning
-    (void) argv;  // Shut "argv unused" warning
-    #endif // DEMO && DEBUG
 
     #ifdef PERFORMANCE_FLAG
     return TIME_THIS(run_neural_network());
@@ -4,6 +4,12 @@
 // Function that handles and runs the entire Neural Network
 int run_neural_network(void);
 
+// Function that predicts the outputs of a file with a saved model
+int run_predictions(void);
+
+// Function that generates the standalone C scorer of a saved model
+int run_code_generation(void);
+
 // Function to process the command line arguments
 int process_command_args(int, char*[]);
 
@@ -0,0 +1,190 @@
+/*
+This file holds the matrix kernels of the mini-batch training engine.
+All matrices are dense, row-major arrays of scalars (double, or float in single and mixed precision). For every function C is an [m][n] matrix and k is the inner dimension.
+
+The loops are blocked, so that a tile of the right-hand matrix stays in the cache while all rows of the left-hand
+matrix stream through it, and the innermost loops run over contiguous memory (allowing the compiler to vectorise them).
+
+The release build is not compiled with -march=native, so every matrix product is compiled three times (for the baseline
+instruction set, AVX2 and AVX-512) and the widest version the CPU supports is run (see MULTIVERSION_PRODUCT()).
+The versions only differ in the width of the vectors: the additions are done in the same order, so the results are the same.
+
+This file may not use any header files but its own (which only includes the scalar type of precision.h).*/
+
+#include "matrix.h"
+
+// Sizes of the tiles of the blocked loops (a BLOCK_K x BLOCK_N tile of doubles fits into the L2 cache)
+#define BLOCK_M 32
+#define BLOCK_K 64
+#define BLOCK_N 256
+
+// Minimum of two size_t
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+
+/*
+Compiles the always inlined body name_body() of a matrix product for the baseline instruction set, AVX2 and AVX-512
+(with the target avx512_target) and defines the function name, which runs the widest version the CPU supports.
+__builtin_cpu_supports() only reads the features libgcc detected at startup, which is cheap next to a matrix product.*/
+#if defined(__x86_64__) || defined(__i386__)
+#define MULTIVERSION_PRODUCT(name, avx512_target)                                                                                       \
+    static void name##_default(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){   \
+        name##_body(A, B, C, m, k, n);                                                                                                  \
+    }                                                                                                                                   \
+    __attribute__((target("avx2,fma")))                                                                                                 \
+    static void name##_avx2(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){      \
+        name##_body(A, B, C, m, k, n);                                                                                                  \
+    }                                                                                                                                   \
+    __attribute__((target(avx512_target)))                                                                                              \
+    static void name##_avx512(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){    \
+        name##_body(A, B, C, m, k, n);                                                                                                  \
+    }                                                                                                                                   \
+    void name(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){                    \
+        if (__builtin_cpu_supports("avx512f")){                                                                                         \
+            name##_avx512(A, B, C, m, k, n);                                                                                            \
+        } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){                                                    \
+            name##_avx2(A, B, C, m, k, n);                                                                                              \
+        } else{                                                                                                                         \
+            name##_default(A, B, C, m, k, n);                                                                                           \
+        }                                                                                                                               \
+    }
+#else
+#define MULTIVERSION_PRODUCT(name, avx512_target)                                                                                       \
+    void name(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){                    \
+        name##_body(A, B, C, m, k, n);                                                                                                  \
+    }
+#endif
+
+
+/*
+Dot product of two arrays of length k.
+Uses four accumulators to break the dependency chain of the additions.*/
+static inline __attribute__((always_inline)) scalar dot_product(const scalar* restrict a, const scalar* restrict b, size_t k){
+    scalar sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+    size_t p = 0;
+    for (; p + 4 <= k; p += 4){
+        sum0 += a[p] * b[p];
+        sum1 += a[p + 1] * b[p + 1];
+        sum2 += a[p + 2] * b[p + 2];
+        sum3 += a[p + 3] * b[p + 3];
+    }
+    for (; p < k; p++){
+        sum0 += a[p] * b[p];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+
+/*
+C[m][n] += A[m][k] * B[k][n]
+Used for the forward pass: inputs of the next layer += outputs of this layer * weights.*/
+static inline __attribute__((always_inline)) void matrix_multiply_add_body(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){
+
+    for (size_t j0 = 0; j0 < n; j0 += BLOCK_N){
+        size_t j1 = MIN(j0 + BLOCK_N, n);
+
+        for (size_t p0 = 0; p0 < k; p0 += BLOCK_K){
+            size_t p1 = MIN(p0 + BLOCK_K, k);
+
+            // The tile B[p0:p1][j0:j1] stays in the cache for all rows of A
+            for (size_t i = 0; i < m; i++){
+                const scalar* a_row = A + i * k;
+                scalar* c_row = C + i * n;
+
+                for (size_t p = p0; p < p1; p++){
+                    scalar a = a_row[p];
+                    const scalar* b_row = B + p * n;
+
+                    for (size_t j = j0; j < j1; j++){
+                        c_row[j] += a * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+MULTIVERSION_PRODUCT(matrix_multiply_add, "avx512f")
+
+
+/*
+C[m][n] += A[k][m]^T * B[k][n]
+Used for the weight derivatives: derivative of the weights += outputs of this layer^T * deltas of the next layer.*/
+static inline __attribute__((always_inline)) void matrix_multiply_add_transposed_a_body(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){
+
+    for (size_t j0 = 0; j0 < n; j0 += BLOCK_N){
+        size_t j1 = MIN(j0 + BLOCK_N, n);
+
+        for (size_t i0 = 0; i0 < m; i0 += BLOCK_M){
+            size_t i1 = MIN(i0 + BLOCK_M, m);
+
+            // The tile C[i0:i1][j0:j1] stays in the cache for all rows of A and B
+            for (size_t p = 0; p < k; p++){
+                const scalar* a_row = A + p * m;
+                const scalar* b_row = B + p * n;
+
+                for (size_t i = i0; i < i1; i++){
+                    scalar a = a_row[i];
+                    scalar* c_row = C + i * n;
+
+                    for (size_t j = j0; j < j1; j++){
+                        c_row[j] += a * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+MULTIVERSION_PRODUCT(matrix_multiply_add_transposed_a, "avx512f")
+
+
+/*
+C[m][n] = A[m][k] * B[n][k]^T
+Used for the backward pass: summed deltas of this layer = deltas of the next layer * weights^T.*/
+static inline __attribute__((always_inline)) void matrix_multiply_transposed_b_body(const scalar* restrict A, const scalar* restrict B, scalar* restrict C, size_t m, size_t k, size_t n){
+
+    for (size_t j0 = 0; j0 < n; j0 += BLOCK_M){
+        size_t j1 = MIN(j0 + BLOCK_M, n);
+
+        // The rows B[j0:j1] stay in the cache for all rows of A
+        for (size_t i = 0; i < m; i++){
+            const scalar* a_row = A + i * k;
+            scalar* c_row = C + i * n;
+
+            for (size_t j = j0; j < j1; j++){
+                c_row[j] = dot_product(a_row, B + j * k, k);
+            }
+        }
+    }
+}
+
+// The dot products with the rows of B are strided across j: with 512 bit vectors the compiler gathers them, which is slower than AVX2
+MULTIVERSION_PRODUCT(matrix_multiply_transposed_b, "avx512f,prefer-vector-width=256")
+
+
+/*
+Copies the array row[n] into every row of C[m][n].
+Used to initialise the inputs of a layer with its biases.*/
+void matrix_broadcast_row(const scalar* restrict row, scalar* restrict C, size_t m, size_t n){
+    for (size_t i = 0; i < m; i++){
+        scalar* c_row = C + i * n;
+        for (size_t j = 0; j < n; j++){
+            c_row[j] = row[j];
+        }
+    }
+}
+
+
+/*
+sums[n] += sum over the rows of A[m][n]
+Used for the bias derivatives: derivative of the biases += sum of the deltas of the batch.*/
+void matrix_add_column_sums(const scalar* restrict A, scalar* restrict sums, size_t m, size_t n){
+    for (size_t i = 0; i < m; i++){
+        const scalar* a_row = A + i * n;
+        for (size_t j = 0; j < n; j++){
+            sums[j] += a_row[j];
+        }
+    }
+}
@@ -0,0 +1,19 @@
+/*
+Header file of the matrix file.
+All matrices are dense, row-major arrays of scalars (double or float, see configurations/precision.h).*/
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+
+#include "../../configurations/precision.h"
+
+void matrix_multiply_add(const scalar*, const scalar*, scalar*, size_t, size_t, size_t);
+void matrix_multiply_add_transposed_a(const scalar*, const scalar*, scalar*, size_t, size_t, size_t);
+void matrix_multiply_transposed_b(const scalar*, const scalar*, scalar*, size_t, size_t, size_t);
+
+void matrix_broadcast_row(const scalar*, scalar*, size_t, size_t);
+void matrix_add_column_sums(const scalar*, scalar*, size_t, size_t);
+
+#endif // MATRIX_H
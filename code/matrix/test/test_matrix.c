@@ -0,0 +1,182 @@
+/*
+Test file for the matrix kernels.
+May not be included in any other files. Its own purpose is for testing.
+
+Every kernel is compared against a naive triple loop.
+The sizes are chosen to not be multiples of the tiles, so that the edges of the blocked loops are tested.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_matrix.h"
+
+
+/*
+Fills a matrix with deterministic values in [-1, 1)*/
+void fill_matrix(scalar* matrix, size_t size){
+    for (size_t i = 0; i < size; i++){
+        matrix[i] = (scalar) ((i * 7919) % 2000) / 1000.0 - 1.0;
+    }
+}
+
+
+/*
+Tests C[m][n] += A[m][k] * B[k][n]*/
+void test_multiply_add(size_t m, size_t k, size_t n){
+    scalar* A = malloc(m * k * sizeof(scalar));
+    scalar* B = malloc(k * n * sizeof(scalar));
+    scalar* C = malloc(m * n * sizeof(scalar));
+    assert(A && B && C);
+
+    fill_matrix(A, m * k);
+    fill_matrix(B, k * n);
+    fill_matrix(C, m * n);
+
+    // Start from a non-zero C to test the accumulation
+    scalar* expected = malloc(m * n * sizeof(scalar));
+    assert(expected);
+    for (size_t i = 0; i < m; i++){
+        for (size_t j = 0; j < n; j++){
+            scalar sum = C[i * n + j];
+            for (size_t p = 0; p < k; p++){
+                sum += A[i * k + p] * B[p * n + j];
+            }
+            expected[i * n + j] = sum;
+        }
+    }
+
+    matrix_multiply_add(A, B, C, m, k, n);
+
+    for (size_t i = 0; i < m * n; i++){
+        COMPARE(C[i], expected[i]);
+    }
+
+    free(A);
+    free(B);
+    free(C);
+    free(expected);
+    return;
+}
+
+
+/*
+Tests C[m][n] += A[k][m]^T * B[k][n]*/
+void test_multiply_add_transposed_a(size_t m, size_t k, size_t n){
+    scalar* A = malloc(k * m * sizeof(scalar));
+    scalar* B = malloc(k * n * sizeof(scalar));
+    scalar* C = malloc(m * n * sizeof(scalar));
+    scalar* expected = malloc(m * n * sizeof(scalar));
+    assert(A && B && C && expected);
+
+    fill_matrix(A, k * m);
+    fill_matrix(B, k * n);
+    fill_matrix(C, m * n);
+
+    for (size_t i = 0; i < m; i++){
+        for (size_t j = 0; j < n; j++){
+            scalar sum = C[i * n + j];
+            for (size_t p = 0; p < k; p++){
+                sum += A[p * m + i] * B[p * n + j];
+            }
+            expected[i * n + j] = sum;
+        }
+    }
+
+    matrix_multiply_add_transposed_a(A, B, C, m, k, n);
+
+    for (size_t i = 0; i < m * n; i++){
+        COMPARE(C[i], expected[i]);
+    }
+
+    free(A);
+    free(B);
+    free(C);
+    free(expected);
+    return;
+}
+
+
+/*
+Tests C[m][n] = A[m][k] * B[n][k]^T (C is overwritten)*/
+void test_multiply_transposed_b(size_t m, size_t k, size_t n){
+    scalar* A = malloc(m * k * sizeof(scalar));
+    scalar* B = malloc(n * k * sizeof(scalar));
+    scalar* C = malloc(m * n * sizeof(scalar));
+    scalar* expected = malloc(m * n * sizeof(scalar));
+    assert(A && B && C && expected);
+
+    fill_matrix(A, m * k);
+    fill_matrix(B, n * k);
+    fill_matrix(C, m * n);
+
+    for (size_t i = 0; i < m; i++){
+        for (size_t j = 0; j < n; j++){
+            scalar sum = 0;
+            for (size_t p = 0; p < k; p++){
+                sum += A[i * k + p] * B[j * k + p];
+            }
+            expected[i * n + j] = sum;
+        }
+    }
+
+    matrix_multiply_transposed_b(A, B, C, m, k, n);
+
+    for (size_t i = 0; i < m * n; i++){
+        COMPARE(C[i], expected[i]);
+    }
+
+    free(A);
+    free(B);
+    free(C);
+    free(expected);
+    return;
+}
+
+
+/*
+Tests the broadcast of the biases and the column sums of the bias derivatives*/
+void test_broadcast_and_column_sums(void){
+    scalar row[3] = {1, -2, 0.5};
+    scalar C[2 * 3];
+
+    matrix_broadcast_row(row, C, 2, 3);
+    for (size_t i = 0; i < 2; i++){
+        for (size_t j = 0; j < 3; j++){
+            COMPARE(C[i * 3 + j], row[j]);
+        }
+    }
+
+    scalar sums[3] = {1, 1, 1};
+    matrix_add_column_sums(C, sums, 2, 3);
+    COMPARE(sums[0], 3);
+    COMPARE(sums[1], -3);
+    COMPARE(sums[2], 2);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Shapes of a batch of one data point, of the test network and shapes crossing the tile sizes
+    size_t shapes[][3] = {{1, 1, 1}, {1, 3, 1}, {4, 1, 1}, {7, 13, 5}, {33, 65, 257}, {70, 130, 300}};
+    size_t num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+
+    for (size_t i = 0; i < num_shapes; i++){
+        test_multiply_add(shapes[i][0], shapes[i][1], shapes[i][2]);
+        test_multiply_add_transposed_a(shapes[i][0], shapes[i][1], shapes[i][2]);
+        test_multiply_transposed_b(shapes[i][0], shapes[i][1], shapes[i][2]);
+    }
+    test_broadcast_and_column_sums();
+
+    printf("All tests for matrix successfully executed.\n");
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
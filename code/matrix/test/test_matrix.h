@@ -0,0 +1,20 @@
+/*
+Header file of the file to test the matrix kernels.
+May only be included in its own .c file.*/
+
+#ifndef TEST_MATRIX_H
+#define TEST_MATRIX_H
+
+#include "../../../configurations/config_manager.h"
+#include "../matrix.h"
+
+void fill_matrix(scalar*, size_t);
+
+void test_multiply_add(size_t, size_t, size_t);
+void test_multiply_add_transposed_a(size_t, size_t, size_t);
+void test_multiply_transposed_b(size_t, size_t, size_t);
+void test_broadcast_and_column_sums(void);
+
+int test_handler_func(void);
+
+#endif //TEST_MATRIX_H
@@ -2,10 +2,14 @@
 This file is responsible for the creation of the Neural Network architecture.
 In addition, it also holds the data for the freeing of the allocated data
 
+The neurons and connections are allocated from an arena owned by the network (see NETWORK_ARENA in structs.h),
+so that a network is built with one allocation and freed with one free.
+
 The network will be created using random weights and biases
 
 Includes structs.h to use the neuron and node_linked_list_connection structs
 Includes time.h for random seeding.
+Includes system_info.h to align the LIST_WORKSPACE of every thread to a cache line.
 Is prohibited from using any other header files
 
 Error should always print a message with the necessary information.
@@ -20,6 +24,7 @@ Error messages should be printed when they arise, not when they are processed.
 #include <string.h>
 
 #include "neurons.h"
+#include "../system_info/system_info.h"
 
 #ifdef TEST_MODE
 // For testing the weights are initialised to 1 to transmit the data without changes throughout the Network
@@ -32,26 +37,69 @@ Error messages should be printed when they arise, not when they are processed.
 #define BIAS_INITIALISER() random_number()
 #endif // TEST_MODE
 
+// Incremented on every added or deleted connection. A DENSE_NETWORK compiled at an older version is stale.
+size_t TOPOLOGY_VERSION = 0;
+
+// Number of connection indices handed out so far. Every connection gets its own index, indices are never reused.
+size_t NUM_CONNECTIONS = 0;
+
 /*
-Function to allocate space for and create a new neuron
-Returns NULL if it fails*/
-extern inline neuron* create_new_neuron(size_t pos){
-    neuron* new_neuron = (neuron*) malloc(size_neuron);
-    if (!new_neuron){
-        return NULL;
-    }
+Function to create a new neuron in the memory given (its slot in the arena of the network).
+Only used by seed_neural_network(), so it is not declared in neurons.h (an inline declaration there warns in every file including it)
+Returns the neuron*/
+static inline neuron* create_new_neuron(neuron* new_neuron, size_t pos){
     new_neuron->pos = pos;            // Assign the position
     new_neuron->next_layer = NULL;    // Initialise the next_layer to NULL for now
 
-    double bias = BIAS_INITIALISER(); // Initialise the bias
-    new_neuron->bias = bias;          // Set the bias to the initialised number
+    new_neuron->bias = BIAS_INITIALISER(); // Initialise the bias
+
+    return new_neuron;
+}
+
+
+// Minimum number of connections of an ARENA_CHUNK (connections added after the first chunk is full)
+#define MIN_ARENA_CHUNK 1024
 
-    // Set all input fields to the respective bias.
-    for (int i = 0; i < NUM_THREADS; i++){
-        new_neuron->input[i] = bias;
+/*
+Returns the NETWORK_ARENA of the network array (the header of its block, see structs.h)*/
+static inline NETWORK_ARENA* network_arena(neuron** network_array){
+    return (NETWORK_ARENA*) ((char*) network_array - sizeof(NETWORK_ARENA));
+}
+
+
+/*
+Returns the number of connections of the fully connected layers (the connections made by connect_neurons())*/
+static size_t default_connections(void){
+    size_t connections = 0;
+    for (size_t layer = 0; layer < NUMBER_LAYERS - 1; layer++){
+        connections += NEURON_NUMBERS[layer] * NEURON_NUMBERS[layer + 1];
     }
+    return connections;
+}
 
-    return new_neuron;
+
+/*
+Takes the next connection from the arena of the network (bump pointer).
+A new ARENA_CHUNK is allocated if the current chunk is full (MIN_ARENA_CHUNK connections first, then twice as many as the last one).
+Returns NULL if it fails*/
+static node_linked_list_connection* allocate_connection(neuron** network_array){
+    NETWORK_ARENA* arena = network_arena(network_array);
+
+    if (arena->used == arena->capacity){
+        size_t capacity = arena->chunks ? 2 * arena->capacity : MIN_ARENA_CHUNK;
+
+        ARENA_CHUNK* chunk = malloc(sizeof(ARENA_CHUNK) + capacity * size_linked_list_connection);
+        if (!chunk){
+            return NULL;
+        }
+        chunk->previous = arena->chunks;
+        arena->chunks = chunk;
+        arena->connections = chunk->connections;
+        arena->used = 0;
+        arena->capacity = capacity;
+    }
+
+    return &arena->connections[arena->used++];
 }
 
 
@@ -59,7 +107,8 @@ extern inline neuron* create_new_neuron(size_t pos){
 Allocated memory for an array and seeds the Neurons into it.
 No connection or manipulation done yet.
 
-In case of failure, the data will be freed immediately
+The network array, the neurons and the connections of the fully connected layers are one block (the arena of the network, see structs.h),
+so that building the Neural Network is one allocation and freeing it one free.
 
 In case of an error, it return NULL.*/
 neuron** seed_neural_network(void){
@@ -68,29 +117,28 @@ neuron** seed_neural_network(void){
     // Initialise the length constants of the neural network.
     initialise_length_network();
 
-    // 1. Allocate memory for the array of pointers to neurons (and initialise all pointer to NULL)
-    // Array of pointers to neurons (Initialised to be all NULL)
-    neuron** network_array = (neuron**) calloc(LENGTH_NETWORK, sizeof(neuron*));
+    // 1. Allocate the block of the network: the arena, the array of pointers to neurons, the neurons and the connections
+    size_t first_chunk = default_connections();
+    NETWORK_ARENA* arena = malloc(sizeof(NETWORK_ARENA) + LENGTH_NETWORK * (sizeof(neuron*) + size_neuron) + first_chunk * size_linked_list_connection);
 
-    if (network_array == NULL){
+    if (arena == NULL){
         // Memory allocation error
         perror("Memory allocation error when trying to allocate memory for network_array.\n");
         return NULL;
     }
 
-    // 2. Initialise the neurons in the array with the respective values for its fields
-    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+    neuron** network_array = (neuron**) (arena + 1);
+    neuron* neurons = (neuron*) (network_array + LENGTH_NETWORK);
 
-        neuron* new_neuron = create_new_neuron(pos);
+    arena->connections = (node_linked_list_connection*) (neurons + LENGTH_NETWORK);
+    arena->used = 0;
+    arena->capacity = first_chunk;
+    arena->first_chunk = first_chunk;
+    arena->chunks = NULL;
 
-        if (new_neuron == NULL){
-            // Case when memory allocation fails
-            perror("Memory allocation error when creating neurons.\n");
-            free_network(network_array);
-            return NULL;
-        }
-
-        network_array[pos] = new_neuron; // Assign the neuron to the network_array
+    // 2. Initialise the neurons in the array with the respective values for its fields
+    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
+        network_array[pos] = create_new_neuron(&neurons[pos], pos); // Assign the neuron to the network_array
     }
 
     return network_array;
@@ -152,12 +200,13 @@ int connect_neurons(neuron** network_array){
 
 /*Function to connect two neurons in a network array inplace.
 Takes ptr_start and ptr_end as args, which are the location of the neurons to connect in the network array
+The connection is taken from the arena of the network.
 
 Memory allocation errors are not handled in this function*/
 int add_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
 
-    // Create a new node in the linked list of connections to link the new node
-    node_linked_list_connection* new_node = (node_linked_list_connection*) malloc(size_linked_list_connection);
+    // Create a new node in the linked list of connections to link the new node (next to the connections created before it)
+    node_linked_list_connection* new_node = allocate_connection(network_array);
 
     if (new_node == NULL){
         // Case where memory allocation failed
@@ -168,14 +217,18 @@ int add_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
     new_node->data = network_array[ptr_end];               // The data of the new node will be the neuron situated in the respective position in the network array
     new_node->next = network_array[ptr_start]->next_layer; // Connect the new_node to the existing linked list of the neuron
     new_node->weight = WEIGHT_INITIALISER();               // Initialise the weight. In testing, this is simplified to be 1.
+    new_node->index = NUM_CONNECTIONS++;                   // Position of the derivative of the weight in the LIST_WORKSPACE
     network_array[ptr_start]->next_layer = new_node;       // Connect the new linked list to the neuron it belongs to
 
+    TOPOLOGY_VERSION++;                                    // Mark compiled copies of the network as stale
+
     return SUCCESSFULL_EXECUTION_CODE;
 }
 
 
 /*Function to deleted the connection between two neurons inplace.
-Takes ptr_start and ptr_end as args, which are the location of the neurons to connect in the network array*/
+Takes ptr_start and ptr_end as args, which are the location of the neurons to connect in the network array
+The memory of the connection stays in the arena of the network until the network is freed.*/
 int del_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
 
     neuron* neuron_to_delete_from = network_array[ptr_start];
@@ -186,6 +239,7 @@ int del_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
     // Special case when we delete the first node (we can not jump it as there is no previous neuron)
     if (current->data == neuron_to_delete){
         neuron_to_delete_from->next_layer = current->next; // Skip that node directly
+        TOPOLOGY_VERSION++;                                // Mark compiled copies of the network as stale
         return SUCCESSFULL_EXECUTION_CODE;
     }
 
@@ -193,6 +247,7 @@ int del_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
     while (current != NULL){                           // Iterate over the entire linked list
         if(current->next->data == neuron_to_delete){   // Case when the next neuron is the connection to delete
             current->next = current->next->next;       // Skip the next node by assigning the node after it as next
+            TOPOLOGY_VERSION++;                        // Mark compiled copies of the network as stale
             return SUCCESSFULL_EXECUTION_CODE;
         }
         current = current->next; // Move to the next node
@@ -204,32 +259,131 @@ int del_connection(neuron** network_array, size_t ptr_start, size_t ptr_end){
 
 
 /*
-Function to set the bias for a node in the neural network.
-This has the problem that the bias is also used as input in the respective field.*/
+Function to set the bias for a node in the neural network.*/
 void set_bias(neuron** network_arr, size_t pos, double val){
     network_arr[pos]->bias = val;
-    for (size_t i = 0; i < NUM_THREADS; i++){
-        network_arr[pos]->input[i] = val;
+}
+
+
+/*
+Allocates the arrays of one LIST_WORKSPACE for capacity connections in one zeroed block starting at a cache line.
+Returns MEMORY_ALLOCATION_ERROR if it fails (the workspace is not changed)*/
+static int allocate_list_workspace(LIST_WORKSPACE* workspace, size_t capacity){
+
+    // inputs, deltas and der_biases of every neuron followed by the derivatives of every connection
+    double* block = cache_aligned_calloc((3 * LENGTH_NETWORK + capacity) * sizeof(double));
+    if (!block){
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    workspace->inputs = block;
+    workspace->deltas = block + LENGTH_NETWORK;
+    workspace->der_biases = block + 2 * LENGTH_NETWORK;
+    workspace->der_weights = block + 3 * LENGTH_NETWORK;
+    workspace->capacity = capacity;
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to allocate one LIST_WORKSPACE for every thread (for the connections existing so far).
+Returns NULL if it fails*/
+LIST_WORKSPACE* initialise_list_workspaces(void){
+
+    LIST_WORKSPACE* workspaces = calloc(NUM_THREADS, sizeof(LIST_WORKSPACE));
+    if (!workspaces){
+        perror("Memory allocation error when trying to allocate the LIST_WORKSPACE array.\n");
+        return NULL;
     }
+
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        if (allocate_list_workspace(&workspaces[thread_pos], NUM_CONNECTIONS) != SUCCESSFULL_EXECUTION_CODE){
+            printf("Memory allocation error when trying to allocate the LIST_WORKSPACE of thread %zu.\n", thread_pos);
+            free_list_workspaces(workspaces); // Works as the workspaces are calloced (unallocated blocks are NULL)
+            return NULL;
+        }
+    }
+
+    return workspaces;
 }
 
 
-// Function to free the neural network. As neuron* are initialised to be NULL, this works for uninitialised network arrays.
-void free_network(neuron** network_array){
-    for (size_t pos = 0; pos < LENGTH_NETWORK; pos++){
-        neuron* curr = network_array[pos];
+/*
+Function to grow the LIST_WORKSPACE of every thread if connections were added since their allocation.
+Has to be called between two generations (the accumulated derivatives are kept).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+int update_list_workspaces(LIST_WORKSPACE* workspaces){
+
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        LIST_WORKSPACE* workspace = &workspaces[thread_pos];
+        if (workspace->capacity >= NUM_CONNECTIONS){
+            continue;
+        }
 
-        if (curr == NULL){
-            // Last initialised neuron reached
-            return;
+        LIST_WORKSPACE grown;
+        if (allocate_list_workspace(&grown, NUM_CONNECTIONS) != SUCCESSFULL_EXECUTION_CODE){
+            printf("Memory allocation error when trying to grow the LIST_WORKSPACE of thread %zu.\n", thread_pos);
+            return MEMORY_ALLOCATION_ERROR;
         }
-        free_linked_list(curr->next_layer);
-        free(curr);
+
+        // Keep the state of the neurons and the derivatives of the existing connections
+        memcpy(grown.inputs, workspace->inputs, (3 * LENGTH_NETWORK + workspace->capacity) * sizeof(double));
+
+        free(workspace->inputs); // Start of the block of the workspace
+        *workspace = grown;
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to move the LIST_WORKSPACE of a thread into a new block allocated (and first touched) by the calling thread.
+Called by the pinned worker of the workspace, so that the kernel places the workspace on the NUMA node of the worker
+(until update_list_workspaces() grows it on the calling thread). Has to be called between two generations (the contents are kept).
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR (the workspace is not changed)*/
+int localise_list_workspace(LIST_WORKSPACE* workspace){
+
+    LIST_WORKSPACE local;
+    if (allocate_list_workspace(&local, workspace->capacity) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Memory allocation error when trying to move a LIST_WORKSPACE.\n");
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    memcpy(local.inputs, workspace->inputs, (3 * LENGTH_NETWORK + workspace->capacity) * sizeof(double));
+
+    free(workspace->inputs); // Start of the block of the workspace
+    *workspace = local;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to free the array of LIST_WORKSPACE*/
+void free_list_workspaces(LIST_WORKSPACE* workspaces){
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        free(workspaces[thread_pos].inputs); // Start of the block of the workspace
+    }
+    free(workspaces);
+}
+
+
+// Function to free the neural network (its arena: the network array, the neurons and all connections)
+void free_network(neuron** network_array){
+    if (network_array == NULL){
+        return;
+    }
+
+    NETWORK_ARENA* arena = network_arena(network_array);
+    while (arena->chunks != NULL){
+        ARENA_CHUNK* previous = arena->chunks->previous;
+        free(arena->chunks);
+        arena->chunks = previous;
     }
+    free(arena);
 }
 
 
-// Function to free the linked list of the neurons
+// Function to free a linked list of connections allocated with malloc (the connections of a network belong to its arena)
 void free_linked_list(node_linked_list_connection* current){
     node_linked_list_connection* temp;
 
@@ -12,9 +12,6 @@ The entire architecture should be managed by this file.
 
 
 // Functions declared in this file
-extern inline neuron* create_new_neuron(size_t);
-
-
 neuron** seed_neural_network(void);
 int connect_neurons(neuron**);
 
@@ -23,10 +20,21 @@ int add_connection(neuron**, size_t, size_t);
 
 void set_bias(neuron**, size_t, double);
 
+LIST_WORKSPACE* initialise_list_workspaces(void);
+int update_list_workspaces(LIST_WORKSPACE*);
+int localise_list_workspace(LIST_WORKSPACE*);
+void free_list_workspaces(LIST_WORKSPACE*);
+
 float random_number(void);
 void seed_random(void);
 
 void free_network(neuron**);
 void free_linked_list(node_linked_list_connection*);
 
+// Counter incremented on every change of the connections (used to resync the DENSE_NETWORK)
+extern size_t TOPOLOGY_VERSION;
+
+// Number of connection indices handed out so far (size needed for the der_weights of a LIST_WORKSPACE)
+extern size_t NUM_CONNECTIONS;
+
 #endif //NEURONS_H
\ No newline at end of file
@@ -189,6 +189,43 @@ void test_disconnect_connect_neurons(neuron** dummy_neural_network){
     return;
 }
 
+/*
+Tests that the neurons and the connections are taken one after the other from the arena of the network:
+the neurons follow each other, the first connection follows the last neuron and the connections of a neuron are next to each other
+(also after the first chunk of the arena is full)*/
+void test_network_arena(void){
+    neuron** network_arr = seed_neural_network();
+    assert(network_arr);
+    assert(connect_neurons(network_arr) == SUCCESSFULL_EXECUTION_CODE);
+
+    for (size_t pos = 1; pos < LENGTH_NETWORK; pos++){
+        assert(network_arr[pos] == network_arr[pos - 1] + 1);
+    }
+    assert((void*) network_arr[0]->next_layer == (void*) (network_arr[LENGTH_NETWORK - 1] + 1));
+
+    // Add enough connections to the first neuron to fill several chunks
+    size_t added = 5000;
+    for (size_t i = 0; i < added; i++){
+        assert(add_connection(network_arr, 0, LENGTH_NETWORK - 1) == SUCCESSFULL_EXECUTION_CODE);
+    }
+
+    // add_connection() puts the new connection in front, so the list walks down the arena
+    size_t connections = 0;
+    size_t jumps = 0;
+    for (node_linked_list_connection* connection = network_arr[0]->next_layer; connection; connection = connection->next){
+        if (connection->next && connection->next != connection - 1){
+            jumps++;
+        }
+        connections++;
+    }
+    assert(connections == added + NEURON_NUMBERS[1]);
+    assert(jumps <= 4); // Only from one chunk to the one before
+
+    free_network(network_arr);
+    return;
+}
+
+
 /*
 Tests if the neurons in the linked list are exactly the same as in the array*/
 int match_neurons_linked_list_vs_array(node_linked_list_connection* act_conns, neuron** pred_conns, size_t len_arr){
@@ -267,6 +304,9 @@ int test_neurons(void){
     // Test the disconnet_connect_neurons function
     test_disconnect_connect_neurons(dummy_network_array);
 
+    // Test the arena the network is allocated from
+    test_network_arena();
+
 
 free_dummy_array:
     free_network(dummy_network_array);
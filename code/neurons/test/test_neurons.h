@@ -12,6 +12,7 @@
 neuron** test_seeding(void);
 int test_connect_neurons(neuron**);
 void test_disconnect_connect_neurons(neuron**);
+void test_network_arena(void);
 
 int match_neurons_linked_list_vs_array(node_linked_list_connection*, neuron**, size_t);
 
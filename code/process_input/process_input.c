@@ -2,7 +2,17 @@
 This file is responsible for taking the raw inout of data (as csv) and parsing and processing it into readable data for the Neural Neutwork
 This file should also include all necessary functions for freeing the datastructures created in this file.
 
-This file is prohibited from using any other header files apart from config.h
+The CSV is read into memory at once and split at line boundaries into one chunk per available CPU.
+The chunks are parsed concurrently in two passes:
+1. Every thread counts the data points of its chunk (giving every chunk the index of its first data point)
+2. Every thread parses its chunk straight into its rows of two contiguous matrices (inputs and outputs)
+so that the data points keep the order of the file without copying or merging the parsed values.
+
+The rows of the input matrix are padded to DATA_ROW_ALIGNMENT bytes (a cache line and the widest SIMD vector), so every row starts aligned.
+The array of pointers to the rows of inputs and both matrices are one allocation, so freeing the array input of the mapping
+(or of the first THREAD_DATA, see free_thread_data_array()) frees all of them.
+
+This file is prohibited from using any other header files apart from config.h (and system_info.h for the number of CPUs)
 
 Errors should always be printed when they occur with a message containing all relevant information.
 Malloc Errors in functions should return a NULL pointer.*/
@@ -10,18 +20,17 @@ Malloc Errors in functions should return a NULL pointer.*/
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "process_input.h"
+#include "../system_info/system_info.h"
 
-// Maximum length of a line (not important, only used for creating the buffer)
-#define MAX_LINE_LENGTH 1024
-
-// Create a global buffer and calculate its size
-char buffer[MAX_LINE_LENGTH];
-size_t size_buffer = sizeof(buffer);
-
-// Calculate the size of a double to avoid constant recalculation
-size_t size_double = sizeof(double);
+// Minimum size of a chunk in bytes (smaller files are parsed by fewer threads, as starting a thread costs more than parsing)
+#ifdef TEST_MODE
+#define MIN_CHUNK_SIZE 16 // Allows testing the splitting with small files
+#else
+#define MIN_CHUNK_SIZE (1 << 20)
+#endif // TEST_MODE
 
 // Define the variables that will be assigned later
 size_t DIMENSIONS_DATA;
@@ -30,77 +39,219 @@ size_t BASE_SIZE_THREAD_DATA;
 size_t REMAINDER_THREAD_DATA;
 
 
-/* 
-Function to read the first line of the CSV and put its output into the mapping
-Returns the number of doubles in the first line.
-If there is a problem, it returns 0.*/
-size_t read_first_line(FILE* csv_file, INPUT_OUTPUT_MAPPING* mapping){
+/*
+Returns a pointer to the end of the line starting at line ('\n' or the end of the text)*/
+static inline const char* end_of_line(const char* line, const char* end){
+    const char* line_end = memchr(line, '\n', (size_t) (end - line));
+    return line_end ? line_end : end;
+}
 
-    // Try to get the first line
-    if (!fgets(buffer, size_buffer, csv_file)){
-        // Case when getting the first line fails
-        perror("Error when tring to get the first line of the csv. Perhaps empty.\n");
-        return 0;
-    }
 
-    // Intermediate variable to count the number of doubles in the first line
-    size_t var_num_doubles = 0;
+/*
+Returns 1 if the line [line, line_end) holds no data (empty or only "\r"), else 0.
+Empty lines are skipped (e.g. the newline at the end of the file).*/
+static inline int line_is_empty(const char* line, const char* line_end){
+    return line == line_end || (line + 1 == line_end && *line == '\r');
+}
 
 
-    // An array that will first hold all doubles and then the output doubles will be taken off again.
-    double* input_arr = NULL; // Initialised to NULL for the behavior of realloc()
+/*
+Returns 1 if the character may not start a value (strtod would skip it or the value is missing), else 0*/
+static inline int is_missing_value(char character){
+    return character == ',' || character == '\n' || character == '\r' || character == '\0';
+}
 
-    // Tokenise the line and parse into doubles
-    char *token = strtok(buffer, ","); // strtok replaces the "," with the "\0" string deliminator
 
-    while(token){
+/*
+Function to parse one line [line, line_end) of num_inputs + num_outputs comma separated doubles.
+The first num_inputs values are written to input_row, the others to output_row.
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR if the line is invalid (the caller prints the position of the line)*/
+int parse_csv_line(const char* line, const char* line_end, double* input_row, size_t num_inputs, double* output_row, size_t num_outputs){
+
+    size_t values_per_row = num_inputs + num_outputs;
+    const char* position = line;
+    size_t count = 0; // Number of values parsed so far
+
+    while (1){
+        // Skip the blanks in front of the value
+        while (*position == ' ' || *position == '\t'){
+            position++;
+        }
+        if (position >= line_end || is_missing_value(*position)){
+            fprintf(stderr, "Missing value.\n");
+            return OTHER_ERROR;
+        }
 
-        // Used by strtod to detect where the valid numeric parsing ends
-        // If entire token is successfully parsed, this endptr will point to the null deliminator (end of each token by strtok)
-        // If unsuccessfull parsing, it will point to the first invalid character
-        char *endptr;
+        // strtod stops at the first character that can not be part of the double (at the latest at the '\n')
+        char* value_end;
+        double value = strtod(position, &value_end);
+        if (value_end == position){
+            fprintf(stderr, "Invalid double value: %.*s\n", (int) (line_end - position), position);
+            return OTHER_ERROR;
+        }
+        if (count == values_per_row){
+            fprintf(stderr, "The line is longer than the first line (%zu values).\n", values_per_row);
+            return OTHER_ERROR;
+        }
+        if (count < num_inputs){
+            input_row[count] = value;
+        } else{
+            output_row[count - num_inputs] = value;
+        }
+        count++;
+
+        // Move to the next value or the end of the line
+        position = value_end;
+        while (*position == ' ' || *position == '\t'){
+            position++;
+        }
+        if (position < line_end && *position == ','){
+            position++;
+            continue;
+        }
+        if (position < line_end && *position == '\r'){
+            position++;
+        }
+        if (position >= line_end){
+            break;
+        }
+        fprintf(stderr, "Invalid double value: %.*s\n", (int) (line_end - value_end), value_end);
+        return OTHER_ERROR;
+    }
+
+    if (count != values_per_row){
+        fprintf(stderr, "The line has %zu values instead of %zu.\n", count, values_per_row);
+        return OTHER_ERROR;
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+First pass of the parsing (run by one thread per chunk).
+Counts the data points (non empty lines) of the chunk.*/
+static void* count_csv_chunk(void* args){
+    CSV_CHUNK* chunk = (CSV_CHUNK*) args;
+
+    size_t rows = 0;
+    const char* line = chunk->start;
+    while (line < chunk->end){
+        const char* line_end = end_of_line(line, chunk->end);
+        rows += !line_is_empty(line, line_end);
+        line = line_end + 1;
+    }
+
+    chunk->rows = rows;
+    return NULL;
+}
 
-        var_num_doubles++; // Increment the number of doubles per line
-        double value = strtod(token, &endptr); // strtod -> string to double
 
-        if (*endptr != '\0' && *endptr != '\n' && *endptr != '\r') {
-            fprintf(stderr, "Invalid double value: %s\n", token);
-            free(input_arr);
-            return 0; // Error code for this function
-        }else{
-            // Increase the memory
-            // Use temp to free the memory safely in case realloc fails
-            double* temp = realloc((void*) input_arr, var_num_doubles * size_double);
-            if (!temp){
-                // Case when memory reallocation failed
-                perror("Memory reallocation in the first line of the csv failed.\n");
-                free(input_arr);
-                return 0; // Error code of this functions
+/*
+Second pass of the parsing (run by one thread per chunk).
+Parses the data points of the chunk into its rows of the matrices of inputs and outputs (rows [first_row, first_row + rows)).
+There is always room for the outputs, if the lines do not hold them, they are left for the predictions.*/
+static void* parse_csv_chunk(void* args){
+    CSV_CHUNK* chunk = (CSV_CHUNK*) args;
+
+    size_t outputs_per_line = chunk->values_per_line - DIMENSIONS_DATA;
+    size_t row = chunk->first_row;
+
+    const char* line = chunk->start;
+    while (line < chunk->end){
+        const char* line_end = end_of_line(line, chunk->end);
+
+        if (!line_is_empty(line, line_end)){
+            double* input_row = chunk->inputs + row * chunk->input_stride;
+            if (parse_csv_line(line, line_end, input_row, DIMENSIONS_DATA, chunk->outputs + row * NUM_OUTPUT, outputs_per_line) != SUCCESSFULL_EXECUTION_CODE){
+                printf("Could not parse data point %zu of the csv.\n", row + 1);
+                chunk->exit_code = OTHER_ERROR;
+                return NULL;
             }
-            // If it worked, reassign the input_arr pointer to the new location
-            input_arr = temp;
 
-            input_arr[var_num_doubles - 1] = value; // Assign the value to the correct location in the array
+            // The padding of the row is never used, but is kept at 0
+            for (size_t dimension = DIMENSIONS_DATA; dimension < chunk->input_stride; dimension++){
+                input_row[dimension] = 0;
+            }
+            row++;
+        }
+        line = line_end + 1;
+    }
+
+    chunk->exit_code = SUCCESSFULL_EXECUTION_CODE;
+    return NULL;
+}
+
+
+/*
+Runs the function on every chunk (chunk 0 on the calling thread, the others on their own threads) and waits for all of them.
+Returns SUCCESSFULL_EXECUTION_CODE or THREAD_CREATION_ERROR (all started threads are joined in any case)*/
+static int run_on_chunks(void* (*function)(void*), CSV_CHUNK* chunks, size_t num_chunks){
+
+    pthread_t threads[num_chunks];
+    size_t started = 1; // Chunks whose thread was started (chunk 0 is run on this thread)
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+
+    for (; started < num_chunks; started++){
+        if (pthread_create(&threads[started], NULL, function, (void*) &chunks[started]) != 0){
+            printf("Creation of the thread parsing chunk %zu of the csv was unsuccessfull.\n", started);
+            exit_code = THREAD_CREATION_ERROR;
+            break;
         }
-        token = strtok(NULL, ","); // move to the next token
     }
-    // No need to reassign memory for the output_arr, we can simply split the other array
-    // Position of where to split
-    size_t split_index = var_num_doubles - NUM_OUTPUT;
 
-    // Pointer to the output doubles
-    double* output_arr = input_arr + split_index;
+    function((void*) &chunks[0]);
+
+    for (size_t chunk = 1; chunk < started; chunk++){
+        pthread_join(threads[chunk], NULL);
+    }
+    return exit_code;
+}
+
 
-    // As we have now read the first line, the size of the mapping is 1
-    mapping->used = 1;
-    mapping->input[0] = input_arr; // Assign the location of the input array to the input
-    mapping->output[0] = output_arr; // Assign the location of the output array to the output
+/*
+Function to read the entire file into a '\0' terminated string.
+Stores the length (without the '\0') in the pointer.
+Returns NULL if it fails*/
+static char* read_file(const char* filename, size_t* length){
 
+    FILE* csv_file = fopen(filename, "rb");
+    if (csv_file == NULL){
+        // Case when reading the file was unsuccessfull
+        perror("An error occured when trying to read the csv file.\n");
+        return NULL;
+    }
+
+    long size = -1;
+    if (fseek(csv_file, 0, SEEK_END) == 0){
+        size = ftell(csv_file);
+    }
+    if (size < 0 || fseek(csv_file, 0, SEEK_SET) != 0){
+        printf("Could not get the size of the csv file %s.\n", filename);
+        fclose(csv_file);
+        return NULL;
+    }
+
+    char* text = malloc((size_t) size + 1);
+    if (!text){
+        perror("Memory allocation error when trying to read the csv file.\n");
+        fclose(csv_file);
+        return NULL;
+    }
 
-    // return the total number of doubles found
-    return var_num_doubles;
+    if (fread(text, 1, (size_t) size, csv_file) != (size_t) size){
+        printf("Could not read the csv file %s.\n", filename);
+        free(text);
+        fclose(csv_file);
+        return NULL;
+    }
+    text[size] = '\0';
+    *length = (size_t) size;
+
+    fclose(csv_file);
+    return text;
 }
 
+
 /*
 Function to initialise an INPUT_OUTPUT_MAPPING
 Returns NULL if it fails*/
@@ -135,184 +286,176 @@ INPUT_OUTPUT_MAPPING* initialise_mapping(void) {
     // Initialize size and used
     mapping->size = initialise_size;
     mapping->used = 0;
+    mapping->rows_owned = 1;
 
     return mapping;
 }
 
 /*
-Function to read the next line of a csv file and store the values in an INPUT_OUTPUT_MAPPING
-Returns SUCCESSFULL_EXECUTION_CODE if successfull and an error code if not.
-Returns END_OF_CSV if the end of the CSV is reached*/
-int read_line_csv(FILE* csv_file, INPUT_OUTPUT_MAPPING* mapping){
-    
-    // Read the next line into the buffer
-    if (fgets(buffer, size_buffer, csv_file)== NULL){
-        // case when the end of the file is reached
-        return END_OF_CSV;
-    }
+Function to parse a CSV of doubles into a data structure that is readable by the Neural Network
+ARGS: const char* filename
+Returns the data as an INPUT_OUTPUT_MAPPING*
+In case of an error, it returns NULL*/
+INPUT_OUTPUT_MAPPING* parse_csv(const char* filename){
+    return parse_csv_in_chunks(filename, available_cpus());
+}
 
-    double* input_arr = calloc(DIMENSIONS_DATA, size_double);
-    if (!input_arr){
-        // Case where memory allocation failed
-        perror("Memory allocation error when trying to read a line from the csv file.\n");
-        return MEMORY_ALLOCATION_ERROR;
+
+/*
+Function to parse a CSV with up to max_chunks threads into rows of DIMENSIONS_DATA inputs followed by NUM_OUTPUT outputs.
+If labelled is 0, the lines only hold the inputs and the outputs are left uninitialised.
+Returns NULL if it fails*/
+static INPUT_OUTPUT_MAPPING* parse_csv_file(const char* filename, size_t max_chunks, int labelled){
+
+    size_t length;
+    char* text = read_file(filename, &length);
+    if (!text){
+        return NULL;
     }
-    // The number of doubles we have already assigned to the input array
-    size_t loc_in_input = 0;
+    const char* end = text + length;
 
-    double* output_arr = calloc(NUM_OUTPUT, size_double);
+    /*********************************************************
+     * 1. Get the number of values per row of the first line *
+     *********************************************************/
 
-    if (!output_arr){
-        // Case where memory allocation failed
-        perror("Memory allocation error when trying to read a line from the csv file.\n");
-        free(input_arr);
-        return MEMORY_ALLOCATION_ERROR;
+    const char* first_line = text;
+    const char* first_line_end = end_of_line(first_line, end);
+    while (first_line < end && line_is_empty(first_line, first_line_end)){
+        first_line = first_line_end + 1;
+        first_line_end = end_of_line(first_line, end);
     }
-    // The number of doubles we have already assigned to the output array
-    size_t loc_in_output = 0;
 
+    size_t values_per_line = 1;
+    for (const char* character = first_line; character < first_line_end; character++){
+        values_per_line += (*character == ',');
+    }
+    size_t outputs_per_line = labelled ? NUM_OUTPUT : 0;
+    if (first_line >= end || values_per_line <= outputs_per_line){
+        printf("The first line of the csv %s has to hold more than %zu values. Perhaps empty.\n", filename, outputs_per_line);
+        free(text);
+        return NULL;
+    }
 
-    // Tokenise the line and parse into doubles
-    char *token = strtok(buffer, ","); // strtok replaces the "," with the "\0" string deliminator
+    /* 1.1 Dimensions of the input variables. This is data specific and should be changed depending on the dataset. 
+    Even though this can not be declared const, it may never be changed!!!*/
+    DIMENSIONS_DATA = values_per_line - outputs_per_line;
 
-    // Iterate until the end of the line and store the values into the input and output arrays
-    while (token){
+    // Every data point has room for the outputs (filled by the predictions if the csv does not hold them)
+    // The rows of the inputs are padded to whole DATA_ROW_ALIGNMENT bytes
+    size_t input_stride = (DIMENSIONS_DATA * sizeof(double) + DATA_ROW_ALIGNMENT - 1) / DATA_ROW_ALIGNMENT * DATA_ROW_ALIGNMENT / sizeof(double);
 
-        // Used by strtod to detect where the valid numeric parsing ends
-        // If entire token is successfully parsed, this endptr will point to the null deliminator (end of each token by strtok)
-        // If unsuccessfull parsing, it will point to the first invalid character
-        char *endptr;
+    /*****************************************************
+     * 2. Split the file at line boundaries into chunks  *
+     *****************************************************/
 
-        double value = strtod(token, &endptr); // strtod -> string to double
+    size_t num_chunks = (size_t) (end - first_line) / MIN_CHUNK_SIZE + 1;
+    if (num_chunks > max_chunks){
+        num_chunks = max_chunks;
+    }
+    if (num_chunks == 0){
+        num_chunks = 1;
+    }
 
-        if (*endptr != '\0' && *endptr != '\n' && *endptr != '\r') {
-            fprintf(stderr, "Invalid double value: %s\n", token);
-            free(input_arr); 
-            free(output_arr);
-            return OTHER_ERROR;
+    CSV_CHUNK* chunks = calloc(num_chunks, sizeof(CSV_CHUNK));
+    if (!chunks){
+        perror("Memory allocation error when trying to split the csv into chunks.\n");
+        free(text);
+        return NULL;
+    }
 
-        } else {
-            // Check if we are still working on the input
-            if (loc_in_input < DIMENSIONS_DATA){
-                input_arr[loc_in_input] = value;
-                loc_in_input++;
-            }else{
-                // Check if we are still in bounds for the output array
-                if (loc_in_output < NUM_OUTPUT){
-                    output_arr[loc_in_output] = value;
-                    loc_in_output++;
-                } else{
-                    // Case when the line is longer than it should be
-                    printf("A line of the CSV is longer than it should be. Its length is: %zu\nNUM_OUTPUT: %zu, DIMENSIONS_DATA: %zu\n", loc_in_input, (size_t) NUM_OUTPUT,DIMENSIONS_DATA);
-                    free(input_arr); 
-                    free(output_arr);
-                    return OTHER_ERROR;
-                }
-            }
+    const char* chunk_start = first_line;
+    for (size_t chunk = 0; chunk < num_chunks; chunk++){
+        chunks[chunk].start = chunk_start;
 
-            // Move to the next token in line
-            // if strok is called with NULL, it continues with the last input
-            token = strtok(NULL, ",");
+        // Move the nominal end of the chunk to the start of the next line
+        const char* chunk_end = first_line + (size_t) (end - first_line) * (chunk + 1) / num_chunks;
+        if (chunk_end < chunk_start){
+            chunk_end = chunk_start;
+        }
+        if (chunk_end > first_line && chunk_end < end && *(chunk_end - 1) != '\n'){
+            chunk_end = end_of_line(chunk_end, end);
+            chunk_end = (chunk_end < end) ? chunk_end + 1 : end;
         }
+        chunks[chunk].end = chunk_end;
+        chunk_start = chunk_end;
     }
 
-    if (loc_in_output != NUM_OUTPUT){
-        // Case when there were not enough datapoint¡s in the output
-        perror("A line in the csv has less doubles than others");
-        free(input_arr);
-        free(output_arr);
-        return OTHER_ERROR;
+    /**************************************************
+     * 3. Count the data points of every chunk        *
+     **************************************************/
+
+    INPUT_OUTPUT_MAPPING* mapping = NULL;
+    char* block = NULL;
+
+    if (run_on_chunks(&count_csv_chunk, chunks, num_chunks) != SUCCESSFULL_EXECUTION_CODE){
+        goto free_chunks;
     }
-    
-    // Allocate the newly created arrays to the mapping
-    if (mapping->used < mapping->size){
-        // Easy case where there is still space for the input_output array
-        mapping->input[mapping->used] = input_arr;
-        mapping->output[mapping->used] = output_arr;
-        mapping->used++;
-    } else{
-        // Reallocate the input array
-        double** temp = (double**) realloc(mapping->input, 2 *  mapping->size * sizeof(double*));
-        if (!temp){
-            // Case where a memory allocation error occured
-            perror("Memory allocation error when trying to increase the size of the mapping->input\n");
-            free(input_arr);
-            free(output_arr);
-            return MEMORY_ALLOCATION_ERROR; // Note that the freeing of the mapping will be handled by the toplevel function
-        } else{
-            mapping->input = temp;
-        }
 
-        // Reallocate the output array
-        temp = (double**) realloc(mapping->output, 2 *  mapping->size * sizeof(double*));
-        if (!temp){
-            // Case where a memory allocation error occured
-            perror("Memory allocation error when trying to increase the size of the mapping->output\n");
-            free(input_arr);
-            free(output_arr);
-            return MEMORY_ALLOCATION_ERROR; // Note that the freeing of the mapping will be handled by the toplevel function
-        } else{
-            mapping->output = temp;
-        }
-        // Update the size of the mapping
-        mapping->size = 2 * mapping->size;
-        // Insert the input and output
-        mapping->input[mapping->used] = input_arr;
-        mapping->output[mapping->used] = output_arr;
-        mapping->used++;
+    size_t rows = 0;
+    for (size_t chunk = 0; chunk < num_chunks; chunk++){
+        chunks[chunk].first_row = rows;
+        rows += chunks[chunk].rows;
     }
 
-    return SUCCESSFULL_EXECUTION_CODE;
-}
+    /**********************************************************
+     * 4. Parse every chunk into its rows of the matrices     *
+     **********************************************************/
 
-/*
-Function to parse a CSV of doubles into a data structure that is readable by the Neural Network
-ARGS: const char* filename
-Returns the data as an INPUT_OUTPUT_MAPPING*
-In case of an error, it returns NULL*/
-INPUT_OUTPUT_MAPPING* parse_csv(const char* filename){
+    // One block: the pointers to the rows of inputs, the matrix of inputs and the matrix of outputs (both start aligned)
+    size_t size_pointers = (rows * sizeof(double*) + DATA_ROW_ALIGNMENT - 1) / DATA_ROW_ALIGNMENT * DATA_ROW_ALIGNMENT;
+    size_t size_inputs = rows * input_stride * sizeof(double);
+    size_t size_outputs = (rows * NUM_OUTPUT * sizeof(double) + DATA_ROW_ALIGNMENT - 1) / DATA_ROW_ALIGNMENT * DATA_ROW_ALIGNMENT;
 
-    // Open the csv file in read mode
-    FILE* csv_file = fopen(filename, "r");
-    if (csv_file == NULL){
-        // Case when reading the file was unsuccessfull
-        perror("An error occured when trying to read the csv file.\n");
-        return NULL; // NULL;
+    block = aligned_alloc(DATA_ROW_ALIGNMENT, size_pointers + size_inputs + size_outputs + DATA_ROW_ALIGNMENT); // Never of size 0
+    if (!block){
+        perror("Memory allocation error when trying to allocate the values of the csv.\n");
+        goto free_chunks;
     }
-
-    INPUT_OUTPUT_MAPPING* mapping = initialise_mapping();
-    if (!mapping){
-        // Case when the memory allocation for mapping did not work
-        fclose(csv_file);
-        return NULL;
+    double* inputs = (double*) (block + size_pointers);
+    double* outputs = (double*) (block + size_pointers + size_inputs);
+
+    for (size_t chunk = 0; chunk < num_chunks; chunk++){
+        chunks[chunk].inputs = inputs;
+        chunks[chunk].outputs = outputs;
+        chunks[chunk].input_stride = input_stride;
+        chunks[chunk].values_per_line = values_per_line;
     }
 
-    // Read in the first line
-    const size_t total_len_row = read_first_line(csv_file, mapping);
-    if (total_len_row == 0){
-        // Case where the read_first_line function failed
-        fclose(csv_file);
-        free_input_output_mapping(mapping);
-        return NULL;
+    if (run_on_chunks(&parse_csv_chunk, chunks, num_chunks) != SUCCESSFULL_EXECUTION_CODE){
+        goto free_block;
+    }
+    for (size_t chunk = 0; chunk < num_chunks; chunk++){
+        if (chunks[chunk].exit_code != SUCCESSFULL_EXECUTION_CODE){
+            perror("Error when trying to read additional lines of the csv file\n");
+            goto free_block;
+        }
     }
 
-    /* 1.1 Dimensions of the input variables. This is data specific and should be changed depending on the dataset. 
-    Even though this can not be declared const, it may never be changed!!!*/
-    DIMENSIONS_DATA = total_len_row - NUM_OUTPUT;
+    /****************************************************
+     * 5. Point the rows of the mapping into the matrices *
+     ****************************************************/
 
-    // Read all other lines
-    int exit_code = read_line_csv(csv_file, mapping);
-    while (exit_code == SUCCESSFULL_EXECUTION_CODE){
-        exit_code = read_line_csv(csv_file, mapping);
+    mapping = malloc(sizeof(INPUT_OUTPUT_MAPPING));
+    if (!mapping){
+        perror("Memory allocation failed for the mapping structure.\n");
+        goto free_block;
+    }
+    mapping->input = (double**) block;
+    mapping->output = malloc((rows > 0 ? rows : 1) * sizeof(double*));
+    if (!mapping->output){
+        perror("Memory allocation failed for the rows of the mapping.\n");
+        free(mapping);
+        mapping = NULL;
+        goto free_block;
     }
 
-    // Case if there was an issue in the read_line_csv function
-    if (exit_code != END_OF_CSV){
-        perror("Error when trying to read additional lines of the csv file\n");
-        free_input_output_mapping(mapping);
-        fclose(csv_file);
-        return NULL;
+    for (size_t row = 0; row < rows; row++){
+        mapping->input[row] = inputs + row * input_stride;
+        mapping->output[row] = outputs + row * NUM_OUTPUT;
     }
+    mapping->size = rows;
+    mapping->used = rows;
+    mapping->rows_owned = 0; // The rows are part of the block of input
 
     SIZE_TRAIN = mapping->used; // The number of datapoints is the number of datapoints in the mapping
 
@@ -320,11 +463,36 @@ INPUT_OUTPUT_MAPPING* parse_csv(const char* filename){
     BASE_SIZE_THREAD_DATA = SIZE_TRAIN / NUM_THREADS; // Base size of the arrays passed into each thread
     REMAINDER_THREAD_DATA = SIZE_TRAIN % NUM_THREADS; // Remainder that still needs to be distributed among the threads
 
-    // Close the file again
-    fclose(csv_file);
-    return mapping; 
+    goto free_chunks; // The block is now owned by the mapping
+
+free_block:
+    free(block);
+free_chunks:
+    free(chunks);
+    free(text);
+    return mapping;
+}
+
+
+/*
+Function to parse a CSV of inputs only (e.g. the data to predict) into a data structure that is readable by the Neural Network.
+Every line holds the DIMENSIONS_DATA inputs of a data point, the outputs of the mapping are left for the predictions.
+Returns NULL if it fails*/
+INPUT_OUTPUT_MAPPING* parse_unlabelled_csv(const char* filename){
+    return parse_csv_file(filename, available_cpus(), 0);
 }
 
+
+/*
+Function to parse a CSV with up to max_chunks threads (chunks are at least MIN_CHUNK_SIZE bytes).
+The rows point into a matrix of inputs (rows padded to DATA_ROW_ALIGNMENT bytes) and a matrix of outputs,
+which are in one block with the array input.
+Returns NULL if it fails*/
+INPUT_OUTPUT_MAPPING* parse_csv_in_chunks(const char* filename, size_t max_chunks){
+    return parse_csv_file(filename, max_chunks, 1);
+}
+
+
 /*
 Function to distribute the data read in by the csv among the different threads.
 Frees the INPUT_OUTPUT_MAPPING itself
@@ -361,8 +529,98 @@ THREAD_DATA* distribute_data_among_threads(INPUT_OUTPUT_MAPPING* mapping){
     return thread_data_arr;
 }
 
+/*
+Returns the next number of the xorshift64* generator and advances its state (the state may never be 0)*/
+static inline uint64_t next_random(uint64_t* state){
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+
+/*
+Function to shuffle the data points in place (Fisher-Yates shuffle).
+Only the pointers to the rows are permuted (the input and output of a data point together), the rows are not copied.
+random_state is the state of the generator and is advanced (it may not be 0).*/
+void shuffle_data_points(double** input, double** output, size_t size, uint64_t* random_state){
+    for (size_t i = size; i > 1; i--){
+        size_t j = (size_t) (next_random(random_state) % i); // Position in [0, i) swapped with the last one of [0, i)
+
+        double* row = input[i - 1];
+        input[i - 1] = input[j];
+        input[j] = row;
+
+        row = output[i - 1];
+        output[i - 1] = output[j];
+        output[j] = row;
+    }
+}
+
+
+/*
+Function to split the rows data points starting at input and output into contiguous parts for the threads (one mini batch).
+The THREAD_DATA array is only updated, the threads point into the arrays of rows (like distribute_window_among_threads()).*/
+void distribute_mini_batch_among_threads(double** input, double** output, size_t rows, THREAD_DATA* thread_data){
+
+    size_t base_size = rows / NUM_THREADS;
+    size_t remainder = rows % NUM_THREADS;
+    size_t data_used_so_far = 0;
+
+    for (size_t thread_num = 0; thread_num < NUM_THREADS; thread_num++){
+        size_t size_of_thread_data = base_size + (thread_num < remainder);
+
+        thread_data[thread_num].input = input + data_used_so_far;
+        thread_data[thread_num].output = output + data_used_so_far;
+        thread_data[thread_num].size = size_of_thread_data;
+        data_used_so_far += size_of_thread_data;
+    }
+}
+
+
+/*
+Function to copy the rows of a thread into one block of its own and point its rows to the copy.
+Called by the (pinned) worker thread itself: the block is allocated and zeroed (first touched) by the thread,
+so that the kernel places it on the NUMA node of the thread instead of the node of the thread that parsed the file.
+The original rows are kept (they are part of the data of all threads), so the data is held twice.
+The block holds the inputs (rows padded to DATA_ROW_ALIGNMENT bytes like a parsed CSV) followed by the outputs.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR (the rows of the thread are not changed)*/
+int localise_thread_data(THREAD_DATA* thread_data){
+
+    size_t input_stride = (DIMENSIONS_DATA * sizeof(double) + DATA_ROW_ALIGNMENT - 1) / DATA_ROW_ALIGNMENT * DATA_ROW_ALIGNMENT / sizeof(double);
+    size_t size_inputs = thread_data->size * input_stride * sizeof(double);
+    size_t size_block = (size_inputs + thread_data->size * NUM_OUTPUT * sizeof(double) + DATA_ROW_ALIGNMENT) / DATA_ROW_ALIGNMENT * DATA_ROW_ALIGNMENT;
+
+    double* block = aligned_alloc(DATA_ROW_ALIGNMENT, size_block); // Never of size 0
+    if (!block){
+        printf("Memory allocation error when trying to copy the %zu data points of a thread.\n", thread_data->size);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    memset(block, 0, size_block); // Zeroes the padding of the rows and touches every page on the node of the calling thread
+
+    double* inputs = block;
+    double* outputs = block + thread_data->size * input_stride;
+    for (size_t row = 0; row < thread_data->size; row++){
+        memcpy(inputs + row * input_stride, thread_data->input[row], DIMENSIONS_DATA * sizeof(double));
+        memcpy(outputs + row * NUM_OUTPUT, thread_data->output[row], NUM_OUTPUT * sizeof(double));
+        thread_data->input[row] = inputs + row * input_stride;
+        thread_data->output[row] = outputs + row * NUM_OUTPUT;
+    }
+
+    free(thread_data->local_rows); // Copy of an earlier call
+    thread_data->local_rows = block;
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
 void free_thread_data_array(THREAD_DATA* thread_data_array){
+    // Copies of the rows on the nodes of the threads (see localise_thread_data())
+    for (size_t thread_num = 0; thread_num < NUM_THREADS; thread_num++){
+        free(thread_data_array[thread_num].local_rows);
+    }
+
     // As the input/output pointers of the first thread_data still points to the start of the data array, we can free the entire array this way.
+    // The array of inputs of a parsed CSV also holds the matrices of the values.
     free(thread_data_array[0].input);
     free(thread_data_array[0].output);
 
@@ -374,10 +632,9 @@ void free_thread_data_array(THREAD_DATA* thread_data_array){
 /*Function to free the input output mapping again in case an error occurs.
 Note that during normal running, the mapping is freed when the threads take over its data.*/
 void free_input_output_mapping(INPUT_OUTPUT_MAPPING* map){
-    // Free each array of inputs
-    for (size_t i = 0; i < map->size; i++){
-        free(map->input[i]);
-        //free(map->output[i]);
+    // Free the block of rows starting at the first input (rows of a binary dataset belong to the BINARY_DATASET)
+    if (map->rows_owned && map->used > 0){
+        free(map->input[0]);
     }
     free(map->input);
     free(map->output);
@@ -7,27 +7,35 @@ Header file to process the input.*/
 // Include for size_t
 #include <stdlib.h>
 
-// Include for FILE*
-#include <stdio.h>
-
 // Include structs for INPUT_OUTPUT_MAPPING
 #include "../structs/structs.h"
 
 // Include config_manager for configurations
 #include "../../configurations/config_manager.h"
 
-// Function to parse the input csv into readable datastructures
-INPUT_OUTPUT_MAPPING* parse_csv(const char*);
+// Alignment of the rows of the inputs of a parsed CSV in bytes (a cache line and the widest SIMD vector, AVX-512)
+#define DATA_ROW_ALIGNMENT 64
 
 /*
 Function to parse a CSV of doubles into a data structure that is readable by the Neural Network
 ARGS: const char* filename
 Returns the data as an INPUT_OUTPUT_MAPPING*
 In case of an error, it returns NULL*/
+INPUT_OUTPUT_MAPPING* parse_csv(const char*);
+INPUT_OUTPUT_MAPPING* parse_csv_in_chunks(const char*, size_t);
+INPUT_OUTPUT_MAPPING* parse_unlabelled_csv(const char*);
+
+int parse_csv_line(const char*, const char*, double*, size_t, double*, size_t);
+
 void free_input_output_mapping(INPUT_OUTPUT_MAPPING*);
 
 THREAD_DATA* distribute_data_among_threads(INPUT_OUTPUT_MAPPING*);
 
+void shuffle_data_points(double**, double**, size_t, uint64_t*);
+void distribute_mini_batch_among_threads(double**, double**, size_t, THREAD_DATA*);
+
+int localise_thread_data(THREAD_DATA*);
+
 void free_thread_data_array(THREAD_DATA*);
 
 /*
@@ -35,19 +43,6 @@ Function to initialise an INPUT_OUTPUT_MAPPING
 Returns NULL if it fails*/
 INPUT_OUTPUT_MAPPING* initialise_mapping(void);
 
-/*
-Function to read the next line of a csv file and store the values in an INPUT_OUTPUT_MAPPING
-Returns SUCCESSFULL_EXECUTION_CODE if successfull and an error code if not.
-Returns END_OF_CSV if the end of the CSV is reached*/
-int read_line_csv(FILE*, INPUT_OUTPUT_MAPPING*);
-
-
-/* 
-Function to read the first line of the CSV and put its output into the mapping
-Returns the number of doubles in the first line.
-If there is a problem, it returns 0.*/
-size_t read_first_line(FILE*, INPUT_OUTPUT_MAPPING*);
-
 
 /*
 |----------------------|
@@ -1,12 +1,14 @@
 /*
 File to test the processing of data
-Works with csv files manually written into this file
+Works with csv files manually written into this file (the files written by the tests are removed again)
 
 May not be included in any files.*/
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#include <math.h> // For fabs
 
 
 #include "test_process_input.h"
@@ -15,6 +17,9 @@ May not be included in any files.*/
 // Use helper functions for print_mapping
 #include "../../helper_functions/helper_functions.h"
 
+// Number of data points shuffled by the tests
+#define TEST_SHUFFLE_ROWS 50
+
 /*
 Function to test the parsing of csv*/
 int test_parse_csv(const char* file){
@@ -38,12 +43,174 @@ int test_parse_csv(const char* file){
     return SUCCESSFULL_EXECUTION_CODE;
 }
 
+// Number of data points of the CSV split into chunks
+#define CHUNK_TEST_ROWS 50
+
+// File written by the tests
+#define CHUNK_TEST_FILE "test_process_input_chunks.csv"
+
+/*
+Writes the content into CHUNK_TEST_FILE*/
+static void write_test_file(const char* content){
+    FILE* file = fopen(CHUNK_TEST_FILE, "w");
+    assert(file != NULL);
+    fputs(content, file);
+    fclose(file);
+}
+
+/*
+Tests that the CSV is parsed in the order of the file for any number of chunks.
+Data point i is "i, i / 2, -i" with "\r\n", blank lines and blanks mixed in.*/
+void test_chunked_parsing(void){
+
+    FILE* file = fopen(CHUNK_TEST_FILE, "w");
+    assert(file != NULL);
+    fputs("\n", file);
+    for (size_t row = 0; row < CHUNK_TEST_ROWS; row++){
+        fprintf(file, (row % 3 == 0) ? "%zu, %.1f ,-%zu\r\n" : "%zu,%.1f,-%zu\n", row, row / 2.0, row);
+        if (row % 7 == 0){
+            fputs("\n", file);
+        }
+    }
+    fclose(file);
+
+    size_t max_chunks[] = {1, 2, 3, 7, 64};
+    for (size_t i = 0; i < sizeof(max_chunks) / sizeof(max_chunks[0]); i++){
+        INPUT_OUTPUT_MAPPING* mapping = parse_csv_in_chunks(CHUNK_TEST_FILE, max_chunks[i]);
+        assert(mapping != NULL);
+
+        assert(DIMENSIONS_DATA == 2);
+        assert(SIZE_TRAIN == CHUNK_TEST_ROWS);
+        assert(mapping->used == CHUNK_TEST_ROWS);
+
+        for (size_t row = 0; row < CHUNK_TEST_ROWS; row++){
+            COMPARE(mapping->input[row][0], (double) row);
+            COMPARE(mapping->input[row][1], row / 2.0);
+            COMPARE(mapping->output[row][0], -(double) row);
+
+            // Rows of two contiguous matrices, the rows of the inputs are aligned and padded with 0
+            assert((size_t) mapping->input[row] % DATA_ROW_ALIGNMENT == 0);
+            assert(mapping->input[row] == mapping->input[0] + row * (DATA_ROW_ALIGNMENT / sizeof(double)));
+            COMPARE(mapping->input[row][DATA_ROW_ALIGNMENT / sizeof(double) - 1], 0);
+            assert(mapping->output[row] == mapping->output[0] + row * NUM_OUTPUT);
+        }
+        free_input_output_mapping(mapping);
+    }
+
+    remove(CHUNK_TEST_FILE);
+    return;
+}
+
+/*
+Tests that invalid CSVs are rejected*/
+void test_invalid_csv(void){
+
+    const char* invalid_files[] = {
+        "",                        // Empty file
+        "1,2,3\n4,,6\n",           // Missing value
+        "1,2,3\n4,5,6,7\n",        // Line longer than the first
+        "1,2,3\n4,5\n",            // Line shorter than the first
+        "1,2,3\n4,five,6\n",       // Not a double
+        "1,2,3\n4,5,6 7\n",        // Two values without a comma
+    };
+
+    for (size_t i = 0; i < sizeof(invalid_files) / sizeof(invalid_files[0]); i++){
+        write_test_file(invalid_files[i]);
+        assert(parse_csv_in_chunks(CHUNK_TEST_FILE, 2) == NULL);
+    }
+
+    remove(CHUNK_TEST_FILE);
+    return;
+}
+
+/*
+Tests that a CSV of inputs only is parsed with room for the outputs (the predictions)*/
+void test_unlabelled_csv(void){
+
+    write_test_file("1,2\n\n3, 4\r\n5,6\n");
+
+    INPUT_OUTPUT_MAPPING* mapping = parse_unlabelled_csv(CHUNK_TEST_FILE);
+    assert(mapping != NULL);
+    assert(DIMENSIONS_DATA == 2);
+    assert(SIZE_TRAIN == 3);
+
+    for (size_t row = 0; row < 3; row++){
+        COMPARE(mapping->input[row][0], 2.0 * row + 1);
+        COMPARE(mapping->input[row][1], 2.0 * row + 2);
+        mapping->output[row][0] = -1; // The outputs have their own matrix (no overlap with the inputs)
+        COMPARE(mapping->input[row][1], 2.0 * row + 2);
+    }
+    COMPARE(mapping->input[2][0], 5);
+    free_input_output_mapping(mapping);
+
+    // Rows of different lengths are still rejected
+    write_test_file("1,2\n3\n");
+    assert(parse_unlabelled_csv(CHUNK_TEST_FILE) == NULL);
+
+    remove(CHUNK_TEST_FILE);
+    return;
+}
+
+/*
+Tests that the shuffle permutes the data points (inputs and outputs together) and that the mini batches are split among the threads*/
+void test_mini_batches(void){
+
+    double rows[TEST_SHUFFLE_ROWS][2];
+    double* input[TEST_SHUFFLE_ROWS];
+    double* output[TEST_SHUFFLE_ROWS];
+    for (size_t i = 0; i < TEST_SHUFFLE_ROWS; i++){
+        rows[i][0] = (double) i;
+        rows[i][1] = -(double) i;
+        input[i] = &rows[i][0];
+        output[i] = &rows[i][1];
+    }
+
+    // 1. Every data point is still there once, with its own output
+    uint64_t random_state = 42;
+    shuffle_data_points(input, output, TEST_SHUFFLE_ROWS, &random_state);
+
+    int seen[TEST_SHUFFLE_ROWS] = {0};
+    size_t moved = 0;
+    for (size_t i = 0; i < TEST_SHUFFLE_ROWS; i++){
+        size_t row = (size_t) *input[i];
+        assert(row < TEST_SHUFFLE_ROWS && !seen[row]);
+        seen[row] = 1;
+        assert(*output[i] == -(double) row);
+        moved += (row != i);
+    }
+    assert(moved > 0);
+
+    // 2. The next pass is shuffled differently
+    double* first_pass[TEST_SHUFFLE_ROWS];
+    memcpy(first_pass, input, sizeof(input));
+    shuffle_data_points(input, output, TEST_SHUFFLE_ROWS, &random_state);
+    assert(memcmp(first_pass, input, sizeof(input)) != 0);
+
+    // 3. A mini batch of 7 data points (fewer than 2 per thread)
+    THREAD_DATA thread_data[NUM_THREADS];
+    distribute_mini_batch_among_threads(input + 3, output + 3, 7, thread_data);
+    size_t total = 0;
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        assert(thread_data[thread_pos].input == input + 3 + total);
+        assert(thread_data[thread_pos].output == output + 3 + total);
+        total += thread_data[thread_pos].size;
+    }
+    assert(total == 7);
+    return;
+}
+
 int main(void){
     //printf("Size of double ptr: %zu\n", sizeof(double*));
-    const char current_file[] = "/Users/matswalker/Neural_Network/code/process_input/test/test_file.csv";
-    if (test_parse_csv(current_file) == SUCCESSFULL_EXECUTION_CODE){
-        return 0;
-    } else{
+    const char current_file[] = "code/process_input/test/test_file.csv";
+    if (test_parse_csv(current_file) != SUCCESSFULL_EXECUTION_CODE){
         return OTHER_ERROR;
     }
+
+    test_chunked_parsing();
+    test_invalid_csv();
+    test_unlabelled_csv();
+    test_mini_batches();
+
+    printf("All tests for process_input successfully executed.\n");
+    return 0;
 }
\ No newline at end of file
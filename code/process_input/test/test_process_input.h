@@ -6,5 +6,9 @@ Header file of the file to test the process_input file*/
 
 // Function prototypes
 int test_parse_csv(const char*);
+void test_chunked_parsing(void);
+void test_invalid_csv(void);
+void test_unlabelled_csv(void);
+void test_mini_batches(void);
 
 #endif //TEST_PROCESS_INPUT_H
\ No newline at end of file
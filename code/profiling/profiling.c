@@ -0,0 +1,199 @@
+/*
+This file measures the wall-clock time of the phases of every generation of the training (built with make PROFILE=1).
+Every worker thread of the THREAD_POOL adds up its times in its own PHASE_PROFILE (selected with a thread local index),
+the main thread and all other threads in the one after the workers:
+- workers: dispatch latency, forward, backward, reduction, update and the time they run jobs (busy)
+- main thread: the time from posting a job until all workers are done, cost, save_state and the whole generation
+The idle time of a worker is the time the main thread waited for the jobs minus the time the worker was busy,
+so that a slow thread (load imbalance) shows up as the idle time of all others.
+
+The times are measured with the monotonic clock (see monotonic_ns()), not with clock(), which adds up the CPU time of all threads.
+
+Errors should always print a message with the necessary information.
+Malloc errors return a MEMORY_ALLOCATION_ERROR.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "profiling.h"
+
+// Names of the phases in the order of the PHASE_ definitions
+static const char* const PHASE_NAMES[NUMBER_PHASES] = {"dispatch", "forward", "backward", "reduction", "update", "busy",
+                                                       "pool", "cost", "save_state", "generation"};
+
+// PHASE_PROFILEs of the workers followed by the one of the main thread (NULL if the profiling is not initialised)
+static char* PROFILES = NULL;
+// Number of profiled worker threads
+static size_t PROFILE_THREADS = 0;
+// Distance of two PHASE_PROFILEs in bytes (whole cache lines)
+static size_t PROFILE_STRIDE = 0;
+// Number of finished generations
+static size_t PROFILED_GENERATIONS = 0;
+// Start of the current generation
+static double GENERATION_START = 0;
+// Time the current job of the THREAD_POOL was posted (written before the job is published, read by the workers after)
+static double JOB_POSTED = 0;
+
+// Index of the PHASE_PROFILE of the calling thread
+static _Thread_local size_t THREAD_SLOT = PROFILE_MAIN_THREAD;
+
+
+/*
+Returns the PHASE_PROFILE of the thread (threads outside of [0, PROFILE_THREADS) share the one of the main thread)*/
+static inline PHASE_PROFILE* profile_slot(size_t thread){
+    size_t slot = (thread < PROFILE_THREADS) ? thread : PROFILE_THREADS;
+    return (PHASE_PROFILE*) (PROFILES + slot * PROFILE_STRIDE);
+}
+
+
+/*
+Allocates the PHASE_PROFILEs of num_threads worker threads and the main thread and starts the first generation.
+Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+int initialise_profile(size_t num_threads){
+    free_profile();
+
+    PROFILE_STRIDE = round_to_cache_line(sizeof(PHASE_PROFILE));
+    PROFILES = cache_aligned_calloc((num_threads + 1) * PROFILE_STRIDE);
+    if (!PROFILES){
+        printf("Memory allocation error when trying to allocate the profiles of %zu threads.\n", num_threads);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+    PROFILE_THREADS = num_threads;
+    PROFILED_GENERATIONS = 0;
+    GENERATION_START = monotonic_ns();
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Selects the PHASE_PROFILE the calling thread adds its times to (PROFILE_MAIN_THREAD for the main thread).
+Called by every worker of the THREAD_POOL with its index.*/
+void set_profile_thread(size_t thread){
+    THREAD_SLOT = thread;
+}
+
+
+/*
+Adds time (ns) to the phase of the calling thread in the current generation. Does nothing if the profiling is not initialised.*/
+void add_phase_time(int phase, double time){
+    if (PROFILES){
+        profile_slot(THREAD_SLOT)->generation[phase] += time;
+    }
+}
+
+
+/*
+Remembers the time a job of the THREAD_POOL was posted (the dispatch latency of the workers is measured from it)*/
+void mark_job_posted(double time){
+    JOB_POSTED = time;
+}
+
+double job_posted_time(void){
+    return JOB_POSTED;
+}
+
+
+/*
+Returns the PHASE_PROFILE of the worker thread (PROFILE_MAIN_THREAD for the main thread) or NULL if the profiling is not initialised*/
+const PHASE_PROFILE* profile_of_thread(size_t thread){
+    return PROFILES ? profile_slot(thread) : NULL;
+}
+
+
+/*
+Returns the time (ns) the worker thread waited in all finished generations while the main thread waited for the jobs*/
+double profile_idle_time(size_t thread){
+    if (!PROFILES){
+        return 0;
+    }
+    return profile_slot(PROFILE_MAIN_THREAD)->total[PHASE_POOL] - profile_slot(thread)->total[PHASE_BUSY];
+}
+
+
+/*
+Returns the mean of the phase over the worker threads (total or current generation)*/
+static double mean_of_workers(int phase, int total){
+    double sum = 0;
+    for (size_t thread = 0; thread < PROFILE_THREADS; thread++){
+        PHASE_PROFILE* profile = profile_slot(thread);
+        sum += total ? profile->total[phase] : profile->generation[phase];
+    }
+    return PROFILE_THREADS ? sum / PROFILE_THREADS : 0;
+}
+
+
+/*
+Prints the phases of the current (or all) generations in unit (ns divided by scale).
+The phases of the workers are the mean over the workers. The join wait is the time a worker waited for the others
+after its job (the time of the jobs minus its dispatch latency and busy time).*/
+static void print_phases(int total, double scale, const char* unit){
+    PHASE_PROFILE* main_profile = profile_slot(PROFILE_MAIN_THREAD);
+    const double* main_times = total ? main_profile->total : main_profile->generation;
+
+    double join_wait = main_times[PHASE_POOL] - mean_of_workers(PHASE_BUSY, total) - mean_of_workers(PHASE_DISPATCH, total);
+
+    printf("%s %.1f, %s %.1f, %s %.1f, join wait %.1f, %s %.1f, %s %.1f, %s %.1f, %s %.1f, %s %.1f %s\n",
+           PHASE_NAMES[PHASE_DISPATCH], mean_of_workers(PHASE_DISPATCH, total) / scale,
+           PHASE_NAMES[PHASE_FORWARD], mean_of_workers(PHASE_FORWARD, total) / scale,
+           PHASE_NAMES[PHASE_BACKWARD], mean_of_workers(PHASE_BACKWARD, total) / scale,
+           join_wait / scale,
+           PHASE_NAMES[PHASE_REDUCTION], mean_of_workers(PHASE_REDUCTION, total) / scale,
+           PHASE_NAMES[PHASE_UPDATE], mean_of_workers(PHASE_UPDATE, total) / scale,
+           PHASE_NAMES[PHASE_COST], main_times[PHASE_COST] / scale,
+           PHASE_NAMES[PHASE_SAVE_STATE], main_times[PHASE_SAVE_STATE] / scale,
+           PHASE_NAMES[PHASE_GENERATION], main_times[PHASE_GENERATION] / scale, unit);
+}
+
+
+/*
+Ends the generation: prints its phases (in microseconds) and adds them to the totals of all threads.
+May only be called by the main thread while the THREAD_POOL is idle.*/
+void end_profile_generation(size_t generation){
+    if (!PROFILES){
+        return;
+    }
+
+    double now = monotonic_ns();
+    profile_slot(PROFILE_MAIN_THREAD)->generation[PHASE_GENERATION] += now - GENERATION_START;
+    GENERATION_START = now;
+
+    printf("Profile of generation %zu: ", generation);
+    print_phases(0, 1e3, "us");
+
+    for (size_t thread = 0; thread <= PROFILE_THREADS; thread++){
+        PHASE_PROFILE* profile = profile_slot(thread);
+        for (int phase = 0; phase < NUMBER_PHASES; phase++){
+            profile->total[phase] += profile->generation[phase];
+            profile->generation[phase] = 0;
+        }
+    }
+    PROFILED_GENERATIONS++;
+}
+
+
+/*
+Prints the phases of all finished generations (in milliseconds) and the busy and idle time of every worker thread*/
+void print_profile_summary(void){
+    if (!PROFILES || PROFILED_GENERATIONS == 0){
+        return;
+    }
+
+    printf("\nProfile of %zu generations (the phases of the threads are the mean over %zu threads):\n", PROFILED_GENERATIONS, PROFILE_THREADS);
+    print_phases(1, 1e6, "ms");
+
+    double pool = profile_slot(PROFILE_MAIN_THREAD)->total[PHASE_POOL];
+    printf("%8s %12s %12s %9s\n", "Thread", "busy (ms)", "idle (ms)", "busy (%)");
+    for (size_t thread = 0; thread < PROFILE_THREADS; thread++){
+        double busy = profile_slot(thread)->total[PHASE_BUSY];
+        printf("%8zu %12.3f %12.3f %9.1f\n", thread, busy / 1e6, profile_idle_time(thread) / 1e6, pool > 0 ? 100 * busy / pool : 0);
+    }
+}
+
+
+/*
+Frees the PHASE_PROFILEs (the profiling stops)*/
+void free_profile(void){
+    free(PROFILES);
+    PROFILES = NULL;
+    PROFILE_THREADS = 0;
+}
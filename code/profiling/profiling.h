@@ -0,0 +1,64 @@
+/*
+Header file of the profiling of the phases of the training.
+Includes structs.h to use the PHASE_PROFILE struct and system_info.h for the monotonic clock.
+
+The PROFILE_ macros only measure if the Neural Network is built with make PROFILE=1 (defines PROFILE_PHASES).
+Otherwise they expand to nothing and PROFILING is 0, so that the training does not pay for the profiling.*/
+
+#ifndef PROFILING_H
+#define PROFILING_H
+
+#include <stdint.h>
+
+#include "../structs/structs.h"
+#include "../system_info/system_info.h"
+
+// Phases measured by the worker threads (index of the times of a PHASE_PROFILE)
+#define PHASE_DISPATCH 0     // From posting a job to the THREAD_POOL until the worker started it
+#define PHASE_FORWARD 1      // Distribution of the inputs and forward pass
+#define PHASE_BACKWARD 2     // Backward pass (deltas and derivatives)
+#define PHASE_REDUCTION 3    // Sum of the derivatives of the threads (dense network)
+#define PHASE_UPDATE 4       // Update of the moments and the params
+#define PHASE_BUSY 5         // Running the jobs of the THREAD_POOL
+
+// Phases measured by the main thread
+#define PHASE_POOL 6         // From posting a job until all workers finished it
+#define PHASE_COST 7         // Average cost and cost of the validation data
+#define PHASE_SAVE_STATE 8   // Write back and save_state of the best state
+#define PHASE_GENERATION 9   // Whole generation
+
+// Slot of the threads that are not workers of the THREAD_POOL (the main thread)
+#define PROFILE_MAIN_THREAD SIZE_MAX
+
+int initialise_profile(size_t);
+void set_profile_thread(size_t);
+void add_phase_time(int, double);
+void mark_job_posted(double);
+double job_posted_time(void);
+const PHASE_PROFILE* profile_of_thread(size_t);
+double profile_idle_time(size_t);
+void end_profile_generation(size_t);
+void print_profile_summary(void);
+void free_profile(void);
+
+#ifdef PROFILE_PHASES
+#define PROFILING 1
+// Starts a timer (declares the variable timer)
+#define PROFILE_BEGIN(timer) double timer = monotonic_ns()
+// Adds the time since PROFILE_BEGIN(timer) to the phase of the calling thread
+#define PROFILE_END(timer, phase) add_phase_time((phase), monotonic_ns() - (timer))
+// Selects the PHASE_PROFILE of the calling worker thread
+#define PROFILE_THREAD(index) set_profile_thread(index)
+// Remembers the time a job was posted (timer started by PROFILE_BEGIN) and adds the time until a worker started it
+#define PROFILE_JOB_POSTED(timer) mark_job_posted(timer)
+#define PROFILE_JOB_STARTED(timer) add_phase_time(PHASE_DISPATCH, (timer) - job_posted_time())
+#else
+#define PROFILING 0
+#define PROFILE_BEGIN(timer)
+#define PROFILE_END(timer, phase)
+#define PROFILE_THREAD(index)
+#define PROFILE_JOB_POSTED(timer)
+#define PROFILE_JOB_STARTED(timer)
+#endif // PROFILE_PHASES
+
+#endif // PROFILING_H
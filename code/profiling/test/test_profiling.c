@@ -0,0 +1,134 @@
+/*
+Test file for the profiling of the phases (built with PROFILE_PHASES, see the Makefile).
+May not be included in any other files. Its own purpose is for testing.
+*/
+
+#define _POSIX_C_SOURCE 200809L // For nanosleep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+
+#include "test_profiling.h"
+
+// Milliseconds a worker sleeps in the job of test_idle_threads (worker i sleeps (i + 1) times as long)
+#define SLEEP_MS 4
+
+
+// Sleeps for the number of milliseconds the args point to
+void* sleep_job(void* args){
+    struct timespec sleep_time = {0, (long) (*(size_t*) args) * 1000000};
+    nanosleep(&sleep_time, NULL);
+    return NULL;
+}
+
+
+/*
+The monotonic clock measures the wall-clock time of a sleep (clock() measures the CPU time, which stays about 0)*/
+void test_monotonic_clock(void){
+    size_t sleep_ms = 20;
+
+    double start = monotonic_ns();
+    sleep_job(&sleep_ms);
+    double time = monotonic_ns() - start;
+
+    assert(time >= 20e6);
+    assert(time < 2e9);
+    return;
+}
+
+
+/*
+Times are added to the PHASE_PROFILE of the calling thread and moved to the totals at the end of the generation*/
+void test_phase_times(void){
+    assert(initialise_profile(2) == SUCCESSFULL_EXECUTION_CODE);
+
+    add_phase_time(PHASE_COST, 5);
+    set_profile_thread(0);
+    add_phase_time(PHASE_FORWARD, 10);
+    set_profile_thread(1);
+    add_phase_time(PHASE_FORWARD, 30);
+    add_phase_time(PHASE_BUSY, 40);
+    set_profile_thread(PROFILE_MAIN_THREAD);
+    add_phase_time(PHASE_POOL, 50);
+
+    assert(profile_of_thread(1)->generation[PHASE_FORWARD] == 30);
+    end_profile_generation(0);
+
+    assert(profile_of_thread(0)->total[PHASE_FORWARD] == 10);
+    assert(profile_of_thread(1)->total[PHASE_FORWARD] == 30);
+    assert(profile_of_thread(1)->generation[PHASE_FORWARD] == 0);
+    assert(profile_of_thread(PROFILE_MAIN_THREAD)->total[PHASE_COST] == 5);
+    assert(profile_of_thread(PROFILE_MAIN_THREAD)->total[PHASE_GENERATION] > 0);
+
+    // Idle is the time of the jobs the thread was not busy
+    assert(profile_idle_time(0) == 50);
+    assert(profile_idle_time(1) == 10);
+
+    // Threads beyond the profiled ones add to the main thread
+    set_profile_thread(7);
+    add_phase_time(PHASE_COST, 1);
+    set_profile_thread(PROFILE_MAIN_THREAD);
+    assert(profile_of_thread(PROFILE_MAIN_THREAD)->generation[PHASE_COST] == 1);
+
+    free_profile();
+    assert(profile_of_thread(0) == NULL);
+    return;
+}
+
+
+/*
+Runs jobs on the THREAD_POOL where the workers take different times.
+The workers measure their busy time and the slow worker makes the others idle (load imbalance).*/
+void test_idle_threads(void){
+    assert(initialise_profile(NUM_THREADS) == SUCCESSFULL_EXECUTION_CODE);
+
+    THREAD_POOL* pool = create_thread_pool(NUM_THREADS);
+    assert(pool);
+
+    size_t sleep_ms[NUM_THREADS];
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        sleep_ms[i] = SLEEP_MS * (i + 1);
+    }
+
+    for (size_t generation = 0; generation < 3; generation++){
+        assert(run_thread_pool(pool, &sleep_job, (void*) sleep_ms, sizeof(size_t)) == SUCCESSFULL_EXECUTION_CODE);
+        end_profile_generation(generation);
+    }
+    print_profile_summary();
+
+    double pool_time = profile_of_thread(PROFILE_MAIN_THREAD)->total[PHASE_POOL];
+    assert(pool_time >= 3 * SLEEP_MS * NUM_THREADS * 1e6);
+
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        const PHASE_PROFILE* profile = profile_of_thread(i);
+        assert(profile->total[PHASE_BUSY] >= 3 * sleep_ms[i] * 1e6);
+        assert(profile->total[PHASE_DISPATCH] >= 0);
+        assert(profile_idle_time(i) >= 0);
+        if (i > 0){
+            assert(profile_idle_time(i) < profile_idle_time(i - 1));
+        }
+    }
+
+    free_thread_pool(pool);
+    free_profile();
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    test_monotonic_clock();
+    test_phase_times();
+    test_idle_threads();
+
+    printf("All tests for profiling successfully executed.\n");
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,20 @@
+/*
+Header file of the file to test the profiling of the phases.
+May only be included in its own .c file.*/
+
+#ifndef TEST_PROFILING_H
+#define TEST_PROFILING_H
+
+#include "../../../configurations/config_manager.h"
+#include "../profiling.h"
+#include "../../thread_pool/thread_pool.h"
+
+void* sleep_job(void*);
+
+void test_monotonic_clock(void);
+void test_phase_times(void);
+void test_idle_threads(void);
+
+int test_handler_func(void);
+
+#endif //TEST_PROFILING_H
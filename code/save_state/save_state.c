@@ -1,5 +1,8 @@
 /*
-Code to save the state of the neural network in a struct.*/
+Code to save the state of the neural network in a struct.
+Also writes the trained Neural Network (the model) and its predictions into files and loads the model again.*/
+
+#define _POSIX_C_SOURCE 200809L // For getline
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -179,8 +182,10 @@ void free_state(STATE* state_to_free){
 }
 
 /*
-Function to save the data of the neural */
-int save_network_to_csv(neuron** network_arr, char* filename){
+Function to save the parameters of the Neural Network (the model) in a csv.
+The model can be loaded into a Neural Network of the same architecture with load_network_from_csv().
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+int save_network_to_csv(neuron** network_arr, const char* filename){
     FILE* csv_file = fopen(filename, "w");
     if (!csv_file){
         // Case when the file could not be opened
@@ -191,9 +196,9 @@ int save_network_to_csv(neuron** network_arr, char* filename){
     /*********************************************************
      * 1. Write the basic architecture of the Neural Network *
      *********************************************************/
-    // Write the first layer
-    fprintf(csv_file, "%zu", NEURON_NUMBERS[0]);
-    for (size_t i = 1; i < NUMBER_LAYERS; i++){
+    // Write the dimensions of the data the model was trained on (the data to predict needs the same dimensions)
+    fprintf(csv_file, "%zu", DIMENSIONS_DATA);
+    for (size_t i = 0; i < NUMBER_LAYERS; i++){
         // Write all other layers
         fprintf(csv_file, ",%zu", NEURON_NUMBERS[i]);
     }
@@ -204,7 +209,7 @@ int save_network_to_csv(neuron** network_arr, char* filename){
      * 2. Write the specifics of every neuron *
      ******************************************/
     /*
-    Note that the data is stored as follows:
+    Note that the data is stored as follows (one line per neuron):
     1. Bias of the Neuron
     2. Pos of the first connection
     3. Weight of the first connection
@@ -216,8 +221,8 @@ int save_network_to_csv(neuron** network_arr, char* filename){
     for (size_t i = 0; i < LENGTH_NETWORK; i++){
         neuron* this_neuron = network_arr[i];
 
-        // 1. Write the bias
-        fprintf(csv_file,"%lf", this_neuron->bias);
+        // 1. Write the bias (17 significant digits, so that the loaded model is exactly the saved one)
+        fprintf(csv_file,"%.17g", this_neuron->bias);
 
         // 2. Write all the connections
         node_linked_list_connection* next_layer = this_neuron->next_layer;
@@ -225,7 +230,7 @@ int save_network_to_csv(neuron** network_arr, char* filename){
             // Write the position
             fprintf(csv_file,",%zu",next_layer->data->pos);
             // Write the weight
-            fprintf(csv_file,",%lf",next_layer->weight);
+            fprintf(csv_file,",%.17g",next_layer->weight);
             // Move to the next node
             next_layer = next_layer->next;
         }
@@ -239,4 +244,152 @@ int save_network_to_csv(neuron** network_arr, char* filename){
     fclose(csv_file);
 
     return SUCCESSFULL_EXECUTION_CODE;
-}
\ No newline at end of file
+}
+
+
+/*
+Function to read the parameters of one neuron from its line of the model (bias, then the position and weight of every connection).
+Every connection of the line has to exist in the Neural Network and every connection of the neuron has to be in the line.
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR if the line does not match the neuron*/
+static int load_neuron_from_line(neuron* neuron_, const char* line){
+
+    char* end;
+    neuron_->bias = strtod(line, &end);
+    if (end == line){
+        printf("Missing bias of neuron %zu in the model.\n", neuron_->pos);
+        return OTHER_ERROR;
+    }
+
+    size_t count_connections = 0; // Number of connections read from the line
+    const char* position = end;
+    while (*position == ','){
+        size_t pos = strtoul(position + 1, &end, 10);
+        if (end == position + 1 || *end != ','){
+            printf("Invalid connection of neuron %zu in the model.\n", neuron_->pos);
+            return OTHER_ERROR;
+        }
+        position = end + 1;
+        double weight = strtod(position, &end);
+        if (end == position){
+            printf("Missing weight of the connection of neuron %zu to neuron %zu in the model.\n", neuron_->pos, pos);
+            return OTHER_ERROR;
+        }
+        position = end;
+
+        // Find the connection to the neuron at pos
+        node_linked_list_connection* connection = neuron_->next_layer;
+        while (connection && connection->data->pos != pos){
+            connection = connection->next;
+        }
+        if (!connection){
+            printf("The model connects neuron %zu to neuron %zu, which are not connected in the Neural Network.\n", neuron_->pos, pos);
+            return OTHER_ERROR;
+        }
+        connection->weight = weight;
+        count_connections++;
+    }
+
+    if (*position != '\n' && *position != '\r' && *position != '\0'){
+        printf("Invalid value in the line of neuron %zu of the model.\n", neuron_->pos);
+        return OTHER_ERROR;
+    }
+
+    // Every connection of the Neural Network needs a weight
+    size_t count_network_connections = 0;
+    for (node_linked_list_connection* connection = neuron_->next_layer; connection; connection = connection->next){
+        count_network_connections++;
+    }
+    if (count_connections != count_network_connections){
+        printf("The number of connections of neuron %zu in the model does not match the Neural Network.\n", neuron_->pos);
+        return OTHER_ERROR;
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to load a model written by save_network_to_csv() into the (connected) Neural Network.
+The architecture of the model has to match NEURON_NUMBERS and the connections of the Neural Network.
+Stores the dimensions of the data the model was trained on in the pointer.
+Returns SUCCESSFULL_EXECUTION_CODE, FILE_ERROR or OTHER_ERROR if the model does not match the Neural Network*/
+int load_network_from_csv(neuron** network_arr, const char* filename, size_t* dimensions_data){
+    FILE* csv_file = fopen(filename, "r");
+    if (!csv_file){
+        // Case when the file could not be opened
+        printf("Could not open the model %s.\n", filename);
+        return FILE_ERROR;
+    }
+
+    int exit_code = SUCCESSFULL_EXECUTION_CODE;
+    char* line = NULL;
+    size_t line_size = 0;
+
+    /********************************************************
+     * 1. Check the basic architecture of the Neural Network *
+     ********************************************************/
+    if (getline(&line, &line_size, csv_file) < 0){
+        printf("The model %s is empty.\n", filename);
+        exit_code = FILE_ERROR;
+        goto close_file;
+    }
+
+    char* end;
+    *dimensions_data = strtoul(line, &end, 10);
+    int matches = (end != line && *dimensions_data > 0); // 1 as long as the line matches the Neural Network
+    for (size_t i = 0; i < NUMBER_LAYERS && matches; i++){
+        char* value = end + 1;
+        matches = (*end == ',' && strtoul(value, &end, 10) == NEURON_NUMBERS[i] && end != value);
+    }
+    if (!matches || (*end != '\n' && *end != '\r' && *end != '\0')){
+        printf("The architecture of the model %s does not match the Neural Network.\n", filename);
+        exit_code = OTHER_ERROR;
+        goto close_file;
+    }
+
+    /*****************************************
+     * 2. Read the parameters of every neuron *
+     *****************************************/
+    for (size_t i = 0; i < LENGTH_NETWORK; i++){
+        if (getline(&line, &line_size, csv_file) < 0){
+            printf("The model %s ends before neuron %zu.\n", filename, i);
+            exit_code = OTHER_ERROR;
+            goto close_file;
+        }
+        if (load_neuron_from_line(network_arr[i], line) != SUCCESSFULL_EXECUTION_CODE){
+            exit_code = OTHER_ERROR;
+            goto close_file;
+        }
+    }
+
+close_file:
+    free(line);
+    fclose(csv_file);
+    return exit_code;
+}
+
+
+/*
+Function to write the predictions (one line of NUM_OUTPUT values per data point) into a csv.
+Writes to stdout if filename is NULL.
+Returns SUCCESSFULL_EXECUTION_CODE or FILE_ERROR*/
+int save_predictions_to_csv(double** predictions, size_t num_data, const char* filename){
+    FILE* csv_file = filename ? fopen(filename, "w") : stdout;
+    if (!csv_file){
+        // Case when the file could not be opened
+        printf("Could not open the file %s for the predictions.\n", filename);
+        return FILE_ERROR;
+    }
+
+    for (size_t data_ptr = 0; data_ptr < num_data; data_ptr++){
+        fprintf(csv_file, "%.17g", predictions[data_ptr][0]);
+        for (size_t output_ptr = 1; output_ptr < NUM_OUTPUT; output_ptr++){
+            fprintf(csv_file, ",%.17g", predictions[data_ptr][output_ptr]);
+        }
+        fprintf(csv_file, "\n");
+    }
+
+    if (filename){
+        fclose(csv_file);
+    }
+    return SUCCESSFULL_EXECUTION_CODE;
+}
@@ -5,6 +5,8 @@ Header file to save the state of a Neural Network
 #ifndef SAVE_STATE_H
 #define SAVE_STATE_H
 
+// Include process_input first to use DIMENSIONS_DATA (the model stores the dimensions of the data)
+#include "../process_input/process_input.h"
 #include "../structs/structs.h"
 
 STATE* initialise_state(neuron**);
@@ -15,4 +17,10 @@ void restore_state(neuron**, STATE*);
 
 void free_state(STATE*);
 
+int save_network_to_csv(neuron**, const char*);
+
+int load_network_from_csv(neuron**, const char*, size_t*);
+
+int save_predictions_to_csv(double**, size_t, const char*);
+
 #endif // SAVE_STATE_H
\ No newline at end of file
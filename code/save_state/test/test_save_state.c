@@ -0,0 +1,134 @@
+/*
+Test file for saving and loading the Neural Network.
+May not be included in any other files. Its own purpose is for testing.
+
+The test files are written into the current directory and removed again.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h> // For fabs
+
+#include "test_save_state.h"
+
+// Files written by the tests
+#define TEST_MODEL "test_save_state_model.csv"
+#define TEST_PREDICTIONS "test_save_state_predictions.csv"
+
+
+/*
+Writes the content into TEST_MODEL*/
+static void write_test_model(const char* content){
+    FILE* file = fopen(TEST_MODEL, "w");
+    assert(file != NULL);
+    fputs(content, file);
+    fclose(file);
+}
+
+
+/*
+Tests that a saved model is loaded exactly (all digits of the parameters)*/
+void test_save_and_load_model(neuron** network_arr){
+
+    DIMENSIONS_DATA = 3;
+    set_bias(network_arr, 0, 0.1);
+    set_bias(network_arr, 1, -1.0 / 3);
+    network_arr[0]->next_layer->weight = 2.5e-7;
+
+    assert(save_network_to_csv(network_arr, TEST_MODEL) == SUCCESSFULL_EXECUTION_CODE);
+
+    set_bias(network_arr, 0, 0);
+    set_bias(network_arr, 1, 0);
+    network_arr[0]->next_layer->weight = 0;
+
+    size_t dimensions_data = 0;
+    assert(load_network_from_csv(network_arr, TEST_MODEL, &dimensions_data) == SUCCESSFULL_EXECUTION_CODE);
+    assert(dimensions_data == 3);
+    assert(network_arr[0]->bias == 0.1);
+    assert(network_arr[1]->bias == -1.0 / 3);
+    assert(network_arr[0]->next_layer->weight == 2.5e-7);
+
+    remove(TEST_MODEL);
+    return;
+}
+
+
+/*
+Tests that models not matching the Neural Network (1 -> 1 neurons) are rejected*/
+void test_invalid_model(neuron** network_arr){
+
+    const char* invalid_models[] = {
+        "3,2,1\n0\n0,1,1\n0\n",    // Other architecture
+        "3,1,1\n0,1,1\n",          // Missing neuron
+        "3,1,1\n0,0,1\n0\n",       // Connection not in the Neural Network
+        "3,1,1\n0\n0\n",           // Missing connection
+        "3,1,1\n0,1,x\n0\n",       // Invalid weight
+    };
+    size_t dimensions_data;
+
+    for (size_t i = 0; i < sizeof(invalid_models) / sizeof(invalid_models[0]); i++){
+        write_test_model(invalid_models[i]);
+        assert(load_network_from_csv(network_arr, TEST_MODEL, &dimensions_data) != SUCCESSFULL_EXECUTION_CODE);
+    }
+
+    remove(TEST_MODEL);
+    assert(load_network_from_csv(network_arr, TEST_MODEL, &dimensions_data) == FILE_ERROR);
+    return;
+}
+
+
+/*
+Tests that the predictions are written one line per data point*/
+void test_save_predictions(void){
+
+    double values[3] = {1.5, -2, 0.25};
+    double* predictions[3] = {&values[0], &values[1], &values[2]};
+
+    assert(save_predictions_to_csv(predictions, 3, TEST_PREDICTIONS) == SUCCESSFULL_EXECUTION_CODE);
+
+    FILE* file = fopen(TEST_PREDICTIONS, "r");
+    assert(file != NULL);
+    double value;
+    for (size_t i = 0; i < 3; i++){
+        assert(fscanf(file, "%lf", &value) == 1);
+        COMPARE(value, values[i]);
+    }
+    assert(fscanf(file, "%lf", &value) == EOF);
+    fclose(file);
+
+    remove(TEST_PREDICTIONS);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    // Create a Simple 2 layer Neural Network
+    neuron** network_arr = seed_neural_network();
+    if (!network_arr){
+        printf("Seeding the network array was unsuccessfull in test_save_state.\n");
+        return OTHER_ERROR;
+    }
+
+    // Connect the neurons (the network array will be freed by the function in case of an error)
+    if (connect_neurons(network_arr) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Error when connecting the neurons.\n");
+        return OTHER_ERROR;
+    }
+
+    test_save_and_load_model(network_arr);
+    test_invalid_model(network_arr);
+    test_save_predictions();
+
+    printf("All tests for save_state successfully executed.\n");
+
+    free_network(network_arr);
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,18 @@
+/*
+Header file of the file to test the save_state file.
+May only be included in its own .c file.*/
+
+#ifndef TEST_SAVE_STATE_H
+#define TEST_SAVE_STATE_H
+
+#include "../save_state.h"
+#include "../../../configurations/config_manager.h"
+#include "../../neurons/neurons.h"
+
+void test_save_and_load_model(neuron**);
+void test_invalid_model(neuron**);
+void test_save_predictions(void);
+
+int test_handler_func(void);
+
+#endif //TEST_SAVE_STATE_H
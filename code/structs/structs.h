@@ -12,6 +12,13 @@ All structs should be defined and explained here*/
 // Forward definition of neuron for other structs definition
 struct neuron;
 
+// Forward definition of the workspaces for the THREAD_ARGS
+struct DENSE_NETWORK;
+struct DENSE_WORKSPACE;
+struct LIST_WORKSPACE;
+struct OPTIMIZER;
+struct WORK_QUEUE;
+
 
 /******************************/
 /* Definitions of the structs */
@@ -23,21 +30,21 @@ struct neuron;
 /* 1. Node of the Linked List for learning */
 /*******************************************/
 
-/*             Layout
- |------|------|------------|--------| 
- | data | next | derivative | weight | 
- |------|------|------------|--------| */
+/*          Layout
+ |------|------|--------|-------|
+ | data | next | weight | index |
+ |------|------|--------|-------|*/
 
 /*
 Data structure to hold the connections fo one node to the next layer.
 Linked list style connection for seemless inserts and deletions.
-Exposes the derivative for backpropagation.
-Exposes the weight with regards to the next node for feed_forward.*/
+Exposes the weight with regards to the next node for feed_forward.
+The derivative of the weight is kept by every thread in its LIST_WORKSPACE (at der_weights[index]).*/
  typedef struct node_linked_list_connection{
     struct neuron* data;                      // Pointer to the data (neuron) of the node
     struct node_linked_list_connection* next; // Pointer to the next node
     double weight;                            // Associated weight of the neuron of the next layer. Used for feed forward.
-    double der_weight[NUM_THREADS];           // Partial derivative with regards to this weight
+    size_t index;                             // Unique index of the connection (position of its derivative in the LIST_WORKSPACE)
  } node_linked_list_connection;
 
 // Definition of the size of the linked list
@@ -49,21 +56,18 @@ extern const size_t size_linked_list_connection;
 /* 2. Neuron of the Neural Network */
 /***********************************/
 
-/*                     Layout
- |------------|------|--------------------|-----|
- | next_layer | bias | input[NUM_THREADS] | pos |
- |------------|------|--------------------|-----| */
+/*          Layout
+ |------|-----|------------|
+ | bias | pos | next_layer |
+ |------|-----|------------| */
 
 /*
 One neuron of the Neural Network. This is where the magic happens.
-Has an array of inputs with one location for each thread.*/
+Only holds the parameters, the state of the threads (inputs, deltas and derivatives) is kept in their LIST_WORKSPACE.*/
 typedef struct neuron{
     double bias;                                    // Bias of the neuron
     size_t pos;                                     // Position of the neuron in the Neural Network
     struct node_linked_list_connection* next_layer; // Connection linked list to the next layer
-    double input[NUM_THREADS];                      // Every thread has its own input they are manipulating simultaneously
-    double delta[NUM_THREADS];                      // Backprop delta of each thread
-    double der_biases[NUM_THREADS];                 // Derivative of the current node to update the biases
 }neuron;
 
 // Definition of the size of the neuron
@@ -75,10 +79,10 @@ extern const size_t size_neuron;
 /* 3. Data available to each thread */
 /************************************/
 
-/*      Layout  
- |------|-----------|
- | size | entries[] |
- |------|-----------|*/
+/*              Layout  
+ |------|-----------|------------|
+ | size | entries[] | local_rows |
+ |------|-----------|------------|*/
 
 /*
 Information of the training data for each thread.
@@ -88,6 +92,7 @@ typedef struct THREAD_DATA{
     size_t size;          // Number of entries for this particular thread
     double** input;       // Data points for this thread. Array of pointers to arrays of doubles.
     double** output;      // Data points of output for this thread. Array of pointers to arrays of doubles.
+    double* local_rows;   // Copy of the rows on the NUMA node of the thread (see localise_thread_data()), NULL if the rows were not copied
 }THREAD_DATA;
 
 extern const size_t size_thread_data;
@@ -98,23 +103,28 @@ extern const size_t size_thread_data;
 /************************************/
 
 /*
-            Layout
- |------|-----|-------------|
- | data | pos | network_arr |
- |------|-----|-------------|*/
-
-#include <stdalign.h>
+                                          Layout
+ |------|-----|-------------|---------------|-----------|----------------|-----------|-------------|------------|------|
+ | data | pos | network_arr | dense_network | workspace | list_workspace | optimizer | update_rows | work_queue | cost |
+ |------|-----|-------------|---------------|-----------|----------------|-----------|-------------|------------|------|*/
 
-#define CACHE_LINE_SIZE 128
 /*
 Data structure carrying all necessary informations for each thread.
-Used for the multi-threading approach.*/
-typedef struct{
-    THREAD_DATA* data;     // Data structure carrying the Input and (actual) Output for this thread
-    size_t pos;            // Position of the thread in the Neural Network (determines which position of the input array in the Neural Network to use)
-    neuron** network_arr;  // Pointer to the array of neurons of the Neural Network
-    char padding[104];     // Padding to align the struct to exactly one cache line (Prevents false sharing)
-}__attribute__((aligned(CACHE_LINE_SIZE))) THREAD_ARGS;
+Used for the multi-threading approach.
+Everything a thread writes per data point lives in its (cache line aligned) workspace.
+The cost is only written once at the end of every job, so the args do not need to be padded to a cache line.*/
+typedef struct THREAD_ARGS{
+    THREAD_DATA* data;                     // Data structure carrying the Input and (actual) Output for this thread
+    size_t pos;                            // Position of the thread in the thread pool
+    neuron** network_arr;                  // Pointer to the array of neurons of the Neural Network
+    struct DENSE_NETWORK* dense_network;   // Pointer to the compiled (dense) Neural Network. NULL if the linked list is used for training
+    struct DENSE_WORKSPACE* workspace;     // Workspace of this thread for the dense training engine
+    struct LIST_WORKSPACE* list_workspace; // Workspace of this thread for the training on the linked list
+    struct OPTIMIZER* optimizer;           // Optimizer of the updates the thread applies itself (asynchronous training, see dense_hogwild_thread())
+    size_t update_rows;                    // Data points of the thread between two of its updates (asynchronous training)
+    struct WORK_QUEUE* work_queue;         // Chunks of the data of all threads the thread takes its work from (NULL: only its own data)
+    double cost;                           // Summed cost of the data of this thread in the current generation (reset by main)
+}THREAD_ARGS;
 
 extern const size_t size_thread_args;
 
@@ -122,10 +132,10 @@ extern const size_t size_thread_args;
 /* 5. Data structure to map input to output */
 /********************************************/
 
-/*      Layout  
- |---------|----------|------|------|
- | input[] | output[] | size | used |
- |---------|----------|------|------|*/
+/*           Layout  
+ |---------|----------|------|------|------------|
+ | input[] | output[] | size | used | rows_owned |
+ |---------|----------|------|------|------------|*/
 
 /*
 Relates an input to an output.
@@ -136,6 +146,7 @@ typedef struct INPUT_OUTPUT_MAPPING{
     double** output;  // Array of doubles as output (note that we can only have one output in this case)
     size_t size;      // Number of input and output arrays
     size_t used;      // Number of pointers used already
+    int rows_owned;   // 1 if the rows are one block starting at input[0] owned by the mapping, 0 if they are part of the block of input (CSV) or point into a BINARY_DATASET
 }INPUT_OUTPUT_MAPPING;
 
 
@@ -151,7 +162,528 @@ typedef struct STATE{
 } STATE;
 
 
-// Array of doubles to hold the sum of costs for each thread 
-extern double SUM_COST[NUM_THREADS];
+/**************************************************************/
+/* 7. Dense (compiled) representation of the Neural Network   */
+/**************************************************************/
+
+/*
+                          Layout
+ |------|-------|-----------|----------------|---------------|
+ | size | pos   | size_next | weights_offset | biases_offset |
+ |------|-------|-----------|----------------|---------------|*/
+
+/*
+One layer of the compiled Neural Network.
+The weights to the next layer are stored row-major as [size][size_next], so that the row of one neuron holds
+the weights of its connections in the same order as the neurons of the next layer.
+Offsets point into the params of the DENSE_NETWORK (and into the der_params of a DENSE_WORKSPACE).*/
+typedef struct DENSE_LAYER{
+    size_t size;           // Number of neurons in this layer
+    size_t pos;            // Position of the first neuron of this layer in the network array
+    size_t size_next;      // Number of neurons in the next layer (0 for the output layer)
+    size_t weights_offset; // Offset of the [size][size_next] weight matrix in the params
+    size_t biases_offset;  // Offset of the [size] biases in the params
+} DENSE_LAYER;
+
+/*
+                                    Layout
+ |--------|----------|-----------------|------------|-----------|------------------|
+ | layers | params[] | master_params[] | num_params | connected | topology_version |
+ |--------|----------|-----------------|------------|-----------|------------------|*/
+
+/*
+Dense copy of the parameters of the Neural Network, used by the training engine.
+The linked list of neurons stays the editable source of truth: the DENSE_NETWORK is compiled from it
+and has to be synced again whenever the topology changes (see TOPOLOGY_VERSION in neurons.h).
+Missing connections are stored as a weight of 0 and are flagged in the connected mask.
+The params have the type of the dense engine (see configurations/precision.h). In mixed precision the gradient descent
+updates the double master_params and rounds them into the float params used by the forward and backward pass.*/
+typedef struct DENSE_NETWORK{
+    DENSE_LAYER* layers;       // Array[NUMBER_LAYERS] of the layers
+    scalar* params;            // All weights and biases of the Neural Network in one contiguous block
+    double* master_params;     // Array[num_params] of the params in double precision (MIXED_PRECISION only, else NULL)
+    size_t num_params;         // Number of scalars in params
+    unsigned char* connected;  // Array[num_params] flagging existing parameters. NULL if the layers are fully connected
+    size_t topology_version;   // TOPOLOGY_VERSION of the linked list at the moment of the last sync
+} DENSE_NETWORK;
+
+/*
+                        Layout
+ |----------|-----------|----------|--------------|
+ | inputs[] | outputs[] | deltas[] | der_params[] |
+ |----------|-----------|----------|--------------|*/
+
+/*
+Per-thread state of the dense training engine.
+inputs, outputs and deltas hold a batch of up to BATCH_SIZE data points:
+for a batch of size B, layer l is a [B][size] matrix starting at B * (position of its first neuron).
+der_params mirrors the layout of the params of the DENSE_NETWORK.
+Workspaces used for predictions only hold the inputs and outputs (deltas and der_params are NULL).*/
+typedef struct DENSE_WORKSPACE{
+    scalar* inputs;      // Input (before activation) of every neuron for every data point of the batch
+    scalar* outputs;     // Activated output of every neuron for every data point of the batch
+    scalar* deltas;      // Backprop delta of every neuron for every data point of the batch
+    scalar* der_params;  // Accumulated partial derivatives of every parameter
+} DENSE_WORKSPACE;
+
+/*
+                         Layout
+ |----------|----------|--------------|---------------|----------|
+ | inputs[] | deltas[] | der_biases[] | der_weights[] | capacity |
+ |----------|----------|--------------|---------------|----------|*/
+
+/*
+Per-thread state of the training on the linked list.
+inputs, deltas and der_biases are indexed by the position of the neuron in the network array,
+der_weights by the index of the connection.
+All arrays of one thread are one contiguous block aligned to a cache line, so that threads never share a cache line.*/
+typedef struct LIST_WORKSPACE{
+    double* inputs;       // Input (before activation) of every neuron
+    double* deltas;       // Backprop delta of every neuron
+    double* der_biases;   // Accumulated derivative of the bias of every neuron
+    double* der_weights;  // Accumulated derivative of the weight of every connection
+    size_t capacity;      // Number of connection indices der_weights can hold
+} LIST_WORKSPACE;
+
+
+/*******************************************/
+/* 8. args for the gradient descent thread */
+/*******************************************/
+
+/*
+                                                      Layout
+ |-------------|---------------|------------|-----------------|-----------|-------|-----|--------------|------------|
+ | network_arr | dense_network | workspaces | list_workspaces | optimizer | start | end | params_start | params_end |
+ |-------------|---------------|------------|-----------------|-----------|-------|-----|--------------|------------|*/
+
+/*
+Data structure carrying the part of the Neural Network one thread updates during the gradient descent.
+On the linked list, every thread updates the neurons at the positions [start, end) (with their outgoing weights).
+On the dense network, every thread updates the shard [params_start, params_end) of the params.*/
+typedef struct GRADIENT_DESCENT_ARGS{
+    neuron** network_arr;                   // Pointer to the array of neurons of the Neural Network
+    struct DENSE_NETWORK* dense_network;    // Pointer to the compiled Neural Network. NULL if the linked list is trained
+    struct DENSE_WORKSPACE* workspaces;     // Array[NUM_THREADS] of the workspaces holding the derivatives of the dense engine
+    struct LIST_WORKSPACE* list_workspaces; // Array[NUM_THREADS] of the workspaces holding the derivatives of the linked list
+    struct OPTIMIZER* optimizer;            // Optimizer computing the steps of the params (shared by all threads, NULL for plain sgd)
+    size_t start;                           // Position of the first neuron to update
+    size_t end;                             // Position after the last neuron to update
+    size_t params_start;                    // Index of the first param of the shard (starts at a cache line)
+    size_t params_end;                      // Index after the last param of the shard
+} GRADIENT_DESCENT_ARGS;
+
+
+/*****************************************************/
+/* 9. Pool of worker threads reused every generation */
+/*****************************************************/
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/*
+                                 Layout
+ |---------|-------------|------|------|-------|------------|--------|-----------|----------|---------|
+ | threads | num_threads | cpus | lock | conds | job (args) | job_id | remaining | shutdown | started |
+ |---------|-------------|------|------|-------|------------|--------|-----------|----------|---------|*/
+
+/*
+Pool of threads that are created once and stay alive across generations.
+A job is one function that is run by every worker on its own element of an args array.
+Workers spin shortly on job_id before sleeping on job_ready, so that back-to-back jobs start within microseconds.*/
+typedef struct THREAD_POOL{
+    pthread_t* threads;           // Array[num_threads] of the worker threads
+    size_t num_threads;           // Number of worker threads
+    int* cpus;                    // Array[num_threads] of the CPU every worker is pinned to (NULL if the workers are not pinned)
+    pthread_mutex_t lock;         // Protects the sleeping on the conditions
+    pthread_cond_t job_ready;     // Signalled when a new job is posted (or the pool shuts down)
+    pthread_cond_t job_done;      // Signalled when the last worker finished the current job
+    void* (*job)(void*);          // Function run by every worker
+    char* job_args;               // Array of args of the job (one element per worker)
+    size_t size_job_args;         // Size of one element of job_args
+    atomic_size_t job_id;         // Incremented for every posted job
+    atomic_size_t remaining;      // Number of workers still running the current job
+    atomic_int shutdown;          // Set to 1 to terminate the workers
+    atomic_size_t started;        // Number of workers started (gives every worker its index)
+} THREAD_POOL;
+
+
+
+/*****************************************/
+/* 10. Binary dataset loaded with mmap   */
+/*****************************************/
+
+#include <stdint.h>
+
+/*
+                                                Layout
+ |-------|---------|-------------|------|------------|---------|--------------|---------------|
+ | magic | version | scalar_size | rows | input_dims | outputs | input_offset | output_offset |
+ |-------|---------|-------------|------|------------|---------|--------------|---------------|*/
+
+/*
+Header at the start of a binary dataset file (64 bytes, stored in the byte order of the machine).
+The inputs are one contiguous [rows][input_dims] block, the outputs one [rows][outputs] block.
+Both blocks start at a multiple of BINARY_DATASET_ALIGNMENT bytes from the start of the file.*/
+typedef struct BINARY_DATASET_HEADER{
+    char magic[8];           // BINARY_DATASET_MAGIC
+    uint64_t version;        // BINARY_DATASET_VERSION
+    uint64_t scalar_size;    // Size of one value in bytes (8 for float64, 4 for float32)
+    uint64_t rows;           // Number of data points
+    uint64_t input_dims;     // Number of inputs of every data point
+    uint64_t outputs;        // Number of outputs of every data point
+    uint64_t input_offset;   // Offset of the block of inputs in bytes
+    uint64_t output_offset;  // Offset of the block of outputs in bytes
+} BINARY_DATASET_HEADER;
+
+/*
+              Layout
+ |---------|--------------|-----------|
+ | mapping | size_mapping | converted |
+ |---------|--------------|-----------|*/
+
+/*
+Memory backing the rows of an INPUT_OUTPUT_MAPPING loaded from a binary dataset.
+float64 files are used in place (the rows point into the mapping), float32 files are widened into converted.*/
+typedef struct BINARY_DATASET{
+    void* mapping;        // Read-only mapping of the file (NULL if nothing is mapped)
+    size_t size_mapping;  // Size of the mapping in bytes
+    double* converted;    // Inputs followed by the (aligned) outputs as doubles if the file stores float32, else NULL
+} BINARY_DATASET;
+
+
+
+/****************************************/
+/* 11. Chunk of a CSV parsed by a thread */
+/****************************************/
+
+/*
+                                         Layout
+ |-------|-----|-----------|------|--------|---------|--------------|-----------------|-----------|
+ | start | end | first_row | rows | inputs | outputs | input_stride | values_per_line | exit_code |
+ |-------|-----|-----------|------|--------|---------|--------------|-----------------|-----------|*/
+
+/*
+Part of a CSV (whole lines) parsed by one thread.
+The threads only share the (read-only) text and the matrices of the values, of which every chunk writes its own rows.*/
+typedef struct CSV_CHUNK{
+    const char* start;      // First character of the chunk (start of a line)
+    const char* end;        // Character after the chunk (start of a line or end of the text)
+    size_t first_row;       // Index of the first data point of the chunk in the block of values
+    size_t rows;            // Number of data points of the chunk
+    double* inputs;         // Matrix of the inputs of the whole CSV (input_stride doubles per data point)
+    double* outputs;        // Matrix of the outputs of the whole CSV (NUM_OUTPUT doubles per data point)
+    size_t input_stride;    // Distance of two rows of inputs (DIMENSIONS_DATA padded to DATA_ROW_ALIGNMENT bytes)
+    size_t values_per_line; // Number of values on every line (DIMENSIONS_DATA if the CSV holds no outputs)
+    int exit_code;          // Result of parsing the chunk
+} CSV_CHUNK;
+
+
+
+/*****************************************************/
+/* 12. Windows of a dataset streamed from the disk   */
+/*****************************************************/
+
+#include <stdio.h>
+
+/*
+                         Layout
+ |--------|---------|-------|--------|------|------|-----------|
+ | inputs | outputs | input | output | rows | last | exit_code |
+ |--------|---------|-------|--------|------|------|-----------|*/
+
+/*
+Fixed number of consecutive data points of a streamed dataset held in memory at once.
+The blocks and the arrays of row pointers are allocated once for the capacity of the window and reused for every window.*/
+typedef struct DATA_WINDOW{
+    double* inputs;      // Block of [capacity][DIMENSIONS_DATA] inputs
+    double* outputs;     // Block of [capacity][NUM_OUTPUT] outputs
+    double** input;      // Array[capacity] of pointers to the rows of inputs
+    double** output;     // Array[capacity] of pointers to the rows of outputs
+    size_t rows;         // Number of data points loaded into the window
+    int last;            // 1 if the window ends the current pass over the file
+    int exit_code;       // Result of loading the window (the stream stops at the first error)
+} DATA_WINDOW;
+
+/*
+                                                    Layout
+ |------|--------|--------|----------|------|-----------|---------|-------------|---------|--------------|
+ | file | binary | header | next_row | line | size_line | staging | window_rows | windows | window_full  |
+ |------|--------|--------|----------|------|-----------|---------|-------------|---------|--------------|
+ |-------------|------|--------|------|---------|----------|
+ | next_window | held | loader | lock | changed | shutdown |
+ |-------------|------|--------|------|---------|----------|*/
+
+/*
+Dataset read from the disk in windows by a loader thread while the Neural Network trains on the previous window.
+Only two windows are held in memory, so the dataset may be larger than the RAM.
+After the last window of a pass the loader starts at the beginning of the file again.*/
+typedef struct DATA_STREAM{
+    FILE* file;                    // File of the dataset (CSV or binary dataset)
+    int binary;                    // 1 if the file is a binary dataset, 0 for a CSV
+    BINARY_DATASET_HEADER header;  // Header of the binary dataset (unused for a CSV)
+    size_t next_row;               // Next data point read by the loader in the current pass
+    char* line;                    // Buffer of getline for the lines of a CSV
+    size_t size_line;              // Size of the buffer of getline
+    void* staging;                 // float32 values of one window as read from the file (NULL for a CSV and float64)
+    size_t window_rows;            // Capacity of every window in data points
+    DATA_WINDOW windows[2];        // Double buffer: one window is trained on while the other one is loaded
+    int window_full[2];            // 1 if the window was loaded and not yet released by the trainer
+    size_t next_window;            // Window handed to the trainer next
+    int held;                      // Window held by the trainer (-1 if none)
+    pthread_t loader;              // Thread loading the windows
+    pthread_mutex_t lock;          // Protects window_full, held and shutdown
+    pthread_cond_t changed;        // Signalled when a window was loaded or released (or the stream shuts down)
+    int shutdown;                  // Set to 1 to terminate the loader
+} DATA_STREAM;
+
+
+
+/*******************************************************/
+/* 13. Binary checkpoint of the Neural Network (mmap)  */
+/*******************************************************/
+
+/*
+                                                       Layout
+ |-------|---------|-----------------|--------|---------|-------------|----------------|------------------|----------------|
+ | magic | version | dimensions_data | layers | neurons | connections | optimizer_type | optimizer_values | optimizer_step |
+ |-------|---------|-----------------|--------|---------|-------------|----------------|------------------|----------------|
+ |---------------|---------------|----------------|---------------|----------------|------------------|
+ | layers_offset | counts_offset | targets_offset | biases_offset | weights_offset | optimizer_offset |
+ |---------------|---------------|----------------|---------------|----------------|------------------|*/
+
+/*
+Header at the start of a checkpoint file (stored in the byte order of the machine).
+Every block starts at a multiple of CHECKPOINT_ALIGNMENT bytes from the start of the file:
+- layers:    [layers] uint64 neurons per layer
+- counts:    [neurons] uint64 connections of every neuron
+- targets:   [connections] uint64 positions of the connected neurons (in the order of the linked lists)
+- biases:    [neurons] doubles
+- weights:   [connections] doubles (same order as the targets)
+- optimizer: [optimizer_values] doubles of optimizer state (the used moments of the OPTIMIZER one after the other, may be empty)*/
+typedef struct CHECKPOINT_HEADER{
+    char magic[8];              // CHECKPOINT_MAGIC
+    uint64_t version;           // CHECKPOINT_VERSION
+    uint64_t dimensions_data;   // Dimensions of the data the Neural Network was trained on
+    uint64_t layers;            // Number of layers (NUMBER_LAYERS)
+    uint64_t neurons;           // Number of neurons (LENGTH_NETWORK)
+    uint64_t connections;       // Number of connections (weights)
+    uint64_t optimizer_type;    // Type of the optimizer the state belongs to (see gradient_descent.h)
+    uint64_t optimizer_values;  // Number of doubles of optimizer state
+    uint64_t optimizer_step;    // Number of updates done by the optimizer
+    uint64_t layers_offset;     // Offset of the block of layer sizes in bytes
+    uint64_t counts_offset;     // Offset of the block of connection counts in bytes
+    uint64_t targets_offset;    // Offset of the block of connection targets in bytes
+    uint64_t biases_offset;     // Offset of the block of biases in bytes
+    uint64_t weights_offset;    // Offset of the block of weights in bytes
+    uint64_t optimizer_offset;  // Offset of the block of optimizer state in bytes
+} CHECKPOINT_HEADER;
+
+/*
+                   Layout
+ |---------|--------------|--------|-----------------|
+ | mapping | size_mapping | header | optimizer_state |
+ |---------|--------------|--------|-----------------|*/
+
+/*
+Checkpoint mapped into memory by load_checkpoint().
+The optimizer state is read in place from the mapping, which stays valid until close_checkpoint().*/
+typedef struct CHECKPOINT{
+    void* mapping;                    // Read-only mapping of the file (NULL if nothing is mapped)
+    size_t size_mapping;              // Size of the mapping in bytes
+    const CHECKPOINT_HEADER* header;  // Header at the start of the mapping
+    const double* optimizer_state;    // [header->optimizer_values] doubles of optimizer state in the mapping
+} CHECKPOINT;
+
+
+
+/**********************************************/
+/* 14. State of the optimizer of the training */
+/**********************************************/
+
+/*
+                                   Layout
+ |------|------------|------|---------------|----------------|-----------------|
+ | type | num_values | step | learning_rate | first_moment[] | second_moment[] |
+ |------|------------|------|---------------|----------------|-----------------|*/
+
+/*
+State of the optimizer of the gradient descent (see gradient_descent.c).
+The moments are contiguous arrays (aligned to a cache line) parallel to the params: on the dense network index i belongs
+to param i, on the linked list index i < LENGTH_NETWORK to the bias of neuron i and LENGTH_NETWORK + i to the weight of connection i.
+Only the moments used by the type are allocated.*/
+typedef struct OPTIMIZER{
+    int type;               // OPTIMIZER_SGD, OPTIMIZER_MOMENTUM, OPTIMIZER_RMSPROP or OPTIMIZER_ADAM
+    size_t num_values;      // Number of params the moments hold
+    atomic_size_t step;     // Number of updates done (used by the bias correction of Adam, counted by every asynchronous update)
+    double learning_rate;   // Step size of the current synchronous update (includes the bias correction of Adam)
+    double* first_moment;   // Velocity (Momentum) or mean of the derivatives (Adam), NULL if unused
+    double* second_moment;  // Mean of the squared derivatives (RMSProp and Adam), NULL if unused
+} OPTIMIZER;
+
+
+
+/************************************************/
+/* 15. Result of a benchmark (see benchmark.c) */
+/************************************************/
+
+/*
+                                         Layout
+ |------|--------|--------|---------|------------|------------------|---------------|-------------|
+ | name | engine | sample | threads | data_points | flops_per_sample | ns_per_sample | ns_variance |
+ |------|--------|--------|---------|------------|------------------|---------------|-------------|*/
+
+/*
+Timing of one benchmark over all its repeats.
+A sample is the unit of work the benchmark is measured in (a data point, a param, a value or a row of a CSV).*/
+typedef struct BENCH_RESULT{
+    const char* name;         // Name of the benchmarked function
+    const char* engine;       // Training engine ("list" or "dense"), "-" if the function does not depend on it
+    const char* sample;       // Unit of work of one sample
+    size_t threads;           // Number of threads the benchmark ran on
+    size_t data_points;       // Size of the dataset of the benchmark
+    double flops_per_sample;  // Nominal floating point operations of one sample (0 if the function does not compute)
+    double ns_per_sample;     // Mean time of one sample over the repeats
+    double ns_variance;       // Variance of the time of one sample over the repeats
+} BENCH_RESULT;
+
+
+
+/****************************************************************/
+/* 16. Wall-clock times of the phases of the training (profile) */
+/****************************************************************/
+
+// Number of phases measured by the profiling (the indices of the times are the PHASE_ definitions of profiling.h)
+#define NUMBER_PHASES 10
+
+/*
+       Layout
+ |------------|-------|
+ | generation | total |
+ |------------|-------|*/
+
+/*
+Times of one thread measured by the profiling (make PROFILE=1, see profiling.c), in nanoseconds of the monotonic clock.
+Every thread only writes its own PHASE_PROFILE. They are allocated a whole number of cache lines apart to prevent false sharing.*/
+typedef struct PHASE_PROFILE{
+    double generation[NUMBER_PHASES];  // Time spent in every phase in the current generation
+    double total[NUMBER_PHASES];       // Time spent in every phase in all finished generations
+} PHASE_PROFILE;
+
+
+
+/******************************************************************/
+/* 17. Arena of the neurons and connections of the Neural Network */
+/******************************************************************/
+
+/*
+                             Layout
+ |-------------|------|----------|-------------|--------|
+ | connections | used | capacity | first_chunk | chunks |
+ |-------------|------|----------|-------------|--------|*/
+
+/*
+Owner of the memory of a Neural Network (see neurons.c). It is the header of the one block allocated by seed_neural_network():
+ | NETWORK_ARENA | neuron* [LENGTH_NETWORK] (the network array) | neuron [LENGTH_NETWORK] | connections [first_chunk] |
+The connections are handed out one after the other (bump pointer), so that the connections of a neuron are next to each other.
+If the first chunk is full, the connections continue in ARENA_CHUNKs. Nothing is freed before the whole network is.*/
+typedef struct NETWORK_ARENA{
+    node_linked_list_connection* connections;  // Chunk the next connections are taken from
+    size_t used;                               // Number of connections taken from the current chunk
+    size_t capacity;                           // Number of connections of the current chunk
+    size_t first_chunk;                        // Number of connections of the chunk in the block of the network
+    struct ARENA_CHUNK* chunks;                // Last chunk allocated after the block of the network (NULL if none)
+} NETWORK_ARENA;
+
+/*
+       Layout
+ |----------|-------------|
+ | previous | connections |
+ |----------|-------------|*/
+
+/*
+Chunk of connections allocated once the connections of the block of the network are used up*/
+typedef struct ARENA_CHUNK{
+    struct ARENA_CHUNK* previous;                   // Chunk allocated before this one (NULL for the first)
+    node_linked_list_connection connections[];      // Connections of the chunk
+} ARENA_CHUNK;
+
+
+
+/***********************************************/
+/* 18. CPUs and NUMA nodes the process runs on */
+/***********************************************/
+
+/*
+                  Layout
+ |--------|-------------|----------|-----------|
+ | cpus[] | cpu_nodes[] | num_cpus | num_nodes |
+ |--------|-------------|----------|-----------|*/
+
+/*
+Topology of the machine detected at startup (see detect_cpu_topology()).
+The CPUs are sorted by their NUMA node, so that neighbouring threads (which work on neighbouring rows) share a node.
+Machines without NUMA information are one node.*/
+typedef struct CPU_TOPOLOGY{
+    int* cpus;          // Array[num_cpus] of the ids of the CPUs the process may run on (sorted by node, then by id)
+    int* cpu_nodes;     // Array[num_cpus] of the NUMA node of every CPU of cpus
+    size_t num_cpus;    // Number of CPUs the process may run on
+    size_t num_nodes;   // Number of NUMA nodes holding at least one of the CPUs
+} CPU_TOPOLOGY;
+
+
+
+/***********************************************************/
+/* 19. Chunks of the data points handed out to the threads */
+/***********************************************************/
+
+/*
+                Layout
+ |-------|------|--------|------|
+ | range | data | stolen | node |
+ |-------|------|--------|------|*/
+
+/*
+Deque of the chunks of the data points of one thread (see work_queue.c).
+The chunks not taken yet are a range of chunk indices packed into one atomic word, so that the owner (taking from the front)
+and the thieves (taking from the back) agree on every chunk with one compare and swap.*/
+typedef struct WORK_DEQUE{
+    _Atomic uint64_t range;  // First chunk not taken (low 32 bits) and end of the chunks (high 32 bits)
+    THREAD_DATA* data;       // Data points the chunks are taken from
+    size_t stolen;           // Number of chunks the owner of the deque stole from other deques in the current job
+    int node;                // NUMA node of the CPU of the owner of the deque (the CPU it is pinned to with --pin)
+} WORK_DEQUE;
+
+/*
+                 Layout
+ |--------|--------|-------------|------------|
+ | deques | stride | num_threads | chunk_rows |
+ |--------|--------|-------------|------------|*/
+
+/*
+Work of one job of the THREAD_POOL split into chunks of chunk_rows data points.
+Every thread first takes the chunks of its own data points, then steals chunks from the back of the deque with the most chunks left,
+first among the deques of the threads on its own NUMA node, then among all deques.
+The WORK_DEQUEs are a whole number of cache lines apart, so that the threads only share a cache line when they steal.*/
+typedef struct WORK_QUEUE{
+    char* deques;        // WORK_DEQUE of every thread (stride bytes apart)
+    size_t stride;       // Distance of two WORK_DEQUEs in bytes
+    size_t num_threads;  // Number of WORK_DEQUEs
+    size_t chunk_rows;   // Number of data points of a chunk
+} WORK_QUEUE;
+
+/*
+           Layout
+ |------|-------|------|
+ | data | first | rows |
+ |------|-------|------|*/
+
+/*
+Chunk of data points taken by a thread: rows data points of data starting at first*/
+typedef struct WORK_CHUNK{
+    THREAD_DATA* data;  // Data points the chunk is part of (NULL before the first chunk is taken)
+    size_t first;       // Position of the first data point of the chunk in data
+    size_t rows;        // Number of data points of the chunk
+} WORK_CHUNK;
+
 
-#endif //STRUCTS_H
\ No newline at end of file
+#endif //STRUCTS_H
@@ -0,0 +1,365 @@
+/*
+This file detects information about the machine at runtime (instead of hardcoding it at compile time).
+Currently holds:
+- the size of a cache line (to align the memory written by different threads)
+- the number of CPUs this process may run on (to choose the number of threads)
+- the monotonic clock (to measure wall-clock times, clock() measures the CPU time of all threads)
+- the CPUs and NUMA nodes of the process and the pinning of threads to CPUs (so that a thread stays next to its memory)
+
+Errors should always print a message with the necessary information.
+Malloc errors return NULL if pointers are returned.*/
+
+#ifdef __linux__
+#define _GNU_SOURCE // For sched_getaffinity and pthread_setaffinity_np
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+#include "system_info.h"
+
+// Detected cache line size (0 until detected)
+static size_t detected_cache_line_size = 0;
+
+
+/*
+Returns 1 if the number is a power of 2 (required for aligned allocations), else 0*/
+static int is_power_of_two(size_t number){
+    return number != 0 && (number & (number - 1)) == 0;
+}
+
+
+/*
+Function to detect the size of a cache line of the L1 data cache.
+Returns 0 if it can not be detected.*/
+static size_t detect_cache_line_size(void){
+    size_t line_size = 0;
+
+#if defined(__APPLE__)
+    size_t size_of_line_size = sizeof(line_size);
+    if (sysctlbyname("hw.cachelinesize", &line_size, &size_of_line_size, NULL, 0) != 0){
+        line_size = 0;
+    }
+
+#elif defined(_SC_LEVEL1_DCACHE_LINESIZE)
+    long result = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    if (result > 0){
+        line_size = (size_t) result;
+    }
+#endif
+
+#ifdef __linux__
+    // Some systems do not report the line size through sysconf
+    if (line_size == 0){
+        FILE* file = fopen("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size", "r");
+        if (file){
+            if (fscanf(file, "%zu", &line_size) != 1){
+                line_size = 0;
+            }
+            fclose(file);
+        }
+    }
+#endif
+
+    return line_size;
+}
+
+
+/*
+Returns the size of a cache line in bytes.
+Detected once, DEFAULT_CACHE_LINE_SIZE is used if the detection fails.*/
+size_t cache_line_size(void){
+    if (detected_cache_line_size == 0){
+        size_t line_size = detect_cache_line_size();
+        detected_cache_line_size = is_power_of_two(line_size) ? line_size : DEFAULT_CACHE_LINE_SIZE;
+    }
+    return detected_cache_line_size;
+}
+
+
+/*
+Rounds a number of bytes up to whole cache lines*/
+size_t round_to_cache_line(size_t bytes){
+    size_t line_size = cache_line_size();
+    return ((bytes + line_size - 1) / line_size) * line_size;
+}
+
+
+/*
+Allocates zeroed memory of (at least) size bytes, which starts at a cache line and fills whole cache lines.
+Memory written by different threads should be allocated with this function to prevent false sharing.
+Free with free(). Returns NULL if it fails*/
+void* cache_aligned_calloc(size_t size){
+    size_t size_aligned = round_to_cache_line(size > 0 ? size : 1);
+
+    void* memory = aligned_alloc(cache_line_size(), size_aligned);
+    if (!memory){
+        return NULL;
+    }
+    memset(memory, 0, size_aligned);
+    return memory;
+}
+
+
+/*
+Reads the CPU quota of the cgroup of the process (cgroup v2 cpu.max or cgroup v1 cfs quota and period).
+Only the cgroup mounted at /sys/fs/cgroup is checked (the cgroup of the process inside a container).
+Returns the quota rounded up to whole CPUs or 0 if there is no quota.*/
+static size_t cgroup_cpu_quota(void){
+    size_t quota_cpus = 0;
+
+#ifdef __linux__
+    long quota = -1;
+    long period = 0;
+
+    // 1. cgroup v2: "<quota> <period>" or "max <period>"
+    FILE* file = fopen("/sys/fs/cgroup/cpu.max", "r");
+    if (file){
+        char quota_str[32];
+        if (fscanf(file, "%31s %ld", quota_str, &period) == 2 && strcmp(quota_str, "max") != 0){
+            quota = strtol(quota_str, NULL, 10);
+        }
+        fclose(file);
+    } else{
+        // 2. cgroup v1: quota of -1 means no limit
+        file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+        if (file){
+            if (fscanf(file, "%ld", &quota) != 1){
+                quota = -1;
+            }
+            fclose(file);
+        }
+        file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+        if (file){
+            if (fscanf(file, "%ld", &period) != 1){
+                period = 0;
+            }
+            fclose(file);
+        }
+    }
+
+    if (quota > 0 && period > 0){
+        quota_cpus = (size_t) ((quota + period - 1) / period);
+    }
+#endif
+
+    return quota_cpus;
+}
+
+
+/*
+Returns the number of CPUs this process can use (at least 1).
+Takes the minimum of the online CPUs, the CPUs of the affinity mask and the CPU quota of the cgroup,
+so that a process restricted by taskset or a container does not start more threads than it can run.*/
+size_t available_cpus(void){
+
+    // 1. Online CPUs of the machine
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t cpus = (online > 0) ? (size_t) online : 1;
+
+#ifdef __linux__
+    // 2. CPUs the process may be scheduled on
+    cpu_set_t affinity;
+    if (sched_getaffinity(0, sizeof(affinity), &affinity) == 0){
+        size_t affinity_cpus = (size_t) CPU_COUNT(&affinity);
+        if (affinity_cpus > 0 && affinity_cpus < cpus){
+            cpus = affinity_cpus;
+        }
+    }
+#endif
+
+    // 3. CPU time the cgroup may use
+    size_t quota_cpus = cgroup_cpu_quota();
+    if (quota_cpus > 0 && quota_cpus < cpus){
+        cpus = quota_cpus;
+    }
+
+    return cpus;
+}
+
+
+/*
+Returns the time of the monotonic clock in nanoseconds (only the difference of two calls is meaningful).
+Unlike clock(), which adds up the CPU time of all threads of the process, this is the wall-clock time.*/
+double monotonic_ns(void){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1e9 + (double) time.tv_nsec;
+}
+
+
+/*
+Returns the NUMA node of the CPU (the nodeN entry in the sysfs directory of the CPU), 0 if it can not be detected*/
+static int node_of_cpu(int cpu){
+    int node = 0;
+
+#ifdef __linux__
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR* directory = opendir(path);
+    if (directory){
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != NULL){
+            if (strncmp(entry->d_name, "node", 4) == 0 && sscanf(entry->d_name + 4, "%d", &node) == 1){
+                break;
+            }
+            node = 0;
+        }
+        closedir(directory);
+    }
+#else
+    (void) cpu;
+#endif
+
+    return node;
+}
+
+
+/*
+Detects the CPUs the process may run on (its affinity mask) and their NUMA nodes (read from sysfs, no libnuma needed).
+Systems without an affinity mask (macOS) get the first available_cpus() ids on one node.
+Free with free_cpu_topology(). Returns SUCCESSFULL_EXECUTION_CODE or MEMORY_ALLOCATION_ERROR*/
+int detect_cpu_topology(CPU_TOPOLOGY* topology){
+
+    // 1. CPUs of the affinity mask in the order of their ids
+    size_t num_cpus = 0;
+#ifdef __linux__
+    cpu_set_t affinity;
+    int has_affinity = sched_getaffinity(0, sizeof(affinity), &affinity) == 0 && CPU_COUNT(&affinity) > 0;
+    num_cpus = has_affinity ? (size_t) CPU_COUNT(&affinity) : available_cpus();
+#else
+    num_cpus = available_cpus();
+#endif
+
+    topology->cpus = malloc(num_cpus * sizeof(int));
+    topology->cpu_nodes = malloc(num_cpus * sizeof(int));
+    if (!topology->cpus || !topology->cpu_nodes){
+        printf("Memory allocation error when trying to allocate the topology of %zu CPUs.\n", num_cpus);
+        free_cpu_topology(topology);
+        return MEMORY_ALLOCATION_ERROR;
+    }
+
+    size_t cpu_pos = 0;
+#ifdef __linux__
+    for (int cpu = 0; has_affinity && cpu < CPU_SETSIZE && cpu_pos < num_cpus; cpu++){
+        if (CPU_ISSET(cpu, &affinity)){
+            topology->cpus[cpu_pos++] = cpu;
+        }
+    }
+#endif
+    for (; cpu_pos < num_cpus; cpu_pos++){
+        topology->cpus[cpu_pos] = (int) cpu_pos;
+    }
+    topology->num_cpus = num_cpus;
+
+    // 2. Sort them by their node (insertion sort keeps the order of the ids on a node)
+    for (cpu_pos = 0; cpu_pos < num_cpus; cpu_pos++){
+        int cpu = topology->cpus[cpu_pos];
+        int node = node_of_cpu(cpu);
+
+        size_t insert_pos = cpu_pos;
+        while (insert_pos > 0 && topology->cpu_nodes[insert_pos - 1] > node){
+            topology->cpus[insert_pos] = topology->cpus[insert_pos - 1];
+            topology->cpu_nodes[insert_pos] = topology->cpu_nodes[insert_pos - 1];
+            insert_pos--;
+        }
+        topology->cpus[insert_pos] = cpu;
+        topology->cpu_nodes[insert_pos] = node;
+    }
+
+    // 3. Count the nodes holding at least one of the CPUs
+    topology->num_nodes = num_cpus > 0 ? 1 : 0;
+    for (cpu_pos = 1; cpu_pos < num_cpus; cpu_pos++){
+        if (topology->cpu_nodes[cpu_pos] != topology->cpu_nodes[cpu_pos - 1]){
+            topology->num_nodes++;
+        }
+    }
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Prints the detected topology (the CPUs of every node as ranges of ids and the size of a cache line)*/
+void print_cpu_topology(const CPU_TOPOLOGY* topology){
+    printf("Detected %zu CPU%s on %zu NUMA node%s (cache line of %zu bytes):\n", topology->num_cpus, topology->num_cpus == 1 ? "" : "s",
+           topology->num_nodes, topology->num_nodes == 1 ? "" : "s", cache_line_size());
+
+    size_t cpu_pos = 0;
+    while (cpu_pos < topology->num_cpus){
+        int node = topology->cpu_nodes[cpu_pos];
+        printf("  node %d: CPUs ", node);
+
+        // Consecutive ids are printed as one range
+        int first_range = 1;
+        while (cpu_pos < topology->num_cpus && topology->cpu_nodes[cpu_pos] == node){
+            size_t range_end = cpu_pos;
+            while (range_end + 1 < topology->num_cpus && topology->cpu_nodes[range_end + 1] == node &&
+                   topology->cpus[range_end + 1] == topology->cpus[range_end] + 1){
+                range_end++;
+            }
+
+            printf(first_range ? "%d" : ",%d", topology->cpus[cpu_pos]);
+            if (range_end > cpu_pos){
+                printf("-%d", topology->cpus[range_end]);
+            }
+            first_range = 0;
+            cpu_pos = range_end + 1;
+        }
+        printf("\n");
+    }
+}
+
+
+/*
+Returns the position (in cpus of the topology) of the CPU of thread thread_pos of num_threads.
+The threads are spread evenly over the CPUs, so every node gets a share of the threads proportional to its CPUs
+and neighbouring threads share a node. More threads than CPUs share the CPUs.*/
+size_t cpu_of_thread(const CPU_TOPOLOGY* topology, size_t thread_pos, size_t num_threads){
+    if (num_threads <= topology->num_cpus){
+        return (thread_pos * topology->num_cpus) / num_threads;
+    }
+    return thread_pos % topology->num_cpus;
+}
+
+
+/*
+Pins the calling thread to the CPU (it is only scheduled on this CPU from now on).
+Memory the thread touches first is then placed on the NUMA node of the CPU by the kernel.
+Returns SUCCESSFULL_EXECUTION_CODE or OTHER_ERROR (pinning is only supported on Linux)*/
+int pin_current_thread(int cpu){
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0){
+        return SUCCESSFULL_EXECUTION_CODE;
+    }
+#else
+    (void) cpu;
+#endif
+    return OTHER_ERROR;
+}
+
+
+/*
+Frees the arrays of the topology*/
+void free_cpu_topology(CPU_TOPOLOGY* topology){
+    free(topology->cpus);
+    free(topology->cpu_nodes);
+    topology->cpus = NULL;
+    topology->cpu_nodes = NULL;
+    topology->num_cpus = 0;
+    topology->num_nodes = 0;
+}
@@ -0,0 +1,30 @@
+/*
+Header file of the system info file.
+Holds the information about the machine detected at runtime.
+Includes structs.h to use the CPU_TOPOLOGY struct.*/
+
+#ifndef SYSTEM_INFO_H
+#define SYSTEM_INFO_H
+
+#include <stddef.h>
+
+#include "../structs/structs.h"
+
+// Cache line size used if it can not be detected (128 bytes covers the adjacent line prefetch of x86 and Apple silicon)
+#define DEFAULT_CACHE_LINE_SIZE 128
+
+size_t cache_line_size(void);
+size_t round_to_cache_line(size_t);
+void* cache_aligned_calloc(size_t);
+
+size_t available_cpus(void);
+
+double monotonic_ns(void);
+
+int detect_cpu_topology(CPU_TOPOLOGY*);
+void print_cpu_topology(const CPU_TOPOLOGY*);
+size_t cpu_of_thread(const CPU_TOPOLOGY*, size_t, size_t);
+int pin_current_thread(int);
+void free_cpu_topology(CPU_TOPOLOGY*);
+
+#endif // SYSTEM_INFO_H
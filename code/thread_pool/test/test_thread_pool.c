@@ -0,0 +1,192 @@
+/*
+Test file for the thread pool.
+May not be included in any other files. Its own purpose is for testing.
+*/
+
+#ifdef __linux__
+#define _GNU_SOURCE // For sched_getcpu
+#include <sched.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+
+#include "test_thread_pool.h"
+
+// Number of jobs run back-to-back on the pool
+#define NUMBER_JOBS 10000
+
+/*
+Args of the test jobs (one per worker)*/
+typedef struct{
+    size_t count;     // Number of times the job ran on this element
+    pthread_t thread; // Thread that ran the job the last time
+    int same_thread;  // 0 if the job ran on different threads over time
+} COUNT_ARGS;
+
+
+// Counts how often the job ran on this element and checks that it always runs on the same thread
+void* count_job(void* args){
+    COUNT_ARGS* count_args = (COUNT_ARGS*) args;
+
+    if (count_args->count > 0 && !pthread_equal(count_args->thread, pthread_self())){
+        count_args->same_thread = 0;
+    }
+    count_args->thread = pthread_self();
+    count_args->count++;
+    return NULL;
+}
+
+// Same as count_job, but takes long enough for the caller and the workers to fall asleep
+void* slow_job(void* args){
+    struct timespec sleep_time = {0, 2000000}; // 2 ms
+    nanosleep(&sleep_time, NULL);
+    return count_job(args);
+}
+
+
+/*
+Runs many short jobs and checks that every worker ran every job on its own (persistent) thread*/
+void test_repeated_jobs(THREAD_POOL* pool){
+
+    COUNT_ARGS args[NUM_THREADS];
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        args[i].count = 0;
+        args[i].same_thread = 1;
+    }
+
+    for (size_t job = 0; job < NUMBER_JOBS; job++){
+        assert(run_thread_pool(pool, &count_job, (void*) args, sizeof(COUNT_ARGS)) == SUCCESSFULL_EXECUTION_CODE);
+    }
+
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        assert(args[i].count == NUMBER_JOBS);
+        assert(args[i].same_thread);
+
+        // Every worker has its own thread
+        for (size_t j = 0; j < i; j++){
+            assert(!pthread_equal(args[i].thread, args[j].thread));
+        }
+    }
+    return;
+}
+
+
+/*
+Runs slow jobs with pauses in between, so that the workers and the caller sleep on the conditions*/
+void test_sleeping_workers(THREAD_POOL* pool){
+
+    COUNT_ARGS args[NUM_THREADS];
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        args[i].count = 0;
+        args[i].same_thread = 1;
+    }
+
+    struct timespec sleep_time = {0, 5000000}; // 5 ms
+
+    for (size_t job = 0; job < 5; job++){
+        nanosleep(&sleep_time, NULL);
+        assert(run_thread_pool(pool, &slow_job, (void*) args, sizeof(COUNT_ARGS)) == SUCCESSFULL_EXECUTION_CODE);
+        assert(run_thread_pool(pool, &count_job, (void*) args, sizeof(COUNT_ARGS)) == SUCCESSFULL_EXECUTION_CODE);
+    }
+
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        assert(args[i].count == 10);
+        assert(args[i].same_thread);
+    }
+    return;
+}
+
+
+/*
+Args of the pinned test job (one per worker)*/
+typedef struct{
+    int cpu;          // CPU the worker is pinned to
+    int ran_on_cpu;   // 0 if the job ran on another CPU
+} PINNED_ARGS;
+
+
+// Checks that the job runs on the CPU its worker is pinned to
+void* pinned_job(void* args){
+    PINNED_ARGS* pinned_args = (PINNED_ARGS*) args;
+#ifdef __linux__
+    if (sched_getcpu() != pinned_args->cpu){
+        pinned_args->ran_on_cpu = 0;
+    }
+#endif
+    return NULL;
+}
+
+
+/*
+Detects the topology, spreads the workers of a pinned pool over its CPUs and checks that every job runs on the CPU of its worker*/
+void test_pinned_workers(void){
+
+    CPU_TOPOLOGY topology;
+    assert(detect_cpu_topology(&topology) == SUCCESSFULL_EXECUTION_CODE);
+    assert(topology.num_cpus >= available_cpus()); // The CPU quota of the cgroup may be smaller than the affinity mask
+    assert(topology.num_nodes >= 1 && topology.num_nodes <= topology.num_cpus);
+
+    // The CPUs are sorted by node
+    for (size_t cpu_pos = 1; cpu_pos < topology.num_cpus; cpu_pos++){
+        assert(topology.cpu_nodes[cpu_pos - 1] <= topology.cpu_nodes[cpu_pos]);
+    }
+
+    // The threads are spread in order over all CPUs (and share them if there are more threads than CPUs)
+    for (size_t thread_pos = 0; thread_pos < 2 * topology.num_cpus; thread_pos++){
+        assert(cpu_of_thread(&topology, thread_pos, 2 * topology.num_cpus) < topology.num_cpus);
+    }
+    assert(cpu_of_thread(&topology, 0, 1) == 0);
+    if (topology.num_cpus >= 2){
+        assert(cpu_of_thread(&topology, 1, 2) == topology.num_cpus / 2);
+    }
+
+    int cpus[NUM_THREADS];
+    PINNED_ARGS args[NUM_THREADS];
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        cpus[i] = topology.cpus[cpu_of_thread(&topology, i, NUM_THREADS)];
+        args[i].cpu = cpus[i];
+        args[i].ran_on_cpu = 1;
+    }
+
+    THREAD_POOL* pool = create_pinned_thread_pool(NUM_THREADS, cpus);
+    assert(pool);
+    for (size_t job = 0; job < 100; job++){
+        assert(run_thread_pool(pool, &pinned_job, (void*) args, sizeof(PINNED_ARGS)) == SUCCESSFULL_EXECUTION_CODE);
+    }
+    for (size_t i = 0; i < NUM_THREADS; i++){
+        assert(args[i].ran_on_cpu);
+    }
+
+    free_thread_pool(pool);
+    free_cpu_topology(&topology);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    THREAD_POOL* pool = create_thread_pool(NUM_THREADS);
+    if (!pool){
+        printf("Could not create the thread pool in test_thread_pool.\n");
+        return THREAD_CREATION_ERROR;
+    }
+
+    test_repeated_jobs(pool);
+    test_sleeping_workers(pool);
+
+    free_thread_pool(pool);
+
+    test_pinned_workers();
+
+    printf("All tests for thread_pool successfully executed.\n");
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
@@ -0,0 +1,22 @@
+/*
+Header file of the file to test the thread pool.
+May only be included in its own .c file.*/
+
+#ifndef TEST_THREAD_POOL_H
+#define TEST_THREAD_POOL_H
+
+#include "../../../configurations/config_manager.h"
+#include "../thread_pool.h"
+#include "../../system_info/system_info.h"
+
+void* count_job(void*);
+void* slow_job(void*);
+void* pinned_job(void*);
+
+void test_repeated_jobs(THREAD_POOL*);
+void test_sleeping_workers(THREAD_POOL*);
+void test_pinned_workers(void);
+
+int test_handler_func(void);
+
+#endif //TEST_THREAD_POOL_H
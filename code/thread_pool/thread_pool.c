@@ -0,0 +1,222 @@
+/*
+File responsible for the pool of worker threads.
+The threads are created once and reused for every job (the work of the threads and the gradient descent of every generation),
+so that a generation does not pay for pthread_create and pthread_join.
+
+Synchronisation:
+- A job is posted by incrementing job_id. Workers spin on it for SPIN_ITERATIONS before sleeping on job_ready.
+- Every worker decrements remaining after its job. The caller spins on it before sleeping on job_done.
+- All sleeping and waking is done under the lock, so that no wake-up can be lost.
+
+Pinned pools (create_pinned_thread_pool()) pin every worker to its CPU before it runs its first job.
+As worker i always runs element i of the job args, the memory a worker allocates and touches first stays on the NUMA node of its CPU.
+
+When profiling (make PROFILE=1), the workers measure their dispatch latency and busy time and the caller the time of the job (see profiling.c).
+
+Errors should always print a message with the necessary information.
+Malloc errors return NULL if pointers are returned.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "thread_pool.h"
+#include "../system_info/system_info.h"
+#include "../profiling/profiling.h"
+
+// Number of checks of an atomic before falling back to sleeping on a condition
+#define SPIN_ITERATIONS 20000
+
+
+/*
+Loop of one worker of the pool.
+Waits for a job, runs it on its own element of the args and signals when all workers are done.*/
+static void* worker_loop(void* args){
+
+    THREAD_POOL* pool = (THREAD_POOL*) args;
+
+    // Index of this worker (selects its element of the job args)
+    size_t index = atomic_fetch_add(&pool->started, 1);
+    PROFILE_THREAD(index);
+
+    // Pinning is best effort, an unpinned worker still runs its jobs
+    if (pool->cpus && pin_current_thread(pool->cpus[index]) != SUCCESSFULL_EXECUTION_CODE){
+        printf("Could not pin worker %zu of the thread pool to CPU %d.\n", index, pool->cpus[index]);
+    }
+
+    // Last job run by this worker
+    size_t seen_job_id = 0;
+
+    while (1){
+
+        /*****************************
+         * 1. Wait for the next job  *
+         *****************************/
+
+        size_t spins = 0;
+        while (atomic_load_explicit(&pool->job_id, memory_order_acquire) == seen_job_id && spins < SPIN_ITERATIONS){
+            spins++;
+        }
+
+        if (atomic_load_explicit(&pool->job_id, memory_order_acquire) == seen_job_id){
+            pthread_mutex_lock(&pool->lock);
+            while (atomic_load(&pool->job_id) == seen_job_id){
+                pthread_cond_wait(&pool->job_ready, &pool->lock);
+            }
+            pthread_mutex_unlock(&pool->lock);
+        }
+        seen_job_id = atomic_load_explicit(&pool->job_id, memory_order_acquire);
+
+        if (atomic_load(&pool->shutdown)){
+            return NULL;
+        }
+
+        /*********************
+         * 2. Run the job    *
+         *********************/
+
+        PROFILE_BEGIN(job_start);
+        PROFILE_JOB_STARTED(job_start);
+        pool->job((void*) (pool->job_args + index * pool->size_job_args));
+        PROFILE_END(job_start, PHASE_BUSY);
+
+        /***********************************
+         * 3. Signal if this was the last  *
+         ***********************************/
+
+        if (atomic_fetch_sub_explicit(&pool->remaining, 1, memory_order_acq_rel) == 1){
+            pthread_mutex_lock(&pool->lock);
+            pthread_cond_signal(&pool->job_done);
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+}
+
+
+/*
+Function to create a pool of num_threads worker threads.
+Returns NULL if it fails*/
+THREAD_POOL* create_thread_pool(size_t num_threads){
+    return create_pinned_thread_pool(num_threads, NULL);
+}
+
+
+/*
+Function to create a pool of num_threads worker threads, worker i is pinned to cpus[i] (the workers are not pinned if cpus is NULL).
+Returns NULL if it fails*/
+THREAD_POOL* create_pinned_thread_pool(size_t num_threads, const int* cpus){
+
+    THREAD_POOL* pool = malloc(sizeof(THREAD_POOL));
+    if (!pool){
+        perror("Memory allocation error when trying to allocate the THREAD_POOL.\n");
+        return NULL;
+    }
+
+    pool->threads = calloc(num_threads, sizeof(pthread_t));
+    if (!pool->threads){
+        perror("Memory allocation error when trying to allocate the threads of the THREAD_POOL.\n");
+        free(pool);
+        return NULL;
+    }
+
+    pool->cpus = NULL;
+    if (cpus){
+        pool->cpus = malloc(num_threads * sizeof(int));
+        if (!pool->cpus){
+            perror("Memory allocation error when trying to allocate the CPUs of the THREAD_POOL.\n");
+            free(pool->threads);
+            free(pool);
+            return NULL;
+        }
+        memcpy(pool->cpus, cpus, num_threads * sizeof(int));
+    }
+
+    pool->num_threads = 0; // Incremented for every created thread (used for the cleanup)
+    pool->job = NULL;
+    pool->job_args = NULL;
+    pool->size_job_args = 0;
+    atomic_init(&pool->job_id, 0);
+    atomic_init(&pool->remaining, 0);
+    atomic_init(&pool->shutdown, 0);
+    atomic_init(&pool->started, 0);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+
+    for (size_t thread_pos = 0; thread_pos < num_threads; thread_pos++){
+        if (pthread_create(&pool->threads[thread_pos], NULL, &worker_loop, (void*) pool) != 0){
+            printf("Creation of Thread %zu of the thread pool was unsuccessfull.\n", thread_pos);
+            free_thread_pool(pool); // Joins the threads created so far
+            return NULL;
+        }
+        pool->num_threads++;
+    }
+
+    return pool;
+}
+
+
+/*
+Function to run a job on every worker of the pool and wait until all workers are done.
+args is an array of num_threads elements of size_args bytes. Worker i is called with a pointer to element i.
+Returns SUCCESSFULL_EXECUTION_CODE*/
+int run_thread_pool(THREAD_POOL* pool, void* (*job)(void*), void* args, size_t size_args){
+
+    // 1. Post the job
+    PROFILE_BEGIN(posted);
+    PROFILE_JOB_POSTED(posted);
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->job_args = (char*) args;
+    pool->size_job_args = size_args;
+    atomic_store(&pool->remaining, pool->num_threads);
+    atomic_fetch_add_explicit(&pool->job_id, 1, memory_order_release);
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    // 2. Wait for the workers (spin first, as most jobs are short)
+    size_t spins = 0;
+    while (atomic_load_explicit(&pool->remaining, memory_order_acquire) != 0 && spins < SPIN_ITERATIONS){
+        spins++;
+    }
+
+    if (atomic_load_explicit(&pool->remaining, memory_order_acquire) != 0){
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->remaining) != 0){
+            pthread_cond_wait(&pool->job_done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    PROFILE_END(posted, PHASE_POOL);
+
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+
+/*
+Function to terminate the workers and free the THREAD_POOL*/
+void free_thread_pool(THREAD_POOL* pool){
+
+    // 1. Wake up all workers with the shutdown flag set
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->shutdown, 1);
+    atomic_fetch_add_explicit(&pool->job_id, 1, memory_order_release);
+    pthread_cond_broadcast(&pool->job_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    // 2. Join them
+    for (size_t thread_pos = 0; thread_pos < pool->num_threads; thread_pos++){
+        if (pthread_join(pool->threads[thread_pos], NULL) != 0){
+            printf("Joining of thread %zu of the thread pool was unsuccessfull.\n", thread_pos);
+        }
+    }
+
+    pthread_cond_destroy(&pool->job_done);
+    pthread_cond_destroy(&pool->job_ready);
+    pthread_mutex_destroy(&pool->lock);
+
+    free(pool->cpus);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,15 @@
+/*
+Header file of the thread pool.
+Includes structs.h to use the THREAD_POOL struct*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "../structs/structs.h"
+
+THREAD_POOL* create_thread_pool(size_t);
+THREAD_POOL* create_pinned_thread_pool(size_t, const int*);
+int run_thread_pool(THREAD_POOL*, void* (*)(void*), void*, size_t);
+void free_thread_pool(THREAD_POOL*);
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,209 @@
+/*
+Test file for the work queue.
+May not be included in any other files. Its own purpose is for testing.
+*/
+
+#define _POSIX_C_SOURCE 200809L // For nanosleep
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+
+#include "test_work_queue.h"
+
+// Number of data points of the tests (not a multiple of WORK_CHUNK_ROWS, so the last chunk is partial)
+#define NUMBER_ROWS 203
+
+// Number of times every row was taken (written by the threads, every row by the thread that took its chunk)
+static int ROW_MARKS[NUMBER_ROWS];
+// First row of the test data (the rows are the pointers ROWS + i, the marks are found by their position)
+static double ROWS[NUMBER_ROWS];
+// 1 if the job sleeps for every chunk (so that the other threads get to steal on a single CPU)
+static int SLOW_CHUNKS = 0;
+
+
+// Marks every row of every chunk the thread takes
+void* mark_rows_job(void* args){
+    THREAD_ARGS* thread_args = (THREAD_ARGS*) args;
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    while (take_work_chunk(thread_args, &chunk)){
+        assert(chunk.rows > 0 && chunk.rows <= WORK_CHUNK_ROWS);
+        assert(chunk.first + chunk.rows <= chunk.data->size);
+
+        for (size_t row = chunk.first; row < chunk.first + chunk.rows; row++){
+            ROW_MARKS[chunk.data->input[row] - ROWS]++;
+        }
+
+        if (SLOW_CHUNKS){
+            struct timespec sleep_time = {0, 1000000}; // 1 ms
+            nanosleep(&sleep_time, NULL);
+        }
+    }
+    return NULL;
+}
+
+
+/*
+Splits the rows into the THREAD_DATA of the threads (thread i gets sizes[i] rows) and points the args to them*/
+static void set_up_rows(double** rows, THREAD_DATA* thread_data, THREAD_ARGS* thread_args, const size_t sizes[NUM_THREADS], WORK_QUEUE* queue){
+    size_t first = 0;
+    for (size_t i = 0; i < NUMBER_ROWS; i++){
+        rows[i] = &ROWS[i];
+        ROW_MARKS[i] = 0;
+    }
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        thread_data[thread_pos].size = sizes[thread_pos];
+        thread_data[thread_pos].input = rows + first;
+        thread_data[thread_pos].output = rows + first;
+        thread_data[thread_pos].local_rows = NULL;
+        first += sizes[thread_pos];
+
+        thread_args[thread_pos] = (THREAD_ARGS) {0};
+        thread_args[thread_pos].pos = thread_pos;
+        thread_args[thread_pos].data = &thread_data[thread_pos];
+        thread_args[thread_pos].work_queue = queue;
+    }
+    assert(first == NUMBER_ROWS);
+}
+
+
+/*
+Without a WORK_QUEUE a thread takes all of its own rows as one chunk*/
+void test_static_split(void){
+    double* rows[NUMBER_ROWS];
+    THREAD_DATA thread_data[NUM_THREADS];
+    THREAD_ARGS thread_args[NUM_THREADS];
+    size_t sizes[NUM_THREADS] = {NUMBER_ROWS - 3, 1, 2, 0};
+    set_up_rows(rows, thread_data, thread_args, sizes, NULL);
+
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    assert(take_work_chunk(&thread_args[0], &chunk));
+    assert(chunk.data == &thread_data[0] && chunk.first == 0 && chunk.rows == NUMBER_ROWS - 3);
+    assert(!take_work_chunk(&thread_args[0], &chunk));
+
+    chunk = (WORK_CHUNK) {NULL, 0, 0};
+    assert(take_work_chunk(&thread_args[3], &chunk));
+    assert(chunk.rows == 0);
+    assert(!take_work_chunk(&thread_args[3], &chunk));
+    return;
+}
+
+
+/*
+Every row is taken exactly once, whatever the split of the rows among the threads (including threads without rows)*/
+void test_every_row_once(THREAD_POOL* pool){
+    double* rows[NUMBER_ROWS];
+    THREAD_DATA thread_data[NUM_THREADS];
+    THREAD_ARGS thread_args[NUM_THREADS];
+
+    WORK_QUEUE* queue = create_work_queue(NUM_THREADS, WORK_CHUNK_ROWS);
+    assert(queue);
+
+    const size_t splits[3][NUM_THREADS] = {{51, 51, 51, 50}, {NUMBER_ROWS, 0, 0, 0}, {0, 3, NUMBER_ROWS - 10, 7}};
+    for (size_t split = 0; split < 3; split++){
+        for (size_t job = 0; job < 50; job++){
+            set_up_rows(rows, thread_data, thread_args, splits[split], queue);
+            reset_work_queue(queue, thread_args);
+            assert(run_thread_pool(pool, &mark_rows_job, (void*) thread_args, size_thread_args) == SUCCESSFULL_EXECUTION_CODE);
+
+            for (size_t row = 0; row < NUMBER_ROWS; row++){
+                assert(ROW_MARKS[row] == 1);
+            }
+        }
+    }
+
+    free_work_queue(queue);
+    return;
+}
+
+
+/*
+If one thread holds all rows and its chunks are slow, the other threads steal chunks from it*/
+void test_stealing(THREAD_POOL* pool){
+    double* rows[NUMBER_ROWS];
+    THREAD_DATA thread_data[NUM_THREADS];
+    THREAD_ARGS thread_args[NUM_THREADS];
+    size_t sizes[NUM_THREADS] = {NUMBER_ROWS, 0, 0, 0};
+
+    WORK_QUEUE* queue = create_work_queue(NUM_THREADS, WORK_CHUNK_ROWS);
+    assert(queue);
+    set_up_rows(rows, thread_data, thread_args, sizes, queue);
+    reset_work_queue(queue, thread_args);
+
+    SLOW_CHUNKS = 1;
+    assert(run_thread_pool(pool, &mark_rows_job, (void*) thread_args, size_thread_args) == SUCCESSFULL_EXECUTION_CODE);
+    SLOW_CHUNKS = 0;
+
+    for (size_t row = 0; row < NUMBER_ROWS; row++){
+        assert(ROW_MARKS[row] == 1);
+    }
+    assert(stolen_work_chunks(queue) > 0);
+
+    // A new job starts without stolen chunks
+    reset_work_queue(queue, thread_args);
+    assert(stolen_work_chunks(queue) == 0);
+
+    free_work_queue(queue);
+    return;
+}
+
+
+/*
+A thread without chunks steals from the threads on its own NUMA node first (even if a deque on another node is fuller),
+and only from the other nodes once its node is done*/
+void test_same_node_first(void){
+    double* rows[NUMBER_ROWS];
+    THREAD_DATA thread_data[NUM_THREADS];
+    THREAD_ARGS thread_args[NUM_THREADS];
+    size_t sizes[NUM_THREADS] = {0, 2 * WORK_CHUNK_ROWS, 2 * WORK_CHUNK_ROWS, NUMBER_ROWS - 4 * WORK_CHUNK_ROWS};
+    assert(NUMBER_ROWS > 8 * WORK_CHUNK_ROWS);
+
+    WORK_QUEUE* queue = create_work_queue(NUM_THREADS, WORK_CHUNK_ROWS);
+    assert(queue);
+    set_up_rows(rows, thread_data, thread_args, sizes, queue);
+    reset_work_queue(queue, thread_args);
+
+    // Threads 0 and 2 on node 0, threads 1 and 3 (the fullest deque) on node 1
+    const int nodes[NUM_THREADS] = {0, 1, 0, 1};
+    for (size_t thread_pos = 0; thread_pos < NUM_THREADS; thread_pos++){
+        ((WORK_DEQUE*) (queue->deques + thread_pos * queue->stride))->node = nodes[thread_pos];
+    }
+
+    // The 2 chunks of thread 2 (from the back), then the fullest deque of node 1
+    WORK_CHUNK chunk = {NULL, 0, 0};
+    assert(take_work_chunk(&thread_args[0], &chunk) && chunk.data == &thread_data[2] && chunk.first == WORK_CHUNK_ROWS);
+    assert(take_work_chunk(&thread_args[0], &chunk) && chunk.data == &thread_data[2] && chunk.first == 0);
+    assert(take_work_chunk(&thread_args[0], &chunk) && chunk.data == &thread_data[3]);
+    assert(stolen_work_chunks(queue) == 3);
+
+    free_work_queue(queue);
+    return;
+}
+
+
+/*
+Function that manages the Testing*/
+int test_handler_func(void){
+
+    THREAD_POOL* pool = create_thread_pool(NUM_THREADS);
+    if (!pool){
+        printf("Could not create the thread pool in test_work_queue.\n");
+        return THREAD_CREATION_ERROR;
+    }
+
+    test_static_split();
+    test_every_row_once(pool);
+    test_stealing(pool);
+    test_same_node_first();
+
+    free_thread_pool(pool);
+
+    printf("All tests for work_queue successfully executed.\n");
+    return SUCCESSFULL_EXECUTION_CODE;
+}
+
+int main(void){
+    return test_handler_func();
+}
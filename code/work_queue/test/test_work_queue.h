@@ -0,0 +1,21 @@
+/*
+Header file of the file to test the work queue.
+May only be included in its own .c file.*/
+
+#ifndef TEST_WORK_QUEUE_H
+#define TEST_WORK_QUEUE_H
+
+#include "../../../configurations/config_manager.h"
+#include "../work_queue.h"
+#include "../../thread_pool/thread_pool.h"
+
+void* mark_rows_job(void*);
+
+void test_static_split(void);
+void test_every_row_once(THREAD_POOL*);
+void test_stealing(THREAD_POOL*);
+void test_same_node_first(void);
+
+int test_handler_func(void);
+
+#endif //TEST_WORK_QUEUE_H
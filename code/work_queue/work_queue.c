@@ -0,0 +1,206 @@
+/*
+This file hands out the data points of a job of the THREAD_POOL to the threads in chunks (work stealing).
+With a static split, a generation takes as long as its slowest thread (hybrid CPUs with fast and slow cores,
+a busy shared host or data points of different cost). Instead, the data points of every thread are split into
+chunks of chunk_rows data points, which are put into the WORK_DEQUE of the thread before every job:
+- a thread takes the chunks of its own deque from the front (its own data points, in order, on its own NUMA node)
+- once its deque is empty, it steals one chunk at a time from the back of the deque with the most chunks left,
+  first among the deques of the threads on its own NUMA node and only then from the other nodes
+- it is done once all deques are empty (no chunks are added during a job)
+A thread only shares the cache line of another deque while stealing from it.
+The NUMA node of a thread is the node of the CPU it is pinned to with --pin (see cpu_of_thread()), so that with --pin
+a thief keeps reading data points from its own node as long as its node has work left. A steal from another node
+pulls the rows over the interconnect, but a thread waiting for the slowest node would cost more.
+Without --pin the threads are not bound to these nodes and the order only decides which deque is robbed first.
+
+As no chunk is added during a job, a deque is a range of chunk indices in one atomic word.
+The owner and the thieves take a chunk with one compare and swap of the range, so every chunk is taken exactly once.
+The data points themselves are published by posting the job (see run_thread_pool()), so the ranges need no ordering.
+
+The threads add up their derivatives and costs in their own workspace, whichever data points they work on,
+so the sums only change in the order of the additions.
+
+Errors should always print a message with the necessary information.
+Malloc errors return NULL if pointers are returned.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "work_queue.h"
+#include "../system_info/system_info.h"
+
+// Packs the range [first, end) of chunk indices into the word of a WORK_DEQUE
+#define PACK_RANGE(first, end) (((uint64_t) (end) << 32) | (uint64_t) (first))
+#define RANGE_FIRST(range) ((size_t) ((range) & 0xFFFFFFFFu))
+#define RANGE_END(range) ((size_t) ((range) >> 32))
+
+
+/*
+Returns the WORK_DEQUE of the thread*/
+static inline WORK_DEQUE* work_deque(const WORK_QUEUE* queue, size_t thread){
+    return (WORK_DEQUE*) (queue->deques + thread * queue->stride);
+}
+
+
+/*
+Function to create the WORK_QUEUE of num_threads threads handing out chunks of chunk_rows data points.
+The deque of every thread is given the NUMA node of the CPU of the thread (all threads are on node 0 if the topology is unknown).
+Returns NULL if it fails*/
+WORK_QUEUE* create_work_queue(size_t num_threads, size_t chunk_rows){
+
+    WORK_QUEUE* queue = malloc(sizeof(WORK_QUEUE));
+    if (!queue){
+        perror("Memory allocation error when trying to allocate the WORK_QUEUE.\n");
+        return NULL;
+    }
+
+    queue->stride = round_to_cache_line(sizeof(WORK_DEQUE));
+    queue->deques = cache_aligned_calloc(num_threads * queue->stride);
+    if (!queue->deques){
+        printf("Memory allocation error when trying to allocate the deques of %zu threads.\n", num_threads);
+        free(queue);
+        return NULL;
+    }
+    queue->num_threads = num_threads;
+    queue->chunk_rows = chunk_rows > 0 ? chunk_rows : 1;
+
+    CPU_TOPOLOGY topology;
+    int has_topology = detect_cpu_topology(&topology) == SUCCESSFULL_EXECUTION_CODE;
+    for (size_t thread = 0; thread < num_threads; thread++){
+        atomic_init(&work_deque(queue, thread)->range, PACK_RANGE(0, 0));
+        work_deque(queue, thread)->node = has_topology ? topology.cpu_nodes[cpu_of_thread(&topology, thread, num_threads)] : 0;
+    }
+    if (has_topology){
+        free_cpu_topology(&topology);
+    }
+    return queue;
+}
+
+
+/*
+Function to fill the deque of every thread with the chunks of the data of its THREAD_ARGS (args_arr holds one per thread).
+Has to be called before every job while the THREAD_POOL is idle.*/
+void reset_work_queue(WORK_QUEUE* queue, THREAD_ARGS* args_arr){
+    for (size_t thread = 0; thread < queue->num_threads; thread++){
+        WORK_DEQUE* deque = work_deque(queue, thread);
+        size_t num_chunks = (args_arr[thread].data->size + queue->chunk_rows - 1) / queue->chunk_rows;
+
+        deque->data = args_arr[thread].data;
+        deque->stolen = 0;
+        atomic_store_explicit(&deque->range, PACK_RANGE(0, num_chunks), memory_order_relaxed);
+    }
+}
+
+
+/*
+Takes the first (from_front) or last chunk of the deque.
+Returns 1 and the index of the chunk or 0 if the deque is empty*/
+static int take_from_deque(WORK_DEQUE* deque, int from_front, size_t* chunk_index){
+    uint64_t range = atomic_load_explicit(&deque->range, memory_order_relaxed);
+
+    while (RANGE_FIRST(range) < RANGE_END(range)){
+        size_t first = RANGE_FIRST(range);
+        size_t end = RANGE_END(range);
+        uint64_t taken = from_front ? PACK_RANGE(first + 1, end) : PACK_RANGE(first, end - 1);
+
+        // Fails (and reloads the range) if another thread took a chunk in the meantime
+        if (atomic_compare_exchange_weak_explicit(&deque->range, &range, taken, memory_order_relaxed, memory_order_relaxed)){
+            *chunk_index = from_front ? first : end - 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+Returns the deque with the most chunks left among the deques of the threads on the node (any node if same_node is 0).
+Returns NULL if all of these deques are empty*/
+static WORK_DEQUE* fullest_deque(const WORK_QUEUE* queue, int node, int same_node){
+    WORK_DEQUE* fullest = NULL;
+    size_t most_chunks = 0;
+    for (size_t thread = 0; thread < queue->num_threads; thread++){
+        WORK_DEQUE* deque = work_deque(queue, thread);
+        if (same_node && deque->node != node){
+            continue;
+        }
+        uint64_t range = atomic_load_explicit(&deque->range, memory_order_relaxed);
+        size_t chunks = RANGE_END(range) - RANGE_FIRST(range);
+        if (RANGE_FIRST(range) < RANGE_END(range) && chunks > most_chunks){
+            most_chunks = chunks;
+            fullest = deque;
+        }
+    }
+    return fullest;
+}
+
+
+/*
+Function to take the next chunk of data points for the thread of the args (its own chunks first, then stolen ones).
+Without a WORK_QUEUE the thread takes all of its own data points as one chunk (the static split).
+chunk has to be {NULL, 0, 0} before the first call of a job.
+Returns 1 if a chunk was taken or 0 if the work of the job is done*/
+int take_work_chunk(THREAD_ARGS* thread_args, WORK_CHUNK* chunk){
+    WORK_QUEUE* queue = thread_args->work_queue;
+
+    if (!queue){
+        if (chunk->data){
+            return 0;
+        }
+        chunk->data = thread_args->data;
+        chunk->first = 0;
+        chunk->rows = thread_args->data->size;
+        return 1;
+    }
+
+    WORK_DEQUE* own_deque = work_deque(queue, thread_args->pos);
+    WORK_DEQUE* deque = own_deque;
+    size_t chunk_index;
+
+    // 1. Own chunks from the front
+    int taken = take_from_deque(own_deque, 1, &chunk_index);
+
+    // 2. Steal from the back of the deque with the most chunks left (the victim keeps working on its front),
+    // on the own NUMA node first, so that the rows only cross the interconnect once the own node is done
+    while (!taken){
+        deque = fullest_deque(queue, own_deque->node, 1);
+        if (!deque){
+            deque = fullest_deque(queue, own_deque->node, 0);
+        }
+        if (!deque){
+            return 0;
+        }
+
+        taken = take_from_deque(deque, 0, &chunk_index);
+        if (taken){
+            own_deque->stolen++;
+        }
+    }
+
+    chunk->data = deque->data;
+    chunk->first = chunk_index * queue->chunk_rows;
+    chunk->rows = (deque->data->size - chunk->first < queue->chunk_rows) ? deque->data->size - chunk->first : queue->chunk_rows;
+    return 1;
+}
+
+
+/*
+Returns the number of chunks stolen by all threads in the last job (may only be called while the THREAD_POOL is idle)*/
+size_t stolen_work_chunks(const WORK_QUEUE* queue){
+    size_t stolen = 0;
+    for (size_t thread = 0; thread < queue->num_threads; thread++){
+        stolen += work_deque(queue, thread)->stolen;
+    }
+    return stolen;
+}
+
+
+/*
+Function to free the WORK_QUEUE*/
+void free_work_queue(WORK_QUEUE* queue){
+    if (!queue){
+        return;
+    }
+    free(queue->deques);
+    free(queue);
+}
@@ -0,0 +1,16 @@
+/*
+Header file of the work queue.
+Includes structs.h to use the WORK_QUEUE, WORK_CHUNK and THREAD_ARGS structs.*/
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include "../structs/structs.h"
+
+WORK_QUEUE* create_work_queue(size_t, size_t);
+void reset_work_queue(WORK_QUEUE*, THREAD_ARGS*);
+int take_work_chunk(THREAD_ARGS*, WORK_CHUNK*);
+size_t stolen_work_chunks(const WORK_QUEUE*);
+void free_work_queue(WORK_QUEUE*);
+
+#endif // WORK_QUEUE_H
@@ -0,0 +1,23 @@
+/*
+This file replaces config.c in the benchmarks (see make bench).
+It uses the configurations of config.h, but the width of the layers is given by the build (BENCH_WIDTH)
+and the depth by HIDDEN_LAYERS, so that the benchmarks can be built for several topologies.
+
+This is its whole purpose and it may not be used for any other definitions.
+*/
+
+#include "../config/config.h"
+
+// Number of neurons of the input and of every hidden layer
+#ifndef BENCH_WIDTH
+#define BENCH_WIDTH 16
+#endif
+
+// Structs actual definition (every layer but the output layer has BENCH_WIDTH neurons)
+const size_t NEURON_NUMBERS[NUMBER_LAYERS] = {[0 ... NUMBER_LAYERS - 2] = BENCH_WIDTH, [NUMBER_LAYERS - 1] = NUM_OUTPUT};
+
+// Number of threads (changed by the benchmarks)
+size_t NUM_THREADS = DEFAULT_NUM_THREADS;
+
+// The benchmarks generate their data
+const char *FILENAME = NULL;
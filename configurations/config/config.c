@@ -9,9 +9,12 @@ This is its whole purpose and it may not be used for any other definitions.
 #include <stdio.h>
 #include <unistd.h>
 
-// Structs actual definition
+// Structs actual definition (the output layer has NUM_OUTPUT neurons, which may be given by the build)
 const size_t NEURON_NUMBERS[NUMBER_LAYERS] = {3, NUM_OUTPUT};
 
+// Number of threads (may be changed by the command line arguments before the data is read)
+size_t NUM_THREADS = DEFAULT_NUM_THREADS;
+
 
 // Declare the name of the file if necessary
 #if defined(DEMO) || defined(DEBUG)
@@ -42,7 +42,10 @@ extern size_t DIMENSIONS_DATA;
 extern size_t SIZE_TRAIN;
 
 // 1.3 Dimensions of the ouput layer. This is data specific and should be changed depending on the dataset
+// (may be given by the build, e.g. make NUM_OUTPUT=3 SOFTMAX_OUTPUT=1 for the classification into 3 classes)
+#ifndef NUM_OUTPUT
 #define NUM_OUTPUT 1
+#endif
 
 
 /*
@@ -52,7 +55,10 @@ extern size_t SIZE_TRAIN;
 */
 
 // 2.1 Number of hidden layers of the Neural Network. By default, all layers are connected
+// (may be given by the build, make bench builds the benchmarks for several depths)
+#ifndef HIDDEN_LAYERS
 #define HIDDEN_LAYERS 0
+#endif
 
 // 2.2 Number of total layers of the Neural Network. Includes input, hidden and output layers
 #define NUMBER_LAYERS (HIDDEN_LAYERS + 2) // By default there must always be 2 more total layers than hidden layers (input and output layer)
@@ -82,6 +88,22 @@ extern size_t WORKING_NEURONS;
 // 3.3 The name of the file from which to learn
 extern const char *FILENAME;
 
+// 3.4 Optimizer of the gradient descent if --optimizer is not given (OPTIMIZER_SGD, _MOMENTUM, _RMSPROP or _ADAM, see gradient_descent.h)
+#define DEFAULT_OPTIMIZER OPTIMIZER_SGD
+
+// 3.5 Hyperparameters of the optimizers (LEARNING_RATE is the step of sgd and momentum)
+#define ADAPTIVE_LEARNING_RATE 1e-2 // Step of rmsprop and adam (the derivatives are normalised, so the step is about the change of a param)
+#define MOMENTUM_DECAY 0.9          // Decay of the velocity (momentum) and of the mean of the derivatives (adam)
+#define SQUARED_DECAY 0.999         // Decay of the mean of the squared derivatives (rmsprop and adam)
+#define OPTIMIZER_EPSILON 1e-8      // Added to the root of the squared derivatives, so that a derivative of 0 does not divide by 0
+
+// 3.6 Number of data points per update of the params if --mini-batch is not given (0 updates once per pass over the data)
+#define DEFAULT_MINI_BATCH_SIZE 0
+
+// 3.7 Early stopping if --patience and --min-improvement are not given
+#define DEFAULT_PATIENCE 0              // Generations without improvement before the training stops (0 always runs all GENERATIONS)
+#define DEFAULT_MIN_IMPROVEMENT 1e-3    // Relative decrease of the best cost that counts as an improvement
+
 /*
 |------------------------|
 | 4. Constant Functions  |
@@ -92,10 +114,22 @@ extern const char *FILENAME;
 #define ACTIVATION_FUNCTION(input) leaky_relu((input), 0.2)
 #define ACTIVATION_FUNCTION_DER(input) der_leaky_relu((input), 0.2)
 
+// 4.1.1 Array versions of the activation function and its derivative (output[i] = f(input[i]) for i < size, uses SIMD)
+// SCALAR_ARR selects the float versions in single and mixed precision (see configurations/precision.h)
+#define ACTIVATION_FUNCTION_ARR(input, output, size) SCALAR_ARR(leaky_relu_arr)((input), (output), (size), 0.2)
+#define ACTIVATION_FUNCTION_DER_ARR(input, output, size) SCALAR_ARR(der_leaky_relu_arr)((input), (output), (size), 0.2)
+
 // 4.2 Cost function definition (a struct with activation function and its derivative) (currently not working for exponential cost)
 #define COST_FUNCTION(actual, pred) mean_squared_error((actual), (pred))
 #define COST_FUNCTION_DER(actual, pred) mean_squared_error_der((actual), (pred))
 
+// 4.3 Softmax output layer for the classification into NUM_OUTPUT > 1 classes (1) or ACTIVATION_FUNCTION and COST_FUNCTION per output (0)
+// The softmax replaces the activation of the output layer and the categorical cross entropy the COST_FUNCTION,
+// their derivative is fused into one kernel (see softmax_cross_entropy_arr()). The labels have to be one hot (or sum up to 1).
+#ifndef SOFTMAX_OUTPUT
+#define SOFTMAX_OUTPUT 0
+#endif
+
 
 /*
 |--------------------|
@@ -103,9 +137,27 @@ extern const char *FILENAME;
 |--------------------|
 */
 
-// 5.1 Number of threads used in the multiprocessing (change to make the code faster)
-#define NUM_THREADS 1
-// To get the number of cores: #include <unistd.h>  int cores = sysconf(_SC_NPROCESSORS_ONLN);
+// 5.1 Number of threads used in the multiprocessing (set at runtime with --threads N|auto, see main.c)
+extern size_t NUM_THREADS;
+// Number of threads used if --threads is not given
+#define DEFAULT_NUM_THREADS 1
+// Largest number of threads per CPU available to the process, larger values of --threads N are clamped to it.
+// More threads only take turns on the CPUs, while every one of them adds a workspace with its own copy of the derivatives
+// of all params (summed up by every gradient descent) and spins while waiting for the next job of the thread pool
+#define MAX_THREADS_PER_CPU 4
+
+// 5.2 Number of data points a thread pushes through the dense network at once (rows of the matrix products)
+#define BATCH_SIZE 64
+
+// 5.3 Number of data points held by one of the two windows of a streamed dataset (see --stream in main.c)
+#define STREAM_WINDOW_ROWS 65536
+
+// 5.4 Number of data points of a chunk of the work handed out to the threads (a multiple of BATCH_SIZE, see work_queue.c)
+// Smaller chunks balance the threads better, every chunk costs one compare and swap
+#define WORK_CHUNK_ROWS (4 * BATCH_SIZE)
+
+// 5.5 Type of the values of the dense training engine (double unless built with make PRECISION=single|mixed)
+#include "../precision.h"
 
 
 /*
@@ -0,0 +1,40 @@
+/*
+This file selects the type of the values of the dense training engine (params, workspaces and matrix kernels).
+
+No code should be written here, the file only defines the type based on the flags of the build (see PRECISION in the Makefile):
+- default:            double for everything
+- SINGLE_PRECISION:   float for the params, activations and derivatives (twice the values per SIMD vector, half the memory traffic)
+- MIXED_PRECISION:    float for the activations and derivatives, the gradient descent updates double master params
+
+The linked list of neurons and the training data always stay double.
+Kept free of other includes, so that the kernels which may not use the configurations (matrix.h) can include it.*/
+
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#if defined(SINGLE_PRECISION) && defined(MIXED_PRECISION)
+#error "Only one of SINGLE_PRECISION and MIXED_PRECISION may be defined"
+#endif
+
+#if defined(SINGLE_PRECISION) || defined(MIXED_PRECISION)
+// Type of the values computed by the dense training engine
+typedef float scalar;
+
+// Name of the array version of an activation function for arrays of scalars
+#define SCALAR_ARR(name) name##_float
+#else
+typedef double scalar;
+
+#define SCALAR_ARR(name) name
+#endif
+
+// Name of the precision (for printing)
+#if defined(SINGLE_PRECISION)
+#define PRECISION_NAME "single"
+#elif defined(MIXED_PRECISION)
+#define PRECISION_NAME "mixed"
+#else
+#define PRECISION_NAME "double"
+#endif
+
+#endif // PRECISION_H
@@ -7,5 +7,5 @@ This is its whole purpose and it may not be used for any other definitions.
 
 #include "test_config.h"
 
-// Structs actual definition
+// Structs actual definition (the output layer has NUM_OUTPUT neurons, which may be given by the build)
 const size_t NEURON_NUMBERS[NUMBER_LAYERS] = {1, NUM_OUTPUT};
@@ -52,7 +52,10 @@ extern size_t SIZE_TRAIN;
 #endif // PROCESS_INPUT
 
 // 1.3 Dimensions of the ouput layer. This is data specific and should be changed depending on the dataset
+// (may be given by the build, make test_softmax_training tests the classification into 3 classes)
+#ifndef NUM_OUTPUT
 #define NUM_OUTPUT 1
+#endif
 
 
 /*
@@ -88,6 +91,15 @@ extern size_t WORKING_NEURONS;
 // 3.2 The number of times the Neural Network should run during the training process
 #define GENERATIONS 10
 
+// 3.3 Optimizer of the gradient descent if --optimizer is not given (OPTIMIZER_SGD, _MOMENTUM, _RMSPROP or _ADAM, see gradient_descent.h)
+#define DEFAULT_OPTIMIZER OPTIMIZER_SGD
+
+// 3.4 Hyperparameters of the optimizers (LEARNING_RATE is the step of sgd and momentum)
+#define ADAPTIVE_LEARNING_RATE 1e-2 // Step of rmsprop and adam (the derivatives are normalised, so the step is about the change of a param)
+#define MOMENTUM_DECAY 0.9          // Decay of the velocity (momentum) and of the mean of the derivatives (adam)
+#define SQUARED_DECAY 0.999         // Decay of the mean of the squared derivatives (rmsprop and adam)
+#define OPTIMIZER_EPSILON 1e-8      // Added to the root of the squared derivatives, so that a derivative of 0 does not divide by 0
+
 
 /*
 |------------------------|
@@ -99,10 +111,22 @@ extern size_t WORKING_NEURONS;
 #define ACTIVATION_FUNCTION(input) relu(input)
 #define ACTIVATION_FUNCTION_DER(input) 1        // For testing purposes, we simply return the input value
 
+// 4.1.1 Array versions of the activation function and its derivative (output[i] = f(input[i]) for i < size)
+#define ACTIVATION_FUNCTION_ARR(input, output, size) SCALAR_ARR(relu_arr)((input), (output), (size))
+#define ACTIVATION_FUNCTION_DER_ARR(input, output, size) \
+    do { (void)(input); for (size_t i_ = 0; i_ < (size); i_++) (output)[i_] = 1; } while (0)
+
 // 4.2 Cost function definition (a struct with activation function and its derivative)
 #define COST_FUNCTION(actual, pred) mean_squared_error((actual), (pred))
 #define COST_FUNCTION_DER(actual, pred) mean_squared_error_der((actual), (pred))
 
+// 4.3 Softmax output layer for the classification into NUM_OUTPUT > 1 classes (1) or ACTIVATION_FUNCTION and COST_FUNCTION per output (0)
+// The softmax replaces the activation of the output layer and the categorical cross entropy the COST_FUNCTION,
+// their derivative is fused into one kernel (see softmax_cross_entropy_arr()). The labels have to be one hot (or sum up to 1).
+#ifndef SOFTMAX_OUTPUT
+#define SOFTMAX_OUTPUT 0
+#endif
+
 
 /*
 |--------------------|
@@ -114,6 +138,15 @@ extern size_t WORKING_NEURONS;
 #define NUM_THREADS 4
 // To get the number of cores: #include <unistd.h>  int cores = sysconf(_SC_NPROCESSORS_ONLN);
 
+// 5.2 Number of data points a thread pushes through the dense network at once (rows of the matrix products)
+#define BATCH_SIZE 4
+
+// 5.3 Number of data points of a chunk of the work handed out to the threads (a multiple of BATCH_SIZE, see work_queue.c)
+#define WORK_CHUNK_ROWS (2 * BATCH_SIZE)
+
+// 5.4 Type of the values of the dense training engine (double unless built with make PRECISION=single|mixed)
+#include "../precision.h"
+
 
 /*
 |----------------------|